@@ -3093,6 +3093,7 @@ CVideoInfoTag* CFileItem::GetVideoInfoTag()
   if (!m_videoInfoTag)
     m_videoInfoTag = new CVideoInfoTag;
 
+  IncrementRevision();
   return m_videoInfoTag;
 }
 
@@ -3101,6 +3102,7 @@ CEpgInfoTag* CFileItem::GetEPGInfoTag()
   if (!m_epgInfoTag)
     m_epgInfoTag = new CEpgInfoTag;
 
+  IncrementRevision();
   return m_epgInfoTag;
 }
 
@@ -3109,6 +3111,7 @@ CPVRChannel* CFileItem::GetPVRChannelInfoTag()
   if (!m_pvrChannelInfoTag)
     m_pvrChannelInfoTag = new CPVRChannel;
 
+  IncrementRevision();
   return m_pvrChannelInfoTag;
 }
 
@@ -3117,6 +3120,7 @@ CPVRRecording* CFileItem::GetPVRRecordingInfoTag()
   if (!m_pvrRecordingInfoTag)
     m_pvrRecordingInfoTag = new CPVRRecording;
 
+  IncrementRevision();
   return m_pvrRecordingInfoTag;
 }
 
@@ -3125,6 +3129,7 @@ CPVRTimerInfoTag* CFileItem::GetPVRTimerInfoTag()
   if (!m_pvrTimerInfoTag)
     m_pvrTimerInfoTag = new CPVRTimerInfoTag;
 
+  IncrementRevision();
   return m_pvrTimerInfoTag;
 }
 
@@ -3133,6 +3138,7 @@ CPictureInfoTag* CFileItem::GetPictureInfoTag()
   if (!m_pictureInfoTag)
     m_pictureInfoTag = new CPictureInfoTag;
 
+  IncrementRevision();
   return m_pictureInfoTag;
 }
 
@@ -3141,6 +3147,7 @@ MUSIC_INFO::CMusicInfoTag* CFileItem::GetMusicInfoTag()
   if (!m_musicInfoTag)
     m_musicInfoTag = new MUSIC_INFO::CMusicInfoTag;
 
+  IncrementRevision();
   return m_musicInfoTag;
 }
 
@@ -94,7 +94,7 @@ public:
   virtual CGUIListItem *Clone() const { return new CFileItem(*this); };
 
   const CStdString &GetPath() const { return m_strPath; };
-  void SetPath(const CStdString &path) { m_strPath = path; };
+  void SetPath(const CStdString &path) { m_strPath = path; IncrementRevision(); };
 
   void Reset();
   const CFileItem& operator=(const CFileItem& item);
@@ -76,6 +76,7 @@
 
 #include "addons/AddonManager.h"
 #include "interfaces/info/InfoBool.h"
+#include "guilib/GUIControlProfiler.h"
 #include "video/VideoThumbLoader.h"
 #include "music/MusicThumbLoader.h"
 #include "video/VideoDatabase.h"
@@ -109,6 +110,14 @@ CGUIInfoManager::CGUIInfoManager(void) :
   m_frameCounter = 0;
   m_lastFPSTime = 0;
   m_updateTime = 1;
+  m_skinVersion = 0;
+  m_libraryVersion = 0;
+  m_playerVersion = 0;
+  m_playerStateTime = 0;
+  m_playerState = 0;
+  m_playerSpeed = 1;
+  m_boolStatsDepth = 0;
+  ResetBoolStats();
   m_MusicBitrate = 0;
   m_playerShowTime = false;
   m_playerShowCodec = false;
@@ -2035,10 +2044,144 @@ bool CGUIInfoManager::EvaluateBool(const CStdString &expression, int contextWind
 bool CGUIInfoManager::GetBoolValue(unsigned int expression, const CGUIListItem *item)
 {
   if (expression && --expression < m_bools.size())
-    return m_bools[expression]->Get(m_updateTime, item);
+  {
+    InfoBool *info = m_bools[expression];
+    unsigned int version = GetUpdateVersion(info->GetDependencies());
+    if (CGUIControlProfiler::IsRunning())
+      return GetBoolValueProfiled(info, version, item);
+    return info->Get(version, item);
+  }
   return false;
 }
 
+bool CGUIInfoManager::GetBoolValueProfiled(InfoBool *info, unsigned int version, const CGUIListItem *item)
+{
+  m_boolStats.lookups++;
+  if (info->IsDirty(version, item))
+    m_boolStats.evaluations++;
+
+  // operands of expressions are timed as part of the expression
+  int64_t start = 0;
+  if (m_boolStatsDepth++ == 0)
+    start = CurrentHostCounter();
+  bool value = info->Get(version, item);
+  if (--m_boolStatsDepth == 0)
+    m_boolStats.time += CurrentHostCounter() - start;
+  return value;
+}
+
+unsigned int CGUIInfoManager::GetUpdateVersion(unsigned int dependencies)
+{
+  if (dependencies & DEPENDS_PLAYER)
+    UpdatePlayerState();
+
+  // the versions only ever increase, so their sum changes as soon as one of them does
+  unsigned int version = 1;
+  if (dependencies & DEPENDS_SKIN)
+    version += m_skinVersion;
+  if (dependencies & DEPENDS_LIBRARY)
+    version += m_libraryVersion;
+  if (dependencies & DEPENDS_PLAYER)
+    version += m_playerVersion;
+  if (dependencies & DEPENDS_POLLED)
+    version += m_updateTime;
+  return version;
+}
+
+void CGUIInfoManager::SetInfoChanged(unsigned int dependencies)
+{
+  if (dependencies & DEPENDS_SKIN)
+    m_skinVersion++;
+  if (dependencies & DEPENDS_LIBRARY)
+    m_libraryVersion++;
+  if (dependencies & DEPENDS_PLAYER)
+    m_playerVersion++;
+}
+
+void CGUIInfoManager::UpdatePlayerState()
+{
+  if (m_playerStateTime == m_updateTime)
+    return;
+  m_playerStateTime = m_updateTime;
+
+  // the players don't tell us when they pause or change speed, so the
+  // state behind the Player.* conditions is checked once per frame instead
+  int state = 0;
+  int speed = 1;
+  if (g_application.IsPlaying())
+  {
+    state = 1;
+    if (g_application.IsPlayingAudio())
+      state |= 2;
+    if (g_application.IsPlayingVideo())
+      state |= 4;
+    if (g_application.IsPaused())
+      state |= 8;
+    speed = g_application.GetPlaySpeed();
+  }
+  if (state != m_playerState || speed != m_playerSpeed)
+  {
+    m_playerState = state;
+    m_playerSpeed = speed;
+    SetInfoChanged(DEPENDS_PLAYER);
+  }
+}
+
+unsigned int CGUIInfoManager::GetDependencies(int condition) const
+{
+  condition = abs(condition);
+  if (condition >= MULTI_INFO_START && condition <= MULTI_INFO_END)
+  {
+    if (condition - MULTI_INFO_START >= (int)m_multiInfo.size())
+      return DEPENDS_POLLED;
+    switch (abs(m_multiInfo[condition - MULTI_INFO_START].m_info))
+    {
+    case SKIN_BOOL:
+    case SKIN_STRING:
+      return DEPENDS_SKIN;
+    case SYSTEM_HAS_CORE_ID:
+      return DEPENDS_NOTHING;
+    default:
+      return DEPENDS_POLLED;
+    }
+  }
+
+  if (condition == SYSTEM_ALWAYS_TRUE || condition == SYSTEM_ALWAYS_FALSE ||
+      condition == SYSTEM_ETHERNET_LINK_ACTIVE || condition == SYSTEM_HAS_PVR ||
+     (condition >= SYSTEM_PLATFORM_LINUX && condition <= SYSTEM_PLATFORM_ANDROID))
+    return DEPENDS_NOTHING;
+  if (condition >= LIBRARY_HAS_MUSIC && condition <= LIBRARY_HAS_MUSICVIDEOS)
+    return DEPENDS_LIBRARY;
+  if (condition >= PLAYER_HAS_MEDIA && condition <= PLAYER_FORWARDING_32x)
+    return DEPENDS_PLAYER;
+  return DEPENDS_POLLED;
+}
+
+unsigned int CGUIInfoManager::GetBoolDependencies(unsigned int expression) const
+{
+  if (expression && --expression < m_bools.size())
+    return m_bools[expression]->GetDependencies();
+  return DEPENDS_NOTHING;
+}
+
+void CGUIInfoManager::GetBoolStats(BoolStats &stats) const
+{
+  CSingleLock lock(m_critInfo);
+  stats = m_boolStats;
+  stats.conditions = m_bools.size();
+  stats.polled = 0;
+  for (unsigned int i = 0; i < m_bools.size(); ++i)
+  {
+    if (m_bools[i]->GetDependencies() & DEPENDS_POLLED)
+      stats.polled++;
+  }
+}
+
+void CGUIInfoManager::ResetBoolStats()
+{
+  memset(&m_boolStats, 0, sizeof(m_boolStats));
+}
+
 // checks the condition and returns it as necessary.  Currently used
 // for toggle button controls and visibility of images.
 bool CGUIInfoManager::GetBool(int condition1, int contextWindow, const CGUIListItem *item)
@@ -4921,6 +5064,29 @@ CStdString CGUIInfoManager::GetItemLabel(const CFileItem *item, int info, CStdSt
   return "";
 }
 
+bool CGUIInfoManager::IsItemOnlyLabel(int info) const
+{
+  if (info < LISTITEM_START || info > LISTITEM_END)
+    return false;
+  switch (info)
+  {
+  // these follow the player, the timers or the clock rather than the item
+  case LISTITEM_ISPLAYING:
+  case LISTITEM_ISSELECTED:
+  case LISTITEM_HASTIMER:
+  case LISTITEM_ISRECORDING:
+  case LISTITEM_PROGRESS:
+    return false;
+  default:
+    return true;
+  }
+}
+
+bool CGUIInfoManager::CanCacheItemLabels(const CFileItem *item) const
+{
+  return !item->HasPVRChannelInfoTag();
+}
+
 CStdString CGUIInfoManager::GetItemImage(const CFileItem *item, int info, CStdString *fallback)
 {
   if (info >= CONDITIONAL_LABEL_START && info <= CONDITIONAL_LABEL_END)
@@ -5261,8 +5427,9 @@ void CGUIInfoManager::SetLibraryBool(int condition, bool value)
       m_libraryHasMusicVideos = value ? 1 : 0;
       break;
     default:
-      break;
+      return;
   }
+  SetInfoChanged(DEPENDS_LIBRARY);
 }
 
 void CGUIInfoManager::ResetLibraryBools()
@@ -5272,6 +5439,7 @@ void CGUIInfoManager::ResetLibraryBools()
   m_libraryHasTVShows = -1;
   m_libraryHasMusicVideos = -1;
   m_libraryHasMovieSets = -1;
+  SetInfoChanged(DEPENDS_LIBRARY);
 }
 
 bool CGUIInfoManager::GetLibraryBool(int condition)
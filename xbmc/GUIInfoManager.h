@@ -49,6 +49,7 @@ namespace INFO
 {
   class InfoBool;
   class InfoSingle;
+  class InfoExpression;
 }
 
 // conditions for window retrieval
@@ -710,6 +711,26 @@ public:
    */
   bool EvaluateBool(const CStdString &expression, int context = 0);
 
+  /*! \brief Tell the info manager that a source of information changed
+   Registered conditions depending on the source are evaluated again the next time they're asked for.
+   \param dependencies the INFO::InfoDependency flags of the changed sources
+   \sa Register
+   */
+  void SetInfoChanged(unsigned int dependencies);
+
+  /*! \brief Counters of the boolean condition lookups, collected while the control profiler runs
+   */
+  struct BoolStats
+  {
+    unsigned int conditions;  ///< registered conditions
+    unsigned int polled;      ///< registered conditions that are evaluated every frame
+    unsigned int lookups;     ///< values asked for, including the operands of expressions
+    unsigned int evaluations; ///< values that had to be evaluated
+    int64_t time;             ///< time spent in lookups, in host counter ticks
+  };
+  void GetBoolStats(BoolStats &stats) const;
+  void ResetBoolStats();
+
   int TranslateString(const CStdString &strCondition);
 
   /*! \brief Get integer value of info.
@@ -787,6 +808,22 @@ public:
   CStdString GetItemLabel(const CFileItem *item, int info, CStdString *fallback = NULL);
   CStdString GetItemImage(const CFileItem *item, int info, CStdString *fallback = NULL);
 
+  /*! \brief Whether a label info only depends on the item it is shown for
+   Labels made up of such infos are cached with the item until the item changes.
+   \param info the label info
+   \return true if GetItemLabel() returns the same for an unchanged item, false otherwise
+   \sa CanCacheItemLabels
+   */
+  bool IsItemOnlyLabel(int info) const;
+
+  /*! \brief Whether the labels of an item may be cached at all
+   Items of live channels show what is on now, which changes without the item changing.
+   \param item the item
+   \return true if item only labels of this item may be cached, false otherwise
+   \sa IsItemOnlyLabel
+   */
+  bool CanCacheItemLabels(const CFileItem *item) const;
+
   // Called from tuxbox service thread to update current status
   void UpdateFromTuxBox();
 
@@ -816,8 +853,30 @@ public:
   bool ConditionsChangedValues(const std::map<int, bool>& map);
 protected:
   friend class INFO::InfoSingle;
+  friend class INFO::InfoExpression;
   bool GetBool(int condition, int contextWindow = 0, const CGUIListItem *item=NULL);
 
+  /*! \brief The INFO::InfoDependency flags of the sources a single condition depends on
+   */
+  unsigned int GetDependencies(int condition) const;
+
+  /*! \brief The INFO::InfoDependency flags of a registered condition/expression
+   \sa Register
+   */
+  unsigned int GetBoolDependencies(unsigned int expression) const;
+
+  /*! \brief Current version of the given sources
+   The version changes whenever one of the sources changed.
+   \param dependencies INFO::InfoDependency flags of the sources
+   */
+  unsigned int GetUpdateVersion(unsigned int dependencies);
+
+  /*! \brief Check once per frame whether the playback state or speed changed
+   */
+  void UpdatePlayerState();
+
+  bool GetBoolValueProfiled(INFO::InfoBool *info, unsigned int version, const CGUIListItem *item);
+
   // routines for window retrieval
   bool CheckWindowCondition(CGUIWindow *window, int condition) const;
   CGUIWindow *GetWindowWithCondition(int contextWindow, int condition) const;
@@ -915,6 +974,17 @@ protected:
   std::vector<INFO::CSkinVariableString> m_skinVariableStrings;
   unsigned int m_updateTime;
 
+  // versions of the sources that tell us when they change
+  unsigned int m_skinVersion;
+  unsigned int m_libraryVersion;
+  unsigned int m_playerVersion;
+  unsigned int m_playerStateTime;
+  int m_playerState;
+  int m_playerSpeed;
+
+  BoolStats m_boolStats;
+  unsigned int m_boolStatsDepth;
+
   int m_libraryHasMusic;
   int m_libraryHasMovies;
   int m_libraryHasTVShows;
@@ -256,8 +256,10 @@ CStdString CTextureDatabase::GetTextureForPath(const CStdString &url, const CStd
     if (url.empty())
       return "";
 
-    CStdString sql = PrepareSQL("select texture from path where url='%s' and type='%s'", url.c_str(), type.c_str());
-    m_pDS->query(sql.c_str());
+    dbiplus::sql_record params;
+    params.push_back(url.c_str());
+    params.push_back(type.c_str());
+    m_pDS->query("select texture from path where url=? and type=?", params);
 
     if (!m_pDS->eof())
     { // have some information
@@ -39,17 +39,22 @@ CSoftAEStream::CSoftAEStream(enum AEDataFormat dataFormat, unsigned int sampleRa
   m_internalRatio   (1.0  ),
   m_convertBuffer   (NULL ),
   m_valid           (false),
-  m_delete          (false),
+  m_delete          (0    ),
   m_volume          (1.0f ),
   m_rgain           (1.0f ),
   m_refillBuffer    (0    ),
   m_convertFn       (NULL ),
   m_ssrc            (NULL ),
   m_framesBuffered  (0    ),
+  m_generation      (0    ),
   m_newPacket       (NULL ),
   m_packet          (NULL ),
+  m_mixerEmpty      (1    ),
   m_vizPacketPos    (NULL ),
-  m_draining        (false),
+  m_draining        (0    ),
+  m_underruns       (0    ),
+  m_overruns        (0    ),
+  m_contention      (0    ),
   m_vizBufferSamples(0    ),
   m_audioCallback   (NULL ),
   m_fadeRunning     (false),
@@ -100,6 +105,7 @@ void CSoftAEStream::Initialize()
   if (m_valid)
   {
     InternalFlush();
+    FreePackets();
     delete m_newPacket;
 
     if (m_convert)
@@ -165,6 +171,7 @@ void CSoftAEStream::Initialize()
   }
 
   m_packet = NULL;
+  m_mixerEmpty = 1;
 
   m_inputBuffer.Alloc(m_format.m_frames * m_format.m_frameSize);
 
@@ -198,6 +205,13 @@ void CSoftAEStream::Initialize()
     m_ssrcData.end_of_input  = 0;
   }
 
+  /*
+    size the packet queue to hold the water level plus one resampled input
+    buffer, each packet holds m_format.m_frames frames
+  */
+  unsigned int maxRatio = m_resample ? (unsigned int)std::ceil(m_internalRatio) : 1;
+  m_outBuffer.Resize(m_waterLevel / m_format.m_frames + maxRatio + 8);
+
   m_limiter.SetSamplerate(AE.GetSampleRate());
 
   m_chLayoutCount = m_format.m_channelLayout.Count();
@@ -207,8 +221,8 @@ void CSoftAEStream::Initialize()
 void CSoftAEStream::Destroy()
 {
   CExclusiveLock lock(m_lock);
-  m_valid       = false;
-  m_delete      = true;
+  /* the mixer may be running, it only looks at m_delete */
+  AtomicIncrement(&m_delete);
 }
 
 CSoftAEStream::~CSoftAEStream()
@@ -216,6 +230,7 @@ CSoftAEStream::~CSoftAEStream()
   CExclusiveLock lock(m_lock);
 
   InternalFlush();
+  FreePackets();
   if (m_convert)
     _aligned_free(m_convertBuffer);
 
@@ -227,34 +242,42 @@ CSoftAEStream::~CSoftAEStream()
   }
 
   delete m_newPacket;
-  delete m_packet;
 
-  CLog::Log(LOGDEBUG, "CSoftAEStream::~CSoftAEStream - Destructed");
+  CLog::Log(LOGDEBUG, "CSoftAEStream::~CSoftAEStream - Destructed, %u underruns, %u overruns, %u lock waits",
+    GetUnderruns(), GetOverruns(), GetContention());
 }
 
 unsigned int CSoftAEStream::GetSpace()
 {
-  if (!m_valid || m_draining)
+  if (!m_valid || m_delete || m_draining)
     return 0;
 
-  if (m_framesBuffered >= m_waterLevel)
+  unsigned int buffered = GetFramesBuffered();
+  if (buffered >= m_waterLevel)
     return 0;
 
-  return m_inputBuffer.Free() + (std::max(0U, (m_waterLevel - m_framesBuffered)) * m_format.m_frameSize);
+  return m_inputBuffer.Free() + ((m_waterLevel - buffered) * m_format.m_frameSize);
 }
 
 unsigned int CSoftAEStream::AddData(void *data, unsigned int size)
 {
-  CExclusiveLock lock(m_lock);
-  if (!m_valid || size == 0 || data == NULL)
+  /* the mixer never takes m_lock, so any wait here is on another producer call */
+  CExclusiveLock lock(m_lock, true);
+  if (!lock.IsOwner())
+  {
+    AtomicIncrement(&m_contention);
+    lock.Enter();
+  }
+
+  if (!m_valid || m_delete || size == 0 || data == NULL)
     return 0;
 
   /* if the stream is draining */
   if (m_draining)
   {
     /* if the stream has finished draining, cork it */
-    if (m_packet && !m_packet->data.Used() && m_outBuffer.empty())
-      m_draining = false;
+    if (m_mixerEmpty && m_outBuffer.Empty())
+      cas(&m_draining, 1, 0);
     else
       return 0;
   }
@@ -278,6 +301,12 @@ unsigned int CSoftAEStream::AddData(void *data, unsigned int size)
 
     if (m_inputBuffer.Free() == 0)
     {
+      /* the mixer is behind, take less rather than drop processed audio */
+      if (!HasPacketRoom())
+      {
+        AtomicIncrement(&m_overruns);
+        break;
+      }
       unsigned int consumed = ProcessFrameBuffer();
       m_inputBuffer.Shift(NULL, consumed);
     }
@@ -286,12 +315,19 @@ unsigned int CSoftAEStream::AddData(void *data, unsigned int size)
   lock.Leave();
 
   /* if the stream is flagged to autoStart when the buffer is full, then do it */
-  if (m_autoStart && m_framesBuffered >= m_waterLevel)
+  if (m_autoStart && GetFramesBuffered() >= m_waterLevel)
     Resume();
 
   return taken;
 }
 
+bool CSoftAEStream::HasPacketRoom()
+{
+  /* a block of input makes at most one packet per unit of resample ratio, plus a partial one */
+  unsigned int packets = (m_resample ? (unsigned int)std::ceil(m_ssrcData.src_ratio) : 1) + 1;
+  return m_outBuffer.Capacity() - m_outBuffer.Count() >= packets;
+}
+
 unsigned int CSoftAEStream::ProcessFrameBuffer()
 {
   uint8_t     *data;
@@ -340,16 +376,17 @@ unsigned int CSoftAEStream::ProcessFrameBuffer()
     consumed = frames * m_bytesPerFrame;
   }
 
-  if (m_refillBuffer)
+  /* count down the refill, the mixer may set it meanwhile */
+  long refill;
+  do
   {
-    if (frames > m_refillBuffer)
-      m_refillBuffer = 0;
-    else
-      m_refillBuffer -= frames;
-  }
+    refill = m_refillBuffer;
+    if (!refill)
+      break;
+  } while (cas(&m_refillBuffer, refill, (long)frames > refill ? 0 : refill - (long)frames) != refill);
 
   /* buffer the data */
-  m_framesBuffered += frames;
+  AtomicAdd(&m_framesBuffered, frames);
   const unsigned int inputBlockSize = m_format.m_frames * m_format.m_channelLayout.Count() * sampleSize;
 
   size_t remaining = samples * sampleSize;
@@ -367,7 +404,13 @@ unsigned int CSoftAEStream::ProcessFrameBuffer()
     /* if we have a full block of data */
     if (AE_IS_RAW(m_initDataFormat))
     {
-      m_outBuffer.push_back(m_newPacket);
+      m_newPacket->generation = m_generation;
+      if (!m_outBuffer.Push(m_newPacket))
+      {
+        AtomicIncrement(&m_overruns);
+        AtomicSubtract(&m_framesBuffered, m_newPacket->data.Used() / m_aeBytesPerFrame);
+        delete m_newPacket;
+      }
       m_newPacket = new PPacket();
       m_newPacket->data.Alloc(inputBlockSize);
       continue;
@@ -399,7 +442,13 @@ unsigned int CSoftAEStream::ProcessFrameBuffer()
     }
 
     /* add the packet to the output */
-    m_outBuffer.push_back(pkt);
+    pkt->generation = m_generation;
+    if (!m_outBuffer.Push(pkt))
+    {
+      AtomicIncrement(&m_overruns);
+      AtomicSubtract(&m_framesBuffered, frames);
+      delete pkt;
+    }
     m_newPacket->data.Empty();
   }
 
@@ -408,10 +457,12 @@ unsigned int CSoftAEStream::ProcessFrameBuffer()
 
 uint8_t* CSoftAEStream::GetFrame()
 {
-  CExclusiveLock lock(m_lock);
-
-  /* if we are fading, this runs even if we have underrun as it is time based */
-  if (m_fadeRunning)
+  /*
+    if we are fading, this runs even if we have underrun as it is time based,
+    a step is skipped rather than waiting when a fade is being set up
+  */
+  CSingleTryLock fadeLock(m_fadeLock);
+  if (fadeLock.IsOwner() && m_fadeRunning)
   {
     m_volume += m_fadeStep;
     m_volume = std::min(1.0f, std::max(0.0f, m_volume));
@@ -426,54 +477,80 @@ uint8_t* CSoftAEStream::GetFrame()
         m_fadeRunning = false;
     }
   }
+  fadeLock.Leave();
 
-  /* if we have been deleted or are refilling but not draining */
-  if (!m_valid || m_delete || (m_refillBuffer && !m_draining))
+  /* if we have been deleted */
+  if (!m_valid || m_delete)
     return NULL;
 
-  /* if the packet is empty, advance to the next one */
-  if (!m_packet || m_packet->data.CursorEnd())
+  /*
+    if the packet is empty or has been flushed, advance to the next one. This
+    runs while refilling too, packets queued before a flush take up the room
+    the producer needs to count the refill down
+  */
+  const long generation = m_generation;
+  if (!m_packet || m_packet->data.CursorEnd() || m_packet->generation != generation)
   {
     delete m_packet;
     m_packet = NULL;
+    m_mixerEmpty = 1;
+
+    /* get the next packet, skipping any that were queued before a flush */
+    PPacket *pkt;
+    while (m_outBuffer.Pop(pkt))
+    {
+      if (pkt->generation == generation)
+      {
+        m_packet = pkt;
+        m_mixerEmpty = 0;
+        break;
+      }
+      delete pkt;
+    }
 
     /* no more packets, return null */
-    if (m_outBuffer.empty())
+    if (!m_packet)
     {
-      if (m_draining)
+      if (m_draining || m_refillBuffer)
         return NULL;
       else
       {
         /* underrun, we need to refill our buffers */
         CLog::Log(LOGDEBUG, "CSoftAEStream::GetFrame - Underrun");
-        ASSERT(m_waterLevel > m_framesBuffered);
-        m_refillBuffer = m_waterLevel - m_framesBuffered;
+        AtomicIncrement(&m_underruns);
+        unsigned int buffered = GetFramesBuffered();
+        ASSERT(m_waterLevel > buffered);
+        cas(&m_refillBuffer, 0, m_waterLevel - buffered);
         return NULL;
       }
     }
-
-    /* get the next packet */
-    m_packet = m_outBuffer.front();
-    m_outBuffer.pop_front();
   }
 
+  /* hold on to the packet until the producer has refilled, unless we are draining */
+  if (m_refillBuffer && !m_draining)
+    return NULL;
+
   /* fetch one frame of data */
   uint8_t *ret = (uint8_t*)m_packet->data.CursorRead(m_aeBytesPerFrame);
 
   /* we have a frame, if we have a viz we need to hand the data to it */
   if (m_audioCallback && !m_packet->vizData.CursorEnd())
   {
+    CSingleLock vizLock(m_vizLock);
     float *vizData = (float*)m_packet->vizData.CursorRead(2 * sizeof(float));
-    memcpy(m_vizBuffer + m_vizBufferSamples, vizData, 2 * sizeof(float));
-    m_vizBufferSamples += 2;
-    if (m_vizBufferSamples == 512)
+    if (m_audioCallback)
     {
-      m_audioCallback->OnAudioData(m_vizBuffer, 512);
-      m_vizBufferSamples = 0;
+      memcpy(m_vizBuffer + m_vizBufferSamples, vizData, 2 * sizeof(float));
+      m_vizBufferSamples += 2;
+      if (m_vizBufferSamples == 512)
+      {
+        m_audioCallback->OnAudioData(m_vizBuffer, 512);
+        m_vizBufferSamples = 0;
+      }
     }
   }
 
-  --m_framesBuffered;
+  AtomicDecrement(&m_framesBuffered);
   return ret;
 }
 
@@ -484,7 +561,7 @@ double CSoftAEStream::GetDelay()
 
   double delay = AE.GetDelay();
   delay += (double)(m_inputBuffer.Used() / m_format.m_frameSize) / (double)m_format.m_sampleRate;
-  delay += (double)m_framesBuffered                              / (double)AE.GetSampleRate();
+  delay += (double)GetFramesBuffered()                           / (double)AE.GetSampleRate();
 
   return delay;
 }
@@ -496,7 +573,7 @@ double CSoftAEStream::GetCacheTime()
 
   double time;
   time  = (double)(m_inputBuffer.Used() / m_format.m_frameSize) / (double)m_format.m_sampleRate;
-  time += (double)(m_waterLevel - m_framesBuffered)             / (double)AE.GetSampleRate();
+  time += (double)(m_waterLevel - GetFramesBuffered())            / (double)AE.GetSampleRate();
   time += AE.GetCacheTime();
   return time;
 }
@@ -532,14 +609,13 @@ void CSoftAEStream::Resume()
 
 void CSoftAEStream::Drain()
 {
-  CSharedLock lock(m_lock);
-  m_draining = true;
+  cas(&m_draining, 0, 1);
 }
 
+/* called by the mixer, only reads state that is published without m_lock */
 bool CSoftAEStream::IsDrained()
 {
-  CSharedLock lock(m_lock);
-  return (m_draining && !m_packet && m_outBuffer.empty());
+  return (m_draining && m_mixerEmpty && m_outBuffer.Empty());
 }
 
 void CSoftAEStream::Flush()
@@ -565,24 +641,31 @@ void CSoftAEStream::InternalFlush()
   m_newPacket->data.Empty();
 
   /*
-    clear the current buffered packet, we cant delete the data as it may be
-    in use by the AE thread, so we just seek to the end of the buffer
+    the current and queued packets belong to the AE thread, bumping the
+    generation makes it drop them the next time it fetches a frame
   */
-  if (m_packet)
-    m_packet->data.CursorSeek(m_packet->data.Size());
-
-  /* clear any other buffered packets */
-  while (!m_outBuffer.empty())
-  {
-    PPacket *p = m_outBuffer.front();
-    m_outBuffer.pop_front();
-    delete p;
-  }
+  AtomicIncrement(&m_generation);
 
   /* reset our counts */
-  m_framesBuffered = 0;
+  long buffered;
+  do
+  {
+    buffered = m_framesBuffered;
+  } while (cas(&m_framesBuffered, buffered, 0) != buffered);
   m_refillBuffer   = m_waterLevel;
-  m_draining       = false;
+  cas(&m_draining, 1, 0);
+}
+
+/* frees all queued packets, this must only be called from the AE thread */
+void CSoftAEStream::FreePackets()
+{
+  delete m_packet;
+  m_packet = NULL;
+  m_mixerEmpty = 1;
+
+  PPacket *pkt;
+  while (m_outBuffer.Pop(pkt))
+    delete pkt;
 }
 
 double CSoftAEStream::GetResampleRatio()
@@ -621,6 +704,7 @@ bool CSoftAEStream::SetResampleRatio(double ratio)
 void CSoftAEStream::RegisterAudioCallback(IAudioCallback* pCallback)
 {
   CExclusiveLock lock(m_lock);
+  CSingleLock vizLock(m_vizLock);
   m_vizBufferSamples = 0;
   m_audioCallback = pCallback;
   if (m_audioCallback)
@@ -630,6 +714,7 @@ void CSoftAEStream::RegisterAudioCallback(IAudioCallback* pCallback)
 void CSoftAEStream::UnRegisterAudioCallback()
 {
   CExclusiveLock lock(m_lock);
+  CSingleLock vizLock(m_vizLock);
   m_audioCallback = NULL;
   m_vizBufferSamples = 0;
 }
@@ -640,7 +725,7 @@ void CSoftAEStream::FadeVolume(float from, float target, unsigned int time)
   if (AE_IS_RAW(m_initDataFormat))
     return;
 
-  CExclusiveLock lock(m_lock);
+  CSingleLock lock(m_fadeLock);
   float delta   = target - from;
   m_fadeDirUp   = target > from;
   m_fadeTarget  = target;
@@ -650,10 +735,22 @@ void CSoftAEStream::FadeVolume(float from, float target, unsigned int time)
 
 bool CSoftAEStream::IsFading()
 {
-  CSharedLock lock(m_lock);
+  CSingleLock lock(m_fadeLock);
   return m_fadeRunning;
 }
 
+float CSoftAEStream::GetVolume()
+{
+  CSingleLock lock(m_fadeLock);
+  return m_volume;
+}
+
+void CSoftAEStream::SetVolume(float volume)
+{
+  CSingleLock lock(m_fadeLock);
+  m_volume = std::max( 0.0f, std::min(1.0f, volume));
+}
+
 void CSoftAEStream::RegisterSlave(IAEStream *slave)
 {
   CSharedLock lock(m_lock);
@@ -20,8 +20,8 @@
  */
 
 #include <samplerate.h>
-#include <list>
 
+#include "threads/CriticalSection.h"
 #include "threads/SharedSection.h"
 
 #include "AEAudioFormat.h"
@@ -30,22 +30,26 @@
 #include "Utils/AERemap.h"
 #include "Utils/AEBuffer.h"
 #include "Utils/AELimiter.h"
+#include "Utils/AELockFreeQueue.h"
 
 class IAEPostProc;
 class CSoftAEStream : public IAEStream
 {
 protected:
   friend class CSoftAE;
+  friend class TestSoftAEStreamHelper;
   CSoftAEStream(enum AEDataFormat format, unsigned int sampleRate, unsigned int encodedSamplerate, CAEChannelInfo channelLayout, unsigned int options);
   virtual ~CSoftAEStream();
 
   void Initialize();
   void InitializeRemap();
   void Destroy();
+
+  /* only ever called from the AE thread, this does not take m_lock */
   uint8_t* GetFrame();
 
   bool IsPaused   () { return m_paused; }
-  bool IsDestroyed() { return m_delete; }
+  bool IsDestroyed() { return m_delete != 0; }
   bool IsValid    () { return m_valid;  }
   const bool IsRaw() const { return AE_IS_RAW(m_initDataFormat); }  
 
@@ -60,14 +64,14 @@ public:
   virtual void              Pause           ();
   virtual void              Resume          ();
   virtual void              Drain           ();
-  virtual bool              IsDraining      () { return m_draining;    }
+  virtual bool              IsDraining      () { return m_draining != 0; }
   virtual bool              IsDrained       ();
   virtual void              Flush           ();
 
-  virtual float             GetVolume       ()             { return m_volume; }
+  virtual float             GetVolume       ();
   virtual float             GetReplayGain   ()             { return m_rgain ; }
   virtual float             GetAmplification()             { return m_limiter.GetAmplification(); }
-  virtual void              SetVolume       (float volume) { m_volume = std::max( 0.0f, std::min(1.0f, volume)); }
+  virtual void              SetVolume       (float volume);
   virtual void              SetReplayGain   (float factor) { m_rgain  = std::max( 0.0f, factor); }
   virtual void              SetAmplification(float amplify){ m_limiter.SetAmplification(amplify); }
 
@@ -87,8 +91,16 @@ public:
   virtual void              FadeVolume(float from, float to, unsigned int time);
   virtual bool              IsFading();
   virtual void              RegisterSlave(IAEStream *stream);
+
+  unsigned int              GetUnderruns    () const { return (unsigned int)m_underruns;  } /* times the mixer ran out of data */
+  unsigned int              GetOverruns     () const { return (unsigned int)m_overruns;   } /* times AddData backed off as the queue was full */
+  unsigned int              GetContention   () const { return (unsigned int)m_contention; } /* times AddData had to wait for m_lock */
 private:
   void InternalFlush();
+  void FreePackets();
+
+  /* the mixer may count down frames of a packet that was just flushed */
+  inline unsigned int GetFramesBuffered() const { long frames = m_framesBuffered; return frames > 0 ? (unsigned int)frames : 0; }
   void CheckResampleBuffers();
 
   CSharedSection    m_lock;
@@ -102,6 +114,7 @@ private:
   {
     CAEBuffer data;
     CAEBuffer vizData;
+    long      generation; /* the flush generation the packet was produced in */
   } PPacket;
 
   AEAudioFormat m_format;
@@ -112,13 +125,17 @@ private:
   double                  m_internalRatio; /* internal resample ratio */ 
   bool                    m_convert;       /* true if the bitspersample needs converting */
   float                  *m_convertBuffer; /* buffer for converted data */
-  bool                    m_valid;         /* true if the stream is valid */
-  bool                    m_delete;        /* true if CSoftAE is to free this object */
+  bool                    m_valid;         /* true if the stream is valid, only changed on the AE thread */
+  volatile long           m_delete;        /* non zero if CSoftAE is to free this object */
   CAERemap                m_remap;         /* the remapper */
   float                   m_volume;        /* the volume level */
   float                   m_rgain;         /* replay gain level */
   unsigned int            m_waterLevel;    /* the fill level to fall below before calling the data callback */
-  unsigned int            m_refillBuffer;  /* how many frames that need to be buffered before we return any frames */
+  /*
+    the producer only counts this down while it is non zero and the mixer only
+    sets it while it is zero, both with cas so neither side loses the others update
+  */
+  volatile long           m_refillBuffer;  /* how many frames that need to be buffered before we return any frames */
 
   CAEConvert::AEConvertToFn m_convertFn;
 
@@ -130,25 +147,35 @@ private:
   unsigned int        m_aeBytesPerFrame;
   SRC_STATE          *m_ssrc;
   SRC_DATA            m_ssrcData;
-  unsigned int        m_framesBuffered;
-  std::list<PPacket*> m_outBuffer;
+  volatile long       m_framesBuffered;
+  CAELockFreeQueue<PPacket*> m_outBuffer; /* producer -> mixer handoff */
+  volatile long       m_generation;        /* bumped on flush, stale packets are dropped by the mixer */
   unsigned int        ProcessFrameBuffer();
+  bool                HasPacketRoom();
   PPacket            *m_newPacket;
-  PPacket            *m_packet;
+  PPacket            *m_packet;            /* owned by the mixer */
+  volatile long       m_mixerEmpty;        /* non zero while the mixer holds no packet, published for the producer */
   uint8_t            *m_packetPos;
   float              *m_vizPacketPos;
   bool                m_paused;
   bool                m_autoStart;
-  bool                m_draining;
+  volatile long       m_draining;          /* non zero once Drain is called, read by the mixer without m_lock */
   CAELimiter          m_limiter;
 
+  /* stream statistics */
+  volatile long      m_underruns;
+  volatile long      m_overruns;
+  volatile long      m_contention;
+
   /* vizualization internals */
+  CCriticalSection   m_vizLock; /* protects m_audioCallback against the mixer */
   CAERemap           m_vizRemap;
   float              m_vizBuffer[512];
   unsigned int       m_vizBufferSamples;
   IAudioCallback    *m_audioCallback;
 
-  /* fade values */
+  /* fade values, m_fadeLock also guards m_volume as the mixer changes it while fading */
+  CCriticalSection   m_fadeLock;
   bool               m_fadeRunning;
   bool               m_fadeDirUp;
   float              m_fadeStep;
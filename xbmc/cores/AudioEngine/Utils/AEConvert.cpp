@@ -25,6 +25,7 @@
 #include "AEUtil.h"
 #include "utils/MathUtils.h"
 #include "utils/EndianSwap.h"
+#include "utils/CPUInfo.h"
 #include <stdint.h>
 
 #if defined(TARGET_WINDOWS)
@@ -67,6 +68,30 @@ static inline int safeRound(double f)
 
 CAEConvert::AEConvertToFn CAEConvert::ToFloat(enum AEDataFormat dataFormat)
 {
+  return ToFloat(dataFormat, g_cpuInfo.GetCPUFeatures());
+}
+
+CAEConvert::AEConvertToFn CAEConvert::ToFloat(enum AEDataFormat dataFormat, unsigned int cpuFeatures)
+{
+#if defined(__SSE2__)
+  if (cpuFeatures & CPU_FEATURE_SSE2)
+  {
+    switch (dataFormat)
+    {
+      case AE_FMT_S16NE : return &S16LE_Float_SSE2;
+      case AE_FMT_S32NE : return &S32LE_Float_SSE2;
+      case AE_FMT_S24NE4: return &S24LE4_Float_SSE2;
+      case AE_FMT_S16LE : return &S16LE_Float_SSE2;
+      case AE_FMT_S16BE : return &S16BE_Float_SSE2;
+      case AE_FMT_S24LE4: return &S24LE4_Float_SSE2;
+      case AE_FMT_S32LE : return &S32LE_Float_SSE2;
+      case AE_FMT_S32BE : return &S32BE_Float_SSE2;
+      default:
+        break;
+    }
+  }
+#endif
+
   switch (dataFormat)
   {
     case AE_FMT_U8    : return &U8_Float;
@@ -176,7 +201,7 @@ unsigned int CAEConvert::S16LE_Float(uint8_t* data, const unsigned int samples,
   }
 #else
   for (unsigned int i = 0; i < samples; ++i, data += 2)
-    *dest++ = Endian_SwapLE16(*(int16_t*)data) * mul;
+    *dest++ = (int16_t)Endian_SwapLE16(*(uint16_t*)data) * mul;
 #endif
 
   return samples;
@@ -207,7 +232,7 @@ unsigned int CAEConvert::S16BE_Float(uint8_t* data, const unsigned int samples,
   }
 #else
   for (unsigned int i = 0; i < samples; ++i, data += 2)
-    *dest++ = Endian_SwapBE16(*(int16_t*)data) * mul;
+    *dest++ = (int16_t)Endian_SwapBE16(*(uint16_t*)data) * mul;
 #endif
 
   return samples;
@@ -261,15 +286,15 @@ unsigned int CAEConvert::S32LE_Float(uint8_t *data, const unsigned int samples,
   /* do this in groups of 4 to give the compiler a better chance of optimizing this */
   for (float *end = dest + (samples & ~0x3); dest < end;)
   {
-    *dest++ = (float)Endian_SwapLE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapLE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapLE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapLE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapLE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapLE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapLE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapLE32(*src++) * factor;
   }
 
   /* process any remaining samples */
   for (float *end = dest + (samples & 0x3); dest < end;)
-    *dest++ = (float)Endian_SwapLE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapLE32(*src++) * factor;
 
   return samples;
 }
@@ -320,15 +345,15 @@ unsigned int CAEConvert::S32BE_Float(uint8_t *data, const unsigned int samples,
   /* do this in groups of 4 to give the compiler a better chance of optimizing this */
   for (float *end = dest + (samples & ~0x3); dest < end;)
   {
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
   }
 
   /* process any remaining samples */
   for (float *end = dest + (samples & 0x3); dest < end;)
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
 
   return samples;
 }
@@ -371,6 +396,133 @@ unsigned int CAEConvert::S32BE_Float_Neon(uint8_t *data, const unsigned int samp
   return samples;
 }
 
+#if defined(__SSE2__)
+/*
+  The SSE2 converters below produce exactly the same output as the scalar
+  versions, the integer to float conversion and the scale are both done in
+  single precision with the default rounding mode. Neither the source nor the
+  destination buffers are required to be aligned.
+*/
+static inline __m128i SwapBE16_SSE2(__m128i val)
+{
+  return _mm_or_si128(_mm_slli_epi16(val, 8), _mm_srli_epi16(val, 8));
+}
+
+static inline __m128i SwapBE32_SSE2(__m128i val)
+{
+  val = _mm_shufflelo_epi16(val, _MM_SHUFFLE(2, 3, 0, 1));
+  val = _mm_shufflehi_epi16(val, _MM_SHUFFLE(2, 3, 0, 1));
+  return SwapBE16_SSE2(val);
+}
+
+static inline void S16_Float_SSE2(__m128i val, const __m128 mul, float *dest)
+{
+  /* sign extend the 8 shorts into two sets of 4 ints */
+  __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(val, val), 16);
+  __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(val, val), 16);
+  _mm_storeu_ps(dest    , _mm_mul_ps(_mm_cvtepi32_ps(lo), mul));
+  _mm_storeu_ps(dest + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), mul));
+}
+#endif
+
+unsigned int CAEConvert::S16LE_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+#if defined(__SSE2__)
+  const __m128 mul = _mm_set_ps1(1.0f / (INT16_MAX + 0.5f));
+  const unsigned int even = samples & ~0x7;
+
+  /* groups of 8 samples */
+  for (unsigned int i = 0; i < even; i += 8, data += 16, dest += 8)
+    S16_Float_SSE2(_mm_loadu_si128((const __m128i*)data), mul, dest);
+
+  /* process any remaining samples */
+  if (samples != even)
+    S16LE_Float(data, samples - even, dest);
+#endif
+  return samples;
+}
+
+unsigned int CAEConvert::S16BE_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+#if defined(__SSE2__)
+  const __m128 mul = _mm_set_ps1(1.0f / (INT16_MAX + 0.5f));
+  const unsigned int even = samples & ~0x7;
+
+  /* groups of 8 samples */
+  for (unsigned int i = 0; i < even; i += 8, data += 16, dest += 8)
+    S16_Float_SSE2(SwapBE16_SSE2(_mm_loadu_si128((const __m128i*)data)), mul, dest);
+
+  /* process any remaining samples */
+  if (samples != even)
+    S16BE_Float(data, samples - even, dest);
+#endif
+  return samples;
+}
+
+unsigned int CAEConvert::S24LE4_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+#if defined(__SSE2__)
+  const __m128 mul = _mm_set_ps1(INT32_SCALE);
+  const unsigned int even = samples & ~0x3;
+
+  /* groups of 4 samples, the padding byte is shifted out */
+  for (unsigned int i = 0; i < even; i += 4, data += 16, dest += 4)
+  {
+    __m128i val = _mm_slli_epi32(_mm_loadu_si128((const __m128i*)data), 8);
+    _mm_storeu_ps(dest, _mm_mul_ps(_mm_cvtepi32_ps(val), mul));
+  }
+
+  /* process any remaining samples */
+  if (samples != even)
+    S24LE4_Float(data, samples - even, dest);
+#endif
+  return samples;
+}
+
+unsigned int CAEConvert::S32LE_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+#if defined(__SSE2__)
+  const __m128 mul = _mm_set_ps1(1.0f / (float)INT32_MAX);
+  const unsigned int even = samples & ~0x7;
+
+  /* groups of 8 samples */
+  for (unsigned int i = 0; i < even; i += 8, data += 32, dest += 8)
+  {
+    __m128i lo = _mm_loadu_si128((const __m128i*)data);
+    __m128i hi = _mm_loadu_si128((const __m128i*)(data + 16));
+    _mm_storeu_ps(dest    , _mm_mul_ps(_mm_cvtepi32_ps(lo), mul));
+    _mm_storeu_ps(dest + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), mul));
+  }
+
+  /* process any remaining samples */
+  if (samples != even)
+    S32LE_Float(data, samples - even, dest);
+#endif
+  return samples;
+}
+
+unsigned int CAEConvert::S32BE_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+#if defined(__SSE2__)
+  const __m128 mul = _mm_set_ps1(1.0f / (float)INT32_MAX);
+  const unsigned int even = samples & ~0x7;
+
+  /* groups of 8 samples */
+  for (unsigned int i = 0; i < even; i += 8, data += 32, dest += 8)
+  {
+    __m128i lo = SwapBE32_SSE2(_mm_loadu_si128((const __m128i*)data));
+    __m128i hi = SwapBE32_SSE2(_mm_loadu_si128((const __m128i*)(data + 16)));
+    _mm_storeu_ps(dest    , _mm_mul_ps(_mm_cvtepi32_ps(lo), mul));
+    _mm_storeu_ps(dest + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), mul));
+  }
+
+  /* process any remaining samples */
+  if (samples != even)
+    S32BE_Float(data, samples - even, dest);
+#endif
+  return samples;
+}
+
 unsigned int CAEConvert::DOUBLE_Float(uint8_t *data, const unsigned int samples, float *dest)
 {
   double *src = (double*)data;
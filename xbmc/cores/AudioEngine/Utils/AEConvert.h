@@ -51,11 +51,21 @@ private:
   static unsigned int Float_S32LE_Neon (float   *data, const unsigned int samples, uint8_t *dest);
   static unsigned int Float_S32BE_Neon (float   *data, const unsigned int samples, uint8_t *dest);
 
+  static unsigned int S16LE_Float_SSE2 (uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S16BE_Float_SSE2 (uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S24LE4_Float_SSE2(uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S32LE_Float_SSE2 (uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S32BE_Float_SSE2 (uint8_t *data, const unsigned int samples, float   *dest);
+
 public:
   typedef unsigned int (*AEConvertToFn)(uint8_t *data, const unsigned int samples, float   *dest);
   typedef unsigned int (*AEConvertFrFn)(float   *data, const unsigned int samples, uint8_t *dest);
 
   static AEConvertToFn ToFloat(enum AEDataFormat dataFormat);
+  /*! \brief Select a converter for the given set of CPU_FEATURE_* flags.
+   Used by ToFloat with the features of the running CPU, and by the test suite to compare the SIMD and scalar converters.
+   */
+  static AEConvertToFn ToFloat(enum AEDataFormat dataFormat, unsigned int cpuFeatures);
   static AEConvertFrFn FrFloat(enum AEDataFormat dataFormat);
 };
 
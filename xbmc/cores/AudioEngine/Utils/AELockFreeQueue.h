@@ -0,0 +1,109 @@
+#pragma once
+/*
+ *      Copyright (C) 2010-2012 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/Atomics.h"
+#include <vector>
+
+/**
+ * Wait-free queue for handing items from one producer thread to one consumer
+ * thread. Push must only be called by the producer and Pop by the consumer,
+ * neither side ever blocks on the other.
+ *
+ * Each side owns its own position, the only shared state is the item count
+ * which is updated with full barrier atomics after the slot has been written
+ * (Push) or read (Pop).
+ *
+ * Resize and Clear are not thread-safe, only call them while neither side
+ * is running.
+ */
+template <typename T>
+class CAELockFreeQueue
+{
+public:
+  CAELockFreeQueue(unsigned int size = 0) :
+    m_readPos (0),
+    m_writePos(0),
+    m_count   (0)
+  {
+    Resize(size);
+  }
+
+  void Resize(unsigned int size)
+  {
+    m_items.assign(size, T());
+    m_readPos  = 0;
+    m_writePos = 0;
+    m_count    = 0;
+  }
+
+  void Clear()
+  {
+    Resize(m_items.size());
+  }
+
+  /**
+   * Adds an item to the queue, producer only.
+   * @return false if the queue is full
+   */
+  bool Push(const T &item)
+  {
+    if ((unsigned long)AtomicAdd(&m_count, 0) >= m_items.size())
+      return false;
+
+    m_items[m_writePos] = item;
+    if (++m_writePos == m_items.size())
+      m_writePos = 0;
+
+    /* publish the item */
+    AtomicIncrement(&m_count);
+    return true;
+  }
+
+  /**
+   * Takes the oldest item from the queue, consumer only.
+   * @return false if the queue is empty
+   */
+  bool Pop(T &item)
+  {
+    if (AtomicAdd(&m_count, 0) == 0)
+      return false;
+
+    item = m_items[m_readPos];
+    m_items[m_readPos] = T();
+    if (++m_readPos == m_items.size())
+      m_readPos = 0;
+
+    /* release the slot back to the producer */
+    AtomicDecrement(&m_count);
+    return true;
+  }
+
+  /* these are only a snapshot when called while the other side is running */
+  bool         Empty   () const { return m_count == 0;           }
+  unsigned int Count   () const { return (unsigned int)m_count;  }
+  unsigned int Capacity() const { return m_items.size();         }
+
+private:
+  std::vector<T> m_items;
+  unsigned int   m_readPos;  /* consumer owned */
+  unsigned int   m_writePos; /* producer owned */
+  volatile long  m_count;
+};
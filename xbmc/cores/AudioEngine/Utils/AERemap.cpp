@@ -26,11 +26,20 @@
 #include "utils/log.h"
 #include "settings/GUISettings.h"
 
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
 using namespace std;
 
-CAERemap::CAERemap() : m_inChannels(0), m_outChannels(0) 
+CAERemap::CAERemap() :
+  m_inChannels (0),
+  m_outChannels(0),
+  m_mode       (AE_REMAP_GENERIC),
+  m_matrixFn   (NULL)
 {
   memset(m_mixInfo, 0, sizeof(m_mixInfo));
+  memset(m_matrix , 0, sizeof(m_matrix ));
 }
 
 CAERemap::~CAERemap()
@@ -87,7 +96,10 @@ bool CAERemap::Initialize(CAEChannelInfo input, CAEChannelInfo output, bool fina
 
   /* the final stage does not need any down/upmix */
   if (finalStage)
+  {
+    BuildDenseMatrix();
     return true;
+  }
 
   /* downmix from the specified channel to the specified list of channels */
   #define RM(from, ...) \
@@ -240,9 +252,130 @@ bool CAERemap::Initialize(CAEChannelInfo input, CAEChannelInfo output, bool fina
   CLog::Log(LOGINFO, "====================\n");
 #endif
 
+  BuildDenseMatrix();
   return true;
 }
 
+void CAERemap::BuildDenseMatrix()
+{
+  m_mode     = AE_REMAP_REORDER;
+  m_matrixFn = NULL;
+  memset(m_matrix, 0, sizeof(m_matrix));
+
+  for (int o = 0; o < m_outChannels; ++o)
+  {
+    const AEMixInfo *info = &m_mixInfo[m_output[o]];
+    if (!info->in_dst || info->srcCount == 0)
+      m_reorder[o] = -1;
+    else if (info->srcCount == 1)
+      m_reorder[o] = info->srcIndex[0].index;
+    else
+    {
+      m_reorder[o] = -1;
+      m_mode       = AE_REMAP_GENERIC;
+    }
+  }
+
+  if (m_mode == AE_REMAP_REORDER)
+    return;
+
+  m_matrixFn = GetMatrixFn(m_inChannels, m_outChannels);
+  if (!m_matrixFn)
+    return;
+
+  for (int o = 0; o < m_outChannels; ++o)
+  {
+    const AEMixInfo *info = &m_mixInfo[m_output[o]];
+    if (!info->in_dst)
+      continue;
+
+    /* single sources are copied as is to match the generic path, so we dont break DPL */
+    if (info->srcCount == 1)
+    {
+      m_matrix[info->srcIndex[0].index * MATRIX_CHANNELS + o] = 1.0f;
+      continue;
+    }
+
+    for (int i = 0; i < info->srcCount; ++i)
+      m_matrix[info->srcIndex[i].index * MATRIX_CHANNELS + o] += info->srcIndex[i].level;
+  }
+
+  m_mode = AE_REMAP_MATRIX;
+}
+
+/*
+  out = in * matrix for every frame. With the channel counts known at compile
+  time the compiler fully unrolls the loops and keeps the matrix in registers.
+*/
+template <int INCOUNT, int OUTCOUNT>
+static void MixMatrix(const float *matrix, const float *in, float *out, const unsigned int frames)
+{
+#ifdef __SSE__
+  /* each input channel contributes a column of up to 8 output levels */
+  __m128 lo[INCOUNT], hi[INCOUNT];
+  for (int i = 0; i < INCOUNT; ++i)
+  {
+    lo[i] = _mm_loadu_ps(matrix + i * CAERemap::MATRIX_CHANNELS);
+    hi[i] = _mm_loadu_ps(matrix + i * CAERemap::MATRIX_CHANNELS + 4);
+  }
+
+  for (unsigned int f = 0; f < frames; ++f, in += INCOUNT, out += OUTCOUNT)
+  {
+    __m128 val = _mm_set1_ps(in[0]);
+    __m128 l   = _mm_mul_ps(val, lo[0]);
+    __m128 h   = _mm_mul_ps(val, hi[0]);
+    for (int i = 1; i < INCOUNT; ++i)
+    {
+      val = _mm_set1_ps(in[i]);
+      l   = _mm_add_ps(l, _mm_mul_ps(val, lo[i]));
+      if (OUTCOUNT > 4)
+        h = _mm_add_ps(h, _mm_mul_ps(val, hi[i]));
+    }
+
+    /* only store the channels of this frame, the next frame may not exist */
+    if (OUTCOUNT == 2)
+      _mm_storel_pi((__m64*)out, l);
+    else if (OUTCOUNT == 4)
+      _mm_storeu_ps(out, l);
+    else
+    {
+      _mm_storeu_ps(out, l);
+      if (OUTCOUNT == 6)
+        _mm_storel_pi((__m64*)(out + 4), h);
+      else
+        _mm_storeu_ps(out + 4, h);
+    }
+  }
+#else
+  for (unsigned int f = 0; f < frames; ++f, in += INCOUNT, out += OUTCOUNT)
+    for (int o = 0; o < OUTCOUNT; ++o)
+    {
+      float sum = 0.0f;
+      for (int i = 0; i < INCOUNT; ++i)
+        sum += in[i] * matrix[i * CAERemap::MATRIX_CHANNELS + o];
+      out[o] = sum;
+    }
+#endif
+}
+
+CAERemap::AEMatrixFn CAERemap::GetMatrixFn(const int inChannels, const int outChannels)
+{
+  #define MM(in, out) \
+    if (inChannels == in && outChannels == out) \
+      return &MixMatrix<in, out>;
+
+  /* 2.0, 5.1 and 7.1 in any combination, eg 2.0 -> 5.1, 5.1 -> 2.0 and 7.1 -> 5.1 */
+  MM(2, 2); MM(2, 6); MM(2, 8);
+  MM(6, 2); MM(6, 6); MM(6, 8);
+  MM(8, 2); MM(8, 6); MM(8, 8);
+
+  /* quad */
+  MM(4, 2); MM(2, 4);
+
+  #undef MM
+  return NULL;
+}
+
 void CAERemap::ResolveMix(const AEChannel from, CAEChannelInfo to)
 {
   AEMixInfo *fromInfo = &m_mixInfo[from];
@@ -280,8 +413,29 @@ void CAERemap::ResolveMix(const AEChannel from, CAEChannelInfo to)
   fromInfo->in_src   = false;
 }
 
-/* This method has unrolled loop for higher performance */
 void CAERemap::Remap(float * const in, float * const out, const unsigned int frames) const
+{
+  if (m_mode == AE_REMAP_MATRIX)
+  {
+    m_matrixFn(m_matrix, in, out, frames);
+    return;
+  }
+
+  if (m_mode == AE_REMAP_REORDER)
+  {
+    const float *src = in;
+    float       *dst = out;
+    for (unsigned int f = 0; f < frames; ++f, src += m_inChannels, dst += m_outChannels)
+      for (int o = 0; o < m_outChannels; ++o)
+        dst[o] = m_reorder[o] < 0 ? 0.0f : src[m_reorder[o]];
+    return;
+  }
+
+  RemapGeneric(in, out, frames);
+}
+
+/* This method has unrolled loop for higher performance */
+void CAERemap::RemapGeneric(float * const in, float * const out, const unsigned int frames) const
 {
   const unsigned int frameBlocks = frames & ~0x3;
 
@@ -23,13 +23,29 @@
 
 class CAERemap {
 public:
+  /* the dense matrix is only used for layouts up to this many channels */
+  static const unsigned int MATRIX_CHANNELS = 8;
+
   CAERemap();
   ~CAERemap();
 
   bool Initialize(CAEChannelInfo input, CAEChannelInfo output, bool finalStage, bool forceNormalize = false, enum AEStdChLayout stdChLayout = AE_CH_LAYOUT_INVALID);
   void Remap(float * const in, float * const out, const unsigned int frames) const;
 
+  /*! \brief Remap using the per channel mix lists, ignoring any precomputed matrix.
+   This is the reference the optimized paths are tested against.
+   */
+  void RemapGeneric(float * const in, float * const out, const unsigned int frames) const;
+
 private:
+  typedef void (*AEMatrixFn)(const float *matrix, const float *in, float *out, const unsigned int frames);
+
+  enum AERemapMode {
+    AE_REMAP_GENERIC, /* walk the mix lists */
+    AE_REMAP_REORDER, /* every output is a copy of an input or silence */
+    AE_REMAP_MATRIX   /* dense matrix with a kernel specialized for the layout */
+  };
+
   typedef struct {
     int       index;
     float     level;
@@ -49,7 +65,14 @@ private:
   int            m_inChannels;
   int            m_outChannels;
 
+  enum AERemapMode m_mode;
+  int            m_reorder[AE_CH_MAX]; /* input index of each output channel, -1 for silence */
+  float          m_matrix[MATRIX_CHANNELS * MATRIX_CHANNELS]; /* [in][out], rows padded to MATRIX_CHANNELS */
+  AEMatrixFn     m_matrixFn;
+
   void ResolveMix(const AEChannel from, CAEChannelInfo to);
   void BuildUpmixMatrix(const CAEChannelInfo& input, const CAEChannelInfo& output);
+  void BuildDenseMatrix();
+  static AEMatrixFn GetMatrixFn(const int inChannels, const int outChannels);
 };
 
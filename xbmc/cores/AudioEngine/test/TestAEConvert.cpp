@@ -0,0 +1,103 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEConvert.h"
+#include "cores/AudioEngine/Utils/AEUtil.h"
+#include "utils/CPUInfo.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+/* odd sample count so the remainder paths of the SIMD converters get exercised */
+#define TEST_SAMPLES (8 * 192 + 7)
+#define BENCH_SAMPLES (8 * 4096)
+#define BENCH_LOOPS 500
+
+static void FillRandom(std::vector<uint8_t> &data)
+{
+  srand(0x5EED);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = (uint8_t)(rand() & 0xFF);
+}
+
+static void CompareToFloat(enum AEDataFormat format)
+{
+  CAEConvert::AEConvertToFn scalar = CAEConvert::ToFloat(format, 0);
+  CAEConvert::AEConvertToFn simd   = CAEConvert::ToFloat(format, g_cpuInfo.GetCPUFeatures());
+  ASSERT_TRUE(scalar != NULL);
+  ASSERT_TRUE(simd != NULL);
+
+  /* offset by one byte/float so the unaligned paths are taken as well */
+  std::vector<uint8_t> in((TEST_SAMPLES + 1) * CAEUtil::DataFormatToBits(format) / 8 + 1);
+  FillRandom(in);
+
+  std::vector<float> ref(TEST_SAMPLES + 1), out(TEST_SAMPLES + 1);
+  EXPECT_EQ((unsigned int)TEST_SAMPLES, scalar(&in[1], TEST_SAMPLES, &ref[1]));
+  EXPECT_EQ((unsigned int)TEST_SAMPLES, simd  (&in[1], TEST_SAMPLES, &out[1]));
+  EXPECT_EQ(0, memcmp(&ref[1], &out[1], TEST_SAMPLES * sizeof(float)))
+    << "converter for " << CAEUtil::DataFormatToStr(format) << " is not bit exact";
+}
+
+static double BenchToFloat(CAEConvert::AEConvertToFn convert, enum AEDataFormat format)
+{
+  std::vector<uint8_t> in(BENCH_SAMPLES * CAEUtil::DataFormatToBits(format) / 8);
+  std::vector<float>   out(BENCH_SAMPLES);
+  FillRandom(in);
+
+  int64_t start = CurrentHostCounter();
+  for (int i = 0; i < BENCH_LOOPS; ++i)
+    convert(&in[0], BENCH_SAMPLES, &out[0]);
+  int64_t end = CurrentHostCounter();
+
+  if (end <= start)
+    return 0.0;
+  return (double)BENCH_SAMPLES * BENCH_LOOPS * CurrentHostFrequency() / (end - start);
+}
+
+TEST(TestAEConvert, ToFloatBitExact)
+{
+  CompareToFloat(AE_FMT_S16LE);
+  CompareToFloat(AE_FMT_S16BE);
+  CompareToFloat(AE_FMT_S16NE);
+  CompareToFloat(AE_FMT_S24LE4);
+  CompareToFloat(AE_FMT_S24NE4);
+  CompareToFloat(AE_FMT_S32LE);
+  CompareToFloat(AE_FMT_S32BE);
+  CompareToFloat(AE_FMT_S32NE);
+}
+
+TEST(TestAEConvert, ToFloatBenchmark)
+{
+  const enum AEDataFormat formats[] = { AE_FMT_S16LE, AE_FMT_S24LE4, AE_FMT_S32LE };
+  for (unsigned int i = 0; i < sizeof(formats) / sizeof(formats[0]); ++i)
+  {
+    double scalar = BenchToFloat(CAEConvert::ToFloat(formats[i], 0), formats[i]);
+    double simd   = BenchToFloat(CAEConvert::ToFloat(formats[i]), formats[i]);
+    std::cout << CAEUtil::DataFormatToStr(formats[i]) << " to float: "
+              << (int64_t)scalar << " samples/sec scalar, "
+              << (int64_t)simd   << " samples/sec selected" << std::endl;
+    EXPECT_GT(simd, 0.0);
+  }
+}
@@ -0,0 +1,95 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AELockFreeQueue.h"
+#include "threads/test/TestHelpers.h"
+
+#include "gtest/gtest.h"
+
+#define TEST_ITEMS 200000
+
+class QueueProducer : public IRunnable
+{
+public:
+  CAELockFreeQueue<long> &queue;
+  unsigned int            full;
+
+  QueueProducer(CAELockFreeQueue<long> &q) : queue(q), full(0) {}
+
+  void Run()
+  {
+    for (long i = 1; i <= TEST_ITEMS; ++i)
+      while (!queue.Push(i))
+      {
+        ++full;
+        XbmcThreads::ThreadSleep(0);
+      }
+  }
+};
+
+TEST(TestAELockFreeQueue, General)
+{
+  CAELockFreeQueue<int> queue(3);
+  int item = 0;
+
+  EXPECT_EQ((unsigned int)3, queue.Capacity());
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_FALSE(queue.Pop(item));
+
+  EXPECT_TRUE(queue.Push(1));
+  EXPECT_TRUE(queue.Push(2));
+  EXPECT_TRUE(queue.Push(3));
+  EXPECT_FALSE(queue.Push(4));
+  EXPECT_EQ((unsigned int)3, queue.Count());
+
+  EXPECT_TRUE(queue.Pop(item));
+  EXPECT_EQ(1, item);
+  EXPECT_TRUE(queue.Push(4));
+
+  EXPECT_TRUE(queue.Pop(item)); EXPECT_EQ(2, item);
+  EXPECT_TRUE(queue.Pop(item)); EXPECT_EQ(3, item);
+  EXPECT_TRUE(queue.Pop(item)); EXPECT_EQ(4, item);
+  EXPECT_FALSE(queue.Pop(item));
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(TestAELockFreeQueue, ProducerConsumer)
+{
+  CAELockFreeQueue<long> queue(16);
+  QueueProducer producer(queue);
+  thread producerThread(producer);
+
+  /* items must arrive complete and in order */
+  long expected = 1;
+  while (expected <= TEST_ITEMS)
+  {
+    long item;
+    if (!queue.Pop(item))
+    {
+      XbmcThreads::ThreadSleep(0);
+      continue;
+    }
+    ASSERT_EQ(expected, item);
+    ++expected;
+  }
+
+  EXPECT_TRUE(producerThread.timed_join(MILLIS(10000)));
+  EXPECT_TRUE(queue.Empty());
+}
@@ -0,0 +1,143 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AERemap.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#define TEST_FRAMES 1023
+#define BENCH_FRAMES 4096
+#define BENCH_LOOPS 200
+
+static void FillRandom(std::vector<float> &data)
+{
+  srand(0x5EED);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+}
+
+static void CompareRemap(enum AEStdChLayout from, enum AEStdChLayout to, bool finalStage)
+{
+  CAEChannelInfo input  = from;
+  CAEChannelInfo output = to;
+
+  CAERemap remap;
+  ASSERT_TRUE(remap.Initialize(input, output, finalStage, true));
+
+  std::vector<float> in(TEST_FRAMES * input.Count());
+  std::vector<float> ref(TEST_FRAMES * output.Count(), 1.0f);
+  std::vector<float> out(TEST_FRAMES * output.Count(), 2.0f);
+  FillRandom(in);
+
+  remap.RemapGeneric(&in[0], &ref[0], TEST_FRAMES);
+  remap.Remap       (&in[0], &out[0], TEST_FRAMES);
+
+  for (size_t i = 0; i < ref.size(); ++i)
+    ASSERT_NEAR(ref[i], out[i], 1e-6f)
+      << (std::string)input << " -> " << (std::string)output << " differs at sample " << i;
+}
+
+static double BenchRemap(const CAERemap &remap, bool generic, unsigned int inChannels, unsigned int outChannels)
+{
+  std::vector<float> in(BENCH_FRAMES * inChannels);
+  std::vector<float> out(BENCH_FRAMES * outChannels);
+  FillRandom(in);
+
+  int64_t start = CurrentHostCounter();
+  for (int i = 0; i < BENCH_LOOPS; ++i)
+  {
+    if (generic)
+      remap.RemapGeneric(&in[0], &out[0], BENCH_FRAMES);
+    else
+      remap.Remap(&in[0], &out[0], BENCH_FRAMES);
+  }
+  int64_t end = CurrentHostCounter();
+
+  if (end <= start)
+    return 0.0;
+  return (double)BENCH_FRAMES * BENCH_LOOPS * CurrentHostFrequency() / (end - start);
+}
+
+TEST(TestAERemap, Downmix)
+{
+  CompareRemap(AE_CH_LAYOUT_5_1, AE_CH_LAYOUT_2_0, false);
+  CompareRemap(AE_CH_LAYOUT_7_1, AE_CH_LAYOUT_2_0, false);
+  CompareRemap(AE_CH_LAYOUT_7_1, AE_CH_LAYOUT_5_1, false);
+  CompareRemap(AE_CH_LAYOUT_4_0, AE_CH_LAYOUT_2_0, false);
+}
+
+TEST(TestAERemap, Upmix)
+{
+  CompareRemap(AE_CH_LAYOUT_2_0, AE_CH_LAYOUT_5_1, false);
+  CompareRemap(AE_CH_LAYOUT_2_0, AE_CH_LAYOUT_7_1, false);
+  CompareRemap(AE_CH_LAYOUT_5_1, AE_CH_LAYOUT_7_1, false);
+  CompareRemap(AE_CH_LAYOUT_1_0, AE_CH_LAYOUT_2_0, false);
+}
+
+TEST(TestAERemap, Reorder)
+{
+  static enum AEChannel wav[] = { AE_CH_FL, AE_CH_FR, AE_CH_FC, AE_CH_LFE, AE_CH_BL, AE_CH_BR, AE_CH_NULL };
+  static enum AEChannel alsa[] = { AE_CH_FL, AE_CH_FR, AE_CH_BL, AE_CH_BR, AE_CH_FC, AE_CH_LFE, AE_CH_NULL };
+
+  CAERemap remap;
+  ASSERT_TRUE(remap.Initialize(CAEChannelInfo(wav), CAEChannelInfo(alsa), true));
+
+  float in [6] = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f };
+  float out[6];
+  remap.Remap(in, out, 1);
+  EXPECT_EQ(1.0f, out[0]);
+  EXPECT_EQ(2.0f, out[1]);
+  EXPECT_EQ(5.0f, out[2]);
+  EXPECT_EQ(6.0f, out[3]);
+  EXPECT_EQ(3.0f, out[4]);
+  EXPECT_EQ(4.0f, out[5]);
+
+  CompareRemap(AE_CH_LAYOUT_7_1, AE_CH_LAYOUT_5_1, true);
+  CompareRemap(AE_CH_LAYOUT_5_1, AE_CH_LAYOUT_5_1, true);
+}
+
+TEST(TestAERemap, Benchmark)
+{
+  const enum AEStdChLayout layouts[][2] = {
+    { AE_CH_LAYOUT_2_0, AE_CH_LAYOUT_5_1 },
+    { AE_CH_LAYOUT_5_1, AE_CH_LAYOUT_2_0 },
+    { AE_CH_LAYOUT_7_1, AE_CH_LAYOUT_5_1 }
+  };
+
+  for (unsigned int i = 0; i < sizeof(layouts) / sizeof(layouts[0]); ++i)
+  {
+    CAEChannelInfo input  = layouts[i][0];
+    CAEChannelInfo output = layouts[i][1];
+    CAERemap remap;
+    ASSERT_TRUE(remap.Initialize(input, output, false, true));
+
+    double generic   = BenchRemap(remap, true , input.Count(), output.Count());
+    double optimized = BenchRemap(remap, false, input.Count(), output.Count());
+    std::cout << (std::string)input << " -> " << (std::string)output << ": "
+              << (int64_t)generic   << " frames/sec generic, "
+              << (int64_t)optimized << " frames/sec optimized" << std::endl;
+    EXPECT_GT(optimized, 0.0);
+  }
+}
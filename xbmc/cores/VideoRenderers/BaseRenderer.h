@@ -81,6 +81,8 @@ public:
   float GetAspectRatio() const;
 
   virtual bool AddVideoPicture(DVDVideoPicture* picture) { return false; }
+  /* let the image at index reference the picture's decoder buffer instead of holding a copy */
+  virtual bool AddVideoBuffer(int index, DVDVideoPicture* picture) { return false; }
   virtual void Flush() {};
 
   virtual unsigned int GetProcessorSize() { return 0; }
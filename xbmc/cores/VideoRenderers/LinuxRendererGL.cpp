@@ -38,6 +38,7 @@
 #include "windowing/WindowingFactory.h"
 #include "dialogs/GUIDialogKaiToast.h"
 #include "guilib/Texture.h"
+#include "guilib/GUIQuadBatchGL.h"
 #include "guilib/LocalizeStrings.h"
 #include "threads/SingleLock.h"
 #include "DllSwScale.h"
@@ -45,6 +46,8 @@
 #include "utils/GLUtils.h"
 #include "RenderCapture.h"
 #include "RenderFormats.h"
+#include "YUV2RGBConverter.h"
+#include "utils/CPUInfo.h"
 
 #ifdef HAVE_LIBVDPAU
 #include "cores/dvdplayer/DVDCodecs/Video/VDPAU.h"
@@ -125,6 +128,8 @@ CLinuxRendererGL::YUVBUFFER::YUVBUFFER()
   memset(&fields, 0, sizeof(fields));
   memset(&image , 0, sizeof(image));
   memset(&pbo   , 0, sizeof(pbo));
+  memset(&bufferPlane , 0, sizeof(bufferPlane));
+  memset(&bufferStride, 0, sizeof(bufferStride));
   flipindex = 0;
 #ifdef HAVE_LIBVDPAU
   vdpau = NULL;
@@ -171,6 +176,7 @@ CLinuxRendererGL::CLinuxRendererGL()
   m_rgbBuffer = NULL;
   m_rgbBufferSize = 0;
   m_context = NULL;
+  m_rgbConverter = NULL;
   m_rgbPbo = 0;
 
   m_dllSwScale = new DllSwScale;
@@ -207,6 +213,7 @@ CLinuxRendererGL::~CLinuxRendererGL()
     m_pYUVShader = NULL;
   }
 
+  delete m_rgbConverter;
   delete m_dllSwScale;
 }
 
@@ -346,6 +353,9 @@ int CLinuxRendererGL::GetImage(YV12Image *image, int source, bool readonly)
       CLog::Log(LOGWARNING, "%s - Timeout waiting for texture %d", __FUNCTION__, source);
 
     im.flags |= IMAGE_FLAG_WRITING;
+
+    /* the image gets written, drop any decoder buffer it referenced */
+    m_buffers[source].buffer.reset();
   }
 
   // copy the image - should be operator of YV12Image
@@ -383,6 +393,31 @@ void CLinuxRendererGL::ReleaseImage(int source, bool preserve)
   m_bImageReady = true;
 }
 
+bool CLinuxRendererGL::AddVideoBuffer(int index, DVDVideoPicture* picture)
+{
+  if (m_format != RENDER_FMT_YUV420P
+  ||  m_textureUpload != &CLinuxRendererGL::UploadYV12Texture
+  || !picture->buffer || !*picture->buffer)
+    return false;
+
+  /* the picture may have been redirected to a copy, for example to render overlays on */
+  CDVDVideoBufferPtr& buffer = *picture->buffer;
+  for (int p = 0; p < MAX_PLANES; p++)
+  {
+    if (!buffer->Contains(picture->data[p]))
+      return false;
+  }
+
+  YUVBUFFER &buf = m_buffers[index];
+  buf.buffer = buffer;
+  for (int p = 0; p < MAX_PLANES; p++)
+  {
+    buf.bufferPlane[p]  = picture->data[p];
+    buf.bufferStride[p] = picture->iLineSize[p];
+  }
+  return true;
+}
+
 void CLinuxRendererGL::CalculateTextureSourceRects(int source, int num_planes)
 {
   YUVBUFFER& buf    =  m_buffers[source];
@@ -511,6 +546,18 @@ void CLinuxRendererGL::UploadYV12Texture(int source)
     return;
   }
 
+  /* upload from the decoder buffer if we were handed one, the pbo's don't hold the data then */
+  BYTE**    plane  = im->plane;
+  unsigned* stride = im->stride;
+  GLuint    nopbo  = 0;
+  GLuint*   pbo    = NULL;
+  if (buf.buffer)
+  {
+    plane  = buf.bufferPlane;
+    stride = buf.bufferStride;
+    pbo    = &nopbo;
+  }
+
   bool deinterlacing;
   if (m_currentField == FIELD_FULL)
     deinterlacing = false;
@@ -527,47 +574,47 @@ void CLinuxRendererGL::UploadYV12Texture(int source)
     // Load Even Y Field
     LoadPlane( fields[FIELD_TOP][0] , GL_LUMINANCE, buf.flipindex
              , im->width, im->height >> 1
-             , im->stride[0]*2, im->bpp, im->plane[0] );
+             , stride[0]*2, im->bpp, plane[0], pbo );
 
     //load Odd Y Field
     LoadPlane( fields[FIELD_BOT][0], GL_LUMINANCE, buf.flipindex
              , im->width, im->height >> 1
-             , im->stride[0]*2, im->bpp, im->plane[0] + im->stride[0]) ;
+             , stride[0]*2, im->bpp, plane[0] + stride[0], pbo );
 
     // Load Even U & V Fields
     LoadPlane( fields[FIELD_TOP][1], GL_LUMINANCE, buf.flipindex
              , im->width >> im->cshift_x, im->height >> (im->cshift_y + 1)
-             , im->stride[1]*2, im->bpp, im->plane[1] );
+             , stride[1]*2, im->bpp, plane[1], pbo );
 
     LoadPlane( fields[FIELD_TOP][2], GL_ALPHA, buf.flipindex
              , im->width >> im->cshift_x, im->height >> (im->cshift_y + 1)
-             , im->stride[2]*2, im->bpp, im->plane[2] );
+             , stride[2]*2, im->bpp, plane[2], pbo );
 
     // Load Odd U & V Fields
     LoadPlane( fields[FIELD_BOT][1], GL_LUMINANCE, buf.flipindex
              , im->width >> im->cshift_x, im->height >> (im->cshift_y + 1)
-             , im->stride[1]*2, im->bpp, im->plane[1] + im->stride[1] );
+             , stride[1]*2, im->bpp, plane[1] + stride[1], pbo );
 
     LoadPlane( fields[FIELD_BOT][2], GL_ALPHA, buf.flipindex
              , im->width >> im->cshift_x, im->height >> (im->cshift_y + 1)
-             , im->stride[2]*2, im->bpp, im->plane[2] + im->stride[2] );
+             , stride[2]*2, im->bpp, plane[2] + stride[2], pbo );
   }
   else
   {
     //Load Y plane
     LoadPlane( fields[FIELD_FULL][0], GL_LUMINANCE, buf.flipindex
              , im->width, im->height
-             , im->stride[0], im->bpp, im->plane[0] );
+             , stride[0], im->bpp, plane[0], pbo );
 
     //load U plane
     LoadPlane( fields[FIELD_FULL][1], GL_LUMINANCE, buf.flipindex
              , im->width >> im->cshift_x, im->height >> im->cshift_y
-             , im->stride[1], im->bpp, im->plane[1] );
+             , stride[1], im->bpp, plane[1], pbo );
 
     //load V plane
     LoadPlane( fields[FIELD_FULL][2], GL_ALPHA, buf.flipindex
              , im->width >> im->cshift_x, im->height >> im->cshift_y
-             , im->stride[2], im->bpp, im->plane[2] );
+             , stride[2], im->bpp, plane[2], pbo );
   }
 
   m_eventTexturesDone[source]->Set();
@@ -616,6 +663,9 @@ void CLinuxRendererGL::RenderUpdate(bool clear, DWORD flags, DWORD alpha)
 {
   int index = m_iYV12RenderBuffer;
 
+  // draw the GUI below the video first
+  CGUIQuadBatchGL::Get().Flush();
+
   if (!ValidateRenderer())
   {
     if (clear) //if clear is set, we're expected to overwrite all backbuffer pixels, even if we have nothing to render
@@ -1038,12 +1088,26 @@ void CLinuxRendererGL::LoadShaders(int field)
           // drop through and use SW
         }
       }
+      case RENDER_METHOD_SOFTWARE_MT:
       case RENDER_METHOD_SOFTWARE:
       default:
       // Use software YUV 2 RGB conversion if user requested it or GLSL and/or ARB shaders failed
       {
         m_renderMethod = RENDER_SW ;
         CLog::Log(LOGNOTICE, "GL: Shaders support not present, falling back to SW mode");
+
+        if (!m_rgbConverter)
+          m_rgbConverter = new CYUV2RGBConverter(g_cpuInfo.GetCPUFeatures());
+
+        TransformMatrix matrix;
+        CalculateYUVMatrix(matrix, m_iFlags, m_format, 0.0f, 1.0f);
+        m_rgbConverter->SetMatrix(matrix.m);
+
+        if (requestedMethod == RENDER_METHOD_SOFTWARE_MT)
+          m_rgbConverter->SetThreads(g_cpuInfo.getCPUCount());
+        else
+          m_rgbConverter->SetThreads(1);
+        CLog::Log(LOGNOTICE, "GL: Converting to RGB on %u threads", m_rgbConverter->GetThreads());
         break;
       }
     }
@@ -1785,6 +1849,8 @@ void CLinuxRendererGL::DeleteYV12Texture(int index)
   YUVFIELDS &fields = m_buffers[index].fields;
   GLuint    *pbo    = m_buffers[index].pbo;
 
+  m_buffers[index].buffer.reset();
+
   if( fields[FIELD_FULL][0].id == 0 ) return;
 
   /* finish up all textures, and delete them */
@@ -2906,14 +2972,21 @@ void CLinuxRendererGL::ToRGBFrame(YV12Image* im, unsigned flipIndexPlane, unsign
     m_rgbBuffer = (BYTE*)glMapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB) + PBO_OFFSET;
   }
 
-  m_context = m_dllSwScale->sws_getCachedContext(m_context,
-                                                 im->width, im->height, srcFormat,
-                                                 im->width, im->height, PIX_FMT_BGRA,
-                                                 SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
+  if (m_rgbConverter && CYUV2RGBConverter::Supports(m_format))
+  {
+    m_rgbConverter->Convert(m_format, src, srcStride, im->width, im->height, m_rgbBuffer, m_sourceWidth * 4);
+  }
+  else
+  {
+    m_context = m_dllSwScale->sws_getCachedContext(m_context,
+                                                   im->width, im->height, srcFormat,
+                                                   im->width, im->height, PIX_FMT_BGRA,
+                                                   SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
 
-  uint8_t *dst[]       = { m_rgbBuffer, 0, 0, 0 };
-  int      dstStride[] = { (int)m_sourceWidth * 4, 0, 0, 0 };
-  m_dllSwScale->sws_scale(m_context, src, srcStride, 0, im->height, dst, dstStride);
+    uint8_t *dst[]       = { m_rgbBuffer, 0, 0, 0 };
+    int      dstStride[] = { (int)m_sourceWidth * 4, 0, 0, 0 };
+    m_dllSwScale->sws_scale(m_context, src, srcStride, 0, im->height, dst, dstStride);
+  }
 
   if (m_rgbPbo)
   {
@@ -2986,18 +3059,26 @@ void CLinuxRendererGL::ToRGBFields(YV12Image* im, unsigned flipIndexPlaneTop, un
     m_rgbBuffer = (BYTE*)glMapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB) + PBO_OFFSET;
   }
 
-  m_context = m_dllSwScale->sws_getCachedContext(m_context,
-                                                 im->width, im->height >> 1, srcFormat,
-                                                 im->width, im->height >> 1, PIX_FMT_BGRA,
-                                                 SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
   uint8_t *dstTop[]    = { m_rgbBuffer, 0, 0, 0 };
   uint8_t *dstBot[]    = { m_rgbBuffer + m_sourceWidth * m_sourceHeight * 2, 0, 0, 0 };
   int      dstStride[] = { (int)m_sourceWidth * 4, 0, 0, 0 };
 
   //convert each YUV field to an RGB field, the top field is placed at the top of the rgb buffer
   //the bottom field is placed at the bottom of the rgb buffer
-  m_dllSwScale->sws_scale(m_context, srcTop, srcStrideTop, 0, im->height >> 1, dstTop, dstStride);
-  m_dllSwScale->sws_scale(m_context, srcBot, srcStrideBot, 0, im->height >> 1, dstBot, dstStride);
+  if (m_rgbConverter && CYUV2RGBConverter::Supports(m_format))
+  {
+    m_rgbConverter->Convert(m_format, srcTop, srcStrideTop, im->width, im->height >> 1, dstTop[0], dstStride[0]);
+    m_rgbConverter->Convert(m_format, srcBot, srcStrideBot, im->width, im->height >> 1, dstBot[0], dstStride[0]);
+  }
+  else
+  {
+    m_context = m_dllSwScale->sws_getCachedContext(m_context,
+                                                   im->width, im->height >> 1, srcFormat,
+                                                   im->width, im->height >> 1, PIX_FMT_BGRA,
+                                                   SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
+    m_dllSwScale->sws_scale(m_context, srcTop, srcStrideTop, 0, im->height >> 1, dstTop, dstStride);
+    m_dllSwScale->sws_scale(m_context, srcBot, srcStrideBot, 0, im->height >> 1, dstBot, dstStride);
+  }
 
   if (m_rgbPbo)
   {
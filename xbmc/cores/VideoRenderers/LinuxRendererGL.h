@@ -33,6 +33,7 @@
 #include "guilib/GraphicContext.h"
 #include "BaseRenderer.h"
 #include "RenderFormats.h"
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoCodec.h"
 
 #include "threads/Event.h"
 
@@ -116,6 +117,7 @@ extern YUVCOEF yuv_coef_ebu;
 extern YUVCOEF yuv_coef_smtp240m;
 
 class DllSwScale;
+class CYUV2RGBConverter;
 
 class CLinuxRendererGL : public CBaseRenderer
 {
@@ -138,6 +140,7 @@ public:
   virtual void         UnInit();
   virtual void         Reset(); /* resets renderer after seek for example */
   virtual void         Flush();
+  virtual bool         AddVideoBuffer(int index, DVDVideoPicture* picture);
 
 #ifdef HAVE_LIBVDPAU
   virtual void         AddProcessor(CVDPAU* vdpau);
@@ -277,6 +280,11 @@ protected:
     unsigned  flipindex; /* used to decide if this has been uploaded */
     GLuint    pbo[MAX_PLANES];
 
+    /* when set, planes are uploaded straight from this decoder buffer */
+    CDVDVideoBufferPtr buffer;
+    BYTE*     bufferPlane[MAX_PLANES];
+    unsigned  bufferStride[MAX_PLANES];
+
 #ifdef HAVE_LIBVDPAU
     CVDPAU*   vdpau;
 #endif
@@ -313,6 +321,7 @@ protected:
   unsigned int       m_rgbBufferSize;
   GLuint             m_rgbPbo;
   struct SwsContext *m_context;
+  CYUV2RGBConverter *m_rgbConverter; // planar and nv12 conversion, swscale handles the packed formats
 
   CEvent* m_eventTexturesDone[NUM_BUFFERS];
 
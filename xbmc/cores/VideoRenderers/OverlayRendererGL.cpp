@@ -25,6 +25,7 @@
 #include "OverlayRendererGL.h"
 #ifdef HAS_GL
   #include "LinuxRendererGL.h"
+  #include "guilib/GUIQuadBatchGL.h"
 #elif HAS_GLES == 2
   #include "LinuxRendererGLES.h"
   #include "guilib/MatrixGLES.h"
@@ -362,6 +363,10 @@ void COverlayGlyphGL::Render(SRenderState& state)
   if (m_texture == 0)
     return;
 
+#ifdef HAS_GL
+  CGUIQuadBatchGL::Get().Flush();
+#endif
+
   glEnable(GL_TEXTURE_2D);
   glEnable(GL_BLEND);
 
@@ -457,6 +462,10 @@ COverlayTextureGL::~COverlayTextureGL()
 
 void COverlayTextureGL::Render(SRenderState& state)
 {
+#ifdef HAS_GL
+  CGUIQuadBatchGL::Get().Flush();
+#endif
+
   glEnable(GL_TEXTURE_2D);
   glEnable(GL_BLEND);
 
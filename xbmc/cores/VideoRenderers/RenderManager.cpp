@@ -103,6 +103,8 @@ CXBMCRenderManager::CXBMCRenderManager()
   m_bReconfigured = false;
   m_hasCaptures = false;
   m_displayLatency = 0.0f;
+  m_framesCopied = 0;
+  m_framesZeroCopy = 0;
 }
 
 CXBMCRenderManager::~CXBMCRenderManager()
@@ -323,6 +325,8 @@ unsigned int CXBMCRenderManager::PreInit()
 
   m_bIsStarted = false;
   m_bPauseDrawing = false;
+  m_framesCopied   = 0;
+  m_framesZeroCopy = 0;
   if (!m_pRenderer)
   {
 #if defined(HAS_GL)
@@ -347,6 +351,9 @@ void CXBMCRenderManager::UnInit()
 
   m_bIsStarted = false;
 
+  if (m_framesCopied || m_framesZeroCopy)
+    CLog::Log(LOGDEBUG, "CXBMCRenderManager::UnInit - frames copied: %u, zero copy: %u", m_framesCopied, m_framesZeroCopy);
+
   m_overlays.Flush();
 
   // free renderer resources.
@@ -810,10 +817,16 @@ int CXBMCRenderManager::AddVideoPicture(DVDVideoPicture& pic)
     return index;
 
   if(pic.format == RENDER_FMT_YUV420P
+  && m_pRenderer->AddVideoBuffer(index, &pic))
+  {
+    m_framesZeroCopy++;
+  }
+  else if(pic.format == RENDER_FMT_YUV420P
   || pic.format == RENDER_FMT_YUV420P10
   || pic.format == RENDER_FMT_YUV420P16)
   {
     CDVDCodecUtils::CopyPicture(&image, &pic);
+    m_framesCopied++;
   }
   else if(pic.format == RENDER_FMT_NV12)
   {
@@ -95,6 +95,8 @@ public:
   inline bool Paused() { return m_bPauseDrawing; };
   inline bool IsStarted() { return m_bIsStarted;}
   double GetDisplayLatency() { return m_displayLatency; }
+  unsigned int GetFramesCopied()   { return m_framesCopied; }
+  unsigned int GetFramesZeroCopy() { return m_framesZeroCopy; }
 
   bool Supports(ERENDERFEATURE feature);
   bool Supports(EDEINTERLACEMODE method);
@@ -181,6 +183,8 @@ protected:
   CEvent     m_presentevent;
   CEvent     m_flushEvent;
 
+  unsigned int m_framesCopied;   // yuv420p frames copied into a render buffer
+  unsigned int m_framesZeroCopy; // yuv420p frames handed over by reference
 
   OVERLAY::CRenderer m_overlays;
 
@@ -0,0 +1,338 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "YUV2RGBConverter.h"
+#include "threads/SingleLock.h"
+#include "utils/CPUInfo.h"
+#include "utils/JobManager.h"
+#include <algorithm>
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define COEF_SHIFT 13
+#define MAX_BANDS  16
+
+class CYUV2RGBBandJob : public CJob
+{
+public:
+  CYUV2RGBBandJob(CYUV2RGBConverter *converter, const CYUV2RGBConverter::Image &image
+                , unsigned int first, unsigned int last)
+    : m_converter(converter)
+    , m_image(image)
+    , m_first(first)
+    , m_last(last)
+  {}
+
+  /* CJobManager frees cancelled jobs without completing them, so this is
+   * the one place every band passes through */
+  virtual ~CYUV2RGBBandJob()
+  {
+    m_converter->BandDone();
+  }
+
+  virtual bool DoWork()
+  {
+    m_converter->ConvertBand(m_image, m_first, m_last);
+    return true;
+  }
+
+  virtual const char *GetType() const { return "yuv2rgb"; }
+
+private:
+  CYUV2RGBConverter        *m_converter;
+  CYUV2RGBConverter::Image  m_image;
+  unsigned int              m_first;
+  unsigned int              m_last;
+};
+
+static inline uint8_t Clip(int value)
+{
+  return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+static inline void PixelToBGRA(const int16_t coef[3][4], int y, int u, int v, uint8_t *dst)
+{
+  dst[0] = Clip((coef[2][0] * y + coef[2][1] * u + coef[2][2] * v + coef[2][3] * 128) >> COEF_SHIFT);
+  dst[1] = Clip((coef[1][0] * y + coef[1][1] * u + coef[1][2] * v + coef[1][3] * 128) >> COEF_SHIFT);
+  dst[2] = Clip((coef[0][0] * y + coef[0][1] * u + coef[0][2] * v + coef[0][3] * 128) >> COEF_SHIFT);
+  dst[3] = 0xff;
+}
+
+/* converts pixels [x, width) of one row, u and v are stepped by uvStep for every two pixels */
+static void RowToBGRA(const int16_t coef[3][4], unsigned int x, unsigned int width
+                    , const uint8_t *y, const uint8_t *u, const uint8_t *v, unsigned int uvStep
+                    , uint8_t *dst)
+{
+  for (; x < width; x++)
+  {
+    unsigned int c = (x >> 1) * uvStep;
+    PixelToBGRA(coef, y[x], u[c], v[c], dst + x * 4);
+  }
+}
+
+#ifdef __SSE2__
+/* weighs y,u and v,128 pairs for one channel and returns four 32 bit sums shifted back */
+static inline __m128i Channel_SSE2(__m128i yu, __m128i vk, __m128i cyu, __m128i cvk)
+{
+  __m128i sum = _mm_add_epi32(_mm_madd_epi16(yu, cyu), _mm_madd_epi16(vk, cvk));
+  return _mm_srai_epi32(sum, COEF_SHIFT);
+}
+
+/* converts 8 pixels from 16 bit y, u and v lanes, the chroma already duplicated per pixel */
+static inline void Pixels8ToBGRA_SSE2(__m128i y, __m128i u, __m128i v, const __m128i cyu[3], const __m128i cvk[3], uint8_t *dst)
+{
+  const __m128i k128  = _mm_set1_epi16(128);
+  const __m128i alpha = _mm_set1_epi8((char)0xff);
+
+  __m128i yuLo = _mm_unpacklo_epi16(y, u);
+  __m128i yuHi = _mm_unpackhi_epi16(y, u);
+  __m128i vkLo = _mm_unpacklo_epi16(v, k128);
+  __m128i vkHi = _mm_unpackhi_epi16(v, k128);
+
+  __m128i rgb[3];
+  for (int c = 0; c < 3; c++)
+  {
+    __m128i lo = Channel_SSE2(yuLo, vkLo, cyu[c], cvk[c]);
+    __m128i hi = Channel_SSE2(yuHi, vkHi, cyu[c], cvk[c]);
+    rgb[c] = _mm_packs_epi32(lo, hi);
+  }
+
+  __m128i r  = _mm_packus_epi16(rgb[0], rgb[0]);
+  __m128i g  = _mm_packus_epi16(rgb[1], rgb[1]);
+  __m128i b  = _mm_packus_epi16(rgb[2], rgb[2]);
+  __m128i bg = _mm_unpacklo_epi8(b, g);
+  __m128i ra = _mm_unpacklo_epi8(r, alpha);
+
+  _mm_storeu_si128((__m128i*)dst       , _mm_unpacklo_epi16(bg, ra));
+  _mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi16(bg, ra));
+}
+
+static unsigned int RowYUV420ToBGRA_SSE2(const int16_t coef[3][4], unsigned int width
+                                       , const uint8_t *y, const uint8_t *u, const uint8_t *v
+                                       , uint8_t *dst)
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128i cyu[3], cvk[3];
+  for (int c = 0; c < 3; c++)
+  {
+    cyu[c] = _mm_set_epi16(coef[c][1], coef[c][0], coef[c][1], coef[c][0], coef[c][1], coef[c][0], coef[c][1], coef[c][0]);
+    cvk[c] = _mm_set_epi16(coef[c][3], coef[c][2], coef[c][3], coef[c][2], coef[c][3], coef[c][2], coef[c][3], coef[c][2]);
+  }
+
+  unsigned int x = 0;
+  for (; x + 8 <= width; x += 8)
+  {
+    __m128i y8 = _mm_loadl_epi64((const __m128i*)(y + x));
+    __m128i u4 = _mm_cvtsi32_si128(*(const int*)(u + (x >> 1)));
+    __m128i v4 = _mm_cvtsi32_si128(*(const int*)(v + (x >> 1)));
+
+    Pixels8ToBGRA_SSE2(_mm_unpacklo_epi8(y8, zero)
+                     , _mm_unpacklo_epi8(_mm_unpacklo_epi8(u4, u4), zero)
+                     , _mm_unpacklo_epi8(_mm_unpacklo_epi8(v4, v4), zero)
+                     , cyu, cvk, dst + x * 4);
+  }
+  return x;
+}
+
+static unsigned int RowNV12ToBGRA_SSE2(const int16_t coef[3][4], unsigned int width
+                                     , const uint8_t *y, const uint8_t *uv
+                                     , uint8_t *dst)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i mask = _mm_set1_epi32(0xffff);
+  __m128i cyu[3], cvk[3];
+  for (int c = 0; c < 3; c++)
+  {
+    cyu[c] = _mm_set_epi16(coef[c][1], coef[c][0], coef[c][1], coef[c][0], coef[c][1], coef[c][0], coef[c][1], coef[c][0]);
+    cvk[c] = _mm_set_epi16(coef[c][3], coef[c][2], coef[c][3], coef[c][2], coef[c][3], coef[c][2], coef[c][3], coef[c][2]);
+  }
+
+  unsigned int x = 0;
+  for (; x + 8 <= width; x += 8)
+  {
+    __m128i y8   = _mm_loadl_epi64((const __m128i*)(y  + x));
+    __m128i uv16 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(uv + x)), zero);
+
+    /* u0 v0 u1 v1 .. -> u0 u0 u1 u1 .. and v0 v0 v1 v1 .. */
+    __m128i u = _mm_and_si128(uv16, mask);
+    __m128i v = _mm_srli_epi32(uv16, 16);
+    u = _mm_or_si128(u, _mm_slli_epi32(u, 16));
+    v = _mm_or_si128(v, _mm_slli_epi32(v, 16));
+
+    Pixels8ToBGRA_SSE2(_mm_unpacklo_epi8(y8, zero), u, v, cyu, cvk, dst + x * 4);
+  }
+  return x;
+}
+#endif
+
+CYUV2RGBConverter::CYUV2RGBConverter(unsigned int cpuFeatures)
+{
+#ifdef __SSE2__
+  m_sse2    = (cpuFeatures & CPU_FEATURE_SSE2) != 0;
+#else
+  m_sse2    = false;
+#endif
+  m_threads = 1;
+  m_pending = 0;
+
+  /* bt601 limited range until told otherwise */
+  const float bt601[3][4] =
+  {
+    { 1.164f,  0.000f,  1.596f, -0.874f },
+    { 1.164f, -0.392f, -0.813f,  0.532f },
+    { 1.164f,  2.017f,  0.000f, -1.086f },
+  };
+  SetMatrix(bt601);
+}
+
+CYUV2RGBConverter::~CYUV2RGBConverter()
+{
+}
+
+void CYUV2RGBConverter::SetMatrix(const float matrix[3][4])
+{
+  for (int c = 0; c < 3; c++)
+  {
+    float coef[4];
+    for (int i = 0; i < 3; i++)
+      coef[i] = matrix[c][i] * (1 << COEF_SHIFT);
+
+    /* the constant is weighed against 128 so it fits, this also adds the rounding */
+    coef[3] = (matrix[c][3] * 255.0f * (1 << COEF_SHIFT) + (1 << (COEF_SHIFT - 1))) / 128.0f;
+
+    for (int i = 0; i < 4; i++)
+    {
+      float value = floorf(coef[i] + 0.5f);
+      if (value >  32767.0f) value =  32767.0f;
+      if (value < -32768.0f) value = -32768.0f;
+      m_coef[c][i] = (int16_t)value;
+    }
+  }
+}
+
+void CYUV2RGBConverter::SetThreads(unsigned int threads)
+{
+  if (threads < 1)
+    threads = 1;
+  if (threads > MAX_BANDS)
+    threads = MAX_BANDS;
+  m_threads = threads;
+}
+
+bool CYUV2RGBConverter::Supports(ERenderFormat format)
+{
+  return format == RENDER_FMT_YUV420P
+      || format == RENDER_FMT_NV12;
+}
+
+bool CYUV2RGBConverter::Convert(ERenderFormat format, uint8_t* const src[], const int srcStride[]
+                              , unsigned int width, unsigned int height
+                              , uint8_t* dst, int dstStride)
+{
+  if (!Supports(format) || !width || !height)
+    return false;
+
+  Image image;
+  image.format    = format;
+  image.width     = width;
+  image.dst       = dst;
+  image.dstStride = dstStride;
+  for (int i = 0; i < 3; i++)
+  {
+    image.src[i]       = i < 2 || format == RENDER_FMT_YUV420P ? src[i]       : NULL;
+    image.srcStride[i] = i < 2 || format == RENDER_FMT_YUV420P ? srcStride[i] : 0;
+  }
+
+  /* bands hold an even number of rows so they never share a chroma row,
+   * and are kept large enough to be worth handing to another thread */
+  unsigned int bands = m_threads;
+  if (bands > height / 64)
+    bands = height / 64;
+  if (bands < 1)
+    bands = 1;
+  unsigned int rows = ((height + bands - 1) / bands + 1) & ~1;
+
+  if (bands > 1)
+  {
+    {
+      CSingleLock lock(m_section);
+      m_pending = (height - 1) / rows;
+    }
+    /* not under m_section, CJobManager frees cancelled jobs holding its own lock */
+    for (unsigned int first = rows; first < height; first += rows)
+    {
+      unsigned int last = std::min(first + rows, height);
+      CJob *job = new CYUV2RGBBandJob(this, image, first, last);
+      if (!CJobManager::GetInstance().AddJob(job, NULL, CJob::PRIORITY_HIGH))
+      { // shutting down, the job was never queued
+        job->DoWork();
+        delete job;
+      }
+    }
+  }
+
+  ConvertBand(image, 0, std::min(rows, height));
+
+  CSingleLock lock(m_section);
+  while (m_pending > 0)
+    m_done.wait(lock);
+
+  return true;
+}
+
+void CYUV2RGBConverter::BandDone()
+{
+  CSingleLock lock(m_section);
+  if (--m_pending == 0)
+    m_done.notifyAll();
+}
+
+void CYUV2RGBConverter::ConvertBand(const Image &image, unsigned int first, unsigned int last) const
+{
+  for (unsigned int row = first; row < last; row++)
+  {
+    const uint8_t *y   = image.src[0] + row * image.srcStride[0];
+    uint8_t       *dst = image.dst    + row * image.dstStride;
+    unsigned int   x   = 0;
+
+    if (image.format == RENDER_FMT_YUV420P)
+    {
+      const uint8_t *u = image.src[1] + (row >> 1) * image.srcStride[1];
+      const uint8_t *v = image.src[2] + (row >> 1) * image.srcStride[2];
+#ifdef __SSE2__
+      if (m_sse2)
+        x = RowYUV420ToBGRA_SSE2(m_coef, image.width, y, u, v, dst);
+#endif
+      RowToBGRA(m_coef, x, image.width, y, u, v, 1, dst);
+    }
+    else
+    {
+      const uint8_t *uv = image.src[1] + (row >> 1) * image.srcStride[1];
+#ifdef __SSE2__
+      if (m_sse2)
+        x = RowNV12ToBGRA_SSE2(m_coef, image.width, y, uv, dst);
+#endif
+      RowToBGRA(m_coef, x, image.width, y, uv, uv + 1, 2, dst);
+    }
+  }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include "RenderFormats.h"
+#include "threads/Condition.h"
+#include "threads/CriticalSection.h"
+#include "utils/Job.h"
+
+/*!
+ \brief Software YUV to BGRA conversion for renderers without usable shaders.
+
+ Handles 8 bit YUV420P and NV12 with a fixed point colour matrix and
+ nearest neighbour chroma. A frame is cut into horizontal bands which are
+ converted in parallel by CJobManager workers, the calling thread converts
+ the first band itself and returns once the whole frame is done.
+ */
+class CYUV2RGBConverter
+{
+public:
+  /*!
+   \param cpuFeatures CPU_FEATURE_* flags, selects the SIMD kernels to use
+   */
+  CYUV2RGBConverter(unsigned int cpuFeatures);
+  virtual ~CYUV2RGBConverter();
+
+  /*!
+   \brief Set the colour conversion.
+   \param matrix rows give r, g and b, the columns weigh y, u, v and a constant,
+                 all values normalized to 0..1 as produced by CalculateYUVMatrix
+   */
+  void SetMatrix(const float matrix[3][4]);
+
+  /*!
+   \brief Set how many bands a frame is split into, 1 converts on the calling thread only
+   */
+  void SetThreads(unsigned int threads);
+  unsigned int GetThreads() const { return m_threads; }
+
+  static bool Supports(ERenderFormat format);
+
+  /*!
+   \brief Convert one image, blocks until all bands are done.
+   \param src the image planes, y + u + v for YUV420P or y + uv for NV12
+   \param dst BGRA output of width * height pixels
+   \return false if the format isn't supported
+   */
+  bool Convert(ERenderFormat format, uint8_t* const src[], const int srcStride[]
+             , unsigned int width, unsigned int height
+             , uint8_t* dst, int dstStride);
+
+private:
+  friend class CYUV2RGBBandJob;
+
+  struct Image
+  {
+    ERenderFormat format;
+    uint8_t*      src[3];
+    int           srcStride[3];
+    unsigned int  width;
+    uint8_t*      dst;
+    int           dstStride;
+  };
+
+  void ConvertBand(const Image &image, unsigned int first, unsigned int last) const;
+  void BandDone();
+
+  int16_t      m_coef[3][4]; // 3.13 fixed point, the constant is applied to 128
+  bool         m_sse2;
+  unsigned int m_threads;
+
+  /* counted down as band jobs are freed, whether they ran or were cancelled.
+   * The last band signals with the lock held, so the converter can't be
+   * destroyed while a worker is still touching it */
+  unsigned int                   m_pending;
+  CCriticalSection               m_section;
+  XbmcThreads::ConditionVariable m_done;
+};
@@ -0,0 +1,218 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoRenderers/YUV2RGBConverter.h"
+#include "utils/CPUInfo.h"
+#include "utils/JobManager.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#define BENCH_LOOPS 20
+
+class TestImage
+{
+public:
+  TestImage(ERenderFormat format, unsigned int width, unsigned int height)
+    : m_format(format)
+    , m_width(width)
+    , m_height(height)
+  {
+    /* odd strides make sure nothing relies on alignment */
+    m_stride[0] = width + 3;
+    m_stride[1] = format == RENDER_FMT_NV12 ? m_stride[0] + 1 : (width + 1) / 2 + 5;
+    m_stride[2] = format == RENDER_FMT_NV12 ? 0 : m_stride[1];
+
+    srand(0x5EED);
+    for (int i = 0; i < 3; i++)
+    {
+      m_plane[i].resize(m_stride[i] * (i ? (height + 1) / 2 : height) + 16);
+      for (size_t j = 0; j < m_plane[i].size(); j++)
+        m_plane[i][j] = rand() & 0xff;
+      m_data[i] = m_plane[i].empty() ? NULL : &m_plane[i][0];
+    }
+  }
+
+  bool Convert(CYUV2RGBConverter &converter, std::vector<uint8_t> &out)
+  {
+    out.assign(m_width * m_height * 4, 0);
+    return converter.Convert(m_format, m_data, m_stride, m_width, m_height, &out[0], m_width * 4);
+  }
+
+  void Pixel(unsigned int x, unsigned int y, int &Y, int &U, int &V) const
+  {
+    Y = m_data[0][y * m_stride[0] + x];
+    if (m_format == RENDER_FMT_NV12)
+    {
+      U = m_data[1][(y / 2) * m_stride[1] + (x / 2) * 2];
+      V = m_data[1][(y / 2) * m_stride[1] + (x / 2) * 2 + 1];
+    }
+    else
+    {
+      U = m_data[1][(y / 2) * m_stride[1] + x / 2];
+      V = m_data[2][(y / 2) * m_stride[2] + x / 2];
+    }
+  }
+
+  ERenderFormat        m_format;
+  unsigned int         m_width;
+  unsigned int         m_height;
+  std::vector<uint8_t> m_plane[3];
+  uint8_t             *m_data[3];
+  int                  m_stride[3];
+};
+
+static const float bt709[3][4] =
+{
+  { 1.164f,  0.000f,  1.793f, -0.973f },
+  { 1.164f, -0.213f, -0.533f,  0.301f },
+  { 1.164f,  2.112f,  0.000f, -1.133f },
+};
+
+static void CompareReference(ERenderFormat format, unsigned int width, unsigned int height)
+{
+  TestImage image(format, width, height);
+  CYUV2RGBConverter converter(0);
+  converter.SetMatrix(bt709);
+
+  std::vector<uint8_t> out;
+  ASSERT_TRUE(image.Convert(converter, out));
+
+  for (unsigned int y = 0; y < height; y++)
+  {
+    for (unsigned int x = 0; x < width; x++)
+    {
+      int Y, U, V;
+      image.Pixel(x, y, Y, U, V);
+      for (int c = 0; c < 3; c++)
+      {
+        float ref = bt709[c][0] * Y + bt709[c][1] * U + bt709[c][2] * V + bt709[c][3] * 255.0f;
+        ref = ref < 0.0f ? 0.0f : (ref > 255.0f ? 255.0f : ref);
+        ASSERT_NEAR(ref, out[(y * width + x) * 4 + 2 - c], 1.0f)
+          << "channel " << c << " differs at " << x << "," << y;
+      }
+      ASSERT_EQ(0xff, out[(y * width + x) * 4 + 3]);
+    }
+  }
+}
+
+static void CompareConverters(ERenderFormat format, unsigned int width, unsigned int height
+                            , unsigned int cpuFeatures, unsigned int threads)
+{
+  TestImage image(format, width, height);
+  CYUV2RGBConverter reference(0);
+  CYUV2RGBConverter converter(cpuFeatures);
+  converter.SetThreads(threads);
+
+  std::vector<uint8_t> ref, out;
+  ASSERT_TRUE(image.Convert(reference, ref));
+  ASSERT_TRUE(image.Convert(converter, out));
+
+  for (size_t i = 0; i < ref.size(); i++)
+    ASSERT_EQ(ref[i], out[i]) << "differs at pixel " << i / 4 << " of " << width << "x" << height;
+}
+
+static double BenchConvert(ERenderFormat format, unsigned int width, unsigned int height
+                         , unsigned int cpuFeatures, unsigned int threads)
+{
+  TestImage image(format, width, height);
+  CYUV2RGBConverter converter(cpuFeatures);
+  converter.SetThreads(threads);
+
+  std::vector<uint8_t> out;
+  image.Convert(converter, out);
+
+  int64_t start = CurrentHostCounter();
+  for (int i = 0; i < BENCH_LOOPS; ++i)
+    converter.Convert(format, image.m_data, image.m_stride, width, height, &out[0], width * 4);
+  int64_t end = CurrentHostCounter();
+
+  if (end <= start)
+    return 0.0;
+  return (double)BENCH_LOOPS * CurrentHostFrequency() / (end - start);
+}
+
+TEST(TestYUV2RGBConverter, Reference)
+{
+  CompareReference(RENDER_FMT_YUV420P, 64, 32);
+  CompareReference(RENDER_FMT_YUV420P, 37, 17);
+  CompareReference(RENDER_FMT_NV12   , 64, 32);
+  CompareReference(RENDER_FMT_NV12   , 37, 17);
+}
+
+TEST(TestYUV2RGBConverter, Unsupported)
+{
+  TestImage image(RENDER_FMT_YUV420P, 16, 16);
+  CYUV2RGBConverter converter(0);
+  std::vector<uint8_t> out(16 * 16 * 4);
+  EXPECT_FALSE(converter.Convert(RENDER_FMT_YUYV422, image.m_data, image.m_stride, 16, 16, &out[0], 16 * 4));
+}
+
+TEST(TestYUV2RGBConverter, SIMD)
+{
+  CompareConverters(RENDER_FMT_YUV420P, 1920, 64, CPU_FEATURE_SSE2, 1);
+  CompareConverters(RENDER_FMT_YUV420P, 1283, 63, CPU_FEATURE_SSE2, 1);
+  CompareConverters(RENDER_FMT_NV12   , 1920, 64, CPU_FEATURE_SSE2, 1);
+  CompareConverters(RENDER_FMT_NV12   , 1283, 63, CPU_FEATURE_SSE2, 1);
+}
+
+TEST(TestYUV2RGBConverter, Threaded)
+{
+  CompareConverters(RENDER_FMT_YUV420P, 1920, 1080, CPU_FEATURE_SSE2, 4);
+  CompareConverters(RENDER_FMT_YUV420P, 721 , 577 , 0               , 3);
+  CompareConverters(RENDER_FMT_NV12   , 1920, 1080, CPU_FEATURE_SSE2, 8);
+  CompareConverters(RENDER_FMT_NV12   , 721 , 577 , 0               , 5);
+}
+
+TEST(TestYUV2RGBConverter, Benchmark)
+{
+  const unsigned int sizes[][2] = { { 1920, 1080 }, { 3840, 2160 } };
+  const ERenderFormat formats[] = { RENDER_FMT_YUV420P, RENDER_FMT_NV12 };
+  unsigned int features = g_cpuInfo.GetCPUFeatures();
+  unsigned int threads  = g_cpuInfo.getCPUCount();
+
+  for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+  {
+    for (unsigned int f = 0; f < sizeof(formats) / sizeof(formats[0]); f++)
+    {
+      double scalar   = BenchConvert(formats[f], sizes[s][0], sizes[s][1], 0       , 1);
+      double simd     = BenchConvert(formats[f], sizes[s][0], sizes[s][1], features, 1);
+      double threaded = BenchConvert(formats[f], sizes[s][0], sizes[s][1], features, threads);
+      std::cout << (formats[f] == RENDER_FMT_NV12 ? "nv12 " : "yuv420p ")
+                << sizes[s][0] << "x" << sizes[s][1] << ": "
+                << scalar   << " fps scalar, "
+                << simd     << " fps simd, "
+                << threaded << " fps with " << threads << " threads" << std::endl;
+      EXPECT_GT(threaded, 0.0);
+    }
+  }
+}
+
+// runs last, the job manager stays stopped for the rest of the process
+TEST(TestYUV2RGBConverter, JobManagerStopped)
+{
+  CJobManager::GetInstance().CancelJobs();
+  CompareConverters(RENDER_FMT_YUV420P, 1920, 1080, CPU_FEATURE_SSE2, 4);
+  CompareConverters(RENDER_FMT_NV12   , 721 , 577 , 0               , 5);
+}
@@ -1633,6 +1633,8 @@ bool CCrystalHD::GetPicture(DVDVideoPicture *pDvdVideoPicture)
   // and external queue. pts will get set from m_timestamp.
   pDvdVideoPicture->dts = DVD_NOPTS_VALUE;
   pDvdVideoPicture->pts = DVD_NOPTS_VALUE;
+  // the planes are in our output buffers, which the renderer copies from
+  pDvdVideoPicture->buffer = NULL;
 
   if (pBuffer->m_timestamp != 0)
     pDvdVideoPicture->pts = (double)pBuffer->m_timestamp / 1000.0;
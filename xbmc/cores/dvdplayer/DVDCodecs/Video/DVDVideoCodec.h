@@ -23,6 +23,7 @@
 #include "system.h"
 
 #include <vector>
+#include <boost/shared_ptr.hpp>
 #include "cores/VideoRenderers/RenderFormats.h"
 
 // when modifying these structures, make sure you update all codecs accordingly
@@ -39,6 +40,22 @@ class COpenMax;
 class COpenMaxVideo;
 struct OpenMaxVideoBuffer;
 
+// memory backing the planes of a software decoded picture, a renderer can
+// keep a reference to it and upload from it instead of copying the picture
+class CDVDVideoBuffer
+{
+public:
+  CDVDVideoBuffer(BYTE* data, unsigned int size) : m_data(data), m_size(size) {}
+  virtual ~CDVDVideoBuffer() {}
+
+  bool Contains(const BYTE* ptr) const { return ptr >= m_data && ptr < m_data + m_size; }
+
+protected:
+  BYTE*        m_data;
+  unsigned int m_size;
+};
+typedef boost::shared_ptr<CDVDVideoBuffer> CDVDVideoBufferPtr;
+
 // should be entirely filled by all codecs
 struct DVDVideoPicture
 {
@@ -71,6 +88,9 @@ struct DVDVideoPicture
     };
   };
 
+  CDVDVideoBufferPtr* buffer; // if set, data[] points into this buffer, valid until the next decode
+                              // every codec sets it, NULL unless the picture is backed by a buffer
+
   unsigned int iFlags;
 
   double       iRepeatPicture;
@@ -36,6 +36,8 @@
 #include "utils/log.h"
 #include "boost/shared_ptr.hpp"
 #include "threads/Atomics.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
 
 #ifndef _LINUX
 #define RINT(x) ((x) >= 0 ? ((int)((x) + 0.5)) : ((int)((x) - 0.5)))
@@ -59,12 +61,185 @@
 
 using namespace boost;
 
+/* Recycles the memory blocks ffmpeg decodes into. Blocks stay out of the
+ * pool for as long as any picture references them, so the renderer can
+ * upload straight from a block without it being overwritten. */
+class CVideoBufferPoolFFmpeg
+{
+public:
+  CVideoBufferPoolFFmpeg() : m_size(0) {}
+  ~CVideoBufferPoolFFmpeg()
+  {
+    for (std::vector<BYTE*>::iterator it = m_free.begin(); it != m_free.end(); ++it)
+      _aligned_free(*it);
+  }
+
+  BYTE* Get(unsigned int size, bool& fresh)
+  {
+    CSingleLock lock(m_section);
+    if (size != m_size)
+    {
+      for (std::vector<BYTE*>::iterator it = m_free.begin(); it != m_free.end(); ++it)
+        _aligned_free(*it);
+      m_free.clear();
+      m_size = size;
+    }
+
+    if (!m_free.empty())
+    {
+      BYTE* block = m_free.back();
+      m_free.pop_back();
+      fresh = false;
+      return block;
+    }
+    fresh = true;
+    return (BYTE*)_aligned_malloc(size, 64);
+  }
+
+  void Put(BYTE* block, unsigned int size)
+  {
+    CSingleLock lock(m_section);
+    if (size != m_size || m_free.size() >= 32)
+      _aligned_free(block);
+    else
+      m_free.push_back(block);
+  }
+
+private:
+  CCriticalSection   m_section;
+  std::vector<BYTE*> m_free;
+  unsigned int       m_size;
+};
+
+class CVideoBufferFFmpeg : public CDVDVideoBuffer
+{
+public:
+  CVideoBufferFFmpeg(const shared_ptr<CVideoBufferPoolFFmpeg>& pool, BYTE* data, unsigned int size)
+    : CDVDVideoBuffer(data, size)
+    , m_pool(pool)
+  {}
+  virtual ~CVideoBufferFFmpeg()
+  {
+    m_pool->Put(m_data, m_size);
+  }
+private:
+  shared_ptr<CVideoBufferPoolFFmpeg> m_pool;
+};
+
+int CDVDVideoCodecFFmpeg::GetBuffer(struct AVCodecContext * avctx, AVFrame * pic)
+{
+  CDVDVideoCodecFFmpeg* ctx  = (CDVDVideoCodecFFmpeg*)avctx->opaque;
+
+  if((avctx->pix_fmt != PIX_FMT_YUV420P && avctx->pix_fmt != PIX_FMT_YUVJ420P)
+  || avctx->width <= 0 || avctx->height <= 0)
+    return ctx->m_dllAvCodec.avcodec_default_get_buffer(avctx, pic);
+
+  int w = avctx->width;
+  int h = avctx->height;
+  int align[AV_NUM_DATA_POINTERS];
+  ctx->m_dllAvCodec.avcodec_align_dimensions2(avctx, &w, &h, align);
+
+  int edge = 0;
+  if(!(avctx->flags & CODEC_FLAG_EMU_EDGE))
+  {
+    edge = ctx->m_dllAvCodec.avcodec_get_edge_width();
+    w += edge * 2;
+    h += edge * 2;
+  }
+
+  /* same search as the default allocator, luma and chroma strides must both be aligned */
+  int stride[3];
+  do
+  {
+    stride[0] = w;
+    stride[1] = stride[2] = (w + 1) >> 1;
+    w += w & ~(w - 1);
+  } while(stride[0] % align[0] || stride[1] % align[1] || stride[2] % align[2]);
+
+  unsigned int offset[3], size = 0;
+  for(int i = 0; i < 3; i++)
+  {
+    offset[i] = size;
+    size     += (stride[i] * (i ? (h + 1) >> 1 : h) + 16 + 63) & ~63;
+  }
+
+  bool  fresh;
+  BYTE* block = ctx->m_bufferPool->Get(size, fresh);
+  if(!block)
+    return -1;
+
+  /* the decoder may read what it hasn't written yet, start with black */
+  if(fresh)
+  {
+    memset(block, 0, offset[1]);
+    memset(block + offset[1], 128, size - offset[1]);
+  }
+
+  pic->opaque = new CDVDVideoBufferPtr(new CVideoBufferFFmpeg(ctx->m_bufferPool, block, size));
+  pic->type   = FF_BUFFER_TYPE_USER;
+
+  for(int i = 0; i < AV_NUM_DATA_POINTERS; i++)
+  {
+    if(i < 3)
+    {
+      int shift = i ? 1 : 0;
+      pic->base[i]     = block + offset[i];
+      pic->data[i]     = pic->base[i] + FFALIGN((stride[i] * edge >> shift) + (edge >> shift), align[i]);
+      pic->linesize[i] = stride[i];
+    }
+    else
+    {
+      pic->base[i]     = NULL;
+      pic->data[i]     = NULL;
+      pic->linesize[i] = 0;
+    }
+  }
+  pic->extended_data = pic->data;
+
+  /* what ff_init_buffer_info would have filled in */
+  if(avctx->pkt)
+  {
+    pic->pkt_pts = avctx->pkt->pts;
+    pic->pkt_pos = avctx->pkt->pos;
+  }
+  else
+  {
+    pic->pkt_pts = AV_NOPTS_VALUE;
+    pic->pkt_pos = -1;
+  }
+  pic->reordered_opaque    = avctx->reordered_opaque;
+  pic->sample_aspect_ratio = avctx->sample_aspect_ratio;
+  pic->width               = avctx->width;
+  pic->height              = avctx->height;
+  pic->format              = avctx->pix_fmt;
+  return 0;
+}
+
+void CDVDVideoCodecFFmpeg::ReleaseBuffer(struct AVCodecContext * avctx, AVFrame * pic)
+{
+  if(pic->type != FF_BUFFER_TYPE_USER)
+  {
+    CDVDVideoCodecFFmpeg* ctx  = (CDVDVideoCodecFFmpeg*)avctx->opaque;
+    ctx->m_dllAvCodec.avcodec_default_release_buffer(avctx, pic);
+    return;
+  }
+
+  delete (CDVDVideoBufferPtr*)pic->opaque;
+  pic->opaque = NULL;
+  for(int i = 0; i < AV_NUM_DATA_POINTERS; i++)
+  {
+    pic->base[i] = NULL;
+    pic->data[i] = NULL;
+  }
+}
+
 enum PixelFormat CDVDVideoCodecFFmpeg::GetFormat( struct AVCodecContext * avctx
                                                 , const PixelFormat * fmt )
 {
   CDVDVideoCodecFFmpeg* ctx  = (CDVDVideoCodecFFmpeg*)avctx->opaque;
 
-  if(!ctx->IsHardwareAllowed())
+  // hardware decoders don't survive frame threading
+  if(!ctx->IsHardwareAllowed() || (avctx->active_thread_type & FF_THREAD_FRAME))
     return ctx->m_dllAvCodec.avcodec_default_get_format(avctx, fmt);
 
   const PixelFormat * cur = fmt;
@@ -120,6 +295,23 @@ enum PixelFormat CDVDVideoCodecFFmpeg::GetFormat( struct AVCodecContext * avctx
   return ctx->m_dllAvCodec.avcodec_default_get_format(avctx, fmt);
 }
 
+bool CDVDVideoCodecFFmpeg::IsHardwareEnabled()
+{
+#ifdef HAVE_LIBVDPAU
+  if(g_guiSettings.GetBool("videoplayer.usevdpau"))
+    return true;
+#endif
+#ifdef HAS_DX
+  if(g_guiSettings.GetBool("videoplayer.usedxva2"))
+    return true;
+#endif
+#ifdef HAVE_LIBVA
+  if(g_guiSettings.GetBool("videoplayer.usevaapi"))
+    return true;
+#endif
+  return false;
+}
+
 CDVDVideoCodecFFmpeg::CDVDVideoCodecFFmpeg() : CDVDVideoCodec()
 {
   m_pCodecContext = NULL;
@@ -140,6 +332,7 @@ CDVDVideoCodecFFmpeg::CDVDVideoCodecFFmpeg() : CDVDVideoCodec()
   m_bSoftware = false;
   m_pHardware = NULL;
   m_iLastKeyframe = 0;
+  m_iThreadDelay = 0;
   m_dts = DVD_NOPTS_VALUE;
   m_started = false;
 }
@@ -245,10 +438,6 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
   m_pCodecContext->workaround_bugs = FF_BUG_AUTODETECT;
   m_pCodecContext->get_format = GetFormat;
   m_pCodecContext->codec_tag = hints.codec_tag;
-  /* Only allow slice threading, since frame threading is more
-   * sensitive to changes in frame sizes, and it causes crashes
-   * during HW accell */
-  m_pCodecContext->thread_type = FF_THREAD_SLICE;
 
 #if defined(TARGET_DARWIN_IOS)
   // ffmpeg with enabled neon will crash and burn if this is enabled
@@ -291,11 +480,52 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
       m_dllAvUtil.av_opt_set(m_pCodecContext, it->m_name.c_str(), it->m_value.c_str(), 0);
   }
 
-  int num_threads = std::min(8 /*MAX_THREADS*/, g_cpuInfo.getCPUCount());
-  if( num_threads > 1 && !hints.software && m_pHardware == NULL // thumbnail extraction fails when run threaded
-  && ( pCodec->id == CODEC_ID_H264
-    || pCodec->id == CODEC_ID_MPEG4 ))
-    m_pCodecContext->thread_count = num_threads;
+  int num_threads = g_advancedSettings.m_videoDecoderThreads;
+  if (num_threads <= 0)
+    num_threads = std::min(16 /*MAX_AUTO_THREADS*/, g_cpuInfo.getCPUCount());
+
+  /* threading is only known to work well for H.264 and MPEG-4 ASP, other
+   * codecs are threaded when a thread type is set explicitly */
+  const CStdString &type = g_advancedSettings.m_videoDecoderThreadType;
+  bool threaded = type.Equals("frame") || type.Equals("slice")
+               || pCodec->id == CODEC_ID_H264
+               || pCodec->id == CODEC_ID_MPEG4;
+
+  if( num_threads > 1 && threaded && !hints.software && m_pHardware == NULL) // thumbnail extraction fails when run threaded
+  {
+    /* Frame threading is more sensitive to changes in frame sizes, and it
+     * causes crashes during HW accell. Only use it when there is no hardware
+     * decoder and GetFormat can't pick one, unless it was explicitly asked
+     * for, in which case hardware decoding is disabled for this codec */
+    bool frame = (pCodec->capabilities & CODEC_CAP_FRAME_THREADS)
+              && !type.Equals("slice")
+              && (m_bSoftware || !IsHardwareEnabled() || type.Equals("frame"));
+
+    if (frame)
+    {
+      m_bSoftware = true;
+      m_pCodecContext->thread_type  = FF_THREAD_FRAME;
+      m_pCodecContext->thread_count = num_threads;
+    }
+    else if (pCodec->capabilities & CODEC_CAP_SLICE_THREADS)
+    {
+      m_pCodecContext->thread_type  = FF_THREAD_SLICE;
+      m_pCodecContext->thread_count = num_threads;
+    }
+  }
+
+  /* decode into refcounted buffers the renderer can keep hold of instead of copying,
+   * hardware decoders install their own get_buffer from GetFormat */
+  if (g_advancedSettings.m_videoZeroCopy && !hints.software && m_pHardware == NULL
+  && (m_bSoftware || !IsHardwareEnabled())
+  && (pCodec->capabilities & CODEC_CAP_DR1))
+  {
+    m_bufferPool.reset(new CVideoBufferPoolFFmpeg());
+    m_pCodecContext->get_buffer            = GetBuffer;
+    m_pCodecContext->release_buffer        = ReleaseBuffer;
+    m_pCodecContext->thread_safe_callbacks = 1;
+    CLog::Log(LOGNOTICE,"CDVDVideoCodecFFmpeg::Open() Decoding into shared buffers");
+  }
 
   if (m_dllAvCodec.avcodec_open2(m_pCodecContext, pCodec, NULL) < 0)
   {
@@ -303,6 +533,15 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
     return false;
   }
 
+  if (m_pCodecContext->active_thread_type & FF_THREAD_FRAME)
+    m_iThreadDelay = m_pCodecContext->thread_count - 1;
+  else
+    m_iThreadDelay = 0;
+
+  if (m_pCodecContext->active_thread_type)
+    CLog::Log(LOGNOTICE,"CDVDVideoCodecFFmpeg::Open() Using %d %s threads", m_pCodecContext->thread_count
+            , m_pCodecContext->active_thread_type & FF_THREAD_FRAME ? "frame" : "slice");
+
   m_pFrame = m_dllAvCodec.avcodec_alloc_frame();
   if (!m_pFrame) return false;
 
@@ -329,6 +568,10 @@ void CDVDVideoCodecFFmpeg::Dispose()
   }
   SAFE_RELEASE(m_pHardware);
 
+  /* pictures still held by the renderer keep the pool alive */
+  m_buffer.reset();
+  m_bufferPool.reset();
+
   FilterClose();
 
   m_dllAvCodec.Unload();
@@ -464,13 +707,17 @@ int CDVDVideoCodecFFmpeg::Decode(BYTE* pData, int iSize, double dts, double pts)
   m_dllAvCodec.av_init_packet(&avpkt);
   avpkt.data = pData;
   avpkt.size = iSize;
+  /* with frame threading the picture we get back belongs to an earlier
+   * packet, so let ffmpeg carry the dts along with it */
+  if (m_iThreadDelay)
+    avpkt.dts = pData ? pts_dtoi(dts) : AV_NOPTS_VALUE;
   /* We lie, but this flag is only used by pngdec.c.
    * Setting it correctly would allow CorePNG decoding. */
   avpkt.flags = AV_PKT_FLAG_KEY;
   len = m_dllAvCodec.avcodec_decode_video2(m_pCodecContext, m_pFrame, &iGotPicture, &avpkt);
 
-  if(m_iLastKeyframe < m_pCodecContext->has_b_frames + 2)
-    m_iLastKeyframe = m_pCodecContext->has_b_frames + 2;
+  if(m_iLastKeyframe < m_pCodecContext->has_b_frames + m_iThreadDelay + 2)
+    m_iLastKeyframe = m_pCodecContext->has_b_frames + m_iThreadDelay + 2;
 
   if (len < 0)
   {
@@ -484,7 +731,7 @@ int CDVDVideoCodecFFmpeg::Decode(BYTE* pData, int iSize, double dts, double pts)
   if(m_pFrame->key_frame)
   {
     m_started = true;
-    m_iLastKeyframe = m_pCodecContext->has_b_frames + 2;
+    m_iLastKeyframe = m_pCodecContext->has_b_frames + m_iThreadDelay + 2;
   }
 
   /* put a limit on convergence count to avoid huge mem usage on streams without keyframes */
@@ -541,7 +788,7 @@ int CDVDVideoCodecFFmpeg::Decode(BYTE* pData, int iSize, double dts, double pts)
 void CDVDVideoCodecFFmpeg::Reset()
 {
   m_started = false;
-  m_iLastKeyframe = m_pCodecContext->has_b_frames;
+  m_iLastKeyframe = m_pCodecContext->has_b_frames + m_iThreadDelay;
   m_dllAvCodec.avcodec_flush_buffers(m_pCodecContext);
 
   if (m_pHardware)
@@ -632,7 +879,15 @@ bool CDVDVideoCodecFFmpeg::GetPictureCommon(DVDVideoPicture* pDvdVideoPicture)
     pDvdVideoPicture->qscale_type = DVP_QSCALE_UNKNOWN;
   }
 
-  pDvdVideoPicture->dts = m_dts;
+  if (m_iThreadDelay)
+  {
+    if (m_pFrame->pkt_dts != AV_NOPTS_VALUE)
+      pDvdVideoPicture->dts = pts_itod(m_pFrame->pkt_dts);
+    else
+      pDvdVideoPicture->dts = DVD_NOPTS_VALUE;
+  }
+  else
+    pDvdVideoPicture->dts = m_dts;
   m_dts = DVD_NOPTS_VALUE;
   if (m_pFrame->reordered_opaque)
     pDvdVideoPicture->pts = pts_itod(m_pFrame->reordered_opaque);
@@ -647,6 +902,9 @@ bool CDVDVideoCodecFFmpeg::GetPictureCommon(DVDVideoPicture* pDvdVideoPicture)
 
 bool CDVDVideoCodecFFmpeg::GetPicture(DVDVideoPicture* pDvdVideoPicture)
 {
+  // only software decoded frames are backed by our buffers
+  pDvdVideoPicture->buffer = NULL;
+
   if(m_pHardware)
     return m_pHardware->GetPicture(m_pCodecContext, m_pFrame, pDvdVideoPicture);
 
@@ -660,6 +918,15 @@ bool CDVDVideoCodecFFmpeg::GetPicture(DVDVideoPicture* pDvdVideoPicture)
       pDvdVideoPicture->iLineSize[i] = m_pFrame->linesize[i];
   }
 
+  /* hand out a reference to the buffer, unless a filter replaced the frame data */
+  if(!m_pBufferRef && m_pFrame->type == FF_BUFFER_TYPE_USER && m_bufferPool && m_pFrame->opaque)
+  {
+    m_buffer = *(CDVDVideoBufferPtr*)m_pFrame->opaque;
+    pDvdVideoPicture->buffer = &m_buffer;
+  }
+  else
+    pDvdVideoPicture->buffer = NULL;
+
   pDvdVideoPicture->iFlags |= pDvdVideoPicture->data[0] ? 0 : DVP_FLAG_DROPPED;
   pDvdVideoPicture->extended_format = 0;
 
@@ -30,6 +30,7 @@
 
 class CVDPAU;
 class CCriticalSection;
+class CVideoBufferPoolFFmpeg;
 
 class CDVDVideoCodecFFmpeg : public CDVDVideoCodec
 {
@@ -62,6 +63,7 @@ public:
   virtual unsigned GetConvergeCount();
 
   bool               IsHardwareAllowed()                     { return !m_bSoftware; }
+  static bool        IsHardwareEnabled();
   IHardwareDecoder * GetHardware()                           { return m_pHardware; };
   void               SetHardware(IHardwareDecoder* hardware) 
   {
@@ -72,6 +74,8 @@ public:
 
 protected:
   static enum PixelFormat GetFormat(struct AVCodecContext * avctx, const PixelFormat * fmt);
+  static int  GetBuffer(struct AVCodecContext * avctx, AVFrame * pic);
+  static void ReleaseBuffer(struct AVCodecContext * avctx, AVFrame * pic);
 
   int  FilterOpen(const CStdString& filters, bool scale);
   void FilterClose();
@@ -116,7 +120,11 @@ protected:
   bool              m_bSoftware;
   IHardwareDecoder *m_pHardware;
   int m_iLastKeyframe;
+  int m_iThreadDelay; // extra frames of latency added by frame threading
   double m_dts;
   bool   m_started;
   std::vector<PixelFormat> m_formats;
+
+  boost::shared_ptr<CVideoBufferPoolFFmpeg> m_bufferPool; // set when decoding into our own buffers
+  CDVDVideoBufferPtr m_buffer;                            // buffer backing the last returned picture
 };
@@ -488,6 +488,7 @@ bool CDVDVideoCodecLibMpeg2::GetPicture(DVDVideoPicture* pDvdVideoPicture)
   if(m_pCurrentBuffer && m_pCurrentBuffer->iFlags & DVP_FLAG_ALLOCATED)
   {
     memcpy(pDvdVideoPicture, m_pCurrentBuffer, sizeof(DVDVideoPicture));
+    pDvdVideoPicture->buffer = NULL;
 
     // If we're decoding a 4:2:2 image, we need to skip every other line to get
     // down to 4:2:0. We lose image quality, but hopefully nobody will notice.
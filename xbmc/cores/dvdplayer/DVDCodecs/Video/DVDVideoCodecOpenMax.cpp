@@ -190,6 +190,7 @@ bool CDVDVideoCodecOpenMax::GetPicture(DVDVideoPicture* pDvdVideoPicture)
 {
   m_omx_decoder->GetPicture(&m_videobuffer);
   *pDvdVideoPicture = m_videobuffer;
+  pDvdVideoPicture->buffer = NULL;
 
   return VC_PICTURE | VC_BUFFER;
 }
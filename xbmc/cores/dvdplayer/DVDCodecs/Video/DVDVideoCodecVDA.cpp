@@ -1044,6 +1044,8 @@ void CDVDVideoCodecVDA::Reset(void)
 
 bool CDVDVideoCodecVDA::GetPicture(DVDVideoPicture* pDvdVideoPicture)
 {
+  pDvdVideoPicture->buffer = NULL;
+
   // get the top yuv frame, we risk getting the wrong frame if the frame queue
   // depth is less than the number of encoded reference frames. If queue depth
   // is greater than the number of encoded reference frames, then the top frame
@@ -1452,6 +1452,7 @@ bool CDVDVideoCodecVideoToolBox::GetPicture(DVDVideoPicture* pDvdVideoPicture)
 {
   // clone the video picture buffer settings.
   *pDvdVideoPicture = m_videobuffer;
+  pDvdVideoPicture->buffer = NULL;
 
   // get the top picture frame, we risk getting the wrong frame if the frame queue
   // depth is less than the number of encoded reference frames. If queue depth
@@ -156,6 +156,8 @@ bool CDVDVideoPPFFmpeg::Process(DVDVideoPicture* pPicture)
   m_pTarget->pts = m_pSource->pts;
   m_pTarget->iGroupId = m_pSource->iGroupId;
   m_pTarget->format = RENDER_FMT_YUV420P;
+  // the postprocessed planes are ours, not in a buffer of the decoder
+  m_pTarget->buffer = NULL;
   return true;
 }
 
@@ -381,6 +381,7 @@ void COpenMaxVideo::Reset(void)
 
 bool COpenMaxVideo::GetPicture(DVDVideoPicture* pDvdVideoPicture)
 {
+  pDvdVideoPicture->buffer = NULL;
   while (m_omx_output_busy.size() > 1)
   {
     // fetch a output buffer and pop it off the busy list
@@ -47,6 +47,12 @@
 #include "threads/SystemClock.h"
 #include "utils/TimeUtils.h"
 
+// bounds for the read ahead queue when the bitrate of the stream is known
+#define READAHEAD_MIN_BYTES (1024 * 1024)
+#define READAHEAD_MAX_BYTES (64 * 1024 * 1024)
+// underruns grow the read ahead time up to this multiple of the configured time
+#define READAHEAD_MAX_GROWTH 4.0
+
 void CDemuxStreamAudioFFmpeg::GetStreamInfo(std::string& strInfo)
 {
   if(!m_stream) return;
@@ -214,6 +220,13 @@ CDVDDemuxFFmpeg::CDVDDemuxFFmpeg() : CDVDDemux()
   m_bAVI = false;
   m_speed = DVD_PLAYSPEED_NORMAL;
   m_program = UINT_MAX;
+  m_readAheadThread = NULL;
+  m_readAheadBytes = 0;
+  m_readAheadFlushes = 0;
+  m_readAheadTarget = 0.0;
+  m_readAheadHold = false;
+  m_readAheadStop = false;
+  m_readAheadAbort = false;
 }
 
 CDVDDemuxFFmpeg::~CDVDDemuxFFmpeg()
@@ -227,6 +240,9 @@ bool CDVDDemuxFFmpeg::Aborted()
   if(m_timeout.IsTimePast())
     return true;
 
+  if(m_readAheadAbort)
+    return true;
+
   return false;
 }
 
@@ -495,11 +511,17 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
       AddStream(i);
   }
 
+  // network shares are reached through the file input stream, others do their own buffering
+  if (g_advancedSettings.m_demuxReadAhead > 0.0f && m_pInput->IsStreamType(DVDSTREAM_TYPE_FILE))
+    StartReadAhead();
+
   return true;
 }
 
 void CDVDDemuxFFmpeg::Dispose()
 {
+  StopReadAhead();
+
   g_demuxer.set(this);
 
   if (m_pFormatContext)
@@ -550,6 +572,15 @@ void CDVDDemuxFFmpeg::Flush()
 {
   g_demuxer.set(this);
 
+  m_readAheadAbort = true;
+  CSingleLock lock(m_critSection);
+  FlushReadAhead();
+
+  FlushInternal();
+}
+
+void CDVDDemuxFFmpeg::FlushInternal()
+{
   // naughty usage of an internal ffmpeg function
   if (m_pFormatContext)
     m_dllAvFormat.av_read_frame_flush(m_pFormatContext);
@@ -569,6 +600,8 @@ void CDVDDemuxFFmpeg::SetSpeed(int iSpeed)
   if(!m_pFormatContext)
     return;
 
+  // no m_critSection here, the read ahead holds it across a blocking read.
+  // pausing only needs the format context, and queued packets stay valid
   if(m_speed != DVD_PLAYSPEED_PAUSE && iSpeed == DVD_PLAYSPEED_PAUSE)
   {
     m_pInput->Pause((double)m_iCurrentPts);
@@ -625,6 +658,20 @@ double CDVDDemuxFFmpeg::ConvertTimestamp(int64_t pts, int den, int num)
 }
 
 DemuxPacket* CDVDDemuxFFmpeg::Read()
+{
+  if (m_readAheadThread)
+    return ReadAhead();
+
+  DemuxPacket* pPacket = ReadPacket();
+
+  // content has changed, or stream did not yet exist
+  if (pPacket && IsStreamChanged(pPacket->iStreamId))
+    AddStream(pPacket->iStreamId);
+
+  return pPacket;
+}
+
+DemuxPacket* CDVDDemuxFFmpeg::ReadPacket()
 {
   g_demuxer.set(this);
 
@@ -657,7 +704,7 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
     }
     else if (result < 0)
     {
-      Flush();
+      FlushInternal();
     }
     else if (pkt.size < 0 || pkt.stream_index >= MAX_STREAMS)
     {
@@ -666,7 +713,7 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
       {
         CLog::Log(LOGERROR, "CDVDDemuxFFmpeg::Read() no valid packet");
         bReturnEmpty = true;
-        Flush();
+        FlushInternal();
       }
       else
         CLog::Log(LOGERROR, "CDVDDemuxFFmpeg::Read() returned invalid packet and eof reached");
@@ -772,39 +819,34 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
   if (bReturnEmpty && !pPacket)
     pPacket = CDVDDemuxUtils::AllocateDemuxPacket(0);
 
-  if (!pPacket) return NULL;
+  return pPacket;
+}
 
+bool CDVDDemuxFFmpeg::IsStreamChanged(int iId)
+{
   // check streams, can we make this a bit more simple?
-  if (pPacket && pPacket->iStreamId >= 0 && pPacket->iStreamId < MAX_STREAMS)
+  if (iId < 0 || iId >= MAX_STREAMS)
+    return false;
+
+  if (!m_streams[iId] ||
+      m_streams[iId]->pPrivate != m_pFormatContext->streams[iId] ||
+      m_streams[iId]->codec != m_pFormatContext->streams[iId]->codec->codec_id)
+    return true;
+
+  // we already check for a valid m_streams[iId] above
+  if (m_streams[iId]->type == STREAM_AUDIO)
   {
-    if (!m_streams[pPacket->iStreamId] ||
-        m_streams[pPacket->iStreamId]->pPrivate != m_pFormatContext->streams[pPacket->iStreamId] ||
-        m_streams[pPacket->iStreamId]->codec != m_pFormatContext->streams[pPacket->iStreamId]->codec->codec_id)
-    {
-      // content has changed, or stream did not yet exist
-      AddStream(pPacket->iStreamId);
-    }
-    // we already check for a valid m_streams[pPacket->iStreamId] above
-    else if (m_streams[pPacket->iStreamId]->type == STREAM_AUDIO)
-    {
-      if (((CDemuxStreamAudio*)m_streams[pPacket->iStreamId])->iChannels != m_pFormatContext->streams[pPacket->iStreamId]->codec->channels ||
-          ((CDemuxStreamAudio*)m_streams[pPacket->iStreamId])->iSampleRate != m_pFormatContext->streams[pPacket->iStreamId]->codec->sample_rate)
-      {
-        // content has changed
-        AddStream(pPacket->iStreamId);
-      }
-    }
-    else if (m_streams[pPacket->iStreamId]->type == STREAM_VIDEO)
-    {
-      if (((CDemuxStreamVideo*)m_streams[pPacket->iStreamId])->iWidth != m_pFormatContext->streams[pPacket->iStreamId]->codec->width ||
-          ((CDemuxStreamVideo*)m_streams[pPacket->iStreamId])->iHeight != m_pFormatContext->streams[pPacket->iStreamId]->codec->height)
-      {
-        // content has changed
-        AddStream(pPacket->iStreamId);
-      }
-    }
+    if (((CDemuxStreamAudio*)m_streams[iId])->iChannels != m_pFormatContext->streams[iId]->codec->channels ||
+        ((CDemuxStreamAudio*)m_streams[iId])->iSampleRate != m_pFormatContext->streams[iId]->codec->sample_rate)
+      return true;
   }
-  return pPacket;
+  else if (m_streams[iId]->type == STREAM_VIDEO)
+  {
+    if (((CDemuxStreamVideo*)m_streams[iId])->iWidth != m_pFormatContext->streams[iId]->codec->width ||
+        ((CDemuxStreamVideo*)m_streams[iId])->iHeight != m_pFormatContext->streams[iId]->codec->height)
+      return true;
+  }
+  return false;
 }
 
 bool CDVDDemuxFFmpeg::SeekTime(int time, bool backwords, double *startpts)
@@ -814,6 +856,10 @@ bool CDVDDemuxFFmpeg::SeekTime(int time, bool backwords, double *startpts)
   if(time < 0)
     time = 0;
 
+  m_readAheadAbort = true;
+  CSingleLock lock(m_critSection);
+  FlushReadAhead();
+
   CDVDInputStream::ISeekTime* ist = dynamic_cast<CDVDInputStream::ISeekTime*>(m_pInput);
   if (ist)
   {
@@ -842,14 +888,10 @@ bool CDVDDemuxFFmpeg::SeekTime(int time, bool backwords, double *startpts)
   if (m_pFormatContext->start_time != (int64_t)AV_NOPTS_VALUE)
     seek_pts += m_pFormatContext->start_time;
 
-  int ret;
-  {
-    CSingleLock lock(m_critSection);
-    ret = m_dllAvFormat.av_seek_frame(m_pFormatContext, -1, seek_pts, backwords ? AVSEEK_FLAG_BACKWARD : 0);
+  int ret = m_dllAvFormat.av_seek_frame(m_pFormatContext, -1, seek_pts, backwords ? AVSEEK_FLAG_BACKWARD : 0);
 
-    if(ret >= 0)
-      UpdateCurrentPTS();
-  }
+  if(ret >= 0)
+    UpdateCurrentPTS();
 
   if(m_iCurrentPts == DVD_NOPTS_VALUE)
     CLog::Log(LOGDEBUG, "%s - unknown position after seek", __FUNCTION__);
@@ -871,7 +913,10 @@ bool CDVDDemuxFFmpeg::SeekByte(int64_t pos)
 {
   g_demuxer.set(this);
 
+  m_readAheadAbort = true;
   CSingleLock lock(m_critSection);
+  FlushReadAhead();
+
   int ret = m_dllAvFormat.av_seek_frame(m_pFormatContext, -1, pos, AVSEEK_FLAG_BYTE);
 
   if(ret >= 0)
@@ -1247,6 +1292,10 @@ bool CDVDDemuxFFmpeg::SeekChapter(int chapter, double* startpts)
   if(chapter < 1)
     chapter = 1;
 
+  m_readAheadAbort = true;
+  CSingleLock lock(m_critSection);
+  FlushReadAhead();
+
   CDVDInputStream::IChapter* ich = dynamic_cast<CDVDInputStream::IChapter*>(m_pInput);
   if(ich)
   {
@@ -1325,3 +1374,179 @@ void CDVDDemuxFFmpeg::GetStreamCodecName(int iStreamId, CStdString &strName)
       strName = codec->name;
   }
 }
+
+void CDVDDemuxFFmpeg::StartReadAhead()
+{
+  m_readAheadTarget = g_advancedSettings.m_demuxReadAhead;
+  m_readAheadBytes  = 0;
+  m_readAheadHold   = false;
+  m_readAheadStop   = false;
+  m_readAheadAbort  = false;
+
+  CLog::Log(LOGDEBUG, "%s - reading %.1f seconds ahead", __FUNCTION__, m_readAheadTarget);
+  m_readAheadThread = new CThread(this, "DemuxReadAhead");
+  m_readAheadThread->Create();
+}
+
+void CDVDDemuxFFmpeg::StopReadAhead()
+{
+  if (!m_readAheadThread)
+    return;
+
+  m_readAheadAbort = true;
+  {
+    CSingleLock lock(m_readAheadSection);
+    m_readAheadStop = true;
+    m_readAheadCond.notifyAll();
+  }
+  m_readAheadThread->StopThread();
+  delete m_readAheadThread;
+  m_readAheadThread = NULL;
+
+  CSingleLock lock(m_critSection);
+  FlushReadAhead();
+}
+
+/* must be called with m_critSection held, which keeps the reader out of
+ * ffmpeg until the caller is done repositioning the stream */
+void CDVDDemuxFFmpeg::FlushReadAhead()
+{
+  m_readAheadAbort = false;
+
+  CSingleLock lock(m_readAheadSection);
+  while (!m_readAheadQueue.empty())
+  {
+    if (m_readAheadQueue.front())
+      CDVDDemuxUtils::FreeDemuxPacket(m_readAheadQueue.front());
+    m_readAheadQueue.pop_front();
+  }
+  m_readAheadBytes = 0;
+  m_readAheadFlushes++;
+  m_readAheadHold = false;
+  m_readAheadTarget = g_advancedSettings.m_demuxReadAhead;
+  m_readAheadCond.notifyAll();
+}
+
+bool CDVDDemuxFFmpeg::IsReadAheadFull()
+{
+  if (m_readAheadQueue.empty())
+    return false;
+
+  // allow twice the average bitrate to cover peaks, the limit is for streams without timestamps
+  unsigned int maxBytes = READAHEAD_MAX_BYTES;
+  if (m_pFormatContext && m_pFormatContext->bit_rate > 0)
+  {
+    double bytes = (double)m_pFormatContext->bit_rate / 8 * m_readAheadTarget * 2;
+    maxBytes = (unsigned int)std::max((double)READAHEAD_MIN_BYTES, std::min(bytes, (double)READAHEAD_MAX_BYTES));
+  }
+  if (m_readAheadBytes >= maxBytes)
+    return true;
+
+  double first = DVD_NOPTS_VALUE;
+  double last  = DVD_NOPTS_VALUE;
+  for (std::deque<DemuxPacket*>::iterator it = m_readAheadQueue.begin(); it != m_readAheadQueue.end(); ++it)
+  {
+    if (*it && (*it)->dts != DVD_NOPTS_VALUE)
+    {
+      first = (*it)->dts;
+      break;
+    }
+  }
+  for (std::deque<DemuxPacket*>::reverse_iterator it = m_readAheadQueue.rbegin(); it != m_readAheadQueue.rend(); ++it)
+  {
+    if (*it && (*it)->dts != DVD_NOPTS_VALUE)
+    {
+      last = (*it)->dts;
+      break;
+    }
+  }
+  if (first == DVD_NOPTS_VALUE || last == DVD_NOPTS_VALUE)
+    return false;
+
+  return last - first >= m_readAheadTarget * DVD_TIME_BASE;
+}
+
+void CDVDDemuxFFmpeg::Run()
+{
+  g_demuxer.set(this);
+
+  CSingleLock lock(m_readAheadSection);
+  while (!m_readAheadStop)
+  {
+    if (m_readAheadHold || IsReadAheadFull())
+    {
+      m_readAheadCond.wait(lock);
+      continue;
+    }
+    lock.Leave();
+
+    DemuxPacket* pPacket;
+    unsigned int flushes;
+    bool changed;
+    {
+      CSingleLock read(m_critSection);
+      flushes = m_readAheadFlushes;
+      pPacket = ReadPacket();
+      changed = pPacket && IsStreamChanged(pPacket->iStreamId);
+    }
+
+    lock.Enter();
+    if (flushes != m_readAheadFlushes || (pPacket && pPacket->iSize == 0))
+    {
+      // read from before a seek, or a timeout
+      if (pPacket)
+        CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+      continue;
+    }
+
+    m_readAheadQueue.push_back(pPacket);
+    if (pPacket)
+      m_readAheadBytes += pPacket->iSize;
+
+    // streams are updated by the consumer, and at eof there is nothing
+    // more to read until it has seen it, so hold until this one is taken
+    if (!pPacket || changed)
+      m_readAheadHold = true;
+
+    m_readAheadCond.notifyAll();
+  }
+}
+
+DemuxPacket* CDVDDemuxFFmpeg::ReadAhead()
+{
+  CSingleLock lock(m_readAheadSection);
+  if (m_readAheadQueue.empty())
+  {
+    if (!m_readAheadHold && m_readAheadTarget < g_advancedSettings.m_demuxReadAhead * READAHEAD_MAX_GROWTH)
+    {
+      m_readAheadTarget = std::min(m_readAheadTarget * 1.5, g_advancedSettings.m_demuxReadAhead * READAHEAD_MAX_GROWTH);
+      CLog::Log(LOGDEBUG, "%s - underrun, reading %.1f seconds ahead", __FUNCTION__, m_readAheadTarget);
+    }
+
+    // don't keep the player from handling its messages
+    m_readAheadCond.wait(lock, 100);
+    if (m_readAheadQueue.empty())
+      return CDVDDemuxUtils::AllocateDemuxPacket(0);
+  }
+
+  DemuxPacket* pPacket = m_readAheadQueue.front();
+  m_readAheadQueue.pop_front();
+  if (pPacket)
+    m_readAheadBytes -= pPacket->iSize;
+
+  if (m_readAheadHold && m_readAheadQueue.empty())
+  {
+    // the reader is waiting on us, so the streams can be updated safely
+    lock.Leave();
+    if (pPacket && IsStreamChanged(pPacket->iStreamId))
+    {
+      CSingleLock read(m_critSection);
+      AddStream(pPacket->iStreamId);
+    }
+    lock.Enter();
+    m_readAheadHold = false;
+  }
+
+  m_readAheadCond.notifyAll();
+  return pPacket;
+}
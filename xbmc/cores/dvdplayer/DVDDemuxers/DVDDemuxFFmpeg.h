@@ -25,8 +25,12 @@
 #include "DllAvCodec.h"
 #include "DllAvUtil.h"
 
+#include "threads/Condition.h"
 #include "threads/CriticalSection.h"
 #include "threads/SystemClock.h"
+#include "threads/Thread.h"
+
+#include <deque>
 
 class CDVDDemuxFFmpeg;
 
@@ -80,7 +84,7 @@ public:
 #define FFMPEG_FILE_BUFFER_SIZE   32768 // default reading size for ffmpeg
 #define FFMPEG_DVDNAV_BUFFER_SIZE 2048  // for dvd's
 
-class CDVDDemuxFFmpeg : public CDVDDemux
+class CDVDDemuxFFmpeg : public CDVDDemux, private IRunnable
 {
 public:
   CDVDDemuxFFmpeg();
@@ -119,6 +123,18 @@ protected:
 
   int ReadFrame(AVPacket *packet);
   void AddStream(int iId);
+  DemuxPacket* ReadPacket();
+  bool IsStreamChanged(int iId);
+  void FlushInternal();
+
+  /* optional read ahead, packets are read on a separate thread into a queue
+   * bounded by time and bytes so that short io stalls don't reach the player */
+  void StartReadAhead();
+  void StopReadAhead();
+  void FlushReadAhead();
+  bool IsReadAheadFull();
+  DemuxPacket* ReadAhead();
+  virtual void Run();
 
   double ConvertTimestamp(int64_t pts, int den, int num);
   void UpdateCurrentPTS();
@@ -140,6 +156,17 @@ protected:
   unsigned m_program;
   XbmcThreads::EndTime  m_timeout;
 
+  CThread*                       m_readAheadThread;
+  CCriticalSection               m_readAheadSection;
+  XbmcThreads::ConditionVariable m_readAheadCond;
+  std::deque<DemuxPacket*>       m_readAheadQueue;  // NULL marks end of stream
+  unsigned int                   m_readAheadBytes;
+  unsigned int                   m_readAheadFlushes; // bumped on every flush, drops packets read before it
+  double                         m_readAheadTarget;  // seconds to keep queued, grows on underruns
+  bool                           m_readAheadHold;    // reader waits until the last queued packet is consumed
+  bool                           m_readAheadStop;
+  volatile bool                  m_readAheadAbort;   // interrupts a read in progress
+
   CDVDInputStream* m_pInput;
 };
 
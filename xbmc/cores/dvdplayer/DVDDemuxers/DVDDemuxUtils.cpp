@@ -24,6 +24,9 @@
 #include "DVDDemuxUtils.h"
 #include "DVDClock.h"
 #include "utils/log.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include <vector>
 extern "C" {
 #if (defined USE_EXTERNAL_FFMPEG)
   #if (defined HAVE_LIBAVCODEC_AVCODEC_H)
@@ -36,13 +39,169 @@ extern "C" {
 #endif
 }
 
+/*
+  Packet buffers are recycled through a pool of power of two sized classes,
+  each buffer is prefixed with a small header recording its class so it can
+  be returned to the right free list no matter what the packet's iSize was
+  changed to. Buffers larger than the biggest class bypass the pool.
+*/
+#define DEMUX_POOL_MIN_SHIFT   8                   // smallest class, 256 bytes
+#define DEMUX_POOL_CLASSES     15                  // largest class, 4 MB
+#define DEMUX_POOL_HEADER      16                  // keeps pData 16 byte aligned
+#define DEMUX_POOL_MAX_CACHED  (8 * 1024 * 1024)   // bytes kept for reuse
+#define DEMUX_POOL_MAX_PACKETS 256                 // DemuxPacket structs kept for reuse
+
+typedef struct DemuxBufferHeader
+{
+  int          sizeClass; // -1 when not pooled
+  unsigned int size;      // usable size of the buffer
+} DemuxBufferHeader;
+
+class CDemuxPacketPool
+{
+public:
+  CDemuxPacketPool()
+  {
+    memset(&m_stats, 0, sizeof(m_stats));
+  }
+
+  ~CDemuxPacketPool()
+  {
+    Trim();
+  }
+
+  DemuxPacket* GetPacket()
+  {
+    {
+      CSingleLock lock(m_section);
+      if (!m_packets.empty())
+      {
+        DemuxPacket* pPacket = m_packets.back();
+        m_packets.pop_back();
+        return pPacket;
+      }
+    }
+    return new DemuxPacket;
+  }
+
+  void ReleasePacket(DemuxPacket* pPacket)
+  {
+    {
+      CSingleLock lock(m_section);
+      if (m_packets.size() < DEMUX_POOL_MAX_PACKETS)
+      {
+        m_packets.push_back(pPacket);
+        return;
+      }
+    }
+    delete pPacket;
+  }
+
+  BYTE* GetBuffer(unsigned int size)
+  {
+    int sizeClass = -1;
+    for (int i = 0; i < DEMUX_POOL_CLASSES; i++)
+    {
+      if (size <= ClassSize(i))
+      {
+        sizeClass = i;
+        size      = ClassSize(i);
+        break;
+      }
+    }
+
+    BYTE* block = NULL;
+    {
+      CSingleLock lock(m_section);
+      m_stats.allocations++;
+      if (sizeClass >= 0 && !m_free[sizeClass].empty())
+      {
+        block = m_free[sizeClass].back();
+        m_free[sizeClass].pop_back();
+        m_stats.bytesCached -= size;
+        m_stats.hits++;
+      }
+      m_stats.bytesInUse += size;
+      if (m_stats.bytesInUse > m_stats.bytesPeak)
+        m_stats.bytesPeak = m_stats.bytesInUse;
+    }
+
+    if (!block)
+    {
+      block = (BYTE*)_aligned_malloc(size + DEMUX_POOL_HEADER, 16);
+      if (!block)
+      {
+        CSingleLock lock(m_section);
+        m_stats.bytesInUse -= size;
+        return NULL;
+      }
+      DemuxBufferHeader* header = (DemuxBufferHeader*)block;
+      header->sizeClass = sizeClass;
+      header->size      = size;
+    }
+    return block + DEMUX_POOL_HEADER;
+  }
+
+  void ReleaseBuffer(BYTE* data)
+  {
+    BYTE* block = data - DEMUX_POOL_HEADER;
+    DemuxBufferHeader* header = (DemuxBufferHeader*)block;
+    {
+      CSingleLock lock(m_section);
+      m_stats.bytesInUse -= header->size;
+      if (header->sizeClass >= 0 && m_stats.bytesCached + header->size <= DEMUX_POOL_MAX_CACHED)
+      {
+        m_free[header->sizeClass].push_back(block);
+        m_stats.bytesCached += header->size;
+        return;
+      }
+    }
+    _aligned_free(block);
+  }
+
+  void GetStats(DemuxPacketPoolStats& stats)
+  {
+    CSingleLock lock(m_section);
+    stats = m_stats;
+  }
+
+  void Trim()
+  {
+    CSingleLock lock(m_section);
+    for (int i = 0; i < DEMUX_POOL_CLASSES; i++)
+    {
+      for (std::vector<BYTE*>::iterator it = m_free[i].begin(); it != m_free[i].end(); ++it)
+        _aligned_free(*it);
+      m_free[i].clear();
+    }
+    for (std::vector<DemuxPacket*>::iterator it = m_packets.begin(); it != m_packets.end(); ++it)
+      delete *it;
+    m_packets.clear();
+
+    unsigned int bytesInUse = m_stats.bytesInUse;
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_stats.bytesInUse = bytesInUse;
+    m_stats.bytesPeak  = bytesInUse;
+  }
+
+private:
+  static unsigned int ClassSize(int sizeClass) { return 1u << (DEMUX_POOL_MIN_SHIFT + sizeClass); }
+
+  CCriticalSection          m_section;
+  std::vector<BYTE*>        m_free[DEMUX_POOL_CLASSES];
+  std::vector<DemuxPacket*> m_packets;
+  DemuxPacketPoolStats      m_stats;
+};
+
+static CDemuxPacketPool g_demuxPacketPool;
+
 void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 {
   if (pPacket)
   {
     try {
-      if (pPacket->pData) _aligned_free(pPacket->pData);
-      delete pPacket;
+      if (pPacket->pData) g_demuxPacketPool.ReleaseBuffer(pPacket->pData);
+      g_demuxPacketPool.ReleasePacket(pPacket);
     }
     catch(...) {
       CLog::Log(LOGERROR, "%s - Exception thrown while freeing packet", __FUNCTION__);
@@ -52,7 +211,7 @@ void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 
 DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
 {
-  DemuxPacket* pPacket = new DemuxPacket;
+  DemuxPacket* pPacket = g_demuxPacketPool.GetPacket();
   if (!pPacket) return NULL;
 
   try
@@ -70,7 +229,7 @@ DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
         * Note, if the first 23 bits of the additional bytes are not 0 then damaged
         * MPEG bitstreams could cause overread and segfault
         */
-      pPacket->pData =(BYTE*)_aligned_malloc(iDataSize + FF_INPUT_BUFFER_PADDING_SIZE, 16);
+      pPacket->pData = g_demuxPacketPool.GetBuffer(iDataSize + FF_INPUT_BUFFER_PADDING_SIZE);
       if (!pPacket->pData)
       {
         FreeDemuxPacket(pPacket);
@@ -94,3 +253,13 @@ DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
   }
   return pPacket;
 }
+
+void CDVDDemuxUtils::GetPoolStats(DemuxPacketPoolStats& stats)
+{
+  g_demuxPacketPool.GetStats(stats);
+}
+
+void CDVDDemuxUtils::TrimPool()
+{
+  g_demuxPacketPool.Trim();
+}
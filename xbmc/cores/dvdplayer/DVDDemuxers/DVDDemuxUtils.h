@@ -22,10 +22,24 @@
 
 #include "DVDDemuxPacket.h"
 
+typedef struct DemuxPacketPoolStats
+{
+  unsigned int allocations; // number of AllocateDemuxPacket calls with data
+  unsigned int hits;        // allocations served from the pool
+  unsigned int bytesInUse;  // bytes currently handed out to packets
+  unsigned int bytesPeak;   // highest bytesInUse seen
+  unsigned int bytesCached; // bytes kept in the pool for reuse
+} DemuxPacketPoolStats;
+
 class CDVDDemuxUtils
 {
 public:
   static void FreeDemuxPacket(DemuxPacket* pPacket);
   static DemuxPacket* AllocateDemuxPacket(int iDataSize = 0);
+
+  /*! \brief Get the statistics of the packet pool */
+  static void GetPoolStats(DemuxPacketPoolStats& stats);
+  /*! \brief Release all cached buffers back to the system and reset the statistics */
+  static void TrimPool();
 };
 
@@ -21,7 +21,12 @@
 #include "DVDInputStreamFile.h"
 #include "filesystem/File.h"
 #include "filesystem/IFile.h"
+#include "filesystem/MappedFile.h"
+#include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
+#include "URL.h"
 #include "utils/log.h"
+#include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
 
 using namespace XFILE;
@@ -29,6 +34,7 @@ using namespace XFILE;
 CDVDInputStreamFile::CDVDInputStreamFile() : CDVDInputStream(DVDSTREAM_TYPE_FILE)
 {
   m_pFile = NULL;
+  m_pMapped = NULL;
   m_eof = true;
 }
 
@@ -39,7 +45,47 @@ CDVDInputStreamFile::~CDVDInputStreamFile()
 
 bool CDVDInputStreamFile::IsEOF()
 {
-  return !m_pFile || m_eof;
+  return !(m_pFile || m_pMapped) || m_eof;
+}
+
+/* local files of the protocols listed in advancedsettings are read through a
+ * memory mapping, anything else or a failure to map goes through CFile */
+XFILE::CMappedFile* CDVDInputStreamFile::OpenMapped(const char* strFile)
+{
+  if (g_advancedSettings.m_videoMappedProtocols.IsEmpty())
+    return NULL;
+
+  CURL url(strFile);
+  CStdString protocol = url.GetProtocol();
+  if (protocol.IsEmpty())
+    protocol = "file";
+
+  bool selected = false;
+  CStdStringArray protocols = StringUtils::SplitString(g_advancedSettings.m_videoMappedProtocols, ",");
+  for (unsigned int i = 0; i < protocols.size() && !selected; i++)
+  {
+    protocols[i].Trim();
+    selected = protocols[i].Equals(protocol, false);
+  }
+  if (!selected)
+    return NULL;
+
+  if (url.GetProtocol().Equals("special"))
+    url = CURL(CSpecialProtocol::TranslatePath(url));
+
+  // only paths on the local filesystem can be mapped
+  if (!url.GetProtocol().IsEmpty() && !url.GetProtocol().Equals("file"))
+    return NULL;
+
+  CMappedFile* file = new CMappedFile();
+  if (!file->Open(url))
+  {
+    delete file;
+    return NULL;
+  }
+
+  CLog::Log(LOGDEBUG, "CDVDInputStreamFile::OpenMapped - reading %s through a memory mapping", strFile);
+  return file;
 }
 
 bool CDVDInputStreamFile::Open(const char* strFile, const std::string& content)
@@ -47,6 +93,13 @@ bool CDVDInputStreamFile::Open(const char* strFile, const std::string& content)
   if (!CDVDInputStream::Open(strFile, content))
     return false;
 
+  m_pMapped = OpenMapped(strFile);
+  if (m_pMapped)
+  {
+    m_eof = true;
+    return true;
+  }
+
   m_pFile = new CFile();
   if (!m_pFile)
     return false;
@@ -74,17 +127,27 @@ void CDVDInputStreamFile::Close()
     m_pFile->Close();
     delete m_pFile;
   }
+  if (m_pMapped)
+  {
+    m_pMapped->Close();
+    delete m_pMapped;
+  }
 
   CDVDInputStream::Close();
   m_pFile = NULL;
+  m_pMapped = NULL;
   m_eof = true;
 }
 
 int CDVDInputStreamFile::Read(BYTE* buf, int buf_size)
 {
-  if(!m_pFile) return -1;
-
-  unsigned int ret = m_pFile->Read(buf, buf_size);
+  unsigned int ret;
+  if(m_pMapped)
+    ret = m_pMapped->Read(buf, buf_size);
+  else if(m_pFile)
+    ret = m_pFile->Read(buf, buf_size);
+  else
+    return -1;
 
   /* we currently don't support non completing reads */
   if( ret <= 0 ) m_eof = true;
@@ -94,6 +157,16 @@ int CDVDInputStreamFile::Read(BYTE* buf, int buf_size)
 
 int64_t CDVDInputStreamFile::Seek(int64_t offset, int whence)
 {
+  if(m_pMapped)
+  {
+    if(whence == SEEK_POSSIBLE)
+      return m_pMapped->IoControl(IOCTRL_SEEK_POSSIBLE, NULL);
+
+    int64_t ret = m_pMapped->Seek(offset, whence);
+    if( ret >= 0 ) m_eof = false;
+    return ret;
+  }
+
   if(!m_pFile) return -1;
 
   if(whence == SEEK_POSSIBLE)
@@ -109,6 +182,8 @@ int64_t CDVDInputStreamFile::Seek(int64_t offset, int whence)
 
 int64_t CDVDInputStreamFile::GetLength()
 {
+  if (m_pMapped)
+    return m_pMapped->GetLength();
   if (m_pFile)
     return m_pFile->GetLength();
   return 0;
@@ -143,6 +218,9 @@ int CDVDInputStreamFile::GetBlockSize()
 
 void CDVDInputStreamFile::SetReadRate(unsigned rate)
 {
+  if(!m_pFile)
+    return;
+
   unsigned maxrate = rate + 1024 * 1024 / 8;
   if(m_pFile->IoControl(IOCTRL_CACHE_SETRATE, &maxrate) >= 0)
     CLog::Log(LOGDEBUG, "CDVDInputStreamFile::SetReadRate - set cache throttle rate to %u bytes per second", maxrate);
@@ -22,6 +22,11 @@
 
 #include "DVDInputStream.h"
 
+namespace XFILE
+{
+  class CMappedFile;
+}
+
 class CDVDInputStreamFile : public CDVDInputStream
 {
 public:
@@ -40,6 +45,9 @@ public:
   virtual bool GetCacheStatus(XFILE::SCacheStatus *status);
 
 protected:
+  XFILE::CMappedFile* OpenMapped(const char* strFile);
+
   XFILE::CFile* m_pFile;
+  XFILE::CMappedFile* m_pMapped;
   bool m_eof;
 };
@@ -22,6 +22,7 @@
 #include "DVDDemuxers/DVDDemuxUtils.h"
 #include "utils/log.h"
 #include "threads/SingleLock.h"
+#include "threads/Atomics.h"
 #include "DVDClock.h"
 #include "utils/MathUtils.h"
 
@@ -31,6 +32,7 @@ CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true)
 {
   m_owner = owner;
   m_iDataSize     = 0;
+  m_iControlCount = 0;
   m_bAbortRequest = false;
   m_bInitialized  = false;
   m_bCaching      = false;
@@ -58,17 +60,35 @@ void CDVDMessageQueue::Init()
   m_TimeFront     = DVD_NOPTS_VALUE;
 }
 
+void CDVDMessageQueue::FlushList(CDVDMsg::Message type, deque<CDVDMsg*>& list)
+{
+  deque<CDVDMsg*> keep;
+  for(deque<CDVDMsg*>::iterator it = list.begin(); it != list.end(); it++)
+  {
+    if ((*it)->IsType(type) ||  type == CDVDMsg::NONE)
+      (*it)->Release();
+    else
+      keep.push_back(*it);
+  }
+  list.swap(keep);
+}
+
 void CDVDMessageQueue::Flush(CDVDMsg::Message type)
 {
+  CSingleLock consumer(m_consumer);
   CSingleLock lock(m_section);
 
-  for(SList::iterator it = m_list.begin(); it != m_list.end();)
+  for(SList::iterator it = m_control.begin(); it != m_control.end();)
   {
     if (it->message->IsType(type) ||  type == CDVDMsg::NONE)
-      it = m_list.erase(it);
+      it = m_control.erase(it);
     else
       it++;
   }
+  m_iControlCount = m_control.size();
+
+  FlushList(type, m_batch);
+  FlushList(type, m_data);
 
   if (type == CDVDMsg::DEMUXER_PACKET ||  type == CDVDMsg::NONE)
   {
@@ -90,6 +110,7 @@ void CDVDMessageQueue::Abort()
 
 void CDVDMessageQueue::End()
 {
+  CSingleLock consumer(m_consumer);
   CSingleLock lock(m_section);
 
   Flush();
@@ -116,32 +137,41 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
     return MSGQ_INVALID_MSG;
   }
 
-  SList::iterator it = m_list.begin();
-  while(it != m_list.end())
+  if (priority > 0)
   {
-    if(priority <= it->priority)
-      break;
-    it++;
-  }
-  m_list.insert(it, DVDMessageListItem(pMsg, priority));
+    SList::iterator it = m_control.begin();
+    while(it != m_control.end())
+    {
+      if(priority <= it->priority)
+        break;
+      it++;
+    }
+    m_control.insert(it, DVDMessageListItem(pMsg, priority));
+    AtomicIncrement(&m_iControlCount);
 
-  if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0)
+    pMsg->Release();
+  }
+  else
   {
-    DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
-    if(packet)
+    // the fifo takes over the reference of the caller
+    m_data.push_back(pMsg);
+
+    if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
     {
-      m_iDataSize += packet->iSize;
-      if     (packet->dts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->dts;
-      else if(packet->pts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->pts;
-      if(m_TimeBack == DVD_NOPTS_VALUE)
-        m_TimeBack = m_TimeFront;
+      DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+      if(packet)
+      {
+        AtomicAdd(&m_iDataSize, packet->iSize);
+        if     (packet->dts != DVD_NOPTS_VALUE)
+          m_TimeFront = packet->dts;
+        else if(packet->pts != DVD_NOPTS_VALUE)
+          m_TimeFront = packet->pts;
+        if(m_TimeBack == DVD_NOPTS_VALUE)
+          m_TimeBack = m_TimeFront;
+      }
     }
   }
 
-  pMsg->Release();
-
   m_hEvent.Set(); // inform waiter for new packet
 
   return MSGQ_OK;
@@ -149,7 +179,7 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
 
 MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutInMilliSeconds, int &priority)
 {
-  CSingleLock lock(m_section);
+  CSingleLock consumer(m_consumer);
 
   *pMsg = NULL;
 
@@ -161,39 +191,67 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     return MSGQ_NOT_INITIALIZED;
   }
 
-  if(m_list.empty() && m_bEmptied == false && priority == 0 && m_owner != "teletext")
+  if(m_batch.empty() && m_bEmptied == false && priority == 0 && m_owner != "teletext")
   {
+    CSingleLock lock(m_section);
+    if(m_data.empty() && m_control.empty())
+    {
 #if !defined(TARGET_RASPBERRY_PI)
-    CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Get - asked for new data packet, with nothing available", m_owner.c_str());
+      CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Get - asked for new data packet, with nothing available", m_owner.c_str());
 #endif
-    m_bEmptied = true;
+      m_bEmptied = true;
+    }
   }
 
   while (!m_bAbortRequest)
   {
-    if(!m_list.empty() && m_list.back().priority >= priority && !m_bCaching)
+    // packets left from the last fetch can be handed out without taking the
+    // producer lock, as long as no priority message is pending
+    if (!m_bCaching && (priority > 0 || m_iControlCount > 0 || m_batch.empty()))
+    {
+      CSingleLock lock(m_section);
+      if(!m_control.empty() && m_control.back().priority >= priority)
+      {
+        DVDMessageListItem& item(m_control.back());
+        priority = item.priority;
+        *pMsg = item.message->Acquire();
+        m_control.pop_back();
+        AtomicDecrement(&m_iControlCount);
+
+        ret = MSGQ_OK;
+        break;
+      }
+
+      // grab everything the producer queued so far in one go
+      if(priority <= 0 && m_batch.empty())
+        m_batch.swap(m_data);
+    }
+
+    if (priority <= 0 && !m_batch.empty() && !m_bCaching)
     {
-      DVDMessageListItem& item(m_list.back());
-      priority = item.priority;
+      CDVDMsg* msg = m_batch.front();
+      m_batch.pop_front();
+      priority = 0;
 
-      if (item.message->IsType(CDVDMsg::DEMUXER_PACKET) && item.priority == 0)
+      if (msg->IsType(CDVDMsg::DEMUXER_PACKET))
       {
-        DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)item.message)->GetPacket();
+        DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)msg)->GetPacket();
         if(packet)
         {
-          m_iDataSize -= packet->iSize;
-          if     (packet->dts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->dts;
-          else if(packet->pts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->pts;
+          AtomicSubtract(&m_iDataSize, packet->iSize);
+          // m_TimeFront and m_TimeBack are read as a pair, so both change under m_section
+          if(packet->dts != DVD_NOPTS_VALUE || packet->pts != DVD_NOPTS_VALUE)
+          {
+            CSingleLock lock(m_section);
+            m_TimeBack = packet->dts != DVD_NOPTS_VALUE ? packet->dts : packet->pts;
+          }
         }
 
         if(m_bEmptied && m_iDataSize > 0)
           m_bEmptied = false;
       }
 
-      *pMsg = item.message->Acquire();
-      m_list.pop_back();
+      *pMsg = msg;
 
       ret = MSGQ_OK;
       break;
@@ -205,14 +263,19 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     }
     else
     {
-      m_hEvent.Reset();
-      lock.Leave();
+      {
+        CSingleLock lock(m_section);
+        if(!m_bCaching && ((priority <= 0 && !m_data.empty()) || (!m_control.empty() && m_control.back().priority >= priority)))
+          continue;
+        m_hEvent.Reset();
+      }
+      consumer.Leave();
 
       // wait for a new message
       if (!m_hEvent.WaitMSec(iTimeoutInMilliSeconds))
         return MSGQ_TIMEOUT;
 
-      lock.Enter();
+      consumer.Enter();
     }
   }
 
@@ -224,17 +287,28 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
 
 unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
 {
+  CSingleLock consumer(m_consumer);
   CSingleLock lock(m_section);
 
   if (!m_bInitialized)
     return 0;
 
   unsigned count = 0;
-  for(SList::iterator it = m_list.begin(); it != m_list.end();it++)
+  for(SList::iterator it = m_control.begin(); it != m_control.end();it++)
   {
     if(it->message->IsType(type))
       count++;
   }
+  for(deque<CDVDMsg*>::iterator it = m_batch.begin(); it != m_batch.end();it++)
+  {
+    if((*it)->IsType(type))
+      count++;
+  }
+  for(deque<CDVDMsg*>::iterator it = m_data.begin(); it != m_data.end();it++)
+  {
+    if((*it)->IsType(type))
+      count++;
+  }
 
   return count;
 }
@@ -250,19 +324,22 @@ void CDVDMessageQueue::WaitUntilEmpty()
 
 int CDVDMessageQueue::GetLevel() const
 {
-  if(m_iDataSize > m_iMaxDataSize)
+  int iDataSize = GetDataSize();
+  if(iDataSize > m_iMaxDataSize)
     return 100;
-  if(m_iDataSize == 0)
+  if(iDataSize == 0)
     return 0;
 
+  CSingleLock lock(m_section);
   if(IsDataBased())
-    return min(100, 100 * m_iDataSize / m_iMaxDataSize);
+    return min(100, 100 * iDataSize / m_iMaxDataSize);
 
   return min(100, MathUtils::round_int(100.0 * m_TimeSize * (m_TimeFront - m_TimeBack) / DVD_TIME_BASE ));
 }
 
 int CDVDMessageQueue::GetTimeSize() const
 {
+  CSingleLock lock(m_section);
   if(IsDataBased())
     return 0;
   else
@@ -271,6 +348,7 @@ int CDVDMessageQueue::GetTimeSize() const
 
 bool CDVDMessageQueue::IsDataBased() const
 {
+  CSingleLock lock(m_section);
   return (m_TimeBack == DVD_NOPTS_VALUE  ||
           m_TimeFront == DVD_NOPTS_VALUE ||
           m_TimeFront <= m_TimeBack);
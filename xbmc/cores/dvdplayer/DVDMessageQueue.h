@@ -23,6 +23,7 @@
 #include "DVDMessage.h"
 #include <string>
 #include <list>
+#include <deque>
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
 
@@ -105,7 +106,7 @@ public:
     return Get(pMsg, iTimeoutInMilliSeconds, priority);
   }
 
-  int GetDataSize() const               { return m_iDataSize; }
+  int GetDataSize() const               { return (int)m_iDataSize; }
   int GetTimeSize() const;
   unsigned GetPacketCount(CDVDMsg::Message type);
   bool ReceivedAbortRequest()           { return m_bAbortRequest; }
@@ -124,14 +125,18 @@ public:
 
 private:
 
+  void FlushList(CDVDMsg::Message type, std::deque<CDVDMsg*>& list);
+
   CEvent m_hEvent;
-  mutable CCriticalSection m_section;
+  mutable CCriticalSection m_section;  // protects the producer side, m_control, m_data and the times
+  CCriticalSection m_consumer;         // protects m_batch, taken before m_section
 
   bool m_bAbortRequest;
   bool m_bInitialized;
   bool m_bCaching;
 
-  int m_iDataSize;
+  volatile long m_iDataSize;           // changed under either lock, so updated atomically
+  volatile long m_iControlCount;       // size of m_control, read without lock by Get
   double m_TimeFront;
   double m_TimeBack;
   double m_TimeSize;
@@ -140,7 +145,15 @@ private:
   bool m_bEmptied;
   std::string m_owner;
 
+  /*
+    priority messages go to a small list sorted on priority, everything else
+    (priority 0, mostly demuxer packets) to a fifo. Get moves the whole fifo
+    to the consumer owned m_batch at once and then serves from it without
+    touching the producer lock until it runs dry or a priority message arrives
+  */
   typedef std::list<DVDMessageListItem> SList;
-  SList m_list;
+  SList m_control;
+  std::deque<CDVDMsg*> m_data;
+  std::deque<CDVDMsg*> m_batch;
 };
 
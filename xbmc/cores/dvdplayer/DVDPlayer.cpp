@@ -1958,6 +1958,13 @@ void CDVDPlayer::OnExit()
     }
     m_pInputStream = NULL;
 
+    // return the cached packet buffers now that nothing is demuxing
+    DemuxPacketPoolStats stats;
+    CDVDDemuxUtils::GetPoolStats(stats);
+    CLog::Log(LOGDEBUG, "CDVDPlayer::OnExit() packet pool - allocations:%u hits:%u peak:%u bytes in use:%u cached:%u",
+              stats.allocations, stats.hits, stats.bytesPeak, stats.bytesInUse, stats.bytesCached);
+    CDVDDemuxUtils::TrimPool();
+
     // clean up all selection streams
     m_SelectionStreams.Clear(STREAM_NONE, STREAM_SOURCE_NONE);
 
@@ -602,6 +602,8 @@ void CDVDPlayerVideo::Process()
 
           // try to retrieve the picture (should never fail!), unless there is a demuxer bug ofcours
           m_pVideoCodec->ClearPicture(&picture);
+          // codecs that don't hand out buffers leave this alone, never keep one of a previous codec
+          picture.buffer = NULL;
           if (m_pVideoCodec->GetPicture(&picture))
           {
             sPostProcessType.clear();
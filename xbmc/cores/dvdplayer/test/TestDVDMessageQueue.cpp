@@ -0,0 +1,171 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDMessageQueue.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "cores/dvdplayer/DVDClock.h"
+#include "threads/test/TestHelpers.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+#include <iostream>
+
+#define TEST_PACKETS      200000
+#define TEST_PACKET_SIZE  64
+
+static CDVDMsg* CreatePacket(int size, double pts)
+{
+  DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(size);
+  packet->iSize = size;
+  packet->pts   = pts;
+  return new CDVDMsgDemuxerPacket(packet);
+}
+
+class QueueProducer : public IRunnable
+{
+public:
+  CDVDMessageQueue &queue;
+
+  QueueProducer(CDVDMessageQueue &q) : queue(q) {}
+
+  void Run()
+  {
+    for (int i = 0; i < TEST_PACKETS; ++i)
+    {
+      queue.Put(CreatePacket(TEST_PACKET_SIZE, i * DVD_MSEC_TO_TIME(10)));
+      if (i % 1000 == 0)
+        queue.Put(new CDVDMsgInt(CDVDMsg::PLAYER_SETSPEED, i), 1);
+    }
+  }
+};
+
+TEST(TestDVDMessageQueue, Order)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  queue.Put(CreatePacket(100, DVD_NOPTS_VALUE));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC));
+  queue.Put(CreatePacket(200, DVD_NOPTS_VALUE));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_FLUSH), 1);
+  queue.Put(new CDVDMsg(CDVDMsg::PLAYER_SETSPEED), 2);
+
+  EXPECT_EQ(300, queue.GetDataSize());
+  EXPECT_EQ((unsigned)2, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  /* priority messages first, highest priority first */
+  CDVDMsg* msg;
+  int priority = 0;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0, priority));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::PLAYER_SETSPEED));
+  EXPECT_EQ(2, priority);
+  msg->Release();
+
+  /* asking for priority messages only must not return data */
+  priority = 1;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0, priority));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_FLUSH));
+  msg->Release();
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0, priority));
+
+  /* the rest in the order it was queued */
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::DEMUXER_PACKET));
+  msg->Release();
+  EXPECT_EQ(200, queue.GetDataSize());
+
+  /* a priority message queued while a batch is in progress jumps ahead */
+  queue.Put(new CDVDMsg(CDVDMsg::PLAYER_SETSPEED), 1);
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::PLAYER_SETSPEED));
+  msg->Release();
+
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_RESYNC));
+  msg->Release();
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::DEMUXER_PACKET));
+  msg->Release();
+
+  EXPECT_EQ(0, queue.GetDataSize());
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0));
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Flush)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  CDVDMsg* msg;
+  queue.Put(CreatePacket(100, DVD_NOPTS_VALUE));
+  queue.Put(CreatePacket(100, DVD_NOPTS_VALUE));
+  /* move the packets to the consumer side */
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  msg->Release();
+  queue.Put(CreatePacket(100, DVD_NOPTS_VALUE));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC));
+
+  queue.Flush();
+  EXPECT_EQ(0, queue.GetDataSize());
+  EXPECT_EQ((unsigned)0, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_RESYNC));
+  msg->Release();
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Stress)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  QueueProducer producer(queue);
+  int64_t start = CurrentHostCounter();
+  thread producerThread(producer);
+
+  /* packets must arrive complete and in order */
+  int packets = 0, messages = 0;
+  double last = -1.0;
+  while (packets < TEST_PACKETS)
+  {
+    CDVDMsg* msg;
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 5000));
+    if (msg->IsType(CDVDMsg::DEMUXER_PACKET))
+    {
+      double pts = ((CDVDMsgDemuxerPacket*)msg)->GetPacket()->pts;
+      EXPECT_LT(last, pts);
+      last = pts;
+      packets++;
+    }
+    messages++;
+    msg->Release();
+  }
+  int64_t end = CurrentHostCounter();
+
+  EXPECT_TRUE(producerThread.timed_join(MILLIS(10000)));
+  EXPECT_EQ(TEST_PACKETS + TEST_PACKETS / 1000, messages);
+  EXPECT_EQ(0, queue.GetDataSize());
+
+  double seconds = (double)(end - start) / CurrentHostFrequency();
+  std::cout << "CDVDMessageQueue: " << (int)(messages / seconds) << " messages/sec" << std::endl;
+  queue.End();
+}
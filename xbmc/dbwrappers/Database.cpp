@@ -25,8 +25,10 @@
 #include "filesystem/SpecialProtocol.h"
 #include "filesystem/File.h"
 #include "utils/AutoPtrHandle.h"
+#include "threads/SystemClock.h"
 #include "utils/log.h"
 #include "utils/SortUtils.h"
+#include "utils/Variant.h"
 #include "utils/URIUtils.h"
 #include "sqlitedataset.h"
 #include "DatabaseManager.h"
@@ -36,11 +38,18 @@
 #include "mysqldataset.h"
 #endif
 
+#include <algorithm>
+
 using namespace AUTOPTR;
 using namespace dbiplus;
 
 #define MAX_COMPRESS_COUNT 20
 
+// limits for a single multi-row statement - sqlite allows at most 500 terms
+// in a compound select, mysql rejects statements larger than max_allowed_packet
+#define BATCH_MAX_ROWS 400
+#define BATCH_MAX_SIZE 256 * 1024
+
 void CDatabase::Filter::AppendField(const std::string &strField)
 {
   if (strField.empty())
@@ -105,6 +114,10 @@ CDatabase::CDatabase(void)
   m_openCount = 0;
   m_sqlite = true;
   m_bMultiWrite = false;
+  m_batchDepth = 0;
+  m_batchMaxItems = 0;
+  m_batchMaxTime = 0;
+  ResetBatch();
 }
 
 CDatabase::~CDatabase(void)
@@ -232,6 +245,8 @@ bool CDatabase::ExecuteQuery(const CStdString &strQuery)
   {
     if (NULL == m_pDB.get()) return bReturn;
     if (NULL == m_pDS.get()) return bReturn;
+    if (m_batchPending)
+      FlushBatch();
     m_pDS->exec(strQuery.c_str());
     bReturn = true;
   }
@@ -252,6 +267,8 @@ bool CDatabase::ResultQuery(const CStdString &strQuery)
   {
     if (NULL == m_pDB.get()) return bReturn;
     if (NULL == m_pDS.get()) return bReturn;
+    if (m_batchPending)
+      FlushBatch();
 
     CStdString strPreparedQuery = PrepareSQL(strQuery.c_str());
 
@@ -308,6 +325,210 @@ bool CDatabase::CommitInsertQueries()
   return bReturn;
 }
 
+void CDatabase::BeginBatch(unsigned int maxItems /* = 100 */, unsigned int maxTime /* = 2000 */)
+{
+  if (NULL == m_pDB.get())
+    return;
+
+  if (InBatch())
+  { // nested, the outermost batch decides when to commit. The rows of earlier
+    // items are written first so a rollback to the savepoint only loses this one
+    FlushBatch();
+    ExecSavepoint("savepoint", ++m_batchDepth);
+    return;
+  }
+
+  BeginTransaction();
+  ResetBatch();
+  m_batchDepth = 1;
+  m_batchMaxItems = std::max(maxItems, 1U);
+  m_batchMaxTime = maxTime;
+}
+
+bool CDatabase::QueueBatchRow(const std::string &strStatement, const std::string &strValues)
+{
+  if (!InBatch())
+    return ExecuteQuery(strStatement + " values (" + strValues + ")");
+
+  BatchStatement &statement = m_batch[strStatement];
+  statement.rows.push_back(strValues);
+  statement.size += strValues.size() + 20;
+  m_batchPending++;
+
+  if (statement.rows.size() >= BATCH_MAX_ROWS || statement.size >= BATCH_MAX_SIZE)
+    return WriteBatchStatement(strStatement, statement);
+  return true;
+}
+
+bool CDatabase::WriteBatchStatement(const std::string &strStatement, BatchStatement &statement)
+{
+  if (statement.rows.empty())
+    return true;
+
+  // multi-row VALUES needs sqlite 3.7.11, a compound select works with any version
+  std::string sql(strStatement);
+  sql.reserve(strStatement.size() + statement.size + 2);
+  for (std::vector<std::string>::const_iterator i = statement.rows.begin(); i != statement.rows.end(); ++i)
+  {
+    if (m_sqlite)
+      sql += i == statement.rows.begin() ? " select " : " union all select ";
+    else
+      sql += i == statement.rows.begin() ? " values (" : "),(";
+    sql += *i;
+  }
+  if (!m_sqlite)
+    sql += ")";
+
+  m_batchPending -= statement.rows.size();
+  m_batchRows += statement.rows.size();
+  m_batchStatements++;
+  statement.rows.clear();
+  statement.size = 0;
+
+  try
+  {
+    m_pDS->exec(sql.c_str());
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to execute query '%s'", __FUNCTION__, sql.c_str());
+    return false;
+  }
+  return true;
+}
+
+void CDatabase::BatchItemDone(unsigned int count /* = 1 */)
+{
+  if (!InBatch())
+    return;
+
+  m_batchItems += count;
+  if (m_batchDepth == 1 && BatchDue())
+    CommitBatch();
+}
+
+bool CDatabase::BatchDue() const
+{
+  return m_batchItems >= m_batchMaxItems ||
+         XbmcThreads::SystemClockMillis() - m_batchStart >= m_batchMaxTime;
+}
+
+bool CDatabase::ExecSavepoint(const char *strCommand, unsigned int depth)
+{
+  CStdString sql = PrepareSQL("%s batch%u", strCommand, depth);
+  try
+  {
+    m_pDS->exec(sql.c_str());
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to execute query '%s'", __FUNCTION__, sql.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool CDatabase::FlushBatch()
+{
+  bool bReturn = true;
+  for (BatchStatements::iterator i = m_batch.begin(); m_batchPending && i != m_batch.end(); ++i)
+  {
+    if (!WriteBatchStatement(i->first, i->second))
+      bReturn = false;
+  }
+  return bReturn;
+}
+
+bool CDatabase::CommitBatch()
+{
+  if (!InBatch())
+    return true;
+
+  bool bReturn = FlushBatch();
+  if (m_batchDepth > 1)
+    return bReturn; // a commit would end the savepoints of the nested batches
+
+  try
+  {
+    m_pDB->commit_transaction();
+    m_pDB->start_transaction();
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - commit failed", __FUNCTION__);
+    bReturn = false;
+  }
+  m_batchItems = 0;
+  m_batchStart = XbmcThreads::SystemClockMillis();
+  m_batchCommits++;
+  return bReturn;
+}
+
+bool CDatabase::EndBatch()
+{
+  if (!InBatch())
+    return true;
+
+  bool bReturn = FlushBatch();
+  if (m_batchDepth > 1)
+  {
+    bReturn = ExecSavepoint("release savepoint", m_batchDepth--) && bReturn;
+    if (m_batchDepth == 1 && BatchDue())
+      CommitBatch();
+    return bReturn;
+  }
+
+  CLog::Log(LOGDEBUG, "%s - wrote %u rows in %u statements and %u transactions",
+            __FUNCTION__, m_batchRows, m_batchStatements, m_batchCommits + 1);
+  if (m_batchDiscarded)
+  {
+    CLog::Log(LOGWARNING, "%s - %u batched items were rolled back", __FUNCTION__, m_batchDiscarded);
+    bReturn = false;
+  }
+
+  // batch mode is left now, so derived classes see a real commit
+  m_batchDepth = 0;
+  ResetBatch();
+  return CommitTransaction() && bReturn;
+}
+
+unsigned int CDatabase::AbortBatch()
+{
+  if (!InBatch())
+    return 0;
+
+  // queued rows were flushed when the savepoint was set, so the rest belong to this batch
+  m_batch.clear();
+  m_batchPending = 0;
+
+  if (m_batchDepth > 1)
+  {
+    ExecSavepoint("rollback to savepoint", m_batchDepth);
+    ExecSavepoint("release savepoint", m_batchDepth--);
+    return 0;
+  }
+
+  unsigned int discarded = m_batchItems + m_batchDiscarded;
+  if (discarded)
+    CLog::Log(LOGWARNING, "%s - rolled back %u batched items", __FUNCTION__, discarded);
+  m_batchDepth = 0;
+  ResetBatch();
+  RollbackTransaction();
+  return discarded;
+}
+
+void CDatabase::ResetBatch()
+{
+  m_batch.clear();
+  m_batchPending = 0;
+  m_batchItems = 0;
+  m_batchStart = XbmcThreads::SystemClockMillis();
+  m_batchRows = 0;
+  m_batchStatements = 0;
+  m_batchCommits = 0;
+  m_batchDiscarded = 0;
+}
+
 bool CDatabase::Open()
 {
   DatabaseSettings db_fallback;
@@ -577,6 +798,11 @@ void CDatabase::Close()
   m_openCount = 0;
 
   if (NULL == m_pDB.get() ) return ;
+  if (InBatch())
+  { // commit whatever is left, however deep it was nested
+    m_batchDepth = 1;
+    EndBatch();
+  }
   if (NULL != m_pDS.get()) m_pDS->close();
   m_pDB->disconnect();
   m_pDB.reset();
@@ -627,6 +853,9 @@ void CDatabase::Interupt()
 
 void CDatabase::BeginTransaction()
 {
+  if (InBatch())
+    return; // the batch already holds a transaction
+
   try
   {
     if (NULL != m_pDB.get())
@@ -640,6 +869,9 @@ void CDatabase::BeginTransaction()
 
 bool CDatabase::CommitTransaction()
 {
+  if (InBatch())
+    return true; // committed along with the batch
+
   try
   {
     if (NULL != m_pDB.get())
@@ -657,6 +889,28 @@ void CDatabase::RollbackTransaction()
 {
   try
   {
+    if (InBatch())
+    { // only the writes since the innermost savepoint belong to the failed transaction
+      m_batch.clear();
+      m_batchPending = 0;
+      if (m_batchDepth > 1)
+      {
+        ExecSavepoint("rollback to savepoint", m_batchDepth);
+        return;
+      }
+
+      // no savepoint, the items done since the last commit go with it. EndBatch() reports them
+      CLog::Log(LOGWARNING, "database:rollback discarded %u batched items", m_batchItems);
+      m_batchDiscarded += m_batchItems;
+      m_batchItems = 0;
+      if (NULL != m_pDB.get())
+      {
+        m_pDB->rollback_transaction();
+        m_pDB->start_transaction();
+      }
+      return;
+    }
+
     if (NULL != m_pDB.get())
       m_pDB->rollback_transaction();
   }
@@ -668,7 +922,7 @@ void CDatabase::RollbackTransaction()
 
 bool CDatabase::InTransaction()
 {
-  if (NULL != m_pDB.get()) return false;
+  if (NULL == m_pDB.get()) return false;
   return m_pDB->in_transaction();
 }
 
@@ -708,6 +962,49 @@ bool CDatabase::BuildSQL(const CStdString &strQuery, const Filter &filter, CStdS
   return true;
 }
 
+bool CDatabase::BuildSortedPageSQL(const CStdString &view, MediaType mediaType, const SortDescription &sortDescription, CStdString &strSQLExtra, int &total)
+{
+  FieldList fields;
+  if (!DatabaseUtils::GetSelectFields(SortUtils::GetFieldsForSorting(sortDescription.sortBy), mediaType, fields))
+    return false;
+
+  try
+  {
+    CStdString strSQL = "SELECT " + DatabaseUtils::BuildSelectFields(fields, mediaType) + " FROM " + view + " " + strSQLExtra;
+    if (!m_pDS->query(strSQL.c_str()))
+      return false;
+
+    DatabaseResults results;
+    bool success = DatabaseUtils::GetDatabaseResults(mediaType, fields, m_pDS, results, true);
+    m_pDS->close();
+    if (!success)
+      return false;
+
+    total = results.size();
+    SortUtils::Sort(sortDescription, results);
+
+    // select the rows of the page by id and keep them in the sorted order
+    CStdString id = DatabaseUtils::GetField(FieldId, mediaType, DatabaseQueryPartSelect);
+    CStdString ids, order;
+    for (unsigned int i = 0; i < results.size(); i++)
+    {
+      int idItem = (int)results[i].at(FieldId).asInteger();
+      ids.AppendFormat(i > 0 ? ",%i" : "%i", idItem);
+      order.AppendFormat(" WHEN %i THEN %u", idItem, i);
+    }
+    if (results.empty())
+      strSQLExtra = " WHERE 1 = 0";
+    else
+      strSQLExtra = " WHERE " + id + " IN (" + ids + ") ORDER BY CASE " + id + order + " END";
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed for %s", __FUNCTION__, view.c_str());
+  }
+  return false;
+}
+
 bool CDatabase::BuildSQL(const CStdString &strBaseDir, const CStdString &strQuery, Filter &filter, CStdString &strSQL, CDbUrl &dbUrl)
 {
   SortDescription sorting;
@@ -21,13 +21,16 @@
  */
 
 #include "utils/StdString.h"
+#include "utils/DatabaseUtils.h"
 
 namespace dbiplus {
   class Database;
   class Dataset;
 }
 
+#include <map>
 #include <memory>
+#include <vector>
 
 class DatabaseSettings; // forward
 class CDbUrl;
@@ -136,6 +139,65 @@ public:
    */
   bool CommitInsertQueries();
 
+  /*!
+   * @brief Start batching writes.
+   * @remarks Opens a transaction that is committed and reopened once maxItems items
+   * have been marked done with BatchItemDone() or maxTime milliseconds have passed.
+   * Rows queued with QueueBatchRow() are written as multi-row statements. Batches
+   * nest, and Begin/CommitTransaction() calls are folded into the outermost one.
+   * A nested batch is a savepoint, so aborting it only rolls back its own writes.
+   * @param maxItems The number of items to write per transaction.
+   * @param maxTime The number of milliseconds after which the transaction is committed.
+   */
+  void BeginBatch(unsigned int maxItems = 100, unsigned int maxTime = 2000);
+
+  /*!
+   * @brief Queue a row for an INSERT, INSERT OR IGNORE or REPLACE statement.
+   * @remarks Outside of a batch the row is written immediately. Queued rows are only
+   * written on FlushBatch() or any ExecuteQuery()/ResultQuery(), so flush before
+   * reading them back through m_pDS.
+   * @param strStatement The statement up to the values, e.g. "replace into song_genre (idGenre, idSong, iOrder)".
+   * @param strValues The PrepareSQL'ed values of the row without parentheses, e.g. "1,2,0".
+   * @return True if the row was queued or written successfully, false otherwise.
+   */
+  bool QueueBatchRow(const std::string &strStatement, const std::string &strValues);
+
+  /*!
+   * @brief Mark items as done, committing the batch if it is full or has been open for too long.
+   * @remarks Inside a nested batch the commit waits until the nested batches have ended.
+   * @param count The number of items done.
+   */
+  void BatchItemDone(unsigned int count = 1);
+
+  /*!
+   * @brief Write all queued rows. The transaction is kept open.
+   * @return True if all rows were written successfully, false otherwise.
+   */
+  bool FlushBatch();
+
+  /*!
+   * @brief Write all queued rows and commit, keeping the batch open.
+   * @return True if the batch was committed successfully, false otherwise.
+   */
+  bool CommitBatch();
+
+  /*!
+   * @brief Write all queued rows and end the batch. The outermost batch commits and stops batching.
+   * @return True if the batch was committed successfully and no items done in it were rolled back
+   * by RollbackTransaction(), false otherwise.
+   */
+  bool EndBatch();
+
+  /*!
+   * @brief Discard the writes of this batch and end it.
+   * @remarks A nested batch rolls back to its savepoint, the outer batch carries on with all
+   * earlier writes. The outermost batch rolls back everything since the last commit.
+   * @return The number of items marked done with BatchItemDone() that were rolled back.
+   */
+  unsigned int AbortBatch();
+
+  bool InBatch() const { return m_batchDepth > 0; };
+
   virtual bool GetFilter(CDbUrl &dbUrl, Filter &filter, SortDescription &sorting) { return true; }
   virtual bool BuildSQL(const CStdString &strBaseDir, const CStdString &strQuery, Filter &filter, CStdString &strSQL, CDbUrl &dbUrl);
   virtual bool BuildSQL(const CStdString &strBaseDir, const CStdString &strQuery, Filter &filter, CStdString &strSQL, CDbUrl &dbUrl, SortDescription &sorting);
@@ -159,6 +221,14 @@ protected:
   bool UpdateVersion(const CStdString &dbName);
 
   bool BuildSQL(const CStdString &strQuery, const Filter &filter, CStdString &strSQL);
+  /*! \brief Sorts the items of a query on just the fields SortUtils needs and replaces the query
+   by one for the full rows of the requested page, in sorted order.
+   \param view the view the items are selected from
+   \param strSQLExtra the joins and conditions following the view, replaced by the ones of the page
+   \param total set to the number of items matching the original conditions
+   \return false if the items couldn't be sorted
+   */
+  bool BuildSortedPageSQL(const CStdString &view, MediaType mediaType, const SortDescription &sortDescription, CStdString &strSQLExtra, int &total);
 
   bool m_sqlite; ///< \brief whether we use sqlite (defaults to true)
 
@@ -171,6 +241,31 @@ private:
   bool Connect(const CStdString &dbName, const DatabaseSettings &db, bool create);
   bool UpdateVersionNumber();
 
+  struct BatchStatement
+  {
+    BatchStatement() : size(0) {};
+    std::vector<std::string> rows;
+    size_t size;
+  };
+  typedef std::map<std::string, BatchStatement> BatchStatements;
+
+  bool WriteBatchStatement(const std::string &strStatement, BatchStatement &statement);
+  void ResetBatch();
+  bool BatchDue() const;
+  bool ExecSavepoint(const char *strCommand, unsigned int depth);
+
   bool m_bMultiWrite; /*!< True if there are any queries in the queue, false otherwise */
   unsigned int m_openCount;
+
+  BatchStatements m_batch;          ///< \brief queued rows, keyed by the statement they are written with
+  unsigned int m_batchPending;      ///< \brief number of queued rows
+  unsigned int m_batchDepth;        ///< \brief number of nested batches, 0 when not batching
+  unsigned int m_batchMaxItems;     ///< \brief items per transaction
+  unsigned int m_batchMaxTime;      ///< \brief milliseconds per transaction
+  unsigned int m_batchItems;        ///< \brief items done since the last commit
+  unsigned int m_batchStart;        ///< \brief time of the last commit
+  unsigned int m_batchRows;         ///< \brief rows written during this batch
+  unsigned int m_batchStatements;   ///< \brief statements written during this batch
+  unsigned int m_batchCommits;      ///< \brief commits during this batch
+  unsigned int m_batchDiscarded;    ///< \brief done items rolled back during this batch
 };
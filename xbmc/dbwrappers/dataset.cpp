@@ -84,6 +84,7 @@ Dataset::Dataset() {
   frecno = 0;
   fbof = feof = true;
   autocommit = true;
+  forward_only = false;
 
   select_sql = "";
 
@@ -101,6 +102,7 @@ Dataset::Dataset(Database *newDb) {
   frecno = 0;
   fbof = feof = true;
   autocommit = true;
+  forward_only = false;
 
   select_sql = "";
 
@@ -198,6 +200,7 @@ void Dataset::close(void) {
   frecno = 0;
   fbof = feof = true;
   active = false;
+  forward_only = false;
 }
 
 
@@ -390,6 +393,29 @@ int Dataset::str_compare(const char * s1, const char * s2) {
  }
 
 
+bool Dataset::query(const std::string &sql, const sql_record &params) {
+  // no compiled statements here, so put the parameters into the text
+  std::string text;
+  unsigned int param = 0;
+  for (std::string::const_iterator i = sql.begin(); i != sql.end(); ++i) {
+    if (*i != '?' || param >= params.size()) {
+      text += *i;
+      continue;
+    }
+    const field_value &value = params[param++];
+    if (value.get_isNull())
+      text += "NULL";
+    else if (value.get_fType() == ft_String || value.get_fType() == ft_Char)
+      text += db->prepare("'%s'", value.get_asString().c_str());
+    else if (value.get_fType() == ft_Boolean)
+      text += value.get_asBool() ? "1" : "0";
+    else
+      text += value.get_asString();
+  }
+  return query(text.c_str());
+}
+
+
 void Dataset::setParamList(const ParamList &params){
   plist = params;
 }
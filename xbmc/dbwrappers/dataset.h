@@ -199,6 +199,7 @@ protected:
   ParamList plist;              // Paramlist for locate
   bool fbof, feof;
   bool autocommit;		// for transactions
+  bool forward_only;		// rows are read on demand by next()
 
 
 /* Variables to store SQL statements */
@@ -296,6 +297,19 @@ public:
   virtual const void* getExecRes()=0;
 /* as open, but with our query exept Sql */
   virtual bool query(const char *sql) = 0;
+/* as query, but with each '?' in sql replaced by the next of params. Where the
+   database supports it the compiled statement is kept for the next call, so
+   keep the sql text constant and pass anything that varies as a parameter */
+  virtual bool query(const std::string &sql, const sql_record &params);
+/* as query, but forward-only: rows are read from the server as next() is
+   called and only the current one is kept in memory. num_rows() counts the
+   rows read so far and the dataset can't be moved backwards. Keep the loop
+   free of other queries on the same connection until close(), MySQL can't
+   run them while a result is still being read. The default reads everything
+   up front like query() */
+  virtual bool query_forward(const char *sql) { return query(sql); }
+/* true while the dataset was opened by query_forward() */
+  bool is_forward_only() const { return forward_only; }
 /* Close SQL Query*/
   virtual void close();
 /* This function looks for field Field_name with value equal Field_value
@@ -1200,6 +1200,8 @@ MysqlDataset::MysqlDataset():Dataset() {
   db = NULL;
   errmsg = NULL;
   autorefresh = false;
+  forward_res = NULL;
+  forward_rows = 0;
 }
 
 
@@ -1208,9 +1210,12 @@ MysqlDataset::MysqlDataset(MysqlDatabase *newDb):Dataset(newDb) {
   db = newDb;
   errmsg = NULL;
   autorefresh = false;
+  forward_res = NULL;
+  forward_rows = 0;
 }
 
 MysqlDataset::~MysqlDataset() {
+   if (forward_res) mysql_free_result(forward_res);
    if (errmsg) free(errmsg);
  }
 
@@ -1408,70 +1413,14 @@ bool MysqlDataset::query(const char *query) {
   MYSQL* conn = handle();
   stmt = mysql_store_result(conn);
 
-  // column headers
-  const unsigned int numColumns = mysql_num_fields(stmt);
-  MYSQL_FIELD *fields = mysql_fetch_fields(stmt);
-  MYSQL_ROW row;
-  result.record_header.resize(numColumns);
-  for (unsigned int i = 0; i < numColumns; i++)
-    result.record_header[i].name = fields[i].name;
+  fetch_header(stmt);
 
   // returned rows
+  MYSQL_ROW row;
   while ((row = mysql_fetch_row(stmt)))
   { // have a row of data
     sql_record *res = new sql_record;
-    res->resize(numColumns);
-    for (unsigned int i = 0; i < numColumns; i++)
-    {
-      field_value &v = res->at(i);
-      switch (fields[i].type)
-      {
-        case MYSQL_TYPE_LONGLONG:
-        case MYSQL_TYPE_DECIMAL:
-        case MYSQL_TYPE_NEWDECIMAL:
-        case MYSQL_TYPE_TINY:
-        case MYSQL_TYPE_SHORT:
-        case MYSQL_TYPE_INT24:
-        case MYSQL_TYPE_LONG:
-          if (row[i] != NULL)
-          {
-            v.set_asInt(atoi(row[i]));
-          }
-          else
-          {
-            v.set_asInt(0);
-          }
-          break;
-        case MYSQL_TYPE_FLOAT:
-        case MYSQL_TYPE_DOUBLE:
-          if (row[i] != NULL)
-          {
-            v.set_asDouble(atof(row[i]));
-          }
-          else
-          {
-            v.set_asDouble(0);
-          }
-          break;
-        case MYSQL_TYPE_STRING:
-        case MYSQL_TYPE_VAR_STRING:
-        case MYSQL_TYPE_VARCHAR:
-          if (row[i] != NULL) v.set_asString((const char *)row[i] );
-          break;
-        case MYSQL_TYPE_TINY_BLOB:
-        case MYSQL_TYPE_MEDIUM_BLOB:
-        case MYSQL_TYPE_LONG_BLOB:
-        case MYSQL_TYPE_BLOB:
-          if (row[i] != NULL) v.set_asString((const char *)row[i]);
-          break;
-        case MYSQL_TYPE_NULL:
-        default:
-          CLog::Log(LOGDEBUG,"MYSQL: Unknown field type: %u", fields[i].type);
-          v.set_asString("");
-          v.set_isNull();
-          break;
-      }
-    }
+    fetch_row(stmt, row, *res);
     result.records.push_back(res);
   }
   mysql_free_result(stmt);
@@ -1481,6 +1430,124 @@ bool MysqlDataset::query(const char *query) {
   return true;
 }
 
+bool MysqlDataset::query_forward(const char *query) {
+  if(!handle()) throw DbErrors("No Database Connection");
+  std::string qry = query;
+  int fs = qry.find("select");
+  int fS = qry.find("SELECT");
+  if (!( fs >= 0 || fS >=0))
+    throw DbErrors("MUST be select SQL!");
+
+  close();
+
+  if ( static_cast<MysqlDatabase*>(db)->setErr(static_cast<MysqlDatabase*>(db)->query_with_reconnect(query), query) != MYSQL_OK )
+    throw DbErrors(db->getErrorMsg());
+
+  // rows stay on the server until we fetch them
+  forward_res = mysql_use_result(handle());
+  if (!forward_res)
+    throw DbErrors(mysql_error(handle()));
+
+  fetch_header(forward_res);
+  // the single row every fetch is read into
+  result.records.push_back(new sql_record(result.record_header.size()));
+
+  forward_only = true;
+  active = true;
+  ds_state = dsSelect;
+  frecno = 0;
+  fbof = feof = !fetch_forward();
+  fill_fields();
+  return true;
+}
+
+bool MysqlDataset::fetch_forward() {
+  if (!forward_res)
+    return false;
+
+  MYSQL_ROW row = mysql_fetch_row(forward_res);
+  if (row)
+  {
+    fetch_row(forward_res, row, *result.records[0]);
+    forward_rows++;
+    return true;
+  }
+
+  // done (or failed) - free now so the connection can run other queries
+  const unsigned int err = mysql_errno(handle());
+  mysql_free_result(forward_res);
+  forward_res = NULL;
+  if (err)
+    throw DbErrors(mysql_error(handle()));
+  return false;
+}
+
+void MysqlDataset::fetch_header(MYSQL_RES *stmt) {
+  const unsigned int numColumns = mysql_num_fields(stmt);
+  MYSQL_FIELD *fields = mysql_fetch_fields(stmt);
+  result.record_header.resize(numColumns);
+  for (unsigned int i = 0; i < numColumns; i++)
+    result.record_header[i].name = fields[i].name;
+}
+
+void MysqlDataset::fetch_row(MYSQL_RES *stmt, MYSQL_ROW row, sql_record &res) {
+  const unsigned int numColumns = mysql_num_fields(stmt);
+  MYSQL_FIELD *fields = mysql_fetch_fields(stmt);
+  res.resize(numColumns);
+  for (unsigned int i = 0; i < numColumns; i++)
+  {
+    field_value &v = res[i];
+    v.set_isNull(false);
+    switch (fields[i].type)
+    {
+      case MYSQL_TYPE_LONGLONG:
+      case MYSQL_TYPE_DECIMAL:
+      case MYSQL_TYPE_NEWDECIMAL:
+      case MYSQL_TYPE_TINY:
+      case MYSQL_TYPE_SHORT:
+      case MYSQL_TYPE_INT24:
+      case MYSQL_TYPE_LONG:
+        if (row[i] != NULL)
+        {
+          v.set_asInt(atoi(row[i]));
+        }
+        else
+        {
+          v.set_asInt(0);
+        }
+        break;
+      case MYSQL_TYPE_FLOAT:
+      case MYSQL_TYPE_DOUBLE:
+        if (row[i] != NULL)
+        {
+          v.set_asDouble(atof(row[i]));
+        }
+        else
+        {
+          v.set_asDouble(0);
+        }
+        break;
+      case MYSQL_TYPE_STRING:
+      case MYSQL_TYPE_VAR_STRING:
+      case MYSQL_TYPE_VARCHAR:
+        v.set_asString(row[i] != NULL ? (const char *)row[i] : "");
+        break;
+      case MYSQL_TYPE_TINY_BLOB:
+      case MYSQL_TYPE_MEDIUM_BLOB:
+      case MYSQL_TYPE_LONG_BLOB:
+      case MYSQL_TYPE_BLOB:
+        v.set_asString(row[i] != NULL ? (const char *)row[i] : "");
+        break;
+      case MYSQL_TYPE_NULL:
+      default:
+        CLog::Log(LOGDEBUG,"MYSQL: Unknown field type: %u", fields[i].type);
+        v.set_asString("");
+        v.set_isNull();
+        break;
+    }
+  }
+}
+
 bool MysqlDataset::query(const string &q) {
   return query(q.c_str());
 }
@@ -1502,6 +1569,12 @@ void MysqlDataset::open() {
 }
 
 void MysqlDataset::close() {
+  if (forward_res)
+  { // frees whatever is left to read as well
+    mysql_free_result(forward_res);
+    forward_res = NULL;
+  }
+  forward_rows = 0;
   Dataset::close();
   result.clear();
   edit_object->clear();
@@ -1523,6 +1596,8 @@ void MysqlDataset::cancel() {
 
 
 int MysqlDataset::num_rows() {
+  if (forward_only)
+    return forward_rows;
   return result.records.size();
 }
 
@@ -1538,21 +1613,42 @@ bool MysqlDataset::bof() {
 
 
 void MysqlDataset::first() {
+  if (forward_only)
+  { // already there unless we moved on
+    if (forward_rows > 1)
+      throw DbErrors("Can't rewind a forward-only dataset");
+    return;
+  }
   Dataset::first();
   this->fill_fields();
 }
 
 void MysqlDataset::last() {
+  if (forward_only)
+    throw DbErrors("Can't seek in a forward-only dataset");
   Dataset::last();
   fill_fields();
 }
 
 void MysqlDataset::prev(void) {
+  if (forward_only)
+    throw DbErrors("Can't rewind a forward-only dataset");
   Dataset::prev();
   fill_fields();
 }
 
 void MysqlDataset::next(void) {
+  if (forward_only)
+  {
+    if (ds_state != dsSelect || feof)
+      return;
+    fbof = false;
+    if (fetch_forward())
+      fill_fields();
+    else
+      feof = true;
+    return;
+  }
   Dataset::next();
   if (!eof())
       fill_fields();
@@ -1572,6 +1668,12 @@ void MysqlDataset::free_row(void)
 }
 
 bool MysqlDataset::seek(int pos) {
+  if (forward_only)
+  { // the current row is the only one we can be at
+    if (pos != forward_rows - 1)
+      throw DbErrors("Can't seek in a forward-only dataset");
+    return true;
+  }
   if (ds_state == dsSelect)
   {
     Dataset::seek(pos);
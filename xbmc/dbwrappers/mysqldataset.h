@@ -124,6 +124,15 @@ protected:
   virtual void fill_fields();
 /* Changing field values during dataset navigation */
   virtual void free_row();  // free the memory allocated for the current row
+/* Fills the result set header from a query result */
+  void fetch_header(MYSQL_RES *stmt);
+/* Copies a fetched row into res */
+  void fetch_row(MYSQL_RES *stmt, MYSQL_ROW row, sql_record &res);
+/* Reads the next row of the forward-only result into the current row, false at the end */
+  bool fetch_forward();
+
+  MYSQL_RES *forward_res;	// unbuffered result of a forward-only query
+  int forward_rows;		// rows read from forward_res so far
 
 public:
 /* constructor */
@@ -147,6 +156,7 @@ or insert() operations default = false) */
 /* as open, but with our query exept Sql */
   virtual bool query(const char *query);
   virtual bool query(const std::string &query);
+  virtual bool query_forward(const char *query);
 /* func. closes a query */
   virtual void close(void);
 /* Cancel changes, made in insert or edit states of dataset */
@@ -40,6 +40,9 @@
 
 using namespace std;
 
+// compiled statements kept per connection
+#define MAX_STATEMENTS 64
+
 namespace dbiplus {
 //************* Callback function ***************************
 
@@ -260,6 +263,7 @@ bool SqliteDatabase::exists(void)
 
 void SqliteDatabase::disconnect(void) {
   if (active == false) return;
+  clearStatements();
   sqlite3_close(conn);
   active = false;
 }
@@ -268,6 +272,32 @@ int SqliteDatabase::create() {
   return connect(true);
 }
 
+sqlite3_stmt *SqliteDatabase::getStatement(const string &sql) {
+  map<string, sqlite3_stmt*>::iterator i = statements.find(sql);
+  if (i != statements.end())
+    return i->second;
+
+  // the sql text is expected to be constant, so this only fills up if callers
+  // format values into it. Start over rather than grow without bounds
+  if (statements.size() >= MAX_STATEMENTS)
+  {
+    CLog::Log(LOGDEBUG, "%s - more than %u statements, clearing the cache", __FUNCTION__, MAX_STATEMENTS);
+    clearStatements();
+  }
+
+  sqlite3_stmt *stmt = NULL;
+  if (setErr(sqlite3_prepare_v2(conn, sql.c_str(), sql.size(), &stmt, NULL), sql.c_str()) != SQLITE_OK)
+    throw DbErrors(getErrorMsg());
+  statements.insert(make_pair(sql, stmt));
+  return stmt;
+}
+
+void SqliteDatabase::clearStatements() {
+  for (map<string, sqlite3_stmt*>::iterator i = statements.begin(); i != statements.end(); ++i)
+    sqlite3_finalize(i->second);
+  statements.clear();
+}
+
 int SqliteDatabase::copy(const char *backup_name) {
   if (active == false)
     throw DbErrors("Can't copy database: no active connection...");
@@ -412,6 +442,8 @@ SqliteDataset::SqliteDataset():Dataset() {
   db = NULL;
   errmsg = NULL;
   autorefresh = false;
+  forward_stmt = NULL;
+  forward_rows = 0;
 }
 
 
@@ -420,9 +452,12 @@ SqliteDataset::SqliteDataset(SqliteDatabase *newDb):Dataset(newDb) {
   db = newDb;
   errmsg = NULL;
   autorefresh = false;
+  forward_stmt = NULL;
+  forward_rows = 0;
 }
 
  SqliteDataset::~SqliteDataset(){
+   if (forward_stmt) sqlite3_finalize(forward_stmt);
    if (errmsg) sqlite3_free(errmsg);
  }
 
@@ -611,54 +646,178 @@ bool SqliteDataset::query(const char *query) {
   if (db->setErr(sqlite3_prepare_v2(handle(),query,-1,&stmt, NULL),query) != SQLITE_OK)
     throw DbErrors(db->getErrorMsg());
 
-  // column headers
-  const unsigned int numColumns = sqlite3_column_count(stmt);
-  result.record_header.resize(numColumns);
-  for (unsigned int i = 0; i < numColumns; i++)
-    result.record_header[i].name = sqlite3_column_name(stmt, i);
+  fetch_rows(stmt);
 
-  // returned rows
-  while (sqlite3_step(stmt) == SQLITE_ROW)
-  { // have a row of data
-    sql_record *res = new sql_record;
-    res->resize(numColumns);
-    for (unsigned int i = 0; i < numColumns; i++)
+  if (db->setErr(sqlite3_finalize(stmt),query) == SQLITE_OK)
+  {
+    active = true;
+    ds_state = dsSelect;
+    this->first();
+    return true;
+  }
+  else
+  {
+    throw DbErrors(db->getErrorMsg());
+  }  
+}
+
+bool SqliteDataset::query(const string &sql, const sql_record &params) {
+  if (!handle()) throw DbErrors("No Database Connection");
+
+  close();
+
+  sqlite3_stmt *stmt = static_cast<SqliteDatabase*>(db)->getStatement(sql);
+  for (unsigned int i = 0; i < params.size(); i++)
+  {
+    const field_value &v = params[i];
+    int rc;
+    if (v.get_isNull())
+      rc = sqlite3_bind_null(stmt, i + 1);
+    else
     {
-      field_value &v = res->at(i);
-      switch (sqlite3_column_type(stmt, i))
+      switch (v.get_fType())
       {
-      case SQLITE_INTEGER:
-        v.set_asInt64(sqlite3_column_int64(stmt, i));
-        break;
-      case SQLITE_FLOAT:
-        v.set_asDouble(sqlite3_column_double(stmt, i));
+      case ft_Boolean:
+      case ft_Short:
+      case ft_UShort:
+      case ft_Int:
+        rc = sqlite3_bind_int(stmt, i + 1, v.get_asInt());
         break;
-      case SQLITE_TEXT:
-        v.set_asString((const char *)sqlite3_column_text(stmt, i));
+      case ft_UInt:
+      case ft_Int64:
+        rc = sqlite3_bind_int64(stmt, i + 1, v.get_asInt64());
         break;
-      case SQLITE_BLOB:
-        v.set_asString((const char *)sqlite3_column_text(stmt, i));
+      case ft_Float:
+      case ft_Double:
+        rc = sqlite3_bind_double(stmt, i + 1, v.get_asDouble());
         break;
-      case SQLITE_NULL:
       default:
-        v.set_asString("");
-        v.set_isNull();
+      {
+        const string text = v.get_asString();
+        rc = sqlite3_bind_text(stmt, i + 1, text.c_str(), text.size(), SQLITE_TRANSIENT);
         break;
       }
+      }
+    }
+    if (db->setErr(rc, sql.c_str()) != SQLITE_OK)
+    {
+      sqlite3_reset(stmt);
+      sqlite3_clear_bindings(stmt);
+      throw DbErrors(db->getErrorMsg());
     }
-    result.records.push_back(res);
   }
-  if (db->setErr(sqlite3_finalize(stmt),query) == SQLITE_OK)
+
+  fetch_rows(stmt);
+
+  // reset right away, a statement that isn't reset keeps its read lock
+  int rc = sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  if (db->setErr(rc, sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+
+  active = true;
+  ds_state = dsSelect;
+  this->first();
+  return true;
+}
+
+bool SqliteDataset::query_forward(const char *query) {
+  if (!handle()) throw DbErrors("No Database Connection");
+  std::string qry = query;
+  int fs = qry.find("select");
+  int fS = qry.find("SELECT");
+  if (!( fs >= 0 || fS >=0))
+    throw DbErrors("MUST be select SQL!");
+
+  close();
+
+  if (db->setErr(sqlite3_prepare_v2(handle(),query,-1,&forward_stmt, NULL),query) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+
+  fetch_header(forward_stmt);
+  // the single row every step is read into
+  result.records.push_back(new sql_record(result.record_header.size()));
+
+  forward_only = true;
+  active = true;
+  ds_state = dsSelect;
+  frecno = 0;
+  fbof = feof = !fetch_forward();
+  fill_fields();
+  return true;
+}
+
+bool SqliteDataset::fetch_forward() {
+  if (!forward_stmt)
+    return false;
+
+  int rc = sqlite3_step(forward_stmt);
+  if (rc == SQLITE_ROW)
   {
-    active = true;
-    ds_state = dsSelect;
-    this->first();
+    fetch_row(forward_stmt, *result.records[0]);
+    forward_rows++;
     return true;
   }
-  else
+
+  // done (or failed) - finalize now so the read lock isn't held until close()
+  const std::string query = sqlite3_sql(forward_stmt);
+  sqlite3_finalize(forward_stmt);
+  forward_stmt = NULL;
+  if (rc != SQLITE_DONE)
   {
+    db->setErr(rc, query.c_str());
     throw DbErrors(db->getErrorMsg());
-  }  
+  }
+  return false;
+}
+
+void SqliteDataset::fetch_header(sqlite3_stmt *stmt) {
+  const unsigned int numColumns = sqlite3_column_count(stmt);
+  result.record_header.resize(numColumns);
+  for (unsigned int i = 0; i < numColumns; i++)
+    result.record_header[i].name = sqlite3_column_name(stmt, i);
+}
+
+void SqliteDataset::fetch_row(sqlite3_stmt *stmt, sql_record &res) {
+  const unsigned int numColumns = result.record_header.size();
+  res.resize(numColumns);
+  for (unsigned int i = 0; i < numColumns; i++)
+  {
+    field_value &v = res[i];
+    v.set_isNull(false);
+    switch (sqlite3_column_type(stmt, i))
+    {
+    case SQLITE_INTEGER:
+      v.set_asInt64(sqlite3_column_int64(stmt, i));
+      break;
+    case SQLITE_FLOAT:
+      v.set_asDouble(sqlite3_column_double(stmt, i));
+      break;
+    case SQLITE_TEXT:
+      v.set_asString((const char *)sqlite3_column_text(stmt, i));
+      break;
+    case SQLITE_BLOB:
+      v.set_asString((const char *)sqlite3_column_text(stmt, i));
+      break;
+    case SQLITE_NULL:
+    default:
+      v.set_asString("");
+      v.set_isNull();
+      break;
+    }
+  }
+}
+
+void SqliteDataset::fetch_rows(sqlite3_stmt *stmt) {
+  fetch_header(stmt);
+
+  // returned rows
+  while (sqlite3_step(stmt) == SQLITE_ROW)
+  { // have a row of data
+    sql_record *res = new sql_record;
+    fetch_row(stmt, *res);
+    result.records.push_back(res);
+  }
 }
 
 bool SqliteDataset::query(const string &q){
@@ -681,6 +840,12 @@ void SqliteDataset::open() {
 
 
 void SqliteDataset::close() {
+  if (forward_stmt)
+  {
+    sqlite3_finalize(forward_stmt);
+    forward_stmt = NULL;
+  }
+  forward_rows = 0;
   Dataset::close();
   result.clear();
   edit_object->clear();
@@ -701,6 +866,8 @@ void SqliteDataset::cancel() {
 
 
 int SqliteDataset::num_rows() {
+  if (forward_only)
+    return forward_rows;
   return result.records.size();
 }
 
@@ -716,21 +883,42 @@ bool SqliteDataset::bof() {
 
 
 void SqliteDataset::first() {
+  if (forward_only)
+  { // already there unless we moved on
+    if (forward_rows > 1)
+      throw DbErrors("Can't rewind a forward-only dataset");
+    return;
+  }
   Dataset::first();
   this->fill_fields();
 }
 
 void SqliteDataset::last() {
+  if (forward_only)
+    throw DbErrors("Can't seek in a forward-only dataset");
   Dataset::last();
   fill_fields();
 }
 
 void SqliteDataset::prev(void) {
+  if (forward_only)
+    throw DbErrors("Can't rewind a forward-only dataset");
   Dataset::prev();
   fill_fields();
 }
 
 void SqliteDataset::next(void) {
+  if (forward_only)
+  {
+    if (ds_state != dsSelect || feof)
+      return;
+    fbof = false;
+    if (fetch_forward())
+      fill_fields();
+    else
+      feof = true;
+    return;
+  }
   Dataset::next();
   if (!eof()) 
       fill_fields();
@@ -750,6 +938,12 @@ void SqliteDataset::free_row(void)
 }
 
 bool SqliteDataset::seek(int pos) {
+  if (forward_only)
+  { // the current row is the only one we can be at
+    if (pos != forward_rows - 1)
+      throw DbErrors("Can't seek in a forward-only dataset");
+    return true;
+  }
   if (ds_state == dsSelect) {
     Dataset::seek(pos);
     fill_fields();
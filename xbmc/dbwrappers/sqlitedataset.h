@@ -30,6 +30,7 @@
 #define _SQLITEDATASET_H
 
 #include <stdio.h>
+#include <map>
 #include "dataset.h"
 #include <sqlite3.h>
 
@@ -45,6 +46,8 @@ protected:
   sqlite3 *conn;
   bool _in_transaction;
   int last_err;
+/* compiled statements, keyed by their sql text */
+  std::map<std::string, sqlite3_stmt*> statements;
 
 public:
 /* default constructor */
@@ -56,6 +59,11 @@ public:
 
 /* func. returns connection handle with SQLite-server */
   sqlite3 *getHandle() {  return conn; }
+/* func. returns the compiled statement for sql, compiling it on first use.
+   Reset it once done, it stays owned by the database */
+  sqlite3_stmt *getStatement(const std::string &sql);
+/* func. finalizes all compiled statements */
+  void clearStatements();
 /* func. returns current status about SQLite-server connection */
   virtual int status();
   virtual int setErr(int err_code,const char * qry);
@@ -124,6 +132,17 @@ protected:
   virtual void fill_fields();
 /* Changing field values during dataset navigation */
   virtual void free_row();  // free the memory allocated for the current row
+/* Reads all rows of a stepped statement into the result set */
+  void fetch_rows(sqlite3_stmt *stmt);
+/* Fills the result set header from a prepared statement */
+  void fetch_header(sqlite3_stmt *stmt);
+/* Copies the current row of a stepped statement into res */
+  void fetch_row(sqlite3_stmt *stmt, sql_record &res);
+/* Steps the forward-only statement into the current row, false at the end */
+  bool fetch_forward();
+
+  sqlite3_stmt *forward_stmt;	// open statement of a forward-only query
+  int forward_rows;		// rows read from forward_stmt so far
 
 public:
 /* constructor */
@@ -147,6 +166,8 @@ or insert() operations default = false) */
 /* as open, but with our query exept Sql */
   virtual bool query(const char *query);
   virtual bool query(const std::string &query);
+  virtual bool query(const std::string &query, const sql_record &params);
+  virtual bool query_forward(const char *query);
 /* func. closes a query */
   virtual void close(void);
 /* Cancel changes, made in insert or edit states of dataset */
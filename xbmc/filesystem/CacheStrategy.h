@@ -30,6 +30,8 @@
 #endif
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
+#include "utils/StdString.h"
+#include "IFileTypes.h"
 
 namespace XFILE {
 
@@ -57,6 +59,15 @@ public:
   virtual bool IsEndOfInput();
   virtual void ClearEndOfInput();
 
+  // called before Open with what identifies the source, caches that outlive an open key their data on it
+  virtual void SetSource(const CStdString &path, int64_t length, int64_t mtime) {}
+  // where the writer at iFilePosition should continue, later if the data in between is cached already
+  virtual int64_t NextWritePosition(int64_t iFilePosition) { return iFilePosition; }
+  // move the writer without disturbing the reader, used after NextWritePosition
+  virtual void SetWritePosition(int64_t iFilePosition) {}
+  // counters for IOCTRL_CACHE_STATS, false if the strategy keeps none
+  virtual bool GetStats(SCacheStats *stats) { return false; }
+
   CEvent m_space;
 protected:
   bool  m_bEndOfInput;
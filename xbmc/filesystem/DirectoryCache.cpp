@@ -24,17 +24,24 @@
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
-#include "climits"
+
+#include <boost/functional/hash.hpp>
 
 using namespace std;
 using namespace XFILE;
 
+// folders kept per shard, not counting the ones that are always cached
+#define MAX_CACHED_DIRS_PER_SHARD 4
+
+size_t CDirectoryCache::PathHash::operator()(const CStdString& path) const
+{
+  return boost::hash_range(path.begin(), path.end());
+}
+
 CDirectoryCache::CDir::CDir(DIR_CACHE_TYPE cacheType)
 {
   m_cacheType = cacheType;
-  m_lastAccess = 0;
   m_Items = new CFileItemList;
-  m_Items->SetFastLookup(true);
 }
 
 CDirectoryCache::CDir::~CDir()
@@ -42,49 +49,70 @@ CDirectoryCache::CDir::~CDir()
   delete m_Items;
 }
 
-void CDirectoryCache::CDir::SetLastAccess(unsigned int &accessCounter)
+void CDirectoryCache::CDir::SetItems(const CFileItemList &items)
 {
-  m_lastAccess = accessCounter++;
+  m_Items->Copy(items);
+  m_files.clear();
+  m_files.rehash(m_Items->Size());
+  for (int i = 0; i < m_Items->Size(); i++)
+    m_files.insert(m_Items->Get(i)->GetPath());
+}
+
+void CDirectoryCache::CDir::AddFile(const CStdString &strFile)
+{
+  CFileItemPtr item(new CFileItem(strFile, false));
+  m_Items->Add(item);
+  m_files.insert(strFile);
+}
+
+bool CDirectoryCache::CDir::Contains(const CStdString &strFile) const
+{
+  return m_files.find(strFile) != m_files.end();
 }
 
 CDirectoryCache::CDirectoryCache(void)
 {
-  m_accessCounter = 0;
-#ifdef _DEBUG
-  m_cacheHits = 0;
-  m_cacheMisses = 0;
-#endif
 }
 
 CDirectoryCache::~CDirectoryCache(void)
 {
 }
 
-bool CDirectoryCache::GetDirectory(const CStdString& strPath, CFileItemList &items, bool retrieveAll)
+CDirectoryCache::CShard& CDirectoryCache::GetShard(const CStdString& strPath)
+{
+  return m_shards[PathHash()(strPath) % SHARDS];
+}
+
+void CDirectoryCache::Touch(CShard& shard, CDir* dir)
 {
-  CSingleLock lock (m_cs);
+  if (dir->m_cacheType != DIR_CACHE_ALWAYS)
+    shard.m_lastAccess.splice(shard.m_lastAccess.begin(), shard.m_lastAccess, dir->m_lastAccess);
+}
 
+bool CDirectoryCache::GetDirectory(const CStdString& strPath, CFileItemList &items, bool retrieveAll)
+{
   CStdString storedPath = URIUtils::SubstitutePath(strPath);
   URIUtils::RemoveSlashAtEnd(storedPath);
 
-  ciCache i = m_cache.find(storedPath);
-  if (i != m_cache.end())
+  CShard& shard = GetShard(storedPath);
+  CSingleLock lock (shard.m_cs);
+
+  ciCache i = shard.m_cache.find(storedPath);
+  if (i != shard.m_cache.end())
   {
     CDir* dir = i->second;
     if (dir->m_cacheType == XFILE::DIR_CACHE_ALWAYS ||
        (dir->m_cacheType == XFILE::DIR_CACHE_ONCE && retrieveAll))
     {
       items.Copy(*dir->m_Items);
-      dir->SetLastAccess(m_accessCounter);
-#ifdef _DEBUG
-      m_cacheHits+=items.Size();
-#endif
+      Touch(shard, dir);
+      shard.m_hits++;
       return true;
     }
   }
+  shard.m_misses++;
   return false;
 }
-
 void CDirectoryCache::SetDirectory(const CStdString& strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType)
 {
   if (cacheType == DIR_CACHE_NEVER)
@@ -101,19 +129,24 @@ void CDirectoryCache::SetDirectory(const CStdString& strPath, const CFileItemLis
   // IDEALLY, any further processing on the item would actually create a new item
   // instead of altering it, but we can't really enforce that in an easy way, so
   // this is the best solution for now.
-  CSingleLock lock (m_cs);
-
   CStdString storedPath = URIUtils::SubstitutePath(strPath);
   URIUtils::RemoveSlashAtEnd(storedPath);
 
-  ClearDirectory(storedPath);
+  CShard& shard = GetShard(storedPath);
+  CSingleLock lock (shard.m_cs);
+
+  iCache i = shard.m_cache.find(storedPath);
+  if (i != shard.m_cache.end())
+    Delete(shard, i);
 
-  CheckIfFull();
+  if (cacheType != DIR_CACHE_ALWAYS)
+    CheckIfFull(shard);
 
   CDir* dir = new CDir(cacheType);
-  dir->m_Items->Copy(items);
-  dir->SetLastAccess(m_accessCounter);
-  m_cache.insert(pair<CStdString, CDir*>(storedPath, dir));
+  dir->SetItems(items);
+  if (cacheType != DIR_CACHE_ALWAYS)
+    dir->m_lastAccess = shard.m_lastAccess.insert(shard.m_lastAccess.begin(), storedPath);
+  shard.m_cache.insert(make_pair(storedPath, dir));
 }
 
 void CDirectoryCache::ClearFile(const CStdString& strFile)
@@ -125,157 +158,137 @@ void CDirectoryCache::ClearFile(const CStdString& strFile)
 
 void CDirectoryCache::ClearDirectory(const CStdString& strPath)
 {
-  CSingleLock lock (m_cs);
-
   CStdString storedPath = URIUtils::SubstitutePath(strPath);
   URIUtils::RemoveSlashAtEnd(storedPath);
 
-  iCache i = m_cache.find(storedPath);
-  if (i != m_cache.end())
-    Delete(i);
+  CShard& shard = GetShard(storedPath);
+  CSingleLock lock (shard.m_cs);
+
+  iCache i = shard.m_cache.find(storedPath);
+  if (i != shard.m_cache.end())
+    Delete(shard, i);
 }
 
 void CDirectoryCache::ClearSubPaths(const CStdString& strPath)
 {
-  CSingleLock lock (m_cs);
-
   CStdString storedPath = URIUtils::SubstitutePath(strPath);
   URIUtils::RemoveSlashAtEnd(storedPath);
 
-  iCache i = m_cache.begin();
-  while (i != m_cache.end())
+  for (unsigned int s = 0; s < SHARDS; s++)
   {
-    CStdString path = i->first;
-    if (strncmp(path.c_str(), storedPath.c_str(), storedPath.GetLength()) == 0)
-      Delete(i++);
-    else
-      i++;
+    CShard& shard = m_shards[s];
+    CSingleLock lock (shard.m_cs);
+
+    iCache i = shard.m_cache.begin();
+    while (i != shard.m_cache.end())
+    {
+      if (strncmp(i->first.c_str(), storedPath.c_str(), storedPath.GetLength()) == 0)
+        Delete(shard, i++);
+      else
+        i++;
+    }
   }
 }
 
 void CDirectoryCache::AddFile(const CStdString& strFile)
 {
-  CSingleLock lock (m_cs);
-
   CStdString strPath;
   URIUtils::GetDirectory(strFile, strPath);
   URIUtils::RemoveSlashAtEnd(strPath);
 
-  ciCache i = m_cache.find(strPath);
-  if (i != m_cache.end())
+  CShard& shard = GetShard(strPath);
+  CSingleLock lock (shard.m_cs);
+
+  iCache i = shard.m_cache.find(strPath);
+  if (i != shard.m_cache.end())
   {
     CDir *dir = i->second;
-    CFileItemPtr item(new CFileItem(strFile, false));
-    dir->m_Items->Add(item);
-    dir->SetLastAccess(m_accessCounter);
+    dir->AddFile(strFile);
+    Touch(shard, dir);
   }
 }
 
 bool CDirectoryCache::FileExists(const CStdString& strFile, bool& bInCache)
 {
-  CSingleLock lock (m_cs);
   bInCache = false;
 
   CStdString strPath;
   URIUtils::GetDirectory(strFile, strPath);
   URIUtils::RemoveSlashAtEnd(strPath);
 
-  ciCache i = m_cache.find(strPath);
-  if (i != m_cache.end())
+  CShard& shard = GetShard(strPath);
+  CSingleLock lock (shard.m_cs);
+
+  ciCache i = shard.m_cache.find(strPath);
+  if (i != shard.m_cache.end())
   {
     bInCache = true;
     CDir *dir = i->second;
-    dir->SetLastAccess(m_accessCounter);
-#ifdef _DEBUG
-    m_cacheHits++;
-#endif
-    return dir->m_Items->Contains(strFile);
+    Touch(shard, dir);
+    shard.m_hits++;
+    return dir->Contains(strFile);
   }
-#ifdef _DEBUG
-  m_cacheMisses++;
-#endif
+  shard.m_misses++;
   return false;
 }
 
 void CDirectoryCache::Clear()
 {
   // this routine clears everything
-  CSingleLock lock (m_cs);
+  for (unsigned int s = 0; s < SHARDS; s++)
+  {
+    CShard& shard = m_shards[s];
+    CSingleLock lock (shard.m_cs);
 
-  iCache i = m_cache.begin();
-  while (i != m_cache.end() )
-    Delete(i++);
+    iCache i = shard.m_cache.begin();
+    while (i != shard.m_cache.end() )
+      Delete(shard, i++);
+  }
 }
 
-void CDirectoryCache::InitCache(set<CStdString>& dirs)
+void CDirectoryCache::CheckIfFull(CShard& shard)
 {
-  set<CStdString>::iterator it;
-  for (it = dirs.begin(); it != dirs.end(); ++it)
-  {
-    const CStdString& strDir = *it;
-    CFileItemList items;
-    CDirectory::GetDirectory(strDir, items, "", DIR_FLAG_NO_FILE_DIRS);
-    items.Clear();
-  }
+  // drop the least recently used folders, the ones that are always cached aren't counted
+  while (shard.m_lastAccess.size() >= MAX_CACHED_DIRS_PER_SHARD)
+    Delete(shard, shard.m_cache.find(shard.m_lastAccess.back()));
 }
 
-void CDirectoryCache::ClearCache(set<CStdString>& dirs)
+void CDirectoryCache::Delete(CShard& shard, iCache it)
 {
-  iCache i = m_cache.begin();
-  while (i != m_cache.end())
-  {
-    if (dirs.find(i->first) != dirs.end())
-      Delete(i++);
-    else
-      i++;
-  }
+  CDir* dir = it->second;
+  if (dir->m_cacheType != DIR_CACHE_ALWAYS)
+    shard.m_lastAccess.erase(dir->m_lastAccess);
+  delete dir;
+  shard.m_cache.erase(it);
 }
 
-void CDirectoryCache::CheckIfFull()
+void CDirectoryCache::GetStats(unsigned int &hits, unsigned int &misses) const
 {
-  CSingleLock lock (m_cs);
-  static const unsigned int max_cached_dirs = 10;
-
-  // find the last accessed folder, and remove if the number of cached folders is too many
-  iCache lastAccessed = m_cache.end();
-  unsigned int numCached = 0;
-  for (iCache i = m_cache.begin(); i != m_cache.end(); i++)
+  hits = misses = 0;
+  for (unsigned int s = 0; s < SHARDS; s++)
   {
-    // ensure dirs that are always cached aren't cleared
-    if (i->second->m_cacheType != DIR_CACHE_ALWAYS)
-    {
-      if (lastAccessed == m_cache.end() || i->second->GetLastAccess() < lastAccessed->second->GetLastAccess())
-        lastAccessed = i;
-      numCached++;
-    }
+    CSingleLock lock (m_shards[s].m_cs);
+    hits += m_shards[s].m_hits;
+    misses += m_shards[s].m_misses;
   }
-  if (lastAccessed != m_cache.end() && numCached >= max_cached_dirs)
-    Delete(lastAccessed);
-}
-
-void CDirectoryCache::Delete(iCache it)
-{
-  CDir* dir = it->second;
-  delete dir;
-  m_cache.erase(it);
 }
 
-#ifdef _DEBUG
 void CDirectoryCache::PrintStats() const
 {
-  CSingleLock lock (m_cs);
-  CLog::Log(LOGDEBUG, "%s - total of %u cache hits, and %u cache misses", __FUNCTION__, m_cacheHits, m_cacheMisses);
-  // run through and find the oldest and the number of items cached
-  unsigned int oldest = UINT_MAX;
+  unsigned int hits, misses;
+  GetStats(hits, misses);
+  CLog::Log(LOGDEBUG, "%s - total of %u cache hits, and %u cache misses", __FUNCTION__, hits, misses);
+
   unsigned int numItems = 0;
   unsigned int numDirs = 0;
-  for (ciCache i = m_cache.begin(); i != m_cache.end(); i++)
+  for (unsigned int s = 0; s < SHARDS; s++)
   {
-    CDir *dir = i->second;
-    oldest = min(oldest, dir->GetLastAccess());
-    numItems += dir->m_Items->Size();
-    numDirs++;
+    CSingleLock lock (m_shards[s].m_cs);
+    for (ciCache i = m_shards[s].m_cache.begin(); i != m_shards[s].m_cache.end(); i++)
+    {
+      numItems += i->second->m_Items->Size();
+      numDirs++;
+    }
   }
-  CLog::Log(LOGDEBUG, "%s - %u folders cached, with %u items total.  Oldest is %u, current is %u", __FUNCTION__, numDirs, numItems, oldest, m_accessCounter);
+  CLog::Log(LOGDEBUG, "%s - %u folders cached, with %u items total", __FUNCTION__, numDirs, numItems);
 }
-#endif
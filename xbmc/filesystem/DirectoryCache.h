@@ -23,8 +23,9 @@
 #include "Directory.h"
 #include "threads/CriticalSection.h"
 
-#include <map>
-#include <set>
+#include <list>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
 
 class CFileItem;
 
@@ -32,19 +33,45 @@ namespace XFILE
 {
   class CDirectoryCache
   {
+    struct PathHash
+    {
+      size_t operator()(const CStdString& path) const;
+    };
+    typedef boost::unordered_set<CStdString, PathHash> PathSet;
+
     class CDir
     {
     public:
       CDir(DIR_CACHE_TYPE cacheType);
       virtual ~CDir();
 
-      void SetLastAccess(unsigned int &accessCounter);
-      unsigned int GetLastAccess() const { return m_lastAccess; };
+      void SetItems(const CFileItemList &items);
+      void AddFile(const CStdString &strFile);
+      bool Contains(const CStdString &strFile) const;
 
       CFileItemList* m_Items;
       DIR_CACHE_TYPE m_cacheType;
+      std::list<CStdString>::iterator m_lastAccess; // position in the shard's LRU list, unused for DIR_CACHE_ALWAYS
     private:
-      unsigned int m_lastAccess;
+      PathSet m_files; // paths of m_Items
+    };
+
+    typedef boost::unordered_map<CStdString, CDir*, PathHash> DirMap;
+    typedef DirMap::iterator iCache;
+    typedef DirMap::const_iterator ciCache;
+
+    /* directories are spread over shards by path, each with its own lock
+     * so that threads working on different folders don't serialize */
+    class CShard
+    {
+    public:
+      CShard() : m_hits(0), m_misses(0) {}
+
+      DirMap m_cache;
+      std::list<CStdString> m_lastAccess; // most recently used first
+      CCriticalSection m_cs;
+      unsigned int m_hits;
+      unsigned int m_misses;
     };
   public:
     CDirectoryCache(void);
@@ -57,27 +84,17 @@ namespace XFILE
     void Clear();
     void AddFile(const CStdString& strFile);
     bool FileExists(const CStdString& strPath, bool& bInCache);
-#ifdef _DEBUG
+    void GetStats(unsigned int &hits, unsigned int &misses) const;
     void PrintStats() const;
-#endif
   protected:
-    void InitCache(std::set<CStdString>& dirs);
-    void ClearCache(std::set<CStdString>& dirs);
-    void CheckIfFull();
-
-    std::map<CStdString, CDir*> m_cache;
-    typedef std::map<CStdString, CDir*>::iterator iCache;
-    typedef std::map<CStdString, CDir*>::const_iterator ciCache;
-    void Delete(iCache i);
-
-    CCriticalSection m_cs;
+    static const unsigned int SHARDS = 8;
 
-    unsigned int m_accessCounter;
+    CShard& GetShard(const CStdString& strPath);
+    void Touch(CShard& shard, CDir* dir);
+    void CheckIfFull(CShard& shard);
+    void Delete(CShard& shard, iCache i);
 
-#ifdef _DEBUG
-    unsigned int m_cacheHits;
-    unsigned int m_cacheMisses;
-#endif
+    CShard m_shards[SHARDS];
   };
 }
 extern XFILE::CDirectoryCache g_directoryCache;
@@ -26,6 +26,7 @@
 #include "URL.h"
 
 #include "CircularCache.h"
+#include "PersistentCache.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
@@ -85,7 +86,9 @@ CFileCache::CFileCache() : CThread("CFileCache")
    m_seekPos = 0;
    m_readPos = 0;
    m_writePos = 0;
-   if (g_advancedSettings.m_cacheMemBufferSize == 0)
+   if (g_advancedSettings.m_cachePersistentSize > 0)
+     m_pCache = new CPersistentCache("special://temp/blockcache/", (int64_t)g_advancedSettings.m_cachePersistentSize * 1024 * 1024);
+   else if (g_advancedSettings.m_cacheMemBufferSize == 0)
      m_pCache = new CSimpleFileCache();
    else
      m_pCache = new CCircularCache(g_advancedSettings.m_cacheMemBufferSize
@@ -145,18 +148,25 @@ bool CFileCache::Open(const CURL& url)
 
   m_sourcePath = url.Get();
 
-  // open cache strategy
-  if (m_pCache->Open() != CACHE_RC_OK)
+  // opening the source file.
+  if (!m_source.Open(m_sourcePath, READ_NO_CACHE | READ_TRUNCATED | READ_CHUNKED))
   {
-    CLog::Log(LOGERROR,"CFileCache::Open - failed to open cache");
+    CLog::Log(LOGERROR,"%s - failed to open source <%s>", __FUNCTION__, m_sourcePath.c_str());
     Close();
     return false;
   }
 
-  // opening the source file.
-  if (!m_source.Open(m_sourcePath, READ_NO_CACHE | READ_TRUNCATED | READ_CHUNKED))
+  // tell the cache what it is holding, so data kept from an earlier open can be reused
+  struct __stat64 st;
+  int64_t mtime = 0;
+  if (m_source.Stat(&st) == 0)
+    mtime = st.st_mtime;
+  m_pCache->SetSource(m_sourcePath, m_source.GetLength(), mtime);
+
+  // open cache strategy
+  if (m_pCache->Open() != CACHE_RC_OK)
   {
-    CLog::Log(LOGERROR,"%s - failed to open source <%s>", __FUNCTION__, m_sourcePath.c_str());
+    CLog::Log(LOGERROR,"CFileCache::Open - failed to open cache");
     Close();
     return false;
   }
@@ -243,6 +253,21 @@ void CFileCache::Process()
       }
     }
 
+    // skip over what the cache holds already
+    int64_t next = m_pCache->NextWritePosition(m_writePos);
+    if (next > m_writePos && m_seekPossible > 0)
+    {
+      if (m_source.Seek(next, SEEK_SET) == next)
+      {
+        m_pCache->SetWritePosition(next);
+        average.Reset(next);
+        limiter.Reset(next);
+        m_writePos = next;
+      }
+      else
+        m_source.Seek(m_writePos, SEEK_SET);
+    }
+
     int iRead = m_source.Read(buffer.get(), m_chunkSize);
     if (iRead == 0)
     {
@@ -481,5 +506,8 @@ int CFileCache::IoControl(EIoControl request, void* param)
   if (request == IOCTRL_SEEK_POSSIBLE)
     return m_seekPossible;
 
+  if (request == IOCTRL_CACHE_STATS)
+    return m_pCache->GetStats((SCacheStats*)param) ? 0 : -1;
+
   return -1;
 }
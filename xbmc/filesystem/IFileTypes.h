@@ -37,12 +37,21 @@ struct SCacheStatus
   bool     full;     /**< is the cache full */
 };
 
+struct SCacheStats
+{
+  uint64_t hits;         /**< number of blocks read that were cached before the file was opened */
+  uint64_t misses;       /**< number of blocks read that had to be fetched from the source */
+  uint64_t cachedBytes;  /**< bytes read from blocks cached before the file was opened */
+  uint64_t fetchedBytes; /**< bytes fetched from the source */
+};
+
 typedef enum {
   IOCTRL_NATIVE        = 1, /**< SNativeIoControl structure, containing what should be passed to native ioctrl */
   IOCTRL_SEEK_POSSIBLE = 2, /**< return 0 if known not to work, 1 if it should work */
   IOCTRL_CACHE_STATUS  = 3, /**< SCacheStatus structure */
   IOCTRL_CACHE_SETRATE = 4, /**< unsigned int with speed limit for caching in bytes per second */
   IOCTRL_SET_CACHE    = 8, /** <CFileCache */
+  IOCTRL_CACHE_STATS   = 9, /**< SCacheStats structure */
 } EIoControl;
 
 }
@@ -0,0 +1,272 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "MappedFile.h"
+#include "URL.h"
+#include "utils/log.h"
+
+#ifdef _LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <string.h>
+
+// how much the kernel is asked to read ahead of the current position
+#define MAPPED_PREFETCH_SIZE (4 * 1024 * 1024)
+// window mapped at once when the whole file doesn't fit the address space
+#define MAPPED_WINDOW_SIZE   (64 * 1024 * 1024)
+
+using namespace XFILE;
+
+CMappedFile::CMappedFile()
+{
+  m_fd = -1;
+  m_window = NULL;
+  m_windowOffset = 0;
+  m_windowSize = 0;
+  m_position = 0;
+  m_length = 0;
+  m_prefetched = 0;
+}
+
+CMappedFile::~CMappedFile()
+{
+  Close();
+}
+
+#ifdef _LINUX
+
+bool CMappedFile::Open(const CURL& url)
+{
+  Close();
+
+  CStdString strFile = GetLocal(url);
+  m_fd = open(strFile.c_str(), O_RDONLY);
+  if (m_fd < 0)
+    return false;
+
+  struct stat64 st;
+  if (fstat64(m_fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+  {
+    Close();
+    return false;
+  }
+  m_length = st.st_size;
+
+  if (!Map(0))
+  {
+    CLog::Log(LOGDEBUG, "%s - unable to map %s", __FUNCTION__, strFile.c_str());
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void CMappedFile::Close()
+{
+  Unmap();
+  if (m_fd >= 0)
+    close(m_fd);
+  m_fd = -1;
+  m_position = 0;
+  m_length = 0;
+}
+
+int CMappedFile::Stat(struct __stat64* buffer)
+{
+  if (m_fd < 0)
+    return -1;
+  return fstat64(m_fd, buffer);
+}
+
+bool CMappedFile::Map(int64_t position)
+{
+  Unmap();
+
+  int64_t offset = 0;
+  int64_t size = m_length;
+  if (sizeof(size_t) < sizeof(int64_t))
+  {
+    // the window offset has to be page aligned, which the window size is a multiple of
+    offset = position - position % MAPPED_WINDOW_SIZE;
+    size = std::min<int64_t>(m_length - offset, MAPPED_WINDOW_SIZE);
+  }
+  if (size <= 0)
+    return false;
+
+  void* window = mmap64(NULL, (size_t)size, PROT_READ, MAP_SHARED, m_fd, offset);
+  if (window == MAP_FAILED)
+    return false;
+
+  madvise(window, (size_t)size, MADV_SEQUENTIAL);
+
+  m_window = (uint8_t*)window;
+  m_windowOffset = offset;
+  m_windowSize = (size_t)size;
+  m_prefetched = position;
+  return true;
+}
+
+void CMappedFile::Unmap()
+{
+  if (m_window)
+    munmap(m_window, m_windowSize);
+  m_window = NULL;
+  m_windowOffset = 0;
+  m_windowSize = 0;
+}
+
+void CMappedFile::Prefetch()
+{
+  // hint the next block once half of the previous one has been read
+  if (m_position + MAPPED_PREFETCH_SIZE / 2 < m_prefetched)
+    return;
+
+  static const int64_t page = sysconf(_SC_PAGESIZE);
+  int64_t from = std::max(m_position, m_prefetched) - m_windowOffset;
+  from -= from % page;
+  int64_t size = std::min<int64_t>(MAPPED_PREFETCH_SIZE, m_windowSize - from);
+  if (size <= 0)
+    return;
+
+  madvise(m_window + from, (size_t)size, MADV_WILLNEED);
+  m_prefetched = m_windowOffset + from + size;
+}
+
+unsigned int CMappedFile::Read(void *lpBuf, int64_t uiBufSize)
+{
+  if (m_fd < 0)
+    return 0;
+
+  if (m_position >= m_length)
+  {
+    // the file may have grown since it was mapped
+    struct stat64 st;
+    if (fstat64(m_fd, &st) == 0 && st.st_size > m_length)
+    {
+      m_length = st.st_size;
+      Unmap();
+    }
+  }
+
+  uint8_t* buffer = (uint8_t*)lpBuf;
+  int64_t done = 0;
+  while (done < uiBufSize && m_position < m_length)
+  {
+    if (!m_window || m_position < m_windowOffset || m_position >= m_windowOffset + (int64_t)m_windowSize)
+    {
+      if (!Map(m_position))
+        break;
+    }
+    Prefetch();
+
+    size_t offset = (size_t)(m_position - m_windowOffset);
+    size_t size = (size_t)std::min<int64_t>(uiBufSize - done, m_windowSize - offset);
+    memcpy(buffer + done, m_window + offset, size);
+    done += size;
+    m_position += size;
+  }
+  return (unsigned int)done;
+}
+
+#else
+
+bool CMappedFile::Open(const CURL& url)
+{
+  return false;
+}
+
+void CMappedFile::Close()
+{
+}
+
+int CMappedFile::Stat(struct __stat64* buffer)
+{
+  return -1;
+}
+
+bool CMappedFile::Map(int64_t position)
+{
+  return false;
+}
+
+void CMappedFile::Unmap()
+{
+}
+
+void CMappedFile::Prefetch()
+{
+}
+
+unsigned int CMappedFile::Read(void *lpBuf, int64_t uiBufSize)
+{
+  return 0;
+}
+
+#endif
+
+int64_t CMappedFile::Seek(int64_t iFilePosition, int iWhence)
+{
+  int64_t position;
+  switch (iWhence)
+  {
+  case SEEK_SET:
+    position = iFilePosition;
+    break;
+  case SEEK_CUR:
+    position = m_position + iFilePosition;
+    break;
+  case SEEK_END:
+    position = m_length + iFilePosition;
+    break;
+  default:
+    return -1;
+  }
+  if (position < 0)
+    return -1;
+
+  // restart the read ahead hints from the new position
+  m_position = position;
+  m_prefetched = position;
+  return m_position;
+}
+
+int64_t CMappedFile::GetPosition()
+{
+  return m_position;
+}
+
+int64_t CMappedFile::GetLength()
+{
+  return m_length;
+}
+
+int CMappedFile::IoControl(EIoControl request, void* param)
+{
+  if (request == IOCTRL_SEEK_POSSIBLE)
+    return 1;
+
+  return -1;
+}
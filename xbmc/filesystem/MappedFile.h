@@ -0,0 +1,70 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "HDFile.h"
+
+namespace XFILE
+{
+/*!
+ \brief Read only access to local files through a memory mapping.
+
+ Reads are plain copies out of the mapping, so seeking and small reads
+ don't cost a syscall each. The kernel is told the access is sequential and
+ asked to page in the data ahead of the read position. Files that don't fit
+ the address space are mapped through a sliding window.
+
+ Open fails where mapping isn't available, callers should fall back to
+ CFile in that case. A file that is truncated while mapped raises SIGBUS on
+ access, so this is only meant for media that isn't being written to.
+ */
+class CMappedFile : public CHDFile
+{
+public:
+  CMappedFile();
+  virtual ~CMappedFile();
+  virtual bool Open(const CURL& url);
+  virtual bool OpenForWrite(const CURL& url, bool bOverWrite = false) { return false; }
+  virtual int Stat(struct __stat64* buffer);
+  virtual unsigned int Read(void* lpBuf, int64_t uiBufSize);
+  virtual int Write(const void* lpBuf, int64_t uiBufSize) { return -1; }
+  virtual int64_t Seek(int64_t iFilePosition, int iWhence = SEEK_SET);
+  virtual int Truncate(int64_t size) { return -1; }
+  virtual void Close();
+  virtual void Flush() {}
+  virtual int64_t GetPosition();
+  virtual int64_t GetLength();
+  virtual int IoControl(EIoControl request, void* param);
+
+protected:
+  bool Map(int64_t position);
+  void Unmap();
+  void Prefetch();
+
+  int      m_fd;
+  uint8_t* m_window;
+  int64_t  m_windowOffset;
+  size_t   m_windowSize;
+  int64_t  m_position;
+  int64_t  m_length;
+  int64_t  m_prefetched; // end of the range last passed to the kernel for read ahead
+};
+}
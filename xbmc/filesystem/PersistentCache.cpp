@@ -0,0 +1,648 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "PersistentCache.h"
+#include "Directory.h"
+#include "FileItem.h"
+#include "URL.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+#include "utils/md5.h"
+#include "utils/URIUtils.h"
+
+#include <algorithm>
+#include <map>
+#include <string.h>
+
+using namespace XFILE;
+
+/* the writer is held back once it is this far ahead of the reader */
+#define PERSISTENT_CACHE_MAX_FORWARD (64 * 1024 * 1024)
+
+namespace
+{
+  struct CachedSource
+  {
+    CStdString path;
+    CDateTime  accessed;
+    int64_t    size;
+    bool operator<(const CachedSource &rhs) const { return accessed < rhs.accessed; }
+  };
+
+  /* bytes in each cache folder of this process, shared by its instances */
+  CCriticalSection               usageSection;
+  std::map<CStdString, int64_t>  usage;
+
+  /* only one instance walks and trims the cache folder at a time */
+  CCriticalSection               evictSection;
+
+  int64_t CountSources(const CStdString &directory, std::vector<CachedSource> &sources)
+  {
+    CFileItemList folders;
+    if (!CDirectory::GetDirectory(directory, folders, "", DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_BYPASS_CACHE))
+      return 0;
+
+    int64_t total = 0;
+    for (int i = 0; i < folders.Size(); i++)
+    {
+      if (!folders[i]->m_bIsFolder)
+        continue;
+
+      CachedSource source;
+      source.path     = folders[i]->GetPath();
+      source.accessed = folders[i]->m_dateTime;
+      source.size     = 0;
+      URIUtils::AddSlashAtEnd(source.path);
+
+      CFileItemList items;
+      CDirectory::GetDirectory(source.path, items, "", DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_BYPASS_CACHE);
+      for (int j = 0; j < items.Size(); j++)
+      {
+        source.size += items[j]->m_dwSize;
+        if (URIUtils::GetFileName(items[j]->GetPath()) == "access")
+          source.accessed = items[j]->m_dateTime;
+      }
+      total += source.size;
+      sources.push_back(source);
+    }
+    return total;
+  }
+
+  bool RemoveFolder(const CStdString &path)
+  {
+    CFileItemList items;
+    CDirectory::GetDirectory(path, items, "", DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_BYPASS_CACHE);
+    for (int i = 0; i < items.Size(); i++)
+      CFile::Delete(items[i]->GetPath());
+    return CDirectory::Remove(path);
+  }
+}
+
+CPersistentCache::CPersistentCache(const CStdString &directory, int64_t budget, unsigned int blockSize)
+ : CCacheStrategy()
+ , m_directory(directory)
+ , m_budget(budget)
+ , m_blockSize(blockSize)
+ , m_length(0)
+ , m_persistent(false)
+ , m_readPos(0)
+ , m_writePos(0)
+ , m_readBlock(-1)
+ , m_lastBlock(-1)
+{
+  URIUtils::AddSlashAtEnd(m_directory);
+  m_maxForward = (size_t)std::min<int64_t>(m_budget / 4, PERSISTENT_CACHE_MAX_FORWARD);
+  m_maxForward = std::max<size_t>(m_maxForward, 2 * m_blockSize);
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
+CPersistentCache::~CPersistentCache()
+{
+  Close();
+}
+
+void CPersistentCache::SetSource(const CStdString &path, int64_t length, int64_t mtime)
+{
+  CSingleLock lock(m_sync);
+  m_path       = path;
+  m_length     = length;
+  m_persistent = length > 0 && mtime != 0;
+
+  if (m_persistent)
+  {
+    CStdString key;
+    key.Format("%s|%"PRId64"|%"PRId64, path.c_str(), length, mtime);
+    m_keyDir = XBMC::XBMC_MD5::GetMD5(key);
+  }
+  else
+  {
+    // nothing to tell a later version of the source apart by, keep the blocks to ourselves
+    m_keyDir.Format("private-%p-%u", (void*)this, XbmcThreads::SystemClockMillis());
+  }
+  m_keyDir = m_directory + m_keyDir;
+  URIUtils::AddSlashAtEnd(m_keyDir);
+}
+
+int CPersistentCache::Open()
+{
+  CSingleLock lock(m_sync);
+
+  if (m_keyDir.IsEmpty())
+    SetSource("", 0, 0);
+
+  if (!CDirectory::Exists(m_directory))
+    CDirectory::Create(m_directory);
+  if (!CDirectory::Exists(m_keyDir) && !CDirectory::Create(m_keyDir))
+  {
+    CLog::Log(LOGERROR, "%s - unable to create %s", __FUNCTION__, m_keyDir.c_str());
+    return CACHE_RC_ERROR;
+  }
+
+  m_stored.clear();
+  m_preexisting.clear();
+  if (m_persistent)
+    LoadBlocks();
+
+  // stamp the source as used for the eviction order, never store credentials on disk
+  CFile stamp;
+  if (stamp.OpenForWrite(m_keyDir + "access", true))
+  {
+    CStdString path = CURL(m_path).GetWithoutUserDetails();
+    stamp.Write(path.c_str(), path.size());
+    stamp.Close();
+  }
+
+  m_head = Block();
+  m_readPos   = 0;
+  m_writePos  = 0;
+  m_readBlock = -1;
+  m_lastBlock = -1;
+  memset(&m_stats, 0, sizeof(m_stats));
+  StartBlock(0);
+  lock.Leave();
+
+  // the first open counts what is on disk, make room if an earlier run left too much behind
+  if (AddUsage(0) > m_budget)
+    Evict();
+
+  return CACHE_RC_OK;
+}
+
+void CPersistentCache::Close()
+{
+  CSingleLock lock(m_sync);
+  m_readFile.Close();
+  m_readBlock = -1;
+
+  if (!m_persistent && !m_keyDir.IsEmpty())
+  {
+    int64_t stored = 0;
+    for (size_t i = 0; i < m_stored.size(); i++)
+    {
+      if (m_stored[i])
+        stored += BlockEnd(i) - (int64_t)i * m_blockSize;
+    }
+    if (RemoveFolder(m_keyDir))
+      AddUsage(-stored);
+  }
+
+  m_keyDir.clear();
+  m_stored.clear();
+  m_preexisting.clear();
+  m_block = Block();
+  m_head  = Block();
+}
+
+CStdString CPersistentCache::GetBlockPath(int64_t index) const
+{
+  CStdString path;
+  path.Format("%s%"PRId64".blk", m_keyDir.c_str(), index);
+  return path;
+}
+
+bool CPersistentCache::IsStored(int64_t index) const
+{
+  return index >= 0 && index < (int64_t)m_stored.size() && m_stored[(size_t)index];
+}
+
+void CPersistentCache::SetStored(int64_t index, bool stored)
+{
+  if (index >= (int64_t)m_stored.size())
+  {
+    if (!stored)
+      return;
+    m_stored.resize((size_t)index + 1, false);
+  }
+  m_stored[(size_t)index] = stored;
+}
+
+int64_t CPersistentCache::BlockEnd(int64_t index) const
+{
+  int64_t end = (index + 1) * m_blockSize;
+  if (m_length > 0 && end > m_length)
+    end = m_length;
+  return end;
+}
+
+/**
+ * Walks the data that can be read from pos on without the source,
+ * block files first and the blocks held in memory after that.
+ * Capped so a reader deep inside a large cached file stays cheap.
+ */
+int64_t CPersistentCache::AvailableEnd(int64_t pos) const
+{
+  int64_t end = pos;
+  for (int i = 0; i < 256; i++)
+  {
+    if (m_length > 0 && end >= m_length)
+      break;
+
+    const int64_t index  = end / m_blockSize;
+    const int64_t offset = end - index * m_blockSize;
+
+    if (IsStored(index))
+      end = BlockEnd(index);
+    else if (m_block.index == index && offset >= m_block.from && offset < m_block.to)
+      end = index * m_blockSize + m_block.to;
+    else if (m_head.index == index && offset >= m_head.from && offset < m_head.to)
+      end = index * m_blockSize + m_head.to;
+    else
+      break;
+  }
+  return end;
+}
+
+void CPersistentCache::StartBlock(int64_t pos)
+{
+  // data that didn't make it to disk may still be read after a reset, keep one such block
+  if (m_block.to > m_block.from && !IsStored(m_block.index))
+  {
+    std::swap(m_head.index, m_block.index);
+    std::swap(m_head.from, m_block.from);
+    std::swap(m_head.to, m_block.to);
+    m_head.data.swap(m_block.data);
+  }
+
+  m_block.index = pos / m_blockSize;
+  m_block.from  = (unsigned int)(pos - m_block.index * m_blockSize);
+  m_block.to    = m_block.from;
+  m_block.data.resize(m_blockSize);
+}
+
+bool CPersistentCache::StoreBlock()
+{
+  // a block that doesn't hold its beginning stays in memory
+  if (m_block.from > 0 || IsStored(m_block.index))
+    return true;
+
+  // other instances may be fetching the same block, write aside and move it in place
+  CStdString path = GetBlockPath(m_block.index);
+  CStdString temp;
+  temp.Format("%s.%p.tmp", path.c_str(), (void*)this);
+
+  CFile file;
+  if (!file.OpenForWrite(temp, true))
+  {
+    CLog::Log(LOGERROR, "%s - unable to create %s", __FUNCTION__, temp.c_str());
+    return false;
+  }
+  int written = file.Write(&m_block.data[0], m_block.to);
+  file.Close();
+
+  if (written != (int)m_block.to)
+  {
+    CLog::Log(LOGERROR, "%s - failed to write %s, disk full?", __FUNCTION__, temp.c_str());
+    CFile::Delete(temp);
+    return false;
+  }
+
+  if (!CFile::Rename(temp, path))
+  {
+    CFile::Delete(temp);
+    if (!CFile::Exists(path, false))
+    {
+      CLog::Log(LOGERROR, "%s - failed to move block into %s", __FUNCTION__, path.c_str());
+      return false;
+    }
+  }
+
+  SetStored(m_block.index, true);
+  AddUsage(m_block.to);
+
+  return true;
+}
+
+void CPersistentCache::LoadBlocks()
+{
+  CFileItemList items;
+  if (!CDirectory::GetDirectory(m_keyDir, items, ".blk", DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_BYPASS_CACHE))
+    return;
+
+  for (int i = 0; i < items.Size(); i++)
+  {
+    const CStdString &path = items[i]->GetPath();
+    int64_t index = _atoi64(URIUtils::GetFileName(path).c_str());
+
+    // anything not exactly the size of its block is left over from a crash
+    if (index < 0 || index * m_blockSize >= m_length
+    ||  items[i]->m_dwSize != BlockEnd(index) - index * m_blockSize)
+    {
+      CFile::Delete(path);
+      continue;
+    }
+
+    SetStored(index, true);
+    if (index >= (int64_t)m_preexisting.size())
+      m_preexisting.resize((size_t)index + 1, false);
+    m_preexisting[(size_t)index] = true;
+  }
+}
+
+/**
+ * Returns the bytes in the cache folder after adding bytes, counting the
+ * folder first if no instance of this process has done so yet.
+ */
+int64_t CPersistentCache::AddUsage(int64_t bytes) const
+{
+  {
+    CSingleLock lock(usageSection);
+    std::map<CStdString, int64_t>::iterator it = usage.find(m_directory);
+    if (it != usage.end())
+      return it->second += bytes;
+  }
+
+  std::vector<CachedSource> sources;
+  int64_t counted = CountSources(m_directory, sources);
+
+  CSingleLock lock(usageSection);
+  std::map<CStdString, int64_t>::iterator it = usage.find(m_directory);
+  if (it == usage.end()) // nobody beat us to it
+    it = usage.insert(std::make_pair(m_directory, counted)).first;
+  return it->second += bytes;
+}
+
+/**
+ * Called without m_sync held, walking the folder can take a while on slow
+ * storage and readers shouldn't stall on it.
+ */
+void CPersistentCache::Evict()
+{
+  CSingleTryLock evicting(evictSection);
+  if (!evicting.IsOwner())
+    return; // another instance is already making room
+
+  CStdString keyDir;
+  {
+    CSingleLock lock(m_sync);
+    keyDir = m_keyDir;
+  }
+
+  // recount, blocks written by other processes only show up this way
+  std::vector<CachedSource> sources;
+  int64_t total = CountSources(m_directory, sources);
+  {
+    CSingleLock lock(usageSection);
+    usage[m_directory] = total;
+  }
+
+  if (total <= m_budget)
+    return;
+
+  // leave some room so we don't evict again on the next block
+  const int64_t target = m_budget - m_budget / 10;
+
+  std::sort(sources.begin(), sources.end());
+  for (size_t i = 0; i < sources.size() && total > target; i++)
+  {
+    if (sources[i].path == keyDir)
+      continue;
+    CLog::Log(LOGDEBUG, "%s - dropping %s", __FUNCTION__, sources[i].path.c_str());
+    RemoveFolder(sources[i].path);
+    total -= sources[i].size;
+    AddUsage(-sources[i].size);
+  }
+
+  if (total <= target)
+    return;
+
+  // still too much, the source itself is larger than the budget
+  CSingleLock lock(m_sync);
+  if (m_keyDir != keyDir)
+    return;
+
+  const int64_t readBlock = m_readPos / m_blockSize;
+  for (int64_t index = 0; index < readBlock && total > target; index++)
+  {
+    if (!IsStored(index))
+      continue;
+    if (index == m_readBlock)
+    {
+      m_readFile.Close();
+      m_readBlock = -1;
+    }
+    CFile::Delete(GetBlockPath(index));
+    SetStored(index, false);
+    int64_t size = BlockEnd(index) - index * m_blockSize;
+    total -= size;
+    AddUsage(-size);
+  }
+}
+
+int CPersistentCache::WriteToCache(const char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  if (m_writePos - m_readPos >= (int64_t)m_maxForward)
+    return 0;
+
+  if (m_writePos / m_blockSize != m_block.index)
+    StartBlock(m_writePos);
+
+  // limit to the end of the block
+  size_t room = m_blockSize - m_block.to;
+  if (len > room)
+    len = room;
+  if (len == 0)
+    return 0;
+
+  memcpy(&m_block.data[m_block.to], buf, len);
+  m_block.to += len;
+  m_writePos += len;
+  m_stats.fetchedBytes += len;
+
+  bool stored = false;
+  if (m_block.to == m_blockSize || (m_length > 0 && m_writePos >= m_length))
+  {
+    if (!StoreBlock())
+      return CACHE_RC_ERROR;
+    StartBlock(m_writePos);
+    stored = true;
+  }
+
+  m_written.Set();
+  lock.Leave();
+
+  if (stored && AddUsage(0) > m_budget)
+    Evict();
+
+  return len;
+}
+
+int CPersistentCache::ReadFromCache(char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  if (m_length > 0 && m_readPos >= m_length)
+    return 0;
+
+  const int64_t  index  = m_readPos / m_blockSize;
+  const unsigned offset = (unsigned)(m_readPos - index * m_blockSize);
+  int read = -1;
+
+  if (IsStored(index))
+  {
+    if (m_readBlock != index)
+    {
+      m_readFile.Close();
+      m_readBlock = m_readFile.Open(GetBlockPath(index)) ? index : -1;
+    }
+
+    size_t avail = (size_t)(BlockEnd(index) - m_readPos);
+    if (m_readBlock == index && m_readFile.Seek(offset, SEEK_SET) == offset)
+      read = (int)m_readFile.Read(buf, std::min(len, avail));
+
+    if (read <= 0)
+    {
+      // dropped by someone else sharing the folder
+      CLog::Log(LOGWARNING, "%s - block %"PRId64" went missing", __FUNCTION__, index);
+      m_readFile.Close();
+      m_readBlock = -1;
+      SetStored(index, false);
+      read = -1;
+    }
+  }
+
+  if (read < 0)
+  {
+    const Block *block = NULL;
+    if (m_block.index == index && offset >= m_block.from && offset < m_block.to)
+      block = &m_block;
+    else if (m_head.index == index && offset >= m_head.from && offset < m_head.to)
+      block = &m_head;
+
+    if (block)
+    {
+      read = (int)std::min<size_t>(len, block->to - offset);
+      memcpy(buf, &block->data[offset], read);
+    }
+  }
+
+  if (read < 0)
+  {
+    if (IsEndOfInput())
+      return 0;
+    else
+      return CACHE_RC_WOULD_BLOCK;
+  }
+
+  bool preexisting = index < (int64_t)m_preexisting.size() && m_preexisting[(size_t)index];
+  if (index != m_lastBlock)
+  {
+    m_lastBlock = index;
+    if (preexisting)
+      m_stats.hits++;
+    else
+      m_stats.misses++;
+  }
+  if (preexisting)
+    m_stats.cachedBytes += read;
+
+  m_readPos += read;
+  m_space.Set();
+
+  return read;
+}
+
+int64_t CPersistentCache::WaitForData(unsigned int minimum, unsigned int millis)
+{
+  CSingleLock lock(m_sync);
+  int64_t avail = AvailableEnd(m_readPos) - m_readPos;
+
+  if (millis == 0 || IsEndOfInput())
+    return avail;
+
+  if (minimum > m_maxForward)
+    minimum = m_maxForward;
+
+  XbmcThreads::EndTime endtime(millis);
+  while (!IsEndOfInput() && avail < minimum && !endtime.IsTimePast())
+  {
+    lock.Leave();
+    m_written.WaitMSec(50);
+    lock.Enter();
+    avail = AvailableEnd(m_readPos) - m_readPos;
+  }
+
+  return avail;
+}
+
+int64_t CPersistentCache::Seek(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+
+  // just past the writer, wait for it rather than seeking the source
+  if (pos > m_writePos && pos < m_writePos + 100000 && m_readPos <= m_writePos
+  &&  AvailableEnd(pos) == pos)
+  {
+    lock.Leave();
+    WaitForData((unsigned int)(pos - m_readPos), 5000);
+    lock.Enter();
+  }
+
+  if (AvailableEnd(pos) > pos || pos == m_writePos || (m_length > 0 && pos == m_length))
+  {
+    m_readPos = pos;
+    m_space.Set();
+    return pos;
+  }
+
+  return CACHE_RC_ERROR;
+}
+
+void CPersistentCache::Reset(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+  StartBlock(pos);
+  m_writePos = pos;
+  m_readPos  = pos;
+  m_space.Set();
+}
+
+void CPersistentCache::EndOfInput()
+{
+  CCacheStrategy::EndOfInput();
+  m_written.Set();
+}
+
+/**
+ * The reader may be ahead of the writer after seeking into blocks that
+ * were on disk already, nothing before it needs fetching then.
+ */
+int64_t CPersistentCache::NextWritePosition(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+  return AvailableEnd(std::max(pos, m_readPos));
+}
+
+void CPersistentCache::SetWritePosition(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+  StartBlock(pos);
+  m_writePos = pos;
+}
+
+bool CPersistentCache::GetStats(SCacheStats *stats)
+{
+  CSingleLock lock(m_sync);
+  *stats = m_stats;
+  return true;
+}
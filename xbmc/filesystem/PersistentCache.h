@@ -0,0 +1,117 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef CACHEPERSISTENT_H
+#define CACHEPERSISTENT_H
+
+#include "CacheStrategy.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "File.h"
+
+#include <vector>
+
+namespace XFILE {
+
+#define PERSISTENT_CACHE_BLOCK_SIZE (1024 * 1024)
+
+/**
+ * Cache that keeps what was fetched in fixed size blocks on local disk,
+ * one file per block in a folder per source. The folder is named after a
+ * hash of the source url, size and modification time, so a changed file
+ * is never served stale data and the blocks are usable by later opens and
+ * other processes.
+ *
+ * The block being written lives in memory until it is complete. Once the
+ * folder grows past the budget the sources opened least recently are
+ * dropped, then the blocks of the current source behind the reader. The
+ * size of the folder is counted once per process and kept as a running
+ * total after that, it is only walked again when evicting.
+ */
+class CPersistentCache : public CCacheStrategy
+{
+public:
+    CPersistentCache(const CStdString &directory, int64_t budget, unsigned int blockSize = PERSISTENT_CACHE_BLOCK_SIZE);
+    virtual ~CPersistentCache();
+
+    virtual void SetSource(const CStdString &path, int64_t length, int64_t mtime);
+    virtual int Open();
+    virtual void Close();
+
+    virtual int WriteToCache(const char *buf, size_t len);
+    virtual int ReadFromCache(char *buf, size_t len);
+    virtual int64_t WaitForData(unsigned int minimum, unsigned int iMillis);
+
+    virtual int64_t Seek(int64_t pos);
+    virtual void Reset(int64_t pos);
+    virtual void EndOfInput();
+
+    virtual int64_t NextWritePosition(int64_t pos);
+    virtual void SetWritePosition(int64_t pos);
+    virtual bool GetStats(SCacheStats *stats);
+
+protected:
+    struct Block
+    {
+      Block() : index(-1), from(0), to(0) {}
+      int64_t           index;
+      unsigned int      from;  /**< valid data in the block starts here */
+      unsigned int      to;    /**< and ends here */
+      std::vector<char> data;
+    };
+
+    CStdString GetBlockPath(int64_t index) const;
+    bool IsStored(int64_t index) const;
+    void SetStored(int64_t index, bool stored);
+    int64_t BlockEnd(int64_t index) const;
+    int64_t AvailableEnd(int64_t pos) const;
+    void StartBlock(int64_t pos);
+    bool StoreBlock();
+    void LoadBlocks();
+    void Evict();
+    int64_t AddUsage(int64_t bytes) const;
+
+    CStdString        m_directory;
+    int64_t           m_budget;
+    unsigned int      m_blockSize;
+    size_t            m_maxForward; /**< how far the writer may get ahead of the reader */
+
+    CStdString        m_path;
+    int64_t           m_length;
+    CStdString        m_keyDir;     /**< folder with the blocks of the current source */
+    bool              m_persistent; /**< false if the source can't be identified, the blocks are dropped on close */
+
+    std::vector<bool> m_stored;     /**< blocks on disk */
+    std::vector<bool> m_preexisting;/**< blocks on disk before the source was opened */
+    Block             m_block;      /**< block being written */
+    Block             m_head;       /**< incomplete block left behind by a reset */
+    int64_t           m_readPos;
+    int64_t           m_writePos;
+    int64_t           m_readBlock;  /**< block m_readFile has open */
+    int64_t           m_lastBlock;  /**< last block the reader was in, for the counters */
+    CFile             m_readFile;
+    SCacheStats       m_stats;
+
+    CCriticalSection  m_sync;
+    CEvent            m_written;
+};
+
+} // namespace XFILE
+#endif
@@ -0,0 +1,140 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/DirectoryCache.h"
+#include "FileItem.h"
+
+#include "gtest/gtest.h"
+
+static void MakeDirectory(const CStdString &path, unsigned int files, CFileItemList &items)
+{
+  items.Clear();
+  for (unsigned int i = 0; i < files; i++)
+  {
+    CStdString file;
+    file.Format("%s/file%u.mkv", path.c_str(), i);
+    items.Add(CFileItemPtr(new CFileItem(file, false)));
+  }
+}
+
+TEST(TestDirectoryCache, FileExists)
+{
+  XFILE::CDirectoryCache cache;
+  CFileItemList items;
+  bool inCache;
+
+  MakeDirectory("/media/movies", 5000, items);
+  cache.SetDirectory("/media/movies/", items, XFILE::DIR_CACHE_ALWAYS);
+
+  EXPECT_TRUE(cache.FileExists("/media/movies/file0.mkv", inCache));
+  EXPECT_TRUE(inCache);
+  EXPECT_TRUE(cache.FileExists("/media/movies/file4999.mkv", inCache));
+  EXPECT_FALSE(cache.FileExists("/media/movies/file5000.mkv", inCache));
+  EXPECT_TRUE(inCache);
+  EXPECT_FALSE(cache.FileExists("/media/other/file0.mkv", inCache));
+  EXPECT_FALSE(inCache);
+
+  cache.AddFile("/media/movies/file5000.mkv");
+  EXPECT_TRUE(cache.FileExists("/media/movies/file5000.mkv", inCache));
+
+  CFileItemList cached;
+  EXPECT_TRUE(cache.GetDirectory("/media/movies", cached));
+  EXPECT_EQ(5001, cached.Size());
+
+  cache.ClearFile("/media/movies/file0.mkv");
+  EXPECT_FALSE(cache.FileExists("/media/movies/file0.mkv", inCache));
+  EXPECT_FALSE(inCache);
+}
+
+TEST(TestDirectoryCache, ClearSubPaths)
+{
+  XFILE::CDirectoryCache cache;
+  CFileItemList items;
+  bool inCache;
+
+  MakeDirectory("/media/tv/show", 3, items);
+  cache.SetDirectory("/media/tv/show", items, XFILE::DIR_CACHE_ALWAYS);
+  MakeDirectory("/media/movies", 3, items);
+  cache.SetDirectory("/media/movies", items, XFILE::DIR_CACHE_ALWAYS);
+
+  cache.ClearSubPaths("/media/tv");
+  cache.FileExists("/media/tv/show/file0.mkv", inCache);
+  EXPECT_FALSE(inCache);
+  EXPECT_TRUE(cache.FileExists("/media/movies/file0.mkv", inCache));
+
+  cache.Clear();
+  cache.FileExists("/media/movies/file0.mkv", inCache);
+  EXPECT_FALSE(inCache);
+}
+
+TEST(TestDirectoryCache, LeastRecentlyUsed)
+{
+  XFILE::CDirectoryCache cache;
+  CFileItemList items;
+  bool inCache;
+
+  MakeDirectory("/media/always", 1, items);
+  cache.SetDirectory("/media/always", items, XFILE::DIR_CACHE_ALWAYS);
+
+  for (unsigned int i = 0; i < 100; i++)
+  {
+    CStdString path;
+    path.Format("/media/dir%u", i);
+    MakeDirectory(path, 1, items);
+    cache.SetDirectory(path, items, XFILE::DIR_CACHE_ONCE);
+
+    // keep the first folder in use
+    EXPECT_TRUE(cache.FileExists("/media/dir0/file0.mkv", inCache));
+  }
+
+  EXPECT_TRUE(cache.FileExists("/media/dir0/file0.mkv", inCache));
+  EXPECT_TRUE(cache.FileExists("/media/dir99/file0.mkv", inCache));
+  EXPECT_TRUE(cache.FileExists("/media/always/file0.mkv", inCache));
+
+  // far more folders than the cache holds, unused ones are gone
+  unsigned int cached = 0;
+  for (unsigned int i = 1; i < 100; i++)
+  {
+    CStdString file;
+    file.Format("/media/dir%u/file0.mkv", i);
+    cache.FileExists(file, inCache);
+    if (inCache)
+      cached++;
+  }
+  EXPECT_LT(cached, 99U);
+}
+
+TEST(TestDirectoryCache, Stats)
+{
+  XFILE::CDirectoryCache cache;
+  CFileItemList items;
+  unsigned int hits, misses;
+  bool inCache;
+
+  MakeDirectory("/media/movies", 10, items);
+  cache.SetDirectory("/media/movies", items, XFILE::DIR_CACHE_ALWAYS);
+
+  cache.FileExists("/media/movies/file1.mkv", inCache);
+  cache.FileExists("/media/movies/file11.mkv", inCache);
+  cache.FileExists("/media/other/file1.mkv", inCache);
+  cache.GetStats(hits, misses);
+  EXPECT_EQ(2U, hits);
+  EXPECT_EQ(1U, misses);
+}
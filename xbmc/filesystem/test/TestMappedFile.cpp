@@ -0,0 +1,162 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/File.h"
+#include "filesystem/MappedFile.h"
+#include "test/TestUtils.h"
+#include "utils/TimeUtils.h"
+#include "URL.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define BENCH_FILE_SIZE (32 * 1024 * 1024)
+#define BENCH_READ_SIZE 32768 // what the ffmpeg demuxer asks for
+#define BENCH_SEEKS     1000
+
+static XFILE::CFile *CreateTestFile(unsigned int size)
+{
+  XFILE::CFile *file = XBMC_CREATETEMPFILE("");
+  if (!file)
+    return NULL;
+  file->Close();
+  if (!file->OpenForWrite(XBMC_TEMPFILEPATH(file), true))
+    return file;
+
+  std::vector<unsigned char> block(65536);
+  srand(0x5EED);
+  for (unsigned int done = 0; done < size; done += block.size())
+  {
+    for (size_t i = 0; i < block.size(); i++)
+      block[i] = rand() & 0xff;
+    file->Write(&block[0], std::min<int64_t>(block.size(), size - done));
+  }
+  file->Close();
+  return file;
+}
+
+/* sequential reads followed by random seeks with a small read each,
+ * the throughput is returned in MB/s and the seek latency in us */
+static void Bench(XFILE::CFile *file, XFILE::CMappedFile *mapped, double &throughput, double &latency)
+{
+  std::vector<unsigned char> buf(BENCH_READ_SIZE);
+
+  int64_t start = CurrentHostCounter();
+  int64_t total = 0;
+  unsigned int ret;
+  do
+  {
+    ret = file ? file->Read(&buf[0], buf.size()) : mapped->Read(&buf[0], buf.size());
+    total += ret;
+  } while (ret > 0);
+  int64_t end = CurrentHostCounter();
+  throughput = end > start ? (double)total / (1024 * 1024) * CurrentHostFrequency() / (end - start) : 0.0;
+
+  srand(1);
+  start = CurrentHostCounter();
+  for (int i = 0; i < BENCH_SEEKS; i++)
+  {
+    int64_t pos = (int64_t)rand() * 4096 % (BENCH_FILE_SIZE - 4096);
+    if (file)
+    {
+      file->Seek(pos, SEEK_SET);
+      file->Read(&buf[0], 4096);
+    }
+    else
+    {
+      mapped->Seek(pos, SEEK_SET);
+      mapped->Read(&buf[0], 4096);
+    }
+  }
+  end = CurrentHostCounter();
+  latency = (double)(end - start) * 1000000 / CurrentHostFrequency() / BENCH_SEEKS;
+}
+
+TEST(TestMappedFile, Read)
+{
+  XFILE::CFile *file, reference;
+  XFILE::CMappedFile mapped;
+  const unsigned int size = 3 * 1024 * 1024 + 123;
+
+  ASSERT_TRUE((file = CreateTestFile(size)) != NULL);
+  ASSERT_TRUE(reference.Open(XBMC_TEMPFILEPATH(file)));
+  ASSERT_TRUE(mapped.Open(CURL(XBMC_TEMPFILEPATH(file))));
+  EXPECT_EQ((int64_t)size, mapped.GetLength());
+  EXPECT_EQ(1, mapped.IoControl(XFILE::IOCTRL_SEEK_POSSIBLE, NULL));
+
+  std::vector<unsigned char> a(100000), b(100000);
+  unsigned int ret;
+  do
+  {
+    ret = reference.Read(&a[0], a.size());
+    ASSERT_EQ(ret, mapped.Read(&b[0], b.size()));
+    ASSERT_TRUE(memcmp(&a[0], &b[0], ret) == 0);
+  } while (ret > 0);
+  EXPECT_EQ((int64_t)size, mapped.GetPosition());
+
+  EXPECT_EQ(1000, mapped.Seek(1000, SEEK_SET));
+  EXPECT_EQ(1500, mapped.Seek(500, SEEK_CUR));
+  EXPECT_EQ((int64_t)size - 10, mapped.Seek(-10, SEEK_END));
+  EXPECT_EQ(10U, mapped.Read(&b[0], b.size()));
+  EXPECT_EQ(0U, mapped.Read(&b[0], b.size()));
+  EXPECT_EQ(-1, mapped.Seek(-1, SEEK_SET));
+
+  reference.Seek(2 * 1024 * 1024 + 7, SEEK_SET);
+  mapped.Seek(2 * 1024 * 1024 + 7, SEEK_SET);
+  EXPECT_EQ(reference.Read(&a[0], 4096), mapped.Read(&b[0], 4096));
+  EXPECT_TRUE(memcmp(&a[0], &b[0], 4096) == 0);
+
+  mapped.Close();
+  reference.Close();
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
+
+TEST(TestMappedFile, Missing)
+{
+  XFILE::CMappedFile mapped;
+  EXPECT_FALSE(mapped.Open(CURL("/nonexistent/path/to/file")));
+  EXPECT_EQ(0U, mapped.Read(NULL, 100));
+}
+
+TEST(TestMappedFile, Benchmark)
+{
+  XFILE::CFile *file, reference;
+  XFILE::CMappedFile mapped;
+
+  ASSERT_TRUE((file = CreateTestFile(BENCH_FILE_SIZE)) != NULL);
+  ASSERT_TRUE(reference.Open(XBMC_TEMPFILEPATH(file), READ_TRUNCATED | READ_CHUNKED));
+  ASSERT_TRUE(mapped.Open(CURL(XBMC_TEMPFILEPATH(file))));
+
+  double fileThroughput, fileLatency, mappedThroughput, mappedLatency;
+  Bench(&reference, NULL, fileThroughput, fileLatency);
+  Bench(NULL, &mapped, mappedThroughput, mappedLatency);
+  std::cout << "CFile: "       << fileThroughput   << " MB/s, " << fileLatency   << " us per seek" << std::endl
+            << "CMappedFile: " << mappedThroughput << " MB/s, " << mappedLatency << " us per seek" << std::endl;
+  EXPECT_GT(mappedThroughput, 0.0);
+
+  mapped.Close();
+  reference.Close();
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
@@ -0,0 +1,198 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/FileCache.h"
+#include "filesystem/PersistentCache.h"
+#include "FileItem.h"
+#include "test/TestUtils.h"
+#include "URL.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define TEST_BLOCK_SIZE 4096
+#define TEST_DIRECTORY  "special://temp/persistentcachetest/"
+
+static XFILE::CFile *CreateTestFile(unsigned int size, int seed)
+{
+  XFILE::CFile *file = XBMC_CREATETEMPFILE("");
+  if (!file)
+    return NULL;
+  file->Close();
+  if (!file->OpenForWrite(XBMC_TEMPFILEPATH(file), true))
+    return file;
+
+  std::vector<unsigned char> data(size);
+  srand(seed);
+  for (unsigned int i = 0; i < size; i++)
+    data[i] = rand() & 0xff;
+  file->Write(&data[0], size);
+  file->Close();
+  return file;
+}
+
+static void RemoveCache()
+{
+  CFileItemList items;
+  XFILE::CDirectory::GetDirectory(TEST_DIRECTORY, items, "", XFILE::DIR_FLAG_NO_FILE_DIRS | XFILE::DIR_FLAG_BYPASS_CACHE);
+  for (int i = 0; i < items.Size(); i++)
+  {
+    CFileItemList blocks;
+    XFILE::CDirectory::GetDirectory(items[i]->GetPath(), blocks, "", XFILE::DIR_FLAG_NO_FILE_DIRS | XFILE::DIR_FLAG_BYPASS_CACHE);
+    for (int j = 0; j < blocks.Size(); j++)
+      XFILE::CFile::Delete(blocks[j]->GetPath());
+    XFILE::CDirectory::Remove(items[i]->GetPath());
+  }
+  XFILE::CDirectory::Remove(TEST_DIRECTORY);
+}
+
+/* reads the whole file through a file cache backed by a persistent
+ * cache, comparing with a direct read */
+static bool ReadThrough(XFILE::CFile *file, int64_t budget, XFILE::SCacheStats &stats)
+{
+  XFILE::CFile reference;
+  XFILE::CFileCache cache(new XFILE::CPersistentCache(TEST_DIRECTORY, budget, TEST_BLOCK_SIZE));
+  if (!reference.Open(XBMC_TEMPFILEPATH(file)) || !cache.Open(CURL(XBMC_TEMPFILEPATH(file))))
+    return false;
+
+  std::vector<char> a(10000), b(10000);
+  unsigned int ret;
+  do
+  {
+    ret = reference.Read(&a[0], a.size());
+    unsigned int got = 0, n;
+    while (got < ret && (n = cache.Read(&b[got], ret - got)) > 0)
+      got += n;
+    if (got != ret || memcmp(&a[0], &b[0], ret) != 0)
+      return false;
+  } while (ret > 0);
+
+  bool ok = cache.IoControl(XFILE::IOCTRL_CACHE_STATS, &stats) == 0;
+  cache.Close();
+  return ok;
+}
+
+TEST(TestPersistentCache, Strategy)
+{
+  const unsigned int size = 10 * TEST_BLOCK_SIZE + 100;
+  std::vector<char> data(size), buf(size);
+  for (unsigned int i = 0; i < size; i++)
+    data[i] = (char)(i * 7);
+
+  XFILE::CPersistentCache cache(TEST_DIRECTORY, 1024 * 1024, TEST_BLOCK_SIZE);
+  cache.SetSource("dummy://file", size, 1);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  // the writer stays a limited distance ahead, so read as we go
+  unsigned int written = 0, read = 0;
+  while (read < size)
+  {
+    int ret = cache.WriteToCache(&data[written], std::min<unsigned int>(3000, size - written));
+    ASSERT_GE(ret, 0);
+    written += ret;
+    while ((ret = cache.ReadFromCache(&buf[read], 1000)) > 0)
+      read += ret;
+  }
+  cache.EndOfInput();
+  EXPECT_EQ(0, memcmp(&data[0], &buf[0], size));
+  EXPECT_EQ(0, cache.ReadFromCache(&buf[0], 1000));
+
+  // completed blocks are on disk, seeking back doesn't need the source
+  EXPECT_EQ(5000, cache.Seek(5000));
+  EXPECT_EQ(1000, cache.ReadFromCache(&buf[0], 1000));
+  EXPECT_EQ(0, memcmp(&data[5000], &buf[0], 1000));
+
+  // nothing needs fetching after a reset into cached data
+  cache.ClearEndOfInput();
+  cache.Reset(2 * TEST_BLOCK_SIZE);
+  EXPECT_EQ((int64_t)size, cache.NextWritePosition(2 * TEST_BLOCK_SIZE));
+
+  XFILE::SCacheStats stats;
+  EXPECT_TRUE(cache.GetStats(&stats));
+  EXPECT_EQ((uint64_t)size, stats.fetchedBytes);
+  EXPECT_EQ(0U, stats.hits);
+  cache.Close();
+
+  // a second open finds the blocks
+  XFILE::CPersistentCache again(TEST_DIRECTORY, 1024 * 1024, TEST_BLOCK_SIZE);
+  again.SetSource("dummy://file", size, 1);
+  ASSERT_EQ(CACHE_RC_OK, again.Open());
+  EXPECT_EQ((int64_t)size, again.NextWritePosition(0));
+  EXPECT_EQ(1000, again.ReadFromCache(&buf[0], 1000));
+  EXPECT_EQ(0, memcmp(&data[0], &buf[0], 1000));
+  EXPECT_TRUE(again.GetStats(&stats));
+  EXPECT_EQ(1U, stats.hits);
+  again.Close();
+
+  // a changed source doesn't
+  again.SetSource("dummy://file", size, 2);
+  ASSERT_EQ(CACHE_RC_OK, again.Open());
+  EXPECT_EQ(0, again.NextWritePosition(0));
+  again.Close();
+
+  RemoveCache();
+}
+
+TEST(TestPersistentCache, ReadThrough)
+{
+  XFILE::CFile *file;
+  XFILE::SCacheStats stats;
+  const unsigned int size = 50 * TEST_BLOCK_SIZE + 123;
+
+  ASSERT_TRUE((file = CreateTestFile(size, 1)) != NULL);
+  ASSERT_TRUE(ReadThrough(file, 1024 * 1024, stats));
+  EXPECT_EQ(0U, stats.hits);
+  EXPECT_EQ((uint64_t)size, stats.fetchedBytes);
+
+  ASSERT_TRUE(ReadThrough(file, 1024 * 1024, stats));
+  EXPECT_EQ(0U, stats.misses);
+  EXPECT_EQ((uint64_t)size, stats.cachedBytes);
+  EXPECT_EQ(0U, stats.fetchedBytes);
+
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+  RemoveCache();
+}
+
+TEST(TestPersistentCache, Budget)
+{
+  XFILE::CFile *first, *second;
+  XFILE::SCacheStats stats;
+  const unsigned int size = 6 * TEST_BLOCK_SIZE;
+  const int64_t budget = 8 * TEST_BLOCK_SIZE;
+
+  ASSERT_TRUE((first = CreateTestFile(size, 1)) != NULL);
+  ASSERT_TRUE((second = CreateTestFile(size, 2)) != NULL);
+  ASSERT_TRUE(ReadThrough(first, budget, stats));
+  ASSERT_TRUE(ReadThrough(second, budget, stats));
+
+  // the first source was dropped to make room for the second
+  ASSERT_TRUE(ReadThrough(first, budget, stats));
+  EXPECT_EQ(0U, stats.hits);
+  EXPECT_EQ((uint64_t)size, stats.fetchedBytes);
+
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(first));
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(second));
+  RemoveCache();
+}
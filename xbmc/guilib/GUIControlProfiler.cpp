@@ -21,11 +21,15 @@
 #include "GUIControlProfiler.h"
 #include "utils/XBMCTinyXML.h"
 #include "utils/TimeUtils.h"
+#include "TextureManager.h"
+#include "TextureAtlas.h"
+#include "GUIFontGlyphAtlas.h"
+#include "GUIInfoManager.h"
 
 bool CGUIControlProfiler::m_bIsRunning = false;
 
 CGUIControlProfilerItem::CGUIControlProfilerItem(CGUIControlProfiler *pProfiler, CGUIControlProfilerItem *pParent, CGUIControl *pControl)
-: m_pProfiler(pProfiler), m_pParent(pParent), m_pControl(pControl), m_visTime(0), m_renderTime(0), m_i64VisStart(0), m_i64RenderStart(0)
+: m_pProfiler(pProfiler), m_pParent(pParent), m_pControl(pControl), m_visTime(0), m_renderTime(0), m_i64VisStart(0), m_i64RenderStart(0), m_drawCalls(0), m_vertices(0), m_textureBinds(0)
 {
   if (m_pControl)
   {
@@ -53,6 +57,9 @@ void CGUIControlProfilerItem::Reset(CGUIControlProfiler *pProfiler)
 
   m_visTime = 0;
   m_renderTime = 0;
+  m_drawCalls = 0;
+  m_vertices = 0;
+  m_textureBinds = 0;
   const unsigned int dwSize = m_vecChildren.size();
   for (unsigned int i=0; i<dwSize; ++i)
     delete m_vecChildren[i];
@@ -203,6 +210,33 @@ void CGUIControlProfilerItem::SaveToXML(TiXmlElement *parent)
     elem->LinkEndChild(text);
   }
 
+  // draw calls and vertices include the ones of the children
+  if (m_drawCalls || m_vertices)
+  {
+    CStdString val;
+    TiXmlElement *elem = new TiXmlElement("drawcalls");
+    xmlControl->LinkEndChild(elem);
+    val.Format("%u", m_drawCalls);
+    TiXmlText *text = new TiXmlText(val.c_str());
+    elem->LinkEndChild(text);
+
+    elem = new TiXmlElement("vertices");
+    xmlControl->LinkEndChild(elem);
+    val.Format("%u", m_vertices);
+    text = new TiXmlText(val.c_str());
+    elem->LinkEndChild(text);
+  }
+
+  if (m_textureBinds)
+  {
+    CStdString val;
+    TiXmlElement *elem = new TiXmlElement("texturebinds");
+    xmlControl->LinkEndChild(elem);
+    val.Format("%u", m_textureBinds);
+    TiXmlText *text = new TiXmlText(val.c_str());
+    elem->LinkEndChild(text);
+  }
+
   if (m_vecChildren.size())
   {
     TiXmlElement *xmlChilds = new TiXmlElement("children");
@@ -238,7 +272,7 @@ CGUIControlProfilerItem *CGUIControlProfilerItem::FindOrAddControl(CGUIControl *
 }
 
 CGUIControlProfiler::CGUIControlProfiler(void)
-: m_ItemHead(NULL, NULL, NULL), m_pLastItem(NULL), m_iMaxFrameCount(200), m_iFrameCount(0)
+: m_ItemHead(NULL, NULL, NULL), m_pLastItem(NULL), m_pRenderItem(NULL), m_iMaxFrameCount(200), m_iFrameCount(0)
 // m_bIsRunning(false), no isRunning because it is static
 {
   m_fPerfScale = 100000.0f / CurrentHostFrequency();
@@ -260,7 +294,9 @@ void CGUIControlProfiler::Start(void)
   m_iFrameCount = 0;
   m_bIsRunning = true;
   m_pLastItem = NULL;
+  m_pRenderItem = NULL;
   m_ItemHead.Reset(this);
+  g_infoManager.ResetBoolStats();
 }
 
 void CGUIControlProfiler::BeginVisibility(CGUIControl *pControl)
@@ -279,12 +315,33 @@ void CGUIControlProfiler::BeginRender(CGUIControl *pControl)
 {
   CGUIControlProfilerItem *item = FindOrAddControl(pControl);
   item->BeginRender();
+  m_pRenderItem = item;
 }
 
 void CGUIControlProfiler::EndRender(CGUIControl *pControl)
 {
   CGUIControlProfilerItem *item = FindOrAddControl(pControl);
   item->EndRender();
+  m_pRenderItem = item->m_pParent;
+}
+
+void CGUIControlProfiler::AddDrawCall(void)
+{
+  // attributed to the control being rendered and all its parents
+  for (CGUIControlProfilerItem *item = m_pRenderItem ? m_pRenderItem : &m_ItemHead; item; item = item->m_pParent)
+    item->m_drawCalls++;
+}
+
+void CGUIControlProfiler::AddVertices(unsigned int count)
+{
+  for (CGUIControlProfilerItem *item = m_pRenderItem ? m_pRenderItem : &m_ItemHead; item; item = item->m_pParent)
+    item->m_vertices += count;
+}
+
+void CGUIControlProfiler::AddTextureBind(void)
+{
+  for (CGUIControlProfilerItem *item = m_pRenderItem ? m_pRenderItem : &m_ItemHead; item; item = item->m_pParent)
+    item->m_textureBinds++;
 }
 
 CGUIControlProfilerItem *CGUIControlProfiler::FindOrAddControl(CGUIControl *pControl)
@@ -329,6 +386,7 @@ void CGUIControlProfiler::EndFrame(void)
     }
 
     m_bIsRunning = false;
+    m_pRenderItem = NULL;
     if (SaveResults())
       m_ItemHead.Reset(this);
   }
@@ -350,6 +408,56 @@ bool CGUIControlProfiler::SaveResults(void)
   root->SetAttribute("timeunit", "ms");
   doc.LinkEndChild(root);
 
+  // how well the small skin images are packed
+  for (unsigned int i = 0; i < g_TextureManager.GetAtlasCount(); i++)
+  {
+    const CTextureAtlas *atlas = g_TextureManager.GetAtlas(i);
+    TiXmlElement *elem = new TiXmlElement("textureatlas");
+    str.Format("%u", atlas->GetSize());
+    elem->SetAttribute("size", str.c_str());
+    str.Format("%u", atlas->GetImageCount());
+    elem->SetAttribute("images", str.c_str());
+    str.Format("%.0f", atlas->GetOccupancy() * 100);
+    elem->SetAttribute("occupancy", str.c_str());
+    root->LinkEndChild(elem);
+  }
+
+  // how often glyphs and the vertices of whole texts could be reused
+  CGUIFontGlyphAtlas &glyphs = CGUIFontGlyphAtlas::Get();
+  const CGUIFontGlyphAtlas::Stats &stats = glyphs.GetStats();
+  TiXmlElement *fontCache = new TiXmlElement("fontcache");
+  str.Format("%u", stats.glyphHits);
+  fontCache->SetAttribute("glyphhits", str.c_str());
+  str.Format("%u", stats.glyphMisses);
+  fontCache->SetAttribute("glyphmisses", str.c_str());
+  str.Format("%u", stats.evictions);
+  fontCache->SetAttribute("evictions", str.c_str());
+  str.Format("%u", stats.runHits);
+  fontCache->SetAttribute("runhits", str.c_str());
+  str.Format("%u", stats.runMisses);
+  fontCache->SetAttribute("runmisses", str.c_str());
+  str.Format("%.0f", glyphs.GetOccupancy() * 100);
+  fontCache->SetAttribute("occupancy", str.c_str());
+  root->LinkEndChild(fontCache);
+  glyphs.ResetStats();
+
+  // how many conditions had to be evaluated per frame, and how long that took
+  CGUIInfoManager::BoolStats boolStats;
+  g_infoManager.GetBoolStats(boolStats);
+  int frames = m_iFrameCount > 0 ? m_iFrameCount : 1;
+  TiXmlElement *infoBools = new TiXmlElement("infobools");
+  str.Format("%u", boolStats.conditions);
+  infoBools->SetAttribute("conditions", str.c_str());
+  str.Format("%u", boolStats.polled);
+  infoBools->SetAttribute("polled", str.c_str());
+  str.Format("%u", boolStats.lookups / frames);
+  infoBools->SetAttribute("lookups", str.c_str());
+  str.Format("%u", boolStats.evaluations / frames);
+  infoBools->SetAttribute("evaluations", str.c_str());
+  str.Format("%.3f", 1000.0 * boolStats.time / CurrentHostFrequency() / frames);
+  infoBools->SetAttribute("time", str.c_str());
+  root->LinkEndChild(infoBools);
+
   m_ItemHead.SaveToXML(root);
   return doc.SaveFile(m_strOutputFile);
 }
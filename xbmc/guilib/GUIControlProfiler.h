@@ -41,6 +41,9 @@ public:
   unsigned int m_renderTime;
   int64_t m_i64VisStart;
   int64_t m_i64RenderStart;
+  unsigned int m_drawCalls;
+  unsigned int m_vertices;
+  unsigned int m_textureBinds;
 
   CGUIControlProfilerItem(CGUIControlProfiler *pProfiler, CGUIControlProfilerItem *pParent, CGUIControl *pControl);
   ~CGUIControlProfilerItem(void);
@@ -69,6 +72,9 @@ public:
   void EndVisibility(CGUIControl *pControl);
   void BeginRender(CGUIControl *pControl);
   void EndRender(CGUIControl *pControl);
+  void AddDrawCall(void);
+  void AddVertices(unsigned int count);
+  void AddTextureBind(void);
   int GetMaxFrameCount(void) const { return m_iMaxFrameCount; };
   void SetMaxFrameCount(int iMaxFrameCount) { m_iMaxFrameCount = iMaxFrameCount; };
   void SetOutputFile(const CStdString &strOutputFile) { m_strOutputFile = strOutputFile; };
@@ -85,6 +91,7 @@ private:
 
   CGUIControlProfilerItem m_ItemHead;
   CGUIControlProfilerItem *m_pLastItem;
+  CGUIControlProfilerItem *m_pRenderItem;
   CGUIControlProfilerItem *FindOrAddControl(CGUIControl *pControl);
 
   static bool m_bIsRunning;
@@ -97,5 +104,8 @@ private:
 #define GUIPROFILER_VISIBILITY_END(x) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().EndVisibility(x); }
 #define GUIPROFILER_RENDER_BEGIN(x) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().BeginRender(x); }
 #define GUIPROFILER_RENDER_END(x) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().EndRender(x); }
+#define GUIPROFILER_DRAWCALL() { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().AddDrawCall(); }
+#define GUIPROFILER_VERTICES(x) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().AddVertices(x); }
+#define GUIPROFILER_TEXTUREBIND() { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().AddTextureBind(); }
 
 #endif
@@ -0,0 +1,220 @@
+/*
+*      Copyright (C) 2005-2012 Team XBMC
+*      http://www.xbmc.org
+*
+*  This Program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2, or (at your option)
+*  any later version.
+*
+*  This Program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with XBMC; see the file COPYING.  If not, see
+*  <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "GUIFontGlyphAtlas.h"
+#include "Texture.h"
+#include "windowing/WindowingFactory.h"
+#include "utils/log.h"
+
+#include <string.h>
+#include <algorithm>
+
+#define GLYPH_ATLAS_SIZE 2048
+#define GLYPH_SPACING    1   // empty pixels around each glyph so filtering doesn't pick up the neighbours
+#define SHELF_ROUNDING   4   // shelf heights are rounded up to this so glyphs of similar height share shelves
+
+CGUIFontGlyphAtlas::CGUIFontGlyphAtlas()
+{
+  m_size = 0;
+  m_clock = 0;
+  m_generation = 0;
+  m_evictionCount = 0;
+  m_pixels = NULL;
+  m_dirtyStart = m_dirtyEnd = 0;
+  m_texture = NULL;
+  ResetStats();
+}
+
+CGUIFontGlyphAtlas::~CGUIFontGlyphAtlas()
+{
+  delete m_texture;
+  delete[] m_pixels;
+}
+
+CGUIFontGlyphAtlas &CGUIFontGlyphAtlas::Get()
+{
+  static CGUIFontGlyphAtlas atlas;
+  return atlas;
+}
+
+unsigned char *CGUIFontGlyphAtlas::Add(unsigned int width, unsigned int height, unsigned int &x, unsigned int &y, unsigned int &shelf, unsigned int &generation)
+{
+  if (!m_pixels)
+  {
+    m_size = std::min((unsigned int)GLYPH_ATLAS_SIZE, g_Windowing.GetMaxTextureSize());
+    m_pixels = new unsigned char[m_size * m_size];
+    memset(m_pixels, 0, m_size * m_size);
+  }
+
+  if (!FindShelf(width + GLYPH_SPACING, height + GLYPH_SPACING, shelf))
+  {
+    CLog::Log(LOGERROR, "%s - no room for a glyph of %ux%u pixels", __FUNCTION__, width, height);
+    return NULL;
+  }
+
+  CShelf &s = m_shelves[shelf];
+  x = s.width;
+  y = s.y;
+  generation = s.generation;
+  s.width += width + GLYPH_SPACING;
+  s.lastUsed = ++m_clock;
+
+  MarkDirty(y, height);
+  m_stats.glyphMisses++;
+  return m_pixels + y * m_size + x;
+}
+
+CBaseTexture *CGUIFontGlyphAtlas::GetTexture()
+{
+  if (!m_texture && m_pixels)
+  {
+    m_texture = new CTexture();
+    m_texture->Update(m_size, m_size, m_size, XB_FMT_A8, m_pixels, false);
+    m_dirtyStart = m_dirtyEnd = 0;
+  }
+  return m_texture;
+}
+
+const unsigned char *CGUIFontGlyphAtlas::GetDirtyRows(unsigned int &first, unsigned int &count)
+{
+  if (m_dirtyEnd <= m_dirtyStart)
+    return NULL;
+
+  first = m_dirtyStart;
+  count = m_dirtyEnd - m_dirtyStart;
+  m_dirtyStart = m_dirtyEnd = 0;
+  return m_pixels + first * m_size;
+}
+
+void CGUIFontGlyphAtlas::Clear()
+{
+  delete m_texture;
+  m_texture = NULL;
+  delete[] m_pixels;
+  m_pixels = NULL;
+  m_shelves.clear();
+  m_dirtyStart = m_dirtyEnd = 0;
+  // fonts still holding on to glyphs have to notice that they're gone
+  m_evictionCount++;
+}
+
+void CGUIFontGlyphAtlas::ResetStats()
+{
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
+float CGUIFontGlyphAtlas::GetOccupancy() const
+{
+  if (!m_size)
+    return 0.0f;
+
+  unsigned int used = 0;
+  for (std::vector<CShelf>::const_iterator i = m_shelves.begin(); i != m_shelves.end(); ++i)
+    used += i->width * i->height;
+  return (float)used / (m_size * m_size);
+}
+
+bool CGUIFontGlyphAtlas::FindShelf(unsigned int width, unsigned int height, unsigned int &shelf)
+{
+  height = (height + SHELF_ROUNDING - 1) / SHELF_ROUNDING * SHELF_ROUNDING;
+  if (width + GLYPH_SPACING > m_size || height + GLYPH_SPACING > m_size)
+    return false;
+
+  // use the lowest shelf with room that doesn't waste more than half of its height
+  unsigned int best = NO_SHELF;
+  for (unsigned int i = 0; i < m_shelves.size(); i++)
+  {
+    const CShelf &s = m_shelves[i];
+    if (s.height >= height && s.height <= 2 * height && s.width + width <= m_size &&
+        (best == NO_SHELF || s.height < m_shelves[best].height))
+      best = i;
+  }
+  if (best != NO_SHELF)
+  {
+    shelf = best;
+    return true;
+  }
+
+  // start a new shelf if there's room left (the glyphs have empty pixels to their right and
+  // below, so only the top and left edge of the atlas need extra spacing)
+  unsigned int top = m_shelves.empty() ? GLYPH_SPACING : m_shelves.back().y + m_shelves.back().height;
+  if (top + height <= m_size)
+  {
+    CShelf s;
+    s.y = top;
+    s.height = height;
+    s.width = GLYPH_SPACING;
+    s.lastUsed = m_clock;
+    s.generation = ++m_generation;
+    m_shelves.push_back(s);
+    shelf = m_shelves.size() - 1;
+    return true;
+  }
+
+  // the atlas is full, so reuse the least recently used shelf of a suitable height
+  for (unsigned int i = 0; i < m_shelves.size(); i++)
+  {
+    const CShelf &s = m_shelves[i];
+    if (s.height >= height && s.height <= 2 * height &&
+        (best == NO_SHELF || s.lastUsed < m_shelves[best].lastUsed))
+      best = i;
+  }
+  if (best != NO_SHELF)
+  {
+    EmptyShelf(m_shelves[best]);
+    shelf = best;
+    return true;
+  }
+
+  // none of the shelves fit the glyph, so start over
+  CLog::Log(LOGDEBUG, "%s - no shelf of height %u, clearing %u shelves", __FUNCTION__, height, (unsigned int)m_shelves.size());
+  memset(m_pixels, 0, m_size * m_size);
+  MarkDirty(0, m_size);
+  m_shelves.clear();
+  m_evictionCount++;
+  m_stats.evictions++;
+  return FindShelf(width, height, shelf);
+}
+
+void CGUIFontGlyphAtlas::EmptyShelf(CShelf &shelf)
+{
+  for (unsigned int y = shelf.y; y < shelf.y + shelf.height; y++)
+    memset(m_pixels + y * m_size, 0, shelf.width);
+  MarkDirty(shelf.y, shelf.height);
+
+  shelf.width = GLYPH_SPACING;
+  shelf.generation = ++m_generation;
+  m_evictionCount++;
+  m_stats.evictions++;
+}
+
+void CGUIFontGlyphAtlas::MarkDirty(unsigned int y, unsigned int height)
+{
+  if (m_dirtyEnd <= m_dirtyStart)
+  {
+    m_dirtyStart = y;
+    m_dirtyEnd = y + height;
+  }
+  else
+  {
+    m_dirtyStart = std::min(m_dirtyStart, y);
+    m_dirtyEnd = std::max(m_dirtyEnd, y + height);
+  }
+}
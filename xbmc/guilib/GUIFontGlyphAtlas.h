@@ -0,0 +1,145 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*!
+\file GUIFontGlyphAtlas.h
+\brief
+*/
+
+#ifndef GUILIB_GUIFONTGLYPHATLAS_H
+#define GUILIB_GUIFONTGLYPHATLAS_H
+
+#include <vector>
+#include <stdint.h>
+
+class CBaseTexture;
+
+/*!
+ \ingroup textures
+ \brief Texture holding the rendered glyphs of all fonts.
+
+ Glyphs are packed into shelves (rows of glyphs of about the same height),
+ so glyphs of different fonts and sizes share a single texture and can be
+ drawn together. When there's no room left for a new glyph, the least
+ recently used shelf of a suitable height is emptied and reused.
+
+ Fonts hold on to the shelf and generation of each glyph they cached and
+ check them with Use() before drawing, a glyph whose shelf was reused in the
+ meantime has to be cached again.
+ */
+class CGUIFontGlyphAtlas
+{
+public:
+  static const unsigned int NO_SHELF = (unsigned int)-1; ///< shelf of glyphs without any pixels
+
+  struct Stats
+  {
+    unsigned int glyphHits;    ///< glyphs found in the atlas
+    unsigned int glyphMisses;  ///< glyphs that had to be rendered into the atlas
+    unsigned int evictions;    ///< shelves that were emptied to make room
+    unsigned int runHits;      ///< texts drawn from previously built vertices
+    unsigned int runMisses;    ///< texts that had to be laid out
+  };
+
+  static CGUIFontGlyphAtlas &Get();
+
+  /*! \brief Allocate room for a glyph
+   \param width width of the glyph in pixels.
+   \param height height of the glyph in pixels.
+   \param x [out] horizontal position of the glyph in the atlas.
+   \param y [out] vertical position of the glyph in the atlas.
+   \param shelf [out] shelf of the glyph, to be passed to Use().
+   \param generation [out] generation of the shelf, to be passed to Use().
+   \return the pixels of the glyph (with a pitch of GetSize()), NULL if the glyph doesn't fit.
+   */
+  unsigned char *Add(unsigned int width, unsigned int height, unsigned int &x, unsigned int &y, unsigned int &shelf, unsigned int &generation);
+
+  /*! \brief Check that a glyph is still in the atlas and mark it as used
+   \return false if the shelf of the glyph has been reused since it was added.
+   */
+  inline bool Use(unsigned int shelf, unsigned int generation)
+  {
+    if (shelf == NO_SHELF)
+      return true;
+    if (shelf >= m_shelves.size() || m_shelves[shelf].generation != generation)
+      return false;
+    m_shelves[shelf].lastUsed = ++m_clock;
+    return true;
+  }
+
+  /*! \brief Texture holding the glyphs, created with all glyphs added so far on first use
+   \sa GetDirtyRows
+   */
+  CBaseTexture *GetTexture();
+
+  /*! \brief Fetch the rows of the texture that changed since the texture was created or last updated
+   The rows are marked as up to date, so the caller must copy them to the texture.
+   \param first [out] first row that changed.
+   \param count [out] number of rows that changed.
+   \return the pixels of the first row (with a pitch of GetSize()), NULL if nothing changed.
+   */
+  const unsigned char *GetDirtyRows(unsigned int &first, unsigned int &count);
+
+  /*! \brief Release the texture and all glyphs, called once all fonts are unloaded */
+  void Clear();
+
+  unsigned int GetSize() const { return m_size; };
+
+  /*! \brief number of times glyphs have been removed from the atlas.
+   Anything that holds on to glyph positions has to be recomputed when this changes.
+   */
+  unsigned int GetEvictionCount() const { return m_evictionCount; };
+
+  Stats &GetStats() { return m_stats; };
+  void ResetStats();
+  float GetOccupancy() const;
+
+private:
+  CGUIFontGlyphAtlas();
+  ~CGUIFontGlyphAtlas();
+  CGUIFontGlyphAtlas(const CGUIFontGlyphAtlas &);
+  CGUIFontGlyphAtlas &operator=(const CGUIFontGlyphAtlas &);
+
+  struct CShelf
+  {
+    unsigned int y;          ///< top of the shelf
+    unsigned int height;     ///< height of the shelf
+    unsigned int width;      ///< used width of the shelf
+    unsigned int lastUsed;   ///< value of m_clock when a glyph on the shelf was last used
+    unsigned int generation; ///< changes whenever the shelf is emptied
+  };
+
+  bool FindShelf(unsigned int width, unsigned int height, unsigned int &shelf);
+  void EmptyShelf(CShelf &shelf);
+  void MarkDirty(unsigned int y, unsigned int height);
+
+  std::vector<CShelf> m_shelves;
+  unsigned int m_size;
+  unsigned int m_clock;
+  unsigned int m_generation;
+  unsigned int m_evictionCount;
+  unsigned char *m_pixels;
+  unsigned int m_dirtyStart;
+  unsigned int m_dirtyEnd;
+  CBaseTexture *m_texture;
+  Stats m_stats;
+};
+
+#endif
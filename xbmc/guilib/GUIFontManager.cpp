@@ -23,6 +23,7 @@
 #include "GUIWindowManager.h"
 #include "addons/Skin.h"
 #include "GUIFontTTF.h"
+#include "GUIFontGlyphAtlas.h"
 #include "GUIFont.h"
 #include "utils/XMLUtils.h"
 #include "GUIControlFactory.h"
@@ -345,6 +346,9 @@ void GUIFontManager::Clear()
   m_vecFontFiles.clear();
   m_vecFontInfo.clear();
   m_fontsetUnicode=false;
+
+  // all glyphs are gone with the fonts
+  CGUIFontGlyphAtlas::Get().Clear();
 }
 
 void GUIFontManager::LoadFonts(const CStdString& strFontSet)
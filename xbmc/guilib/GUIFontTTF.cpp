@@ -21,6 +21,7 @@
 #include "GUIFont.h"
 #include "GUIFontTTF.h"
 #include "GUIFontManager.h"
+#include "GUIFontGlyphAtlas.h"
 #include "Texture.h"
 #include "GraphicContext.h"
 #include "filesystem/SpecialProtocol.h"
@@ -29,6 +30,7 @@
 #include "windowing/WindowingFactory.h"
 
 #include <math.h>
+#include <algorithm>
 
 // stuff for freetype
 #include <ft2build.h>
@@ -46,8 +48,8 @@
 using namespace std;
 
 
-#define CHARS_PER_TEXTURE_LINE 20 // number of characters to cache per texture line
 #define CHAR_CHUNK    64      // 64 chars allocated at a time (1024 bytes)
+#define MAX_GLYPH_RUNS 128    // texts whose vertices are kept for reuse
 
 int CGUIFontTTFBase::justification_word_weight = 6;   // weight of word spacing over letter spacing when justifying.
                                                   // A larger number means more of the "dead space" is placed between
@@ -133,12 +135,10 @@ XBMC_GLOBAL_REF(CFreeTypeLibrary, g_freeTypeLibrary); // our freetype library
 
 CGUIFontTTFBase::CGUIFontTTFBase(const CStdString& strFileName)
 {
-  m_texture = NULL;
   m_char = NULL;
   m_maxChars = 0;
   m_nestedBeginCount = 0;
 
-  m_bTextureLoaded = false;
   m_vertex_size   = 4*1024;
   m_vertex        = (SVertex*)malloc(m_vertex_size * sizeof(SVertex));
 
@@ -150,13 +150,12 @@ CGUIFontTTFBase::CGUIFontTTFBase(const CStdString& strFileName)
   m_originX = m_originY = 0.0f;
   m_cellBaseLine = m_cellHeight = 0;
   m_numChars = 0;
-  m_posX = m_posY = 0;
-  m_textureHeight = m_textureWidth = 0;
   m_textureScaleX = m_textureScaleY = 0.0;
   m_ellipsesWidth = m_height = 0.0f;
   m_color = 0;
   m_vertex_count = 0;
-  m_nTexture = 0;
+  m_runClock = 0;
+  m_glyphCached = false;
 }
 
 CGUIFontTTFBase::~CGUIFontTTFBase(void)
@@ -178,36 +177,15 @@ void CGUIFontTTFBase::RemoveReference()
 }
 
 
-void CGUIFontTTFBase::ClearCharacterCache()
-{
-  delete(m_texture);
-
-  DeleteHardwareTexture();
-
-  m_texture = NULL;
-  delete[] m_char;
-  m_char = new Character[CHAR_CHUNK];
-  memset(m_charquick, 0, sizeof(m_charquick));
-  m_numChars = 0;
-  m_maxChars = CHAR_CHUNK;
-  // set the posX and posY so that our texture will be created on first character write.
-  m_posX = m_textureWidth;
-  m_posY = -(int)GetTextureLineHeight();
-  m_textureHeight = 0;
-}
-
 void CGUIFontTTFBase::Clear()
 {
-  delete(m_texture);
-  m_texture = NULL;
   delete[] m_char;
   memset(m_charquick, 0, sizeof(m_charquick));
   m_char = NULL;
   m_maxChars = 0;
   m_numChars = 0;
-  m_posX = 0;
-  m_posY = 0;
   m_nestedBeginCount = 0;
+  m_runs.clear();
 
   if (m_face)
     g_freeTypeLibrary.ReleaseFont(m_face);
@@ -279,28 +257,16 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
 
   m_height = height;
 
-  delete(m_texture);
-  m_texture = NULL;
   delete[] m_char;
   m_char = NULL;
+  memset(m_charquick, 0, sizeof(m_charquick));
 
   m_maxChars = 0;
   m_numChars = 0;
+  m_runs.clear();
 
   m_strFilename = strFilename;
 
-  m_textureHeight = 0;
-  m_textureWidth = ((m_cellHeight * CHARS_PER_TEXTURE_LINE) & ~63) + 64;
-
-  m_textureWidth = CBaseTexture::PadPow2(m_textureWidth);
-
-  if (m_textureWidth > g_Windowing.GetMaxTextureSize())
-    m_textureWidth = g_Windowing.GetMaxTextureSize();
-
-  // set the posX and posY so that our texture will be created on first character write.
-  m_posX = m_textureWidth;
-  m_posY = -(int)GetTextureLineHeight();
-
   // cache the ellipses width
   Character *ellipse = GetCharacter(L'.');
   if (ellipse) m_ellipsesWidth = ellipse->advance;
@@ -312,6 +278,22 @@ void CGUIFontTTFBase::DrawTextInternal(float x, float y, const vecColors &colors
 {
   Begin();
 
+  // texts that haven't changed since the last frame reuse their vertices
+  GlyphRunKey key;
+  uint32_t hash = 0;
+  if (!scrolling)
+  {
+    hash = GetRunKey(key, x, y, colors, text, alignment, maxPixelWidth);
+    if (DrawRun(hash, key, colors, text))
+    {
+      End();
+      return;
+    }
+  }
+  int firstVertex = m_vertex_count;
+  m_glyphCached = false;
+  m_runShelves.clear();
+
   // save the origin, which is scaled separately
   m_originX = x;
   m_originY = y;
@@ -413,9 +395,121 @@ void CGUIFontTTFBase::DrawTextInternal(float x, float y, const vecColors &colors
       cursorX += ch->advance;
   }
 
+  // if glyphs were cached the vertices have been drawn in between, so there's nothing to keep
+  if (!scrolling && !m_glyphCached)
+    AddRun(hash, key, colors, text, firstVertex);
+
   End();
 }
 
+static inline uint32_t HashBytes(uint32_t hash, const void *data, size_t size)
+{
+  // FNV-1a
+  const unsigned char *bytes = (const unsigned char *)data;
+  for (size_t i = 0; i < size; i++)
+    hash = (hash ^ bytes[i]) * 16777619U;
+  return hash;
+}
+
+uint32_t CGUIFontTTFBase::GetRunKey(GlyphRunKey &key, float x, float y, const vecColors &colors, const vecText &text, uint32_t alignment, float maxPixelWidth)
+{
+  memset(&key, 0, sizeof(key));
+  key.x = x;
+  key.y = y;
+  key.maxPixelWidth = maxPixelWidth;
+  key.alignment = alignment;
+  key.scaleX = g_graphicsContext.GetGUIScaleX();
+  key.scaleY = g_graphicsContext.GetGUIScaleY();
+  memcpy(key.transform, g_graphicsContext.GetFinalTransform().m, sizeof(key.transform));
+  CRect clip;
+  if (g_graphicsContext.GetClipRegion(clip))
+  {
+    key.clipped = 1;
+    key.clip[0] = clip.x1;
+    key.clip[1] = clip.y1;
+    key.clip[2] = clip.x2;
+    key.clip[3] = clip.y2;
+  }
+
+  uint32_t hash = HashBytes(2166136261U, &key, sizeof(key));
+  if (!text.empty())
+    hash = HashBytes(hash, &text[0], text.size() * sizeof(character_t));
+  if (!colors.empty())
+    hash = HashBytes(hash, &colors[0], colors.size() * sizeof(color_t));
+  return hash;
+}
+
+bool CGUIFontTTFBase::DrawRun(uint32_t hash, const GlyphRunKey &key, const vecColors &colors, const vecText &text)
+{
+  CGUIFontGlyphAtlas &atlas = CGUIFontGlyphAtlas::Get();
+  std::pair<GlyphRuns::iterator, GlyphRuns::iterator> range = m_runs.equal_range(hash);
+  for (GlyphRuns::iterator i = range.first; i != range.second; ++i)
+  {
+    GlyphRun &run = i->second;
+    if (memcmp(&run.key, &key, sizeof(key)) != 0 || run.text != text || run.colors != colors)
+      continue;
+
+    if (run.evictionCount != atlas.GetEvictionCount())
+    { // some glyphs may have moved in the atlas
+      m_runs.erase(i);
+      break;
+    }
+
+    // keep the glyphs from being evicted
+    for (std::vector<std::pair<unsigned int, unsigned int> >::const_iterator j = run.shelves.begin(); j != run.shelves.end(); ++j)
+      atlas.Use(j->first, j->second);
+
+    int count = (int)run.vertices.size();
+    if (m_vertex_count + count > m_vertex_size)
+    {
+      while (m_vertex_count + count > m_vertex_size)
+        m_vertex_size *= 2;
+      void* old = m_vertex;
+      m_vertex  = (SVertex*)realloc(m_vertex, m_vertex_size * sizeof(SVertex));
+      if (!m_vertex)
+      {
+        free(old);
+        printf("realloc failed in CGUIFontTTF::DrawRun. aborting\n");
+        abort();
+      }
+    }
+    if (count)
+      memcpy(m_vertex + m_vertex_count, &run.vertices[0], count * sizeof(SVertex));
+    m_vertex_count += count;
+
+    run.lastUsed = ++m_runClock;
+    atlas.GetStats().runHits++;
+    return true;
+  }
+  atlas.GetStats().runMisses++;
+  return false;
+}
+
+void CGUIFontTTFBase::AddRun(uint32_t hash, const GlyphRunKey &key, const vecColors &colors, const vecText &text, int firstVertex)
+{
+  if (m_runs.size() >= MAX_GLYPH_RUNS)
+  { // make room by dropping the least recently drawn text
+    GlyphRuns::iterator oldest = m_runs.begin();
+    for (GlyphRuns::iterator i = m_runs.begin(); i != m_runs.end(); ++i)
+    {
+      if (i->second.lastUsed < oldest->second.lastUsed)
+        oldest = i;
+    }
+    m_runs.erase(oldest);
+  }
+
+  GlyphRun &run = m_runs.insert(std::make_pair(hash, GlyphRun()))->second;
+  run.key = key;
+  run.text = text;
+  run.colors = colors;
+  run.vertices.assign(m_vertex + firstVertex, m_vertex + m_vertex_count);
+  std::sort(m_runShelves.begin(), m_runShelves.end());
+  m_runShelves.erase(std::unique(m_runShelves.begin(), m_runShelves.end()), m_runShelves.end());
+  run.shelves = m_runShelves;
+  run.evictionCount = CGUIFontGlyphAtlas::Get().GetEvictionCount();
+  run.lastUsed = ++m_runClock;
+}
+
 // this routine assumes a single line (i.e. it was called from GUITextLayout)
 float CGUIFontTTFBase::GetTextWidthInternal(vecText::const_iterator start, vecText::const_iterator end)
 {
@@ -456,13 +550,6 @@ float CGUIFontTTFBase::GetLineHeight(float lineSpacing) const
   return 0.0f;
 }
 
-unsigned int CGUIFontTTFBase::spacing_between_characters_in_texture = 1;
-
-unsigned int CGUIFontTTFBase::GetTextureLineHeight() const
-{
-  return m_cellHeight + spacing_between_characters_in_texture;
-}
-
 CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
 {
   wchar_t letter = (wchar_t)(chr & 0xffff);
@@ -477,7 +564,7 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   {
     character_t ch = (style << 8) | letter;
     if (m_charquick[ch])
-      return m_charquick[ch];
+      return UseCharacter(m_charquick[ch]);
   }
 
   // letters are stored based on style and letter
@@ -494,7 +581,7 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
     else if (ch < m_char[mid].letterAndStyle)
       high = mid - 1;
     else
-      return &m_char[mid];
+      return UseCharacter(&m_char[mid]);
   }
   // if we get to here, then low is where we should insert the new character
 
@@ -516,26 +603,15 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   { // just move the data along as necessary
     memmove(m_char + low + 1, m_char + low, (m_numChars - low) * sizeof(Character));
   }
-  // render the character to our texture
-  // must End() as we can't render text to our texture during a Begin(), End() block
-  unsigned int nestedBeginCount = m_nestedBeginCount;
-  m_nestedBeginCount = 1;
-  if (nestedBeginCount) End();
-  if (!CacheCharacter(letter, style, m_char + low))
-  { // unable to cache character - try clearing them all out and starting over
-    CLog::Log(LOGDEBUG, "GUIFontTTF::GetCharacter: Unable to cache character.  Clearing character cache of %i characters", m_numChars);
-    ClearCharacterCache();
-    low = 0;
-    if (!CacheCharacter(letter, style, m_char + low))
-    {
-      CLog::Log(LOGERROR, "GUIFontTTF::GetCharacter: Unable to cache character (out of memory?)");
-      if (nestedBeginCount) Begin();
-      m_nestedBeginCount = nestedBeginCount;
-      return NULL;
-    }
+  // render the character to the glyph atlas
+  bool cached = CacheCharacterOutsideBlock(letter, style, m_char + low);
+  if (cached)
+    m_numChars++;
+  else
+  { // close the gap again
+    CLog::Log(LOGERROR, "GUIFontTTF::GetCharacter: Unable to cache character %x", letter);
+    memmove(m_char + low, m_char + low + 1, (m_numChars - low) * sizeof(Character));
   }
-  if (nestedBeginCount) Begin();
-  m_nestedBeginCount = nestedBeginCount;
 
   // fixup quick access
   memset(m_charquick, 0, sizeof(m_charquick));
@@ -548,7 +624,36 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
     }
   }
 
-  return m_char + low;
+  return cached ? m_char + low : NULL;
+}
+
+CGUIFontTTFBase::Character* CGUIFontTTFBase::UseCharacter(Character *ch)
+{
+  CGUIFontGlyphAtlas &atlas = CGUIFontGlyphAtlas::Get();
+  if (atlas.Use(ch->shelf, ch->generation))
+  {
+    atlas.GetStats().glyphHits++;
+    return ch;
+  }
+
+  // the glyph has been evicted from the atlas, so render it again
+  if (CacheCharacterOutsideBlock(ch->letterAndStyle & 0xffff, ch->letterAndStyle >> 16, ch))
+    return ch;
+  return NULL;
+}
+
+bool CGUIFontTTFBase::CacheCharacterOutsideBlock(wchar_t letter, uint32_t style, Character *ch)
+{
+  // must End() as the glyphs drawn so far have to be flushed before the atlas changes,
+  // and Begin() again to upload the new glyph
+  unsigned int nestedBeginCount = m_nestedBeginCount;
+  m_nestedBeginCount = 1;
+  if (nestedBeginCount) End();
+  m_glyphCached = true;
+  bool cached = CacheCharacter(letter, style, ch);
+  if (nestedBeginCount) Begin();
+  m_nestedBeginCount = nestedBeginCount;
+  return cached;
 }
 
 bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *ch)
@@ -583,72 +688,44 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
   }
   FT_BitmapGlyph bitGlyph = (FT_BitmapGlyph)glyph;
   FT_Bitmap bitmap = bitGlyph->bitmap;
-  if (bitGlyph->left < 0)
-    m_posX += -bitGlyph->left;
-
-  // check we have enough room for the character
-  if (m_posX + bitGlyph->left + bitmap.width > (int)m_textureWidth)
-  { // no space - gotta drop to the next line (which means creating a new texture and copying it across)
-    m_posX = 0;
-    m_posY += GetTextureLineHeight();
-    if (bitGlyph->left < 0)
-      m_posX += -bitGlyph->left;
-
-    if(m_posY + GetTextureLineHeight() >= m_textureHeight)
+
+  unsigned int x = 0, y = 0;
+  unsigned int shelf = CGUIFontGlyphAtlas::NO_SHELF, generation = 0;
+
+  // we need only render if we actually have some pixels
+  if (bitmap.width * bitmap.rows)
+  {
+    CGUIFontGlyphAtlas &atlas = CGUIFontGlyphAtlas::Get();
+    unsigned char *target = atlas.Add(bitmap.width, bitmap.rows, x, y, shelf, generation);
+    if (!target)
     {
-      // create the new larger texture
-      unsigned int newHeight = m_posY + GetTextureLineHeight();
-      // check for max height
-      if (newHeight > g_Windowing.GetMaxTextureSize())
-      {
-        CLog::Log(LOGDEBUG, "GUIFontTTF::CacheCharacter: New cache texture is too large (%u > %u pixels long)", newHeight, g_Windowing.GetMaxTextureSize());
-        FT_Done_Glyph(glyph);
-        return false;
-      }
+      CLog::Log(LOGDEBUG, "%s No room in the glyph atlas for %x", __FUNCTION__, letter);
+      FT_Done_Glyph(glyph);
+      return false;
+    }
 
-      CBaseTexture* newTexture = NULL;
-      newTexture = ReallocTexture(newHeight);
-      if(newTexture == NULL)
-      {
-        FT_Done_Glyph(glyph);
-        CLog::Log(LOGDEBUG, "GUIFontTTF::CacheCharacter: Failed to allocate new texture of height %u", newHeight);
-        return false;
-      }
-      m_texture = newTexture;
+    const unsigned char *source = bitmap.buffer;
+    for (unsigned int row = 0; row < (unsigned int)bitmap.rows; row++)
+    {
+      memcpy(target, source, bitmap.width);
+      source += bitmap.pitch;
+      target += atlas.GetSize();
     }
-  }
 
-  if(m_texture == NULL)
-  {
-    CLog::Log(LOGDEBUG, "GUIFontTTF::CacheCharacter: no texture to cache character to");
-    return false;
+    m_textureScaleX = m_textureScaleY = 1.0f / atlas.GetSize();
   }
 
   // set the character in our table
   ch->letterAndStyle = (style << 16) | letter;
   ch->offsetX = (short)bitGlyph->left;
   ch->offsetY = (short)m_cellBaseLine - bitGlyph->top;
-  ch->left = (float)m_posX + ch->offsetX;
-  ch->top = (float)m_posY + ch->offsetY;
+  ch->left = (float)x;
+  ch->top = (float)y;
   ch->right = ch->left + bitmap.width;
   ch->bottom = ch->top + bitmap.rows;
   ch->advance = (float)MathUtils::round_int( (float)m_face->glyph->advance.x / 64 );
-
-  // we need only render if we actually have some pixels
-  if (bitmap.width * bitmap.rows)
-  {
-    // ensure our rect will stay inside the texture (it *should* but we need to be certain)
-    unsigned int x1 = max(m_posX + ch->offsetX, 0);
-    unsigned int y1 = max(m_posY + ch->offsetY, 0);
-    unsigned int x2 = min(x1 + bitmap.width, m_textureWidth);
-    unsigned int y2 = min(y1 + bitmap.rows, m_textureHeight);
-    CopyCharToTexture(bitGlyph, x1, y1, x2, y2);
-  }
-  m_posX += spacing_between_characters_in_texture + (unsigned short)max(ch->right - ch->left + ch->offsetX, ch->advance);
-  m_numChars++;
-
-  m_textureScaleX = 1.0f / m_textureWidth;
-  m_textureScaleY = 1.0f / m_textureHeight;
+  ch->shelf = shelf;
+  ch->generation = generation;
 
   // free the glyph
   FT_Done_Glyph(glyph);
@@ -790,6 +867,11 @@ void CGUIFontTTFBase::RenderCharacter(float posX, float posY, const Character *c
 #endif
 
   m_vertex_count+=4;
+
+  // remember the glyphs of the text for the vertex run cache
+  if (ch->shelf != CGUIFontGlyphAtlas::NO_SHELF &&
+      (m_runShelves.empty() || m_runShelves.back().first != ch->shelf))
+    m_runShelves.push_back(std::make_pair(ch->shelf, ch->generation));
 }
 
 // Oblique code - original taken from freetype2 (ftsynth.c)
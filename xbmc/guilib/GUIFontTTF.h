@@ -27,6 +27,8 @@
  *
  */
 
+#include <map>
+
 // forward definition
 class CBaseTexture;
 
@@ -89,7 +91,37 @@ protected:
     float left, top, right, bottom;
     float advance;
     character_t letterAndStyle;
+    unsigned int shelf;       // where the glyph is in the glyph atlas
+    unsigned int generation;
+  };
+
+  // everything the vertices of a text depend on, besides the text and its colors
+  struct GlyphRunKey
+  {
+    float x, y;
+    float maxPixelWidth;
+    uint32_t alignment;
+    float scaleX, scaleY;
+    float transform[3][4];
+    uint32_t clipped;
+    float clip[4];
+  };
+  /*! \brief Vertices of a previously drawn text.
+   Labels that don't change are drawn by copying the vertices instead of
+   laying out the text again, as long as the glyphs are still in the atlas.
+   */
+  struct GlyphRun
+  {
+    GlyphRunKey key;
+    vecText text;
+    vecColors colors;
+
+    std::vector<SVertex> vertices;
+    std::vector<std::pair<unsigned int, unsigned int> > shelves; // shelves and generations of the glyphs
+    unsigned int evictionCount;   // eviction count of the atlas when the glyphs were cached
+    unsigned int lastUsed;
   };
+  typedef std::multimap<uint32_t, GlyphRun> GlyphRuns;
   void AddReference();
   void RemoveReference();
 
@@ -108,31 +140,21 @@ protected:
 
   // Stuff for pre-rendering for speed
   inline Character *GetCharacter(character_t letter);
+  inline Character *UseCharacter(Character *ch);
   bool CacheCharacter(wchar_t letter, uint32_t style, Character *ch);
+  bool CacheCharacterOutsideBlock(wchar_t letter, uint32_t style, Character *ch);
   void RenderCharacter(float posX, float posY, const Character *ch, color_t color, bool roundX);
-  void ClearCharacterCache();
 
-  virtual CBaseTexture* ReallocTexture(unsigned int& newHeight) = 0;
-  virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) = 0;
-  virtual void DeleteHardwareTexture() = 0;
+  // reusing the vertices of unchanged texts
+  static uint32_t GetRunKey(GlyphRunKey &key, float x, float y, const vecColors &colors, const vecText &text,
+                            uint32_t alignment, float maxPixelWidth);
+  bool DrawRun(uint32_t hash, const GlyphRunKey &key, const vecColors &colors, const vecText &text);
+  void AddRun(uint32_t hash, const GlyphRunKey &key, const vecColors &colors, const vecText &text, int firstVertex);
 
   // modifying glyphs
   void EmboldenGlyph(FT_GlyphSlot slot);
   void ObliqueGlyph(FT_GlyphSlot slot);
 
-  CBaseTexture* m_texture;        // texture that holds our rendered characters (8bit alpha only)
-
-  unsigned int m_textureWidth;       // width of our texture
-  unsigned int m_textureHeight;      // heigth of our texture
-  int m_posX;                        // current position in the texture
-  int m_posY;
-
-  /*! \brief the height of each line in the texture.
-   Accounts for spacing between lines to avoid characters overlapping.
-   */
-  unsigned int GetTextureLineHeight() const;
-  static unsigned int spacing_between_characters_in_texture;
-
   color_t m_color;
 
   Character *m_char;                 // our characters
@@ -154,9 +176,6 @@ protected:
   float m_originX;
   float m_originY;
 
-  bool m_bTextureLoaded;
-  unsigned int m_nTexture;
-
   SVertex* m_vertex;
   int      m_vertex_count;
   int      m_vertex_size;
@@ -164,6 +183,11 @@ protected:
   float    m_textureScaleX;
   float    m_textureScaleY;
 
+  GlyphRuns m_runs;
+  unsigned int m_runClock;
+  bool m_glyphCached;                // a glyph was added to the atlas while drawing
+  std::vector<std::pair<unsigned int, unsigned int> > m_runShelves;
+
   static int justification_word_weight;
 
   CStdString m_strFileName;
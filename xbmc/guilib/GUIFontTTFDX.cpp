@@ -23,6 +23,7 @@
 #include "GUIFont.h"
 #include "GUIFontTTFDX.h"
 #include "GUIFontManager.h"
+#include "GUIFontGlyphAtlas.h"
 #include "Texture.h"
 #include "gui3d.h"
 #include "windowing/WindowingFactory.h"
@@ -40,14 +41,12 @@ using namespace std;
 CGUIFontTTFDX::CGUIFontTTFDX(const CStdString& strFileName)
 : CGUIFontTTFBase(strFileName)
 {
-  m_speedupTexture = NULL;
   m_index      = NULL;
   m_index_size = 0;
 }
 
 CGUIFontTTFDX::~CGUIFontTTFDX(void)
 {
-  SAFE_DELETE(m_speedupTexture);
   free(m_index);
 }
 
@@ -57,8 +56,37 @@ void CGUIFontTTFDX::Begin()
 
   if (m_nestedBeginCount == 0)
   {
-    // just have to blit from our texture.
-    m_texture->BindToUnit(0);
+    CGUIFontGlyphAtlas &atlas = CGUIFontGlyphAtlas::Get();
+    CBaseTexture *texture = atlas.GetTexture();
+    if (texture)
+    {
+      // uploads the whole atlas the first time only, afterwards just the glyphs that changed
+      texture->LoadToGPU();
+      unsigned int first, count;
+      const unsigned char *pixels = atlas.GetDirtyRows(first, count);
+      LPDIRECT3DTEXTURE9 d3dTexture = ((CDXTexture *)texture)->GetTextureObject();
+      if (pixels && d3dTexture)
+      {
+        RECT rect = { 0, (LONG)first, (LONG)atlas.GetSize(), (LONG)(first + count) };
+        D3DLOCKED_RECT lr;
+        if (SUCCEEDED(d3dTexture->LockRect(0, &lr, &rect, 0)))
+        {
+          unsigned char *dst = (unsigned char *)lr.pBits;
+          for (unsigned int y = 0; y < count; y++)
+          {
+            memcpy(dst, pixels, atlas.GetSize());
+            pixels += atlas.GetSize();
+            dst += lr.Pitch;
+          }
+          d3dTexture->UnlockRect(0);
+        }
+        else
+          CLog::Log(LOGERROR, __FUNCTION__" - failed to lock the glyph texture");
+      }
+
+      // just have to blit from our texture.
+      texture->BindToUnit(0);
+    }
     pD3DDevice->SetTextureStageState( 0, D3DTSS_COLOROP, D3DTOP_SELECTARG1 ); // only use diffuse
     pD3DDevice->SetTextureStageState( 0, D3DTSS_COLORARG1, D3DTA_DIFFUSE);
     pD3DDevice->SetTextureStageState( 0, D3DTSS_ALPHAOP, D3DTOP_MODULATE );
@@ -147,162 +175,4 @@ void CGUIFontTTFDX::End()
   pD3DDevice->SetTextureStageState( 0, D3DTSS_COLOROP, D3DTOP_MODULATE );
 }
 
-CBaseTexture* CGUIFontTTFDX::ReallocTexture(unsigned int& newHeight)
-{
-  CDXTexture* pNewTexture = new CDXTexture(m_textureWidth, newHeight, XB_FMT_A8);
-  pNewTexture->CreateTextureObject();
-  LPDIRECT3DTEXTURE9 newTexture = pNewTexture->GetTextureObject();
-
-  if (newTexture == NULL)
-  {
-    CLog::Log(LOGERROR, __FUNCTION__" - failed to create the new texture h=%d w=%d", m_textureWidth, newHeight);
-    SAFE_DELETE(pNewTexture);
-    return NULL;
-  }
-
-  // Use a speedup texture in system memory when main texture in default pool+dynamic
-  // Otherwise the texture would have to be copied from vid mem to sys mem, which is too slow for subs while playing video.
-  CD3DTexture* newSpeedupTexture = NULL;
-  if (g_Windowing.DefaultD3DPool() == D3DPOOL_DEFAULT && g_Windowing.DefaultD3DUsage() == D3DUSAGE_DYNAMIC)
-  {
-    newSpeedupTexture = new CD3DTexture();
-
-    if (!newSpeedupTexture->Create(m_textureWidth, newHeight, 1, 0, D3DFMT_A8, D3DPOOL_SYSTEMMEM))
-    {
-      SAFE_DELETE(newSpeedupTexture);
-      SAFE_DELETE(pNewTexture);
-      return NULL;
-    }
-  }
-
-  LPDIRECT3DSURFACE9 pSource, pTarget;
-  HRESULT hr;
-  // There might be data to copy from the previous texture
-  if ((newSpeedupTexture && m_speedupTexture) || (newTexture && m_texture))
-  {
-    if (m_speedupTexture && newSpeedupTexture)
-    {
-      m_speedupTexture->GetSurfaceLevel(0, &pSource);
-      newSpeedupTexture->GetSurfaceLevel(0, &pTarget);
-    }
-    else
-    {
-      ((CDXTexture *)m_texture)->GetTextureObject()->GetSurfaceLevel(0, &pSource);
-      newTexture->GetSurfaceLevel(0, &pTarget);
-    }
-
-    D3DLOCKED_RECT srclr, dstlr;
-    if(FAILED(pSource->LockRect( &srclr, NULL, 0 ))
-    || FAILED(pTarget->LockRect( &dstlr, NULL, 0 )))
-    {
-      CLog::Log(LOGERROR, __FUNCTION__" - failed to lock surfaces");
-      SAFE_DELETE(newSpeedupTexture);
-      SAFE_DELETE(pNewTexture);
-      pSource->Release();
-      pTarget->Release();
-      return NULL;
-    }
-
-    unsigned char *dst = (unsigned char *)dstlr.pBits;
-    unsigned char *src = (unsigned char *)srclr.pBits;
-    unsigned int dstPitch = dstlr.Pitch;
-    unsigned int srcPitch = srclr.Pitch;
-    unsigned int minPitch = std::min(srcPitch, dstPitch);
-
-    if (srcPitch == dstPitch)
-    {
-      memcpy(dst, src, srcPitch * m_textureHeight);
-    }
-    else
-    {
-      for (unsigned int y = 0; y < m_textureHeight; y++)
-      {
-        memcpy(dst, src, minPitch);
-        src += srcPitch;
-        dst += dstPitch;
-      }
-    }
-    pSource->UnlockRect();
-    pTarget->UnlockRect();
-
-    pSource->Release();
-    pTarget->Release();
-  }
-
-  // Upload from speedup texture to main texture
-  if (newSpeedupTexture && m_speedupTexture)
-  {
-    LPDIRECT3DSURFACE9 pSource, pTarget;
-    newSpeedupTexture->GetSurfaceLevel(0, &pSource);
-    newTexture->GetSurfaceLevel(0, &pTarget);
-    const RECT rect = { 0, 0, m_textureWidth, m_textureHeight };
-    const POINT point = { 0, 0 };
-
-    hr = g_Windowing.Get3DDevice()->UpdateSurface(pSource, &rect, pTarget, &point);
-    SAFE_RELEASE(pSource);
-    SAFE_RELEASE(pTarget);
-
-    if (FAILED(hr))
-    {
-      CLog::Log(LOGERROR, __FUNCTION__": Failed to upload from sysmem to vidmem (0x%08X)", hr);
-      SAFE_DELETE(newSpeedupTexture);
-      SAFE_DELETE(pNewTexture);
-      return NULL;
-    }
-  }
-
-  SAFE_DELETE(m_texture);
-  SAFE_DELETE(m_speedupTexture);
-  m_textureHeight = newHeight;
-  m_speedupTexture = newSpeedupTexture;
-
-  return pNewTexture;
-}
-
-bool CGUIFontTTFDX::CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
-{
-  FT_Bitmap bitmap = bitGlyph->bitmap;
-
-  LPDIRECT3DTEXTURE9 texture = ((CDXTexture *)m_texture)->GetTextureObject();
-  LPDIRECT3DSURFACE9 target;
-  if (m_speedupTexture)
-    m_speedupTexture->GetSurfaceLevel(0, &target);
-  else
-    texture->GetSurfaceLevel(0, &target);
-
-  RECT sourcerect = { 0, 0, bitmap.width, bitmap.rows };
-  RECT targetrect = { x1, y1, x2, y2 };
-
-  HRESULT hr = D3DXLoadSurfaceFromMemory( target, NULL, &targetrect,
-                                          bitmap.buffer, D3DFMT_LIN_A8, bitmap.pitch, NULL, &sourcerect,
-                                          D3DX_FILTER_NONE, 0x00000000);
-
-  SAFE_RELEASE(target);
-
-  if (FAILED(hr))
-  {
-    CLog::Log(LOGERROR, __FUNCTION__": Failed to copy the new character (0x%08X)", hr);
-    return false;
-  }
-
-  if (m_speedupTexture)
-  {
-    // Upload to GPU - the automatic dirty region tracking takes care of the rect.
-    HRESULT hr = g_Windowing.Get3DDevice()->UpdateTexture(m_speedupTexture->Get(), texture);
-    if (FAILED(hr))
-    {
-      CLog::Log(LOGERROR, __FUNCTION__": Failed to upload from sysmem to vidmem (0x%08X)", hr);
-      return false;
-    }
-  }
-  return TRUE;
-}
-
-
-void CGUIFontTTFDX::DeleteHardwareTexture()
-{
-  
-}
-
-
 #endif
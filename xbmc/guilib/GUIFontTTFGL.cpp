@@ -22,12 +22,15 @@
 #include "GUIFont.h"
 #include "GUIFontTTFGL.h"
 #include "GUIFontManager.h"
+#include "GUIFontGlyphAtlas.h"
 #include "Texture.h"
-#include "TextureManager.h"
 #include "GraphicContext.h"
 #include "gui3d.h"
 #include "utils/log.h"
 #include "utils/GLUtils.h"
+#ifdef HAS_GL
+#include "GUIQuadBatchGL.h"
+#endif
 #if HAS_GLES == 2
 #include "windowing/WindowingFactory.h"
 #endif
@@ -56,49 +59,35 @@ void CGUIFontTTFGL::Begin()
 {
   if (m_nestedBeginCount == 0)
   {
-    if (!m_bTextureLoaded)
+    CGUIFontGlyphAtlas &atlas = CGUIFontGlyphAtlas::Get();
+    CBaseTexture *texture = atlas.GetTexture();
+    if (texture)
     {
-      // Have OpenGL generate a texture object handle for us
-      glGenTextures(1, (GLuint*) &m_nTexture);
-
-      // Bind the texture object
-      glBindTexture(GL_TEXTURE_2D, m_nTexture);
+      // uploads the whole atlas the first time only, afterwards just the glyphs that changed
+      texture->LoadToGPU();
+      unsigned int first, count;
+      const unsigned char *pixels = atlas.GetDirtyRows(first, count);
+      if (pixels)
+      {
 #ifdef HAS_GL
-      glEnable(GL_TEXTURE_2D);
+        // glyphs waiting to be drawn may be in the rows that change
+        CGUIQuadBatchGL::Get().Flush();
 #endif
-      // Set the texture's stretching properties
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-      // Set the texture image -- THIS WORKS, so the pixels must be wrong.
-      glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, m_texture->GetWidth(), m_texture->GetHeight(), 0,
-                   GL_ALPHA, GL_UNSIGNED_BYTE, m_texture->GetPixels());
-
-      VerifyGLState();
-      m_bTextureLoaded = true;
+        glBindTexture(GL_TEXTURE_2D, ((CTexture *)texture)->GetTextureObject());
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first, atlas.GetSize(), count, GL_ALPHA, GL_UNSIGNED_BYTE, pixels);
+        VerifyGLState();
+      }
     }
 
+#ifdef HAS_GL
+    // the state is set up by the batch when the glyphs are drawn
+#else
     // Turn Blending On
     glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
     glEnable(GL_BLEND);
-#ifdef HAS_GL
-    glEnable(GL_TEXTURE_2D);
-#endif
-    glBindTexture(GL_TEXTURE_2D, m_nTexture);
+    if (texture)
+      texture->BindToUnit(0);
 
-#ifdef HAS_GL
-    glTexEnvi(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_COMBINE);
-    glTexEnvi(GL_TEXTURE_ENV,GL_COMBINE_RGB,GL_REPLACE);
-    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_PRIMARY_COLOR);
-    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
-    glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
-    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE0);
-    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
-    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PRIMARY_COLOR);
-    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    VerifyGLState();
-#else
     g_Windowing.EnableGUIShader(SM_FONTS);
 #endif
 
@@ -117,16 +106,27 @@ void CGUIFontTTFGL::End()
     return;
 
 #ifdef HAS_GL
-  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
-
-  glColorPointer   (4, GL_UNSIGNED_BYTE, sizeof(SVertex), (char*)m_vertex + offsetof(SVertex, r));
-  glVertexPointer  (3, GL_FLOAT        , sizeof(SVertex), (char*)m_vertex + offsetof(SVertex, x));
-  glTexCoordPointer(2, GL_FLOAT        , sizeof(SVertex), (char*)m_vertex + offsetof(SVertex, u));
-  glEnableClientState(GL_COLOR_ARRAY);
-  glEnableClientState(GL_VERTEX_ARRAY);
-  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-  glDrawArrays(GL_QUADS, 0, m_vertex_count);
-  glPopClientAttrib();
+  // the glyphs are drawn together with the textures and labels sharing the state
+  CBaseTexture *texture = CGUIFontGlyphAtlas::Get().GetTexture();
+  CGUIQuadBatchGL &batch = CGUIQuadBatchGL::Get();
+  batch.SetState(CGUIQuadBatchGL::MODE_FONT, texture ? ((CTexture *)texture)->GetTextureObject() : 0);
+  for (int i = 0; i + 3 < m_vertex_count; i += 4)
+  {
+    CGUIQuadBatchGL::SVertex *quad = batch.AddQuad();
+    for (int j = 0; j < 4; j++)
+    {
+      const SVertex &vertex = m_vertex[i + j];
+      quad[j].x = vertex.x;
+      quad[j].y = vertex.y;
+      quad[j].z = vertex.z;
+      quad[j].r = vertex.r;
+      quad[j].g = vertex.g;
+      quad[j].b = vertex.b;
+      quad[j].a = vertex.a;
+      quad[j].u1 = vertex.u;
+      quad[j].v1 = vertex.v;
+    }
+  }
 #else
   // GLES 2.0 version. Cannot draw quads. Convert to triangles.
   GLint posLoc  = g_Windowing.GUIShaderGetPos();
@@ -169,75 +169,4 @@ void CGUIFontTTFGL::End()
 #endif
 }
 
-CBaseTexture* CGUIFontTTFGL::ReallocTexture(unsigned int& newHeight)
-{
-  newHeight = CBaseTexture::PadPow2(newHeight);
-
-  CBaseTexture* newTexture = new CTexture(m_textureWidth, newHeight, XB_FMT_A8);
-
-  if (!newTexture || newTexture->GetPixels() == NULL)
-  {
-    CLog::Log(LOGERROR, "GUIFontTTFGL::CacheCharacter: Error creating new cache texture for size %f", m_height);
-    delete newTexture;
-    return NULL;
-  }
-  m_textureHeight = newTexture->GetHeight();
-  m_textureWidth = newTexture->GetWidth();
-
-  memset(newTexture->GetPixels(), 0, m_textureHeight * newTexture->GetPitch());
-  if (m_texture)
-  {
-    unsigned char* src = (unsigned char*) m_texture->GetPixels();
-    unsigned char* dst = (unsigned char*) newTexture->GetPixels();
-    for (unsigned int y = 0; y < m_texture->GetHeight(); y++)
-    {
-      memcpy(dst, src, m_texture->GetPitch());
-      src += m_texture->GetPitch();
-      dst += newTexture->GetPitch();
-    }
-    delete m_texture;
-  }
-
-  return newTexture;
-}
-
-bool CGUIFontTTFGL::CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
-{
-  FT_Bitmap bitmap = bitGlyph->bitmap;
-
-  unsigned char* source = (unsigned char*) bitmap.buffer;
-  unsigned char* target = (unsigned char*) m_texture->GetPixels() + y1 * m_texture->GetPitch() + x1;
-
-  for (unsigned int y = y1; y < y2; y++)
-  {
-    memcpy(target, source, x2-x1);
-    source += bitmap.width;
-    target += m_texture->GetPitch();
-  }
-  // THE SOURCE VALUES ARE THE SAME IN BOTH SITUATIONS.
-
-  // Since we have a new texture, we need to delete the old one
-  // the Begin(); End(); stuff is handled by whoever called us
-  if (m_bTextureLoaded)
-  {
-    g_graphicsContext.BeginPaint();  //FIXME
-    DeleteHardwareTexture();
-    g_graphicsContext.EndPaint();
-    m_bTextureLoaded = false;
-  }
-
-  return TRUE;
-}
-
-
-void CGUIFontTTFGL::DeleteHardwareTexture()
-{
-  if (m_bTextureLoaded)
-  {
-    if (glIsTexture(m_nTexture))
-      g_TextureManager.ReleaseHwTexture(m_nTexture);
-    m_bTextureLoaded = false;
-  }
-}
-
 #endif
@@ -43,12 +43,6 @@ public:
 
   virtual void Begin();
   virtual void End();
-
-protected:
-  virtual CBaseTexture* ReallocTexture(unsigned int& newHeight);
-  virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2);
-  virtual void DeleteHardwareTexture();
-
 };
 
 #endif
@@ -28,6 +28,7 @@
 #include "GUIListItem.h"
 #include "utils/StringUtils.h"
 #include "addons/Skin.h"
+#include "threads/Atomics.h"
 
 using namespace std;
 using ADDON::CAddonMgr;
@@ -141,22 +142,26 @@ void CGUIInfoLabel::SetLabel(const CStdString &label, const CStdString &fallback
 CStdString CGUIInfoLabel::GetLabel(int contextWindow, bool preferImage, CStdString *fallback /*= NULL*/) const
 {
   CStdString label;
-  for (unsigned int i = 0; i < m_info.size(); i++)
+  if (m_program)
   {
-    const CInfoPortion &portion = m_info[i];
-    if (portion.m_info)
+    const vector<CInfoPortion> &portions = m_program->m_portions;
+    for (unsigned int i = 0; i < portions.size(); i++)
     {
-      CStdString infoLabel;
-      if (preferImage)
-        infoLabel = g_infoManager.GetImage(portion.m_info, contextWindow, fallback);
-      if (infoLabel.IsEmpty())
-        infoLabel = g_infoManager.GetLabel(portion.m_info, contextWindow, fallback);
-      if (!infoLabel.IsEmpty())
-        label += portion.GetLabel(infoLabel);
-    }
-    else
-    { // no info, so just append the prefix
-      label += portion.m_prefix;
+      const CInfoPortion &portion = portions[i];
+      if (portion.m_info)
+      {
+        CStdString infoLabel;
+        if (preferImage)
+          infoLabel = g_infoManager.GetImage(portion.m_info, contextWindow, fallback);
+        if (infoLabel.IsEmpty())
+          infoLabel = g_infoManager.GetLabel(portion.m_info, contextWindow, fallback);
+        if (!infoLabel.IsEmpty())
+          portion.AppendLabel(label, infoLabel);
+      }
+      else
+      { // no info, so just append the prefix
+        label += portion.m_prefix;
+      }
     }
   }
   if (label.IsEmpty())  // empty label, use the fallback
@@ -164,41 +169,63 @@ CStdString CGUIInfoLabel::GetLabel(int contextWindow, bool preferImage, CStdStri
   return label;
 }
 
+static volatile long itemLabelMisses = 0;
+
 CStdString CGUIInfoLabel::GetItemLabel(const CGUIListItem *item, bool preferImages, CStdString *fallback /*= NULL*/) const
 {
   if (!item->IsFileItem()) return "";
   CStdString label;
-  for (unsigned int i = 0; i < m_info.size(); i++)
+  if (m_program)
   {
-    const CInfoPortion &portion = m_info[i];
-    if (portion.m_info)
+    // labels showing nothing but info of the item are kept with the item until it changes
+    bool cache = m_program->m_itemOnly && !preferImages && !fallback &&
+                 g_infoManager.CanCacheItemLabels((const CFileItem *)item);
+    if (cache && item->GetCachedLabel(m_program->m_id, label))
+      return label.IsEmpty() ? m_fallback : label;
+    if (cache)
+      AtomicIncrement(&itemLabelMisses);
+
+    const vector<CInfoPortion> &portions = m_program->m_portions;
+    for (unsigned int i = 0; i < portions.size(); i++)
     {
-      CStdString infoLabel;
-      if (preferImages)
-        infoLabel = g_infoManager.GetItemImage((const CFileItem *)item, portion.m_info, fallback);
+      const CInfoPortion &portion = portions[i];
+      if (portion.m_info)
+      {
+        CStdString infoLabel;
+        if (preferImages)
+          infoLabel = g_infoManager.GetItemImage((const CFileItem *)item, portion.m_info, fallback);
+        else
+          infoLabel = g_infoManager.GetItemLabel((const CFileItem *)item, portion.m_info, fallback);
+        if (!infoLabel.IsEmpty())
+          portion.AppendLabel(label, infoLabel);
+      }
       else
-        infoLabel = g_infoManager.GetItemLabel((const CFileItem *)item, portion.m_info, fallback);
-      if (!infoLabel.IsEmpty())
-        label += portion.GetLabel(infoLabel);
-    }
-    else
-    { // no info, so just append the prefix
-      label += portion.m_prefix;
+      { // no info, so just append the prefix
+        label += portion.m_prefix;
+      }
     }
+
+    if (cache)
+      item->SetCachedLabel(m_program->m_id, label);
   }
   if (label.IsEmpty())
     return m_fallback;
   return label;
 }
 
+unsigned int CGUIInfoLabel::GetItemLabelMisses()
+{
+  return (unsigned int)itemLabelMisses;
+}
+
 bool CGUIInfoLabel::IsEmpty() const
 {
-  return m_info.size() == 0;
+  return !m_program || m_program->m_portions.empty();
 }
 
 bool CGUIInfoLabel::IsConstant() const
 {
-  return m_info.size() == 0 || (m_info.size() == 1 && m_info[0].m_info == 0);
+  return IsEmpty() || (m_program->m_portions.size() == 1 && m_program->m_portions[0].m_info == 0);
 }
 
 CStdString CGUIInfoLabel::ReplaceLocalize(const CStdString &label)
@@ -271,7 +298,9 @@ const static infoformat infoformatmap[] = {{ "$INFO[",    FORMATINFO },
 
 void CGUIInfoLabel::Parse(const CStdString &label, int context)
 {
-  m_info.clear();
+  CProgram *program = new CProgram;
+  m_program.reset(program);
+  vector<CInfoPortion> &portions = program->m_portions;
   // Step 1: Replace all $LOCALIZE[number] with the real string
   CStdString work = ReplaceLocalize(label);
   // Step 2: Replace all $ADDON[id number] with the real string
@@ -298,7 +327,7 @@ void CGUIInfoLabel::Parse(const CStdString &label, int context)
     if (format != NONE)
     {
       if (pos1 > 0)
-        m_info.push_back(CInfoPortion(0, work.Left(pos1), ""));
+        portions.push_back(CInfoPortion(0, work.Left(pos1), ""));
 
       pos2 = StringUtils::FindEndBracket(work, '[', ']', pos1 + len);
       if (pos2 > pos1)
@@ -323,7 +352,7 @@ void CGUIInfoLabel::Parse(const CStdString &label, int context)
           prefix = params[1];
         if (params.size() > 2)
           postfix = params[2];
-        m_info.push_back(CInfoPortion(info, prefix, postfix, format == FORMATESCINFO));
+        portions.push_back(CInfoPortion(info, prefix, postfix, format == FORMATESCINFO));
         // and delete it from our work string
         work = work.Mid(pos2 + 1);
       }
@@ -337,7 +366,28 @@ void CGUIInfoLabel::Parse(const CStdString &label, int context)
   while (format != NONE);
 
   if (!work.IsEmpty())
-    m_info.push_back(CInfoPortion(0, work, ""));
+    portions.push_back(CInfoPortion(0, work, ""));
+
+  // labels made up of nothing but info of the list item may be kept with the item
+  for (unsigned int i = 0; i < portions.size(); i++)
+  {
+    if (portions[i].m_info)
+    {
+      if (!g_infoManager.IsItemOnlyLabel(portions[i].m_info))
+      {
+        program->m_itemOnly = false;
+        break;
+      }
+      program->m_itemOnly = true;
+    }
+  }
+}
+
+CGUIInfoLabel::CProgram::CProgram()
+{
+  static volatile long programs = 0;
+  m_id = (unsigned int)AtomicIncrement(&programs);
+  m_itemOnly = false;
 }
 
 CGUIInfoLabel::CInfoPortion::CInfoPortion(int info, const CStdString &prefix, const CStdString &postfix, bool escaped /*= false */)
@@ -353,16 +403,19 @@ CGUIInfoLabel::CInfoPortion::CInfoPortion(int info, const CStdString &prefix, co
   m_postfix.Replace("$LBRACKET", "["); m_postfix.Replace("$RBRACKET", "]");
 }
 
-CStdString CGUIInfoLabel::CInfoPortion::GetLabel(const CStdString &info) const
+void CGUIInfoLabel::CInfoPortion::AppendLabel(CStdString &label, const CStdString &info) const
 {
-  CStdString label = m_prefix + info + m_postfix;
   if (m_escaped) // escape all quotes and backslashes, then quote
   {
-    label.Replace("\\", "\\\\");
-    label.Replace("\"", "\\\"");
-    return "\"" + label + "\"";
+    CStdString escaped = m_prefix + info + m_postfix;
+    escaped.Replace("\\", "\\\\");
+    escaped.Replace("\"", "\\\"");
+    label += "\"" + escaped + "\"";
+    return;
   }
-  return label;
+  label += m_prefix;
+  label += info;
+  label += m_postfix;
 }
 
 CStdString CGUIInfoLabel::GetLabel(const CStdString &label, int contextWindow /*= 0*/, bool preferImage /*= false */)
@@ -29,6 +29,7 @@
  */
 
 #include "utils/StdString.h"
+#include "boost/shared_ptr.hpp"
 
 class CGUIListItem;
 
@@ -100,6 +101,12 @@ public:
 
   static CStdString GetLabel(const CStdString &label, int contextWindow = 0, bool preferImage = false);
 
+  /*!
+   \brief Number of cacheable item labels that had to be built because they weren't cached.
+   \sa GetItemLabel
+   */
+  static unsigned int GetItemLabelMisses();
+
   /*!
    \brief Replaces instances of $LOCALIZE[number] with the appropriate localized string
    \param label text to replace
@@ -121,7 +128,7 @@ private:
   {
   public:
     CInfoPortion(int info, const CStdString &prefix, const CStdString &postfix, bool escaped = false);
-    CStdString GetLabel(const CStdString &info) const;
+    void AppendLabel(CStdString &label, const CStdString &info) const;
     int m_info;
     CStdString m_prefix;
     CStdString m_postfix;
@@ -129,8 +136,21 @@ private:
     bool m_escaped;
   };
 
+  /*! \brief The parsed label, shared by all copies of the label
+   Copies are made for the layout of every list item, so the portions are kept in here
+   rather than being copied along with the label.
+   */
+  class CProgram
+  {
+  public:
+    CProgram();
+    std::vector<CInfoPortion> m_portions;
+    unsigned int m_id;   ///< unique id of the program, used to keep labels with the list items
+    bool m_itemOnly;     ///< true if the label depends on nothing but the list item
+  };
+
   CStdString m_fallback;
-  std::vector<CInfoPortion> m_info;
+  boost::shared_ptr<const CProgram> m_program;
 };
 
 #endif
@@ -23,13 +23,22 @@
 #include "utils/Archive.h"
 #include "utils/CharsetConverter.h"
 #include "utils/Variant.h"
+#include "threads/Atomics.h"
 
 using namespace std;
 
+// labels cached per item are cleared once they grow past this
+#define MAX_CACHED_LABELS 16
+
+volatile long CGUIListItem::m_labelEpoch = 0;
+
 CGUIListItem::CGUIListItem(const CGUIListItem& item)
 {
   m_layout = NULL;
   m_focusedLayout = NULL;
+  m_revision = 0;
+  m_labelCacheRevision = 0;
+  m_labelCacheEpoch = 0;
   *this = item;
   SetInvalid();
 }
@@ -44,6 +53,9 @@ CGUIListItem::CGUIListItem(void)
   m_overlayIcon = ICON_OVERLAY_NONE;
   m_layout = NULL;
   m_focusedLayout = NULL;
+  m_revision = 0;
+  m_labelCacheRevision = 0;
+  m_labelCacheEpoch = 0;
 }
 
 CGUIListItem::CGUIListItem(const CStdString& strLabel)
@@ -57,6 +69,9 @@ CGUIListItem::CGUIListItem(const CStdString& strLabel)
   m_overlayIcon = ICON_OVERLAY_NONE;
   m_layout = NULL;
   m_focusedLayout = NULL;
+  m_revision = 0;
+  m_labelCacheRevision = 0;
+  m_labelCacheEpoch = 0;
 }
 
 CGUIListItem::~CGUIListItem(void)
@@ -97,11 +112,14 @@ void CGUIListItem::SetSortLabel(const CStdString &label)
 {
   g_charsetConverter.utf8ToW(label, m_sortLabel, false);
   // no need to invalidate - this is never shown in the UI
+  // other than by ListItem.SortLetter, which may be cached
+  IncrementRevision();
 }
 
 void CGUIListItem::SetSortLabel(const CStdStringW &label)
 {
   m_sortLabel = label;
+  IncrementRevision();
 }
 
 const CStdStringW& CGUIListItem::GetSortLabel() const
@@ -128,12 +146,14 @@ void CGUIListItem::SetArt(const ArtMap &art)
 void CGUIListItem::SetArtFallback(const std::string &from, const std::string &to)
 {
   m_artFallbacks[from] = to;
+  IncrementRevision();
 }
 
 void CGUIListItem::ClearArt()
 {
   m_art.clear();
   m_artFallbacks.clear();
+  IncrementRevision();
 }
 
 void CGUIListItem::AppendArt(const ArtMap &art, const std::string &prefix)
@@ -248,6 +268,7 @@ const CGUIListItem& CGUIListItem::operator =(const CGUIListItem& item)
   m_mapProperties = item.m_mapProperties;
   m_art = item.m_art;
   m_artFallbacks = item.m_artFallbacks;
+  m_labelCache.clear();
   SetInvalid();
   return *this;
 }
@@ -321,6 +342,7 @@ void CGUIListItem::Archive(CArchive &ar)
       ar >> value;
       m_artFallbacks.insert(make_pair(key, value));
     }
+    IncrementRevision();
   }
 }
 void CGUIListItem::Serialize(CVariant &value)
@@ -388,6 +410,7 @@ CGUIListItemLayout *CGUIListItem::GetFocusedLayout()
 
 void CGUIListItem::SetInvalid()
 {
+  IncrementRevision();
   if (m_layout) m_layout->SetInvalid();
   if (m_focusedLayout) m_focusedLayout->SetInvalid();
 }
@@ -395,6 +418,7 @@ void CGUIListItem::SetInvalid()
 void CGUIListItem::SetProperty(const CStdString &strKey, const CVariant &value)
 {
   m_mapProperties[strKey] = value;
+  IncrementRevision();
 }
 
 CVariant CGUIListItem::GetProperty(const CStdString &strKey) const
@@ -419,12 +443,16 @@ void CGUIListItem::ClearProperty(const CStdString &strKey)
 {
   PropertyMap::iterator iter = m_mapProperties.find(strKey);
   if (iter != m_mapProperties.end())
+  {
     m_mapProperties.erase(iter);
+    IncrementRevision();
+  }
 }
 
 void CGUIListItem::ClearProperties()
 {
   m_mapProperties.clear();
+  IncrementRevision();
 }
 
 void CGUIListItem::IncrementProperty(const CStdString &strKey, int nVal)
@@ -446,3 +474,37 @@ void CGUIListItem::AppendProperties(const CGUIListItem &item)
   for (PropertyMap::const_iterator i = item.m_mapProperties.begin(); i != item.m_mapProperties.end(); ++i)
     SetProperty(i->first, i->second);
 }
+
+bool CGUIListItem::GetCachedLabel(unsigned int id, CStdString &label) const
+{
+  if (m_labelCacheRevision != m_revision || m_labelCacheEpoch != (unsigned int)m_labelEpoch)
+  {
+    m_labelCache.clear();
+    m_labelCacheRevision = m_revision;
+    m_labelCacheEpoch = (unsigned int)m_labelEpoch;
+    return false;
+  }
+  for (LabelCache::const_iterator i = m_labelCache.begin(); i != m_labelCache.end(); ++i)
+  {
+    if (i->first == id)
+    {
+      label = i->second;
+      return true;
+    }
+  }
+  return false;
+}
+
+void CGUIListItem::SetCachedLabel(unsigned int id, const CStdString &label) const
+{
+  if (m_labelCacheRevision != m_revision || m_labelCacheEpoch != (unsigned int)m_labelEpoch)
+    return; // changed while the label was built
+  if (m_labelCache.size() >= MAX_CACHED_LABELS)
+    m_labelCache.clear();
+  m_labelCache.push_back(make_pair(id, label));
+}
+
+void CGUIListItem::InvalidateCachedLabels()
+{
+  AtomicIncrement(&m_labelEpoch);
+}
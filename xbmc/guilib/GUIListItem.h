@@ -32,6 +32,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 //  Forward
 class CGUIListItemLayout;
@@ -174,7 +175,38 @@ public:
 
   CVariant   GetProperty(const CStdString &strKey) const;
 
+  /*! \brief Revision of the item, increased whenever something shown by a label may have changed
+   \return the current revision
+   */
+  unsigned int GetRevision() const { return m_revision; };
+
+  /*! \brief Fetch a label built from this item by a label program
+   Entries are dropped once the item revision moves on or InvalidateCachedLabels() is called.
+   \param id the id of the label program
+   \param label [out] the cached label
+   \return true if the label was cached, false otherwise
+   \sa SetCachedLabel
+   */
+  bool GetCachedLabel(unsigned int id, CStdString &label) const;
+
+  /*! \brief Keep a label built from this item by a label program
+   \param id the id of the label program
+   \param label the label to keep
+   \sa GetCachedLabel
+   */
+  void SetCachedLabel(unsigned int id, const CStdString &label) const;
+
+  /*! \brief Drop the cached labels of all items
+   Called when something outside the items changes how labels are formatted, e.g. a setting.
+   */
+  static void InvalidateCachedLabels();
+
 protected:
+  /*! \brief Mark the item as changed so that cached labels are rebuilt
+   Only touches the revision, so this is safe to call from the loader threads.
+   */
+  void IncrementRevision() { m_revision++; };
+
   CStdString m_strLabel2;     // text of column2
   CStdString m_strIcon;      // filename of icon
   GUIIconOverlay m_overlayIcon; // type of overlay icon
@@ -199,6 +231,13 @@ private:
 
   ArtMap m_art;
   ArtMap m_artFallbacks;
+
+  typedef std::vector< std::pair<unsigned int, CStdString> > LabelCache;
+  volatile unsigned int m_revision;
+  mutable LabelCache m_labelCache;
+  mutable unsigned int m_labelCacheRevision;
+  mutable unsigned int m_labelCacheEpoch;
+  static volatile long m_labelEpoch;
 };
 #endif
 
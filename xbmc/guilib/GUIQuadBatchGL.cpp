@@ -0,0 +1,188 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#if defined(HAS_GL)
+#include "GUIQuadBatchGL.h"
+#endif
+#include "GUIControlProfiler.h"
+#include "utils/GLUtils.h"
+
+#include <stddef.h>
+
+#if defined(HAS_GL)
+
+// upper bound of the vertices kept before the batch is drawn anyway
+#define BATCH_MAX_VERTICES (4 * 4096)
+#define BATCH_MIN_VERTICES (4 * 64)
+
+CGUIQuadBatchGL::CGUIQuadBatchGL()
+: m_mode(MODE_COLOR), m_texture(0), m_diffuse(0), m_count(0)
+{
+}
+
+CGUIQuadBatchGL &CGUIQuadBatchGL::Get()
+{
+  static CGUIQuadBatchGL batch;
+  return batch;
+}
+
+void CGUIQuadBatchGL::SetState(Mode mode, GLuint texture /* = 0 */, GLuint diffuse /* = 0 */)
+{
+  if (mode == MODE_COLOR)
+    texture = 0;
+  if (mode != MODE_TEXTURE_DIFFUSE)
+    diffuse = 0;
+
+  if (mode == m_mode && texture == m_texture && diffuse == m_diffuse)
+    return;
+
+  Flush();
+  m_mode = mode;
+  m_texture = texture;
+  m_diffuse = diffuse;
+}
+
+CGUIQuadBatchGL::SVertex *CGUIQuadBatchGL::AddQuad()
+{
+  if (m_count + 4 > m_vertices.size())
+  {
+    if (m_vertices.size() >= BATCH_MAX_VERTICES)
+      Flush();
+    else
+      m_vertices.resize(m_vertices.empty() ? BATCH_MIN_VERTICES : m_vertices.size() * 2);
+  }
+
+  SVertex *quad = &m_vertices[m_count];
+  m_count += 4;
+
+  GUIPROFILER_VERTICES(4);
+  return quad;
+}
+
+void CGUIQuadBatchGL::Flush()
+{
+  if (m_count == 0)
+    return;
+
+  ApplyState();
+
+  const char *vertices = (const char*)&m_vertices[0];
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+  glVertexPointer(3, GL_FLOAT        , sizeof(SVertex), vertices + offsetof(SVertex, x));
+  glColorPointer (4, GL_UNSIGNED_BYTE, sizeof(SVertex), vertices + offsetof(SVertex, r));
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+  if (m_mode != MODE_COLOR)
+  {
+    glClientActiveTexture(GL_TEXTURE0);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(SVertex), vertices + offsetof(SVertex, u1));
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  }
+  if (m_mode == MODE_TEXTURE_DIFFUSE)
+  {
+    glClientActiveTexture(GL_TEXTURE1);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(SVertex), vertices + offsetof(SVertex, u2));
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glClientActiveTexture(GL_TEXTURE0);
+  }
+
+  glDrawArrays(GL_QUADS, 0, m_count);
+  glPopClientAttrib();
+
+  ResetState();
+  VerifyGLState();
+
+  GUIPROFILER_DRAWCALL();
+  m_count = 0;
+}
+
+void CGUIQuadBatchGL::ApplyState()
+{
+  glEnable(GL_BLEND);
+  if (m_mode == MODE_FONT)
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
+  else
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+  glActiveTexture(GL_TEXTURE0);
+  if (m_mode == MODE_COLOR)
+  {
+    glDisable(GL_TEXTURE_2D);
+    return;
+  }
+
+  glBindTexture(GL_TEXTURE_2D, m_texture);
+  glEnable(GL_TEXTURE_2D);
+  GUIPROFILER_TEXTUREBIND();
+
+  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+  if (m_mode == MODE_FONT)
+  {
+    // color of the vertices, alpha of the glyphs
+    glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_REPLACE);
+    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_PRIMARY_COLOR);
+    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
+  }
+  else
+  {
+    // diffuse coloring
+    glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
+    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE0);
+    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
+    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PRIMARY_COLOR);
+    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
+  }
+  glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
+  glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE0);
+  glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
+  glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PRIMARY_COLOR);
+  glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
+
+  if (m_mode == MODE_TEXTURE_DIFFUSE)
+  {
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, m_diffuse);
+    glEnable(GL_TEXTURE_2D);
+    GUIPROFILER_TEXTUREBIND();
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+    glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
+    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE1);
+    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
+    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PREVIOUS);
+    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
+  }
+}
+
+void CGUIQuadBatchGL::ResetState()
+{
+  // leave texturing disabled just like the immediate mode drawing did
+  if (m_mode == MODE_TEXTURE_DIFFUSE)
+  {
+    glActiveTexture(GL_TEXTURE1);
+    glDisable(GL_TEXTURE_2D);
+    glActiveTexture(GL_TEXTURE0);
+  }
+  glDisable(GL_TEXTURE_2D);
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*!
+\file GUIQuadBatchGL.h
+\brief
+*/
+
+#ifndef GUILIB_GUIQUADBATCHGL_H
+#define GUILIB_GUIQUADBATCHGL_H
+
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system_gl.h"
+
+#include <vector>
+
+/*!
+ \ingroup textures
+ \brief Collects the quads of textures and fonts rendered in a frame and draws
+ all consecutive quads sharing the same texture and blending state with a
+ single draw call.
+
+ Quads are only drawn once the state changes or Flush() is called. Any code
+ changing GL state or drawing on its own (scissors, viewport, video, ...)
+ has to call Flush() first so the quads are drawn in the right order.
+ */
+class CGUIQuadBatchGL
+{
+public:
+  enum Mode
+  {
+    MODE_COLOR = 0,       ///< untextured quads
+    MODE_TEXTURE,         ///< texture modulated by the vertex color
+    MODE_TEXTURE_DIFFUSE, ///< texture modulated by a diffuse texture and the vertex color
+    MODE_FONT             ///< vertex color with the alpha of a font texture
+  };
+
+  struct SVertex
+  {
+    float x, y, z;
+    unsigned char r, g, b, a;
+    float u1, v1;
+    float u2, v2;
+  };
+
+  static CGUIQuadBatchGL &Get();
+
+  /*!
+   \brief Set the state of the following quads, flushes the batch if it changes
+   */
+  void SetState(Mode mode, GLuint texture = 0, GLuint diffuse = 0);
+
+  /*!
+   \brief Add a quad using the current state
+   \return the four vertices of the quad which have to be filled in by the caller
+   */
+  SVertex *AddQuad();
+
+  /*!
+   \brief Draw all collected quads
+   */
+  void Flush();
+
+private:
+  CGUIQuadBatchGL();
+  CGUIQuadBatchGL(const CGUIQuadBatchGL &);
+  CGUIQuadBatchGL &operator=(const CGUIQuadBatchGL &);
+
+  void ApplyState();
+  void ResetState();
+
+  Mode m_mode;
+  GLuint m_texture;
+  GLuint m_diffuse;
+  std::vector<SVertex> m_vertices;
+  unsigned int m_count;
+};
+
+#endif
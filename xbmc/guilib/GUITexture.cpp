@@ -248,6 +248,8 @@ void CGUITextureBase::Render(float left, float top, float right, float bottom, f
 
   int orientation = GetOrientation();
   OrientateTexture(texture, u3, v3, orientation);
+  // images packed into an atlas sit somewhere within their texture
+  texture += CPoint(m_texture.m_texOffsetX, m_texture.m_texOffsetY);
 
   if (m_diffuse.size())
   {
@@ -257,6 +259,7 @@ void CGUITextureBase::Render(float left, float top, float right, float bottom, f
     diffuse.y1 *= m_diffuseScaleV / v3; diffuse.y2 *= m_diffuseScaleV / v3;
     diffuse += m_diffuseOffset;
     OrientateTexture(diffuse, m_diffuseU, m_diffuseV, m_info.orientation);
+    diffuse += CPoint(m_diffuse.m_texOffsetX, m_diffuse.m_texOffsetY);
   }
 
   float x[4], y[4], z[4];
@@ -20,6 +20,7 @@
 
 #include "Texture.h"
 #include "GUITextureD3D.h"
+#include "GUIControlProfiler.h"
 #include "windowing/WindowingFactory.h"
 
 #ifdef HAS_DX
@@ -39,6 +40,7 @@ void CGUITextureD3D::Begin(color_t color)
     m_diffuse.m_textures[0]->LoadToGPU();
   // Set state to render the image
   texture->BindToUnit(0);
+  GUIPROFILER_TEXTUREBIND();
   p3DDevice->SetTextureStageState( 0, D3DTSS_COLOROP, D3DTOP_MODULATE );
   p3DDevice->SetTextureStageState( 0, D3DTSS_COLORARG1, D3DTA_TEXTURE );
   p3DDevice->SetTextureStageState( 0, D3DTSS_COLORARG2, D3DTA_DIFFUSE );
@@ -48,6 +50,7 @@ void CGUITextureD3D::Begin(color_t color)
   if (m_diffuse.size())
   {
     m_diffuse.m_textures[0]->BindToUnit(1);
+    GUIPROFILER_TEXTUREBIND();
     p3DDevice->SetTextureStageState( 1, D3DTSS_COLORARG1, D3DTA_TEXTURE );
     p3DDevice->SetTextureStageState( 1, D3DTSS_COLORARG2, D3DTA_CURRENT );
     p3DDevice->SetTextureStageState( 1, D3DTSS_COLOROP, D3DTOP_MODULATE );
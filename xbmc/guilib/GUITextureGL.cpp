@@ -21,6 +21,7 @@
 #include "system.h"
 #if defined(HAS_GL)
 #include "GUITextureGL.h"
+#include "GUIQuadBatchGL.h"
 #endif
 #include "Texture.h"
 #include "utils/log.h"
@@ -41,146 +42,118 @@ void CGUITextureGL::Begin(color_t color)
   m_col[2] = (GLubyte)GET_B(color);
   m_col[3] = (GLubyte)GET_A(color);
 
-  CBaseTexture* texture = m_texture.m_textures[m_currentFrame];
+  CGLTexture* texture = (CGLTexture*)m_texture.m_textures[m_currentFrame];
   texture->LoadToGPU();
-  if (m_diffuse.size())
-    m_diffuse.m_textures[0]->LoadToGPU();
-
-  texture->BindToUnit(0);
-
-  glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
-  glEnable(GL_BLEND);          // Turn Blending On
-  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-  // diffuse coloring
-  glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE0);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PRIMARY_COLOR);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
-  VerifyGLState();
-
   if (m_diffuse.size())
   {
-    m_diffuse.m_textures[0]->BindToUnit(1);
-    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-    glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE1);
-    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
-    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PREVIOUS);
-    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
-    VerifyGLState();
+    CGLTexture* diffuse = (CGLTexture*)m_diffuse.m_textures[0];
+    diffuse->LoadToGPU();
+    CGUIQuadBatchGL::Get().SetState(CGUIQuadBatchGL::MODE_TEXTURE_DIFFUSE, texture->GetTextureObject(), diffuse->GetTextureObject());
   }
-  //glDisable(GL_TEXTURE_2D); // uncomment these 2 lines to switch to wireframe rendering
-  //glBegin(GL_LINE_LOOP);
-  glBegin(GL_QUADS);
+  else
+    CGUIQuadBatchGL::Get().SetState(CGUIQuadBatchGL::MODE_TEXTURE, texture->GetTextureObject());
 }
 
 void CGUITextureGL::End()
 {
-  glEnd();
-  if (m_diffuse.size())
-  {
-    glDisable(GL_TEXTURE_2D);
-    glActiveTextureARB(GL_TEXTURE0_ARB);
-  }
-  glDisable(GL_TEXTURE_2D);
+  // the quads are drawn by the batch once the state changes
 }
 
 void CGUITextureGL::Draw(float *x, float *y, float *z, const CRect &texture, const CRect &diffuse, int orientation)
 {
+  CGUIQuadBatchGL::SVertex *v = CGUIQuadBatchGL::Get().AddQuad();
+  for (int i = 0; i < 4; i++)
+  {
+    v[i].x = x[i];
+    v[i].y = y[i];
+    v[i].z = z[i];
+    v[i].r = m_col[0];
+    v[i].g = m_col[1];
+    v[i].b = m_col[2];
+    v[i].a = m_col[3];
+  }
+
   // Top-left vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y1);
-  if (m_diffuse.size())
-    glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y1);
-  glVertex3f(x[0], y[0], z[0]);
+  v[0].u1 = texture.x1;
+  v[0].v1 = texture.y1;
 
   // Top-right vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
   if (orientation & 4)
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y2);
+  {
+    v[1].u1 = texture.x1;
+    v[1].v1 = texture.y2;
+  }
   else
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y1);
-  if (m_diffuse.size())
   {
-    if (m_info.orientation & 4)
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y2);
-    else
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y1);
+    v[1].u1 = texture.x2;
+    v[1].v1 = texture.y1;
   }
-  glVertex3f(x[1], y[1], z[1]);
 
   // Bottom-right vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y2);
-  if (m_diffuse.size())
-    glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y2);
-  glVertex3f(x[2], y[2], z[2]);
+  v[2].u1 = texture.x2;
+  v[2].v1 = texture.y2;
 
   // Bottom-left vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
   if (orientation & 4)
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y1);
+  {
+    v[3].u1 = texture.x2;
+    v[3].v1 = texture.y1;
+  }
   else
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y2);
+  {
+    v[3].u1 = texture.x1;
+    v[3].v1 = texture.y2;
+  }
+
   if (m_diffuse.size())
   {
+    v[0].u2 = diffuse.x1;
+    v[0].v2 = diffuse.y1;
+    v[2].u2 = diffuse.x2;
+    v[2].v2 = diffuse.y2;
     if (m_info.orientation & 4)
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y1);
+    {
+      v[1].u2 = diffuse.x1;
+      v[1].v2 = diffuse.y2;
+      v[3].u2 = diffuse.x2;
+      v[3].v2 = diffuse.y1;
+    }
     else
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y2);
+    {
+      v[1].u2 = diffuse.x2;
+      v[1].v2 = diffuse.y1;
+      v[3].u2 = diffuse.x1;
+      v[3].v2 = diffuse.y2;
+    }
   }
-  glVertex3f(x[3], y[3], z[3]);
 }
 
 void CGUITextureGL::DrawQuad(const CRect &rect, color_t color, CBaseTexture *texture, const CRect *texCoords)
 {
+  CGUIQuadBatchGL &batch = CGUIQuadBatchGL::Get();
   if (texture)
   {
     texture->LoadToGPU();
-    texture->BindToUnit(0);
-    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-    glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE1);
-    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
-    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PREVIOUS);
-    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
+    batch.SetState(CGUIQuadBatchGL::MODE_TEXTURE, ((CGLTexture*)texture)->GetTextureObject());
   }
   else
-  glDisable(GL_TEXTURE_2D);
-
-  glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
-  glEnable(GL_BLEND);          // Turn Blending On
-  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-  // diffuse coloring
-  glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE0);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PRIMARY_COLOR);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
-  VerifyGLState();
-
-  glBegin(GL_QUADS);
-
-  glColor4ub((GLubyte)GET_R(color), (GLubyte)GET_G(color), (GLubyte)GET_B(color), (GLubyte)GET_A(color));
+    batch.SetState(CGUIQuadBatchGL::MODE_COLOR);
 
+  CGUIQuadBatchGL::SVertex *v = batch.AddQuad();
   CRect coords = texCoords ? *texCoords : CRect(0.0f, 0.0f, 1.0f, 1.0f);
-  glTexCoord2f(coords.x1, coords.y1);
-  glVertex3f(rect.x1, rect.y1, 0);
-  glTexCoord2f(coords.x2, coords.y1);
-  glVertex3f(rect.x2, rect.y1, 0);
-  glTexCoord2f(coords.x2, coords.y2);
-  glVertex3f(rect.x2, rect.y2, 0);
-  glTexCoord2f(coords.x1, coords.y2);
-  glVertex3f(rect.x1, rect.y2, 0);
-
-  glEnd();
-  if (texture)
-    glDisable(GL_TEXTURE_2D);
+  for (int i = 0; i < 4; i++)
+  {
+    v[i].z = 0;
+    v[i].r = (GLubyte)GET_R(color);
+    v[i].g = (GLubyte)GET_G(color);
+    v[i].b = (GLubyte)GET_B(color);
+    v[i].a = (GLubyte)GET_A(color);
+  }
+
+  v[0].x = rect.x1; v[0].y = rect.y1; v[0].u1 = coords.x1; v[0].v1 = coords.y1;
+  v[1].x = rect.x2; v[1].y = rect.y1; v[1].u1 = coords.x2; v[1].v1 = coords.y1;
+  v[2].x = rect.x2; v[2].y = rect.y2; v[2].u1 = coords.x2; v[2].v1 = coords.y2;
+  v[3].x = rect.x1; v[3].y = rect.y2; v[3].u1 = coords.x1; v[3].v1 = coords.y2;
 }
 
 #endif
@@ -28,6 +28,7 @@
 #include "utils/MathUtils.h"
 #include "windowing/WindowingFactory.h"
 #include "guilib/GraphicContext.h"
+#include "GUIControlProfiler.h"
 
 #if defined(HAS_GLES)
 
@@ -45,6 +46,7 @@ void CGUITextureGLES::Begin(color_t color)
     m_diffuse.m_textures[0]->LoadToGPU();
 
   texture->BindToUnit(0);
+  GUIPROFILER_TEXTUREBIND();
 
   // Setup Colors
   for (int i = 0; i < 4; i++)
@@ -71,6 +73,7 @@ void CGUITextureGLES::Begin(color_t color)
     hasAlpha |= m_diffuse.m_textures[0]->HasAlpha();
 
     m_diffuse.m_textures[0]->BindToUnit(1);
+    GUIPROFILER_TEXTUREBIND();
 
     GLint tex1Loc = g_Windowing.GUIShaderGetCoord1();
     glVertexAttribPointer(tex1Loc, 2, GL_FLOAT, 0, 0, m_tex1);
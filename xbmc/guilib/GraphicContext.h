@@ -119,6 +119,7 @@ public:
   inline float ScaleFinalYCoord(float x, float y) const XBMC_FORCE_INLINE { return m_finalTransform.TransformYCoord(x, y, 0); }
   inline float ScaleFinalZCoord(float x, float y) const XBMC_FORCE_INLINE { return m_finalTransform.TransformZCoord(x, y, 0); }
   inline void ScaleFinalCoords(float &x, float &y, float &z) const XBMC_FORCE_INLINE { m_finalTransform.TransformPosition(x, y, z); }
+  inline const TransformMatrix &GetFinalTransform() const XBMC_FORCE_INLINE { return m_finalTransform; }
   bool RectIsAngled(float x1, float y1, float x2, float y2) const;
 
   inline float GetGUIScaleX() const XBMC_FORCE_INLINE { return m_guiScaleX; }
@@ -169,6 +170,10 @@ public:
   void ApplyHardwareTransform();
   void RestoreHardwareTransform();
   void ClipRect(CRect &vertex, CRect &texture, CRect *diffuse = NULL);
+  /*! \brief Get the clip region used by ClipRect(), relative to the current origin
+   \return false if there's no clip region.
+   */
+  bool GetClipRegion(CRect &region) const;
   inline unsigned int AddGUITransform()
   {
     unsigned int size = m_groupTransform.size();
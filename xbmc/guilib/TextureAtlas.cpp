@@ -0,0 +1,146 @@
+/*
+*      Copyright (C) 2005-2012 Team XBMC
+*      http://www.xbmc.org
+*
+*  This Program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2, or (at your option)
+*  any later version.
+*
+*  This Program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with XBMC; see the file COPYING.  If not, see
+*  <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "TextureAtlas.h"
+#include "Texture.h"
+
+#include <string.h>
+
+#define ATLAS_BORDER 1
+
+CTextureAtlas::CTextureAtlas(unsigned int size)
+{
+  m_size = size;
+  m_images = 0;
+  m_usedPixels = 0;
+  m_pixels = new unsigned char[m_size * m_size * 4];
+  memset(m_pixels, 0, m_size * m_size * 4);
+  m_texture = new CTexture();
+  m_texture->Update(m_size, m_size, m_size * 4, XB_FMT_A8R8G8B8, m_pixels, false);
+}
+
+CTextureAtlas::~CTextureAtlas()
+{
+  delete m_texture;
+  delete[] m_pixels;
+}
+
+bool CTextureAtlas::Add(const CBaseTexture *texture, unsigned int &x, unsigned int &y)
+{
+  if (!texture || !texture->GetPixels() || (texture->GetFormat() & XB_FMT_MASK) != XB_FMT_A8R8G8B8)
+    return false;
+
+  if (!FindSpace(texture->GetWidth() + 2 * ATLAS_BORDER, texture->GetHeight() + 2 * ATLAS_BORDER, x, y))
+    return false;
+  x += ATLAS_BORDER;
+  y += ATLAS_BORDER;
+
+  CopyImage(m_pixels, texture, x, y);
+  if (m_texture->GetPixels())
+  { // not uploaded since the last change, so just add the image to the pending pixels
+    CopyImage(m_texture->GetPixels(), texture, x, y);
+  }
+  else
+  { // the texture is on the GPU already, upload the whole atlas again on next use
+    m_texture->Update(m_size, m_size, m_size * 4, XB_FMT_A8R8G8B8, m_pixels, false);
+  }
+
+  m_images++;
+  m_usedPixels += (texture->GetWidth() + 2 * ATLAS_BORDER) * (texture->GetHeight() + 2 * ATLAS_BORDER);
+  return true;
+}
+
+float CTextureAtlas::GetOccupancy() const
+{
+  return (float)m_usedPixels / (m_size * m_size);
+}
+
+uint32_t CTextureAtlas::GetMemoryUsage() const
+{
+  // the texture itself and our copy of its pixels
+  return sizeof(CTexture) + m_size * m_size * 4 * 2;
+}
+
+bool CTextureAtlas::FindSpace(unsigned int width, unsigned int height, unsigned int &x, unsigned int &y)
+{
+  if (width > m_size || height > m_size)
+    return false;
+
+  // use the lowest shelf the image fits on
+  CShelf *shelf = NULL;
+  for (std::vector<CShelf>::iterator i = m_shelves.begin(); i != m_shelves.end(); ++i)
+  {
+    if (i->height >= height && i->width + width <= m_size && (!shelf || i->height < shelf->height))
+      shelf = &(*i);
+  }
+
+  // don't waste a shelf of twice the height on the image while there's room for a new one
+  unsigned int top = m_shelves.empty() ? 0 : m_shelves.back().y + m_shelves.back().height;
+  if (shelf && shelf->height > 2 * height && top + height <= m_size)
+    shelf = NULL;
+
+  if (!shelf)
+  {
+    if (top + height > m_size)
+      return false;
+    CShelf newShelf;
+    newShelf.y = top;
+    newShelf.height = height;
+    newShelf.width = 0;
+    m_shelves.push_back(newShelf);
+    shelf = &m_shelves.back();
+  }
+
+  x = shelf->width;
+  y = shelf->y;
+  shelf->width += width;
+  return true;
+}
+
+void CTextureAtlas::CopyImage(unsigned char *dest, const CBaseTexture *texture, unsigned int x, unsigned int y) const
+{
+  const unsigned int width = texture->GetWidth();
+  const unsigned int height = texture->GetHeight();
+  const unsigned int srcPitch = texture->GetPitch();
+  const unsigned int destPitch = m_size * 4;
+  const unsigned char *src = texture->GetPixels();
+
+  // the image and its left and right border
+  for (unsigned int row = 0; row < height; row++)
+  {
+    unsigned char *dst = dest + (y + row) * destPitch + x * 4;
+    memcpy(dst, src + row * srcPitch, width * 4);
+    for (unsigned int b = 1; b <= ATLAS_BORDER; b++)
+    {
+      memcpy(dst - b * 4, dst, 4);
+      memcpy(dst + (width - 1 + b) * 4, dst + (width - 1) * 4, 4);
+    }
+  }
+
+  // the top and bottom border repeat the first and last row
+  const unsigned int rowSize = (width + 2 * ATLAS_BORDER) * 4;
+  unsigned char *first = dest + y * destPitch + (x - ATLAS_BORDER) * 4;
+  unsigned char *last = first + (height - 1) * destPitch;
+  for (unsigned int b = 1; b <= ATLAS_BORDER; b++)
+  {
+    memcpy(first - b * destPitch, first, rowSize);
+    memcpy(last + b * destPitch, last, rowSize);
+  }
+}
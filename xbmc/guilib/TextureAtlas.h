@@ -0,0 +1,90 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*!
+\file TextureAtlas.h
+\brief
+*/
+
+#ifndef GUILIB_TEXTUREATLAS_H
+#define GUILIB_TEXTUREATLAS_H
+
+#include <vector>
+#include <stdint.h>
+
+class CBaseTexture;
+
+/*!
+ \ingroup textures
+ \brief A large texture holding many small skin images.
+
+ Images are packed into shelves (rows of images sharing the same height), each
+ surrounded by a one pixel border repeating its edge pixels so that filtering
+ near the edge of an image never picks up its neighbours.
+
+ The atlas keeps a copy of its pixels so that images can be added after the
+ texture has been loaded to the GPU, the texture is then uploaded again the
+ next time it is rendered.
+ */
+class CTextureAtlas
+{
+public:
+  CTextureAtlas(unsigned int size);
+  ~CTextureAtlas();
+
+  /*! \brief Copy an image into a free area of the atlas
+   \param texture the image to add, has to be an uncompressed A8R8G8B8 texture.
+   \param x [out] horizontal position of the image within the atlas in pixels.
+   \param y [out] vertical position of the image within the atlas in pixels.
+   \return true if the image was added, false if there was no room left for it.
+   */
+  bool Add(const CBaseTexture *texture, unsigned int &x, unsigned int &y);
+
+  CBaseTexture *GetTexture() const { return m_texture; };
+  unsigned int GetSize() const { return m_size; };
+  unsigned int GetImageCount() const { return m_images; };
+
+  /*! \brief return the fraction of the atlas covered by images (including their borders) */
+  float GetOccupancy() const;
+  uint32_t GetMemoryUsage() const;
+
+private:
+  CTextureAtlas(const CTextureAtlas &);
+  CTextureAtlas &operator=(const CTextureAtlas &);
+
+  struct CShelf
+  {
+    unsigned int y;      ///< top of the shelf
+    unsigned int height; ///< height of the shelf
+    unsigned int width;  ///< used width of the shelf
+  };
+
+  bool FindSpace(unsigned int width, unsigned int height, unsigned int &x, unsigned int &y);
+  void CopyImage(unsigned char *dest, const CBaseTexture *texture, unsigned int x, unsigned int y) const;
+
+  std::vector<CShelf> m_shelves;
+  unsigned int m_size;
+  unsigned int m_images;
+  unsigned int m_usedPixels;
+  unsigned char *m_pixels;
+  CBaseTexture *m_texture;
+};
+
+#endif
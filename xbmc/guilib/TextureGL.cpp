@@ -20,6 +20,9 @@
 
 #include "system.h"
 #include "TextureGL.h"
+#if defined(HAS_GL)
+#include "GUIQuadBatchGL.h"
+#endif
 #include "windowing/WindowingFactory.h"
 #include "utils/log.h"
 #include "utils/GLUtils.h"
@@ -50,7 +53,13 @@ void CGLTexture::CreateTextureObject()
 void CGLTexture::DestroyTextureObject()
 {
   if (m_texture)
+  {
+#if defined(HAS_GL)
+    // quads still waiting to be drawn may use the texture
+    CGUIQuadBatchGL::Get().Flush();
+#endif
     glDeleteTextures(1, (GLuint*) &m_texture);
+  }
 }
 
 void CGLTexture::LoadToGPU()
@@ -66,6 +75,13 @@ void CGLTexture::LoadToGPU()
     // this happens only one time - the first time the texture is loaded
     CreateTextureObject();
   }
+#if defined(HAS_GL)
+  else
+  {
+    // quads still waiting to be drawn may use the old image
+    CGUIQuadBatchGL::Get().Flush();
+  }
+#endif
 
   // Bind the texture object
   glBindTexture(GL_TEXTURE_2D, m_texture);
@@ -109,6 +125,10 @@ void CGLTexture::LoadToGPU()
     format = GL_RGB;
     numcomponents = GL_RGB;
     break;
+  case XB_FMT_A8:
+    format = GL_ALPHA;
+    numcomponents = GL_ALPHA;
+    break;
   case XB_FMT_A8R8G8B8:
   default:
     break;
@@ -152,6 +172,9 @@ void CGLTexture::LoadToGPU()
     case XB_FMT_RGB8:
       internalformat = pixelformat = GL_RGB;
       break;
+    case XB_FMT_A8:
+      internalformat = pixelformat = GL_ALPHA;
+      break;
     case XB_FMT_A8R8G8B8:
       if (g_Windowing.SupportsBGRA())
       {
@@ -20,13 +20,19 @@
 
 #include "TextureManager.h"
 #include "Texture.h"
+#include "TextureAtlas.h"
 #include "AnimatedGif.h"
 #include "GraphicContext.h"
+#if defined(HAS_GL)
+#include "GUIQuadBatchGL.h"
+#endif
 #include "threads/SingleLock.h"
 #include "utils/CharsetConverter.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "addons/Skin.h"
+#include "settings/AdvancedSettings.h"
+#include "windowing/WindowingFactory.h"
 #ifdef _DEBUG
 #include "utils/TimeUtils.h"
 #endif
@@ -34,9 +40,13 @@
 #include "filesystem/Directory.h"
 #include "URL.h"
 #include <assert.h>
+#include <algorithm>
 
 using namespace std;
 
+#define ATLAS_SIZE     1024
+#define ATLAS_MAXCOUNT 4
+
 
 /************************************************************************/
 /*                                                                      */
@@ -50,6 +60,8 @@ CTextureArray::CTextureArray(int width, int height, int loops,  bool texCoordsAr
   m_texWidth = 0;
   m_texHeight = 0;
   m_texCoordsArePixels = false;
+  m_texOffsetX = 0;
+  m_texOffsetY = 0;
 }
 
 CTextureArray::CTextureArray()
@@ -79,6 +91,8 @@ void CTextureArray::Reset()
   m_texWidth = 0;
   m_texHeight = 0;
   m_texCoordsArePixels = false;
+  m_texOffsetX = 0;
+  m_texOffsetY = 0;
 }
 
 void CTextureArray::Add(CBaseTexture *texture, int delay)
@@ -127,6 +141,7 @@ CTextureMap::CTextureMap()
   m_textureName = "";
   m_referenceCount = 0;
   m_memUsage = 0;
+  m_atlased = false;
 }
 
 CTextureMap::CTextureMap(const CStdString& textureName, int width, int height, int loops)
@@ -135,6 +150,7 @@ CTextureMap::CTextureMap(const CStdString& textureName, int width, int height, i
   m_textureName = textureName;
   m_referenceCount = 0;
   m_memUsage = 0;
+  m_atlased = false;
 }
 
 CTextureMap::~CTextureMap()
@@ -192,7 +208,13 @@ void CTextureMap::Flush()
 
 void CTextureMap::FreeTexture()
 {
-  m_texture.Free();
+  if (m_atlased)
+  { // the atlas is freed by the texture manager
+    m_texture.Reset();
+    m_atlased = false;
+  }
+  else
+    m_texture.Free();
 }
 
 bool CTextureMap::IsEmpty() const
@@ -208,6 +230,15 @@ void CTextureMap::Add(CBaseTexture* texture, int delay)
     m_memUsage += sizeof(CTexture) + (texture->GetTextureWidth() * texture->GetTextureHeight() * 4);
 }
 
+void CTextureMap::Add(CTextureAtlas *atlas, unsigned int x, unsigned int y)
+{
+  // the memory is accounted for by the atlas
+  m_texture.Add(atlas->GetTexture(), 100);
+  m_texture.m_texOffsetX = (float)x / m_texture.m_texWidth;
+  m_texture.m_texOffsetY = (float)y / m_texture.m_texHeight;
+  m_atlased = true;
+}
+
 /************************************************************************/
 /*                                                                      */
 /************************************************************************/
@@ -390,6 +421,9 @@ int CGUITextureManager::Load(const CStdString& strTextureName, bool checkBundleO
     return 1;
   } // of if (strPath.Right(4).ToLower()==".gif")
 
+  if (LoadFromAtlas(strTextureName))
+    return 1;
+
   CBaseTexture *pTexture = NULL;
   int width = 0, height = 0;
   if (bundle >= 0)
@@ -411,6 +445,12 @@ int CGUITextureManager::Load(const CStdString& strTextureName, bool checkBundleO
 
   if (!pTexture) return 0;
 
+  if (AddToAtlas(strTextureName, pTexture, width, height))
+  {
+    delete pTexture;
+    return 1;
+  }
+
   CTextureMap* pMap = new CTextureMap(strTextureName, width, height, 0);
   pMap->Add(pTexture, 100);
   m_vecTextures.push_back(pMap);
@@ -427,6 +467,56 @@ int CGUITextureManager::Load(const CStdString& strTextureName, bool checkBundleO
   return 1;
 }
 
+bool CGUITextureManager::LoadFromAtlas(const CStdString &textureName)
+{
+  map<CStdString, CAtlasImage>::const_iterator i = m_atlasImages.find(textureName);
+  if (i == m_atlasImages.end())
+    return false;
+
+  const CAtlasImage &image = i->second;
+  CTextureMap* pMap = new CTextureMap(textureName, image.width, image.height, 0);
+  pMap->Add(m_atlases[image.atlas], image.x, image.y);
+  m_vecTextures.push_back(pMap);
+  return true;
+}
+
+bool CGUITextureManager::AddToAtlas(const CStdString &textureName, CBaseTexture *texture, int width, int height)
+{
+  // only small uncompressed images from the skin are worth packing
+  int threshold = g_advancedSettings.m_guiTextureAtlasThreshold;
+  if (threshold <= 0 || width > threshold || height > threshold || CURL::IsFullPath(textureName))
+    return false;
+  if ((int)texture->GetWidth() != width || (int)texture->GetHeight() != height)
+    return false;
+  // check the format before an atlas gets allocated for an image it can't take
+  if (!texture->GetPixels() || (texture->GetFormat() & XB_FMT_MASK) != XB_FMT_A8R8G8B8)
+    return false;
+
+  CAtlasImage image;
+  image.width = width;
+  image.height = height;
+  for (image.atlas = 0; image.atlas < m_atlases.size(); image.atlas++)
+  {
+    if (m_atlases[image.atlas]->Add(texture, image.x, image.y))
+      break;
+  }
+  if (image.atlas == m_atlases.size())
+  {
+    unsigned int size = std::min((unsigned int)ATLAS_SIZE, g_Windowing.GetMaxTextureSize());
+    if (m_atlases.size() >= ATLAS_MAXCOUNT || (unsigned int)threshold + 2 > size)
+      return false;
+    CTextureAtlas *atlas = new CTextureAtlas(size);
+    if (!atlas->Add(texture, image.x, image.y))
+    {
+      delete atlas;
+      return false;
+    }
+    m_atlases.push_back(atlas);
+  }
+
+  m_atlasImages[textureName] = image;
+  return LoadFromAtlas(textureName);
+}
 
 void CGUITextureManager::ReleaseTexture(const CStdString& strTextureName)
 {
@@ -456,6 +546,9 @@ void CGUITextureManager::ReleaseTexture(const CStdString& strTextureName)
 void CGUITextureManager::FreeUnusedTextures()
 {
   CSingleLock lock(g_graphicsContext);
+#if defined(HAS_GL)
+  CGUIQuadBatchGL::Get().Flush();
+#endif
   for (ivecTextures i = m_unusedTextures.begin(); i != m_unusedTextures.end(); ++i)
     delete *i;
   m_unusedTextures.clear();
@@ -490,6 +583,15 @@ void CGUITextureManager::Cleanup()
   for (int i = 0; i < 2; i++)
     m_TexBundle[i].Cleanup();
   FreeUnusedTextures();
+
+  if (!m_atlases.empty())
+  {
+    CLog::Log(LOGDEBUG, "%s: Freeing %u texture atlases holding %u images", __FUNCTION__, (unsigned int)m_atlases.size(), (unsigned int)m_atlasImages.size());
+    for (vector<CTextureAtlas*>::iterator i = m_atlases.begin(); i != m_atlases.end(); ++i)
+      delete *i;
+    m_atlases.clear();
+    m_atlasImages.clear();
+  }
 }
 
 void CGUITextureManager::Dump() const
@@ -504,6 +606,13 @@ void CGUITextureManager::Dump() const
     if (!pMap->IsEmpty())
       pMap->Dump();
   }
+
+  for (unsigned int i = 0; i < m_atlases.size(); ++i)
+  {
+    strLog.Format("  atlas:%u is %ux%u with %u images %.0f%% used\n", i, m_atlases[i]->GetSize(), m_atlases[i]->GetSize(),
+                  m_atlases[i]->GetImageCount(), m_atlases[i]->GetOccupancy() * 100);
+    OutputDebugString(strLog.c_str());
+  }
 }
 
 void CGUITextureManager::Flush()
@@ -535,6 +644,8 @@ unsigned int CGUITextureManager::GetMemoryUsage() const
   {
     memUsage += m_vecTextures[i]->GetMemoryUsage();
   }
+  for (unsigned int i = 0; i < m_atlases.size(); ++i)
+    memUsage += m_atlases[i]->GetMemoryUsage();
   return memUsage;
 }
 
@@ -26,6 +26,7 @@
 #ifndef GUILIB_TEXTUREMANAGER_H
 #define GUILIB_TEXTUREMANAGER_H
 
+#include <map>
 #include <vector>
 #include "TextureBundle.h"
 #include "threads/CriticalSection.h"
@@ -59,6 +60,8 @@ public:
   int m_texWidth;
   int m_texHeight;
   bool m_texCoordsArePixels;
+  float m_texOffsetX; ///< offset of the image within the texture (in texture coords), set for images packed into an atlas
+  float m_texOffsetY;
 };
 
 /*!
@@ -68,6 +71,8 @@ public:
 /************************************************************************/
 /*                                                                      */
 /************************************************************************/
+class CTextureAtlas;
+
 class CTextureMap
 {
 public:
@@ -76,6 +81,7 @@ public:
   virtual ~CTextureMap();
 
   void Add(CBaseTexture* texture, int delay);
+  void Add(CTextureAtlas *atlas, unsigned int x, unsigned int y);
   bool Release();
 
   const CStdString& GetName() const;
@@ -91,6 +97,7 @@ protected:
   CTextureArray m_texture;
   unsigned int m_referenceCount;
   uint32_t m_memUsage;
+  bool m_atlased; ///< our texture is owned by an atlas
 };
 
 /*!
@@ -124,7 +131,13 @@ public:
 
   void FreeUnusedTextures(); ///< Free textures (called from app thread only)
   void ReleaseHwTexture(unsigned int texture);
+
+  unsigned int GetAtlasCount() const { return m_atlases.size(); };
+  const CTextureAtlas *GetAtlas(unsigned int i) const { return m_atlases[i]; };
 protected:
+  bool LoadFromAtlas(const CStdString &textureName);
+  bool AddToAtlas(const CStdString &textureName, CBaseTexture *texture, int width, int height);
+
   std::vector<CTextureMap*> m_vecTextures;
   std::vector<CTextureMap*> m_unusedTextures;
   std::vector<unsigned int> m_unusedHwTextures;
@@ -134,6 +147,16 @@ protected:
 
   std::vector<CStdString> m_texturePaths;
   CCriticalSection m_section;
+
+  // small skin images are packed into atlases, where they stay until the skin is unloaded
+  struct CAtlasImage
+  {
+    unsigned int atlas;
+    unsigned int x, y;
+    int width, height;
+  };
+  std::vector<CTextureAtlas*> m_atlases;
+  std::map<CStdString, CAtlasImage> m_atlasImages;
 };
 
 /*!
@@ -0,0 +1,134 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GUIInfoTypes.h"
+#include "guilib/GUIListContainer.h"
+#include "guilib/GUILabel.h"
+#include "guilib/GUIMessage.h"
+#include "guilib/Key.h"
+#include "FileItem.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <iostream>
+
+#define BENCH_ITEMS       5000
+#define BENCH_CONTROL_ID  50
+#define BENCH_FRAME_TIME  20
+#define BENCH_PAGE_FRAMES 12  // frames to let the scroller settle after a page move
+
+/* A list container as the skins of old defined it, with the layouts built in
+ * code so that no skin is needed.  Nothing is rendered, the container is only
+ * processed, which is where the labels of the items are built.
+ */
+class CTestListContainer : public CGUIListContainer
+{
+public:
+  CTestListContainer()
+  : CGUIListContainer(0, BENCH_CONTROL_ID, 0, 0, 800, 600, CLabelInfo(), CLabelInfo(),
+                      CTextureInfo(""), CTextureInfo(""), 40, 32, 32, 0)
+  {
+  }
+
+  int ItemsPerPage() const { return m_itemsPerPage; }
+};
+
+static void MakeItems(CFileItemList &items)
+{
+  for (int i = 0; i < BENCH_ITEMS; i++)
+  {
+    CStdString path, label, label2;
+    path.Format("/media/music/album %i/track %02i.mp3", i / 10, i % 10);
+    label.Format("%02i. Track number %i of album %i", i % 10 + 1, i % 10 + 1, i / 10);
+    label2.Format("%i:%02i", 2 + i % 5, i % 60);
+    CFileItemPtr item(new CFileItem(path, false));
+    item->SetLabel(label);
+    item->SetLabel2(label2);
+    items.Add(item);
+  }
+}
+
+/* Pages through the whole list and back again, processing the container every
+ * frame like the window manager does.  Returns the number of frames processed
+ * per second.
+ */
+static double ScrollThrough(CTestListContainer &container, unsigned int &currentTime, bool cacheLabels)
+{
+  int pages = BENCH_ITEMS / container.ItemsPerPage() + 1;
+  int frames = 0;
+  CDirtyRegionList dirty;
+
+  int64_t start = CurrentHostCounter();
+  for (int direction = 0; direction < 2; direction++)
+  {
+    for (int page = 0; page < pages; page++)
+    {
+      container.OnAction(CAction(direction ? ACTION_PAGE_UP : ACTION_PAGE_DOWN));
+      for (int i = 0; i < BENCH_PAGE_FRAMES; i++, frames++)
+      {
+        if (!cacheLabels)
+          CGUIListItem::InvalidateCachedLabels();
+        currentTime += BENCH_FRAME_TIME;
+        container.DoProcess(currentTime, dirty);
+        dirty.clear();
+      }
+    }
+  }
+  return frames / ((double)(CurrentHostCounter() - start) / CurrentHostFrequency());
+}
+
+TEST(TestGUIBaseContainer, ScrollBenchmark)
+{
+  CFileItemList items;
+  MakeItems(items);
+
+  CTestListContainer container;
+  CGUIMessage msg(GUI_MSG_LABEL_BIND, 0, BENCH_CONTROL_ID, 0, 0, &items);
+  ASSERT_TRUE(container.OnMessage(msg));
+
+  unsigned int currentTime = 0;
+  unsigned int misses = CGUIInfoLabel::GetItemLabelMisses();
+  double uncachedRate = ScrollThrough(container, currentTime, false);
+  unsigned int uncachedMisses = CGUIInfoLabel::GetItemLabelMisses() - misses;
+
+  misses = CGUIInfoLabel::GetItemLabelMisses();
+  double cachedRate = ScrollThrough(container, currentTime, true);
+  unsigned int cachedMisses = CGUIInfoLabel::GetItemLabelMisses() - misses;
+
+  std::cout << "labels rebuilt: " << uncachedRate << " frames/s, " << uncachedMisses << " labels built" << std::endl
+            << "labels cached: "  << cachedRate   << " frames/s, " << cachedMisses   << " labels built" << std::endl;
+  EXPECT_GT(uncachedMisses, cachedMisses);
+
+  // fresh layouts for the items on screen take all their labels from the cache
+  for (int i = 0; i < items.Size(); i++)
+    items[i]->FreeMemory();
+  misses = CGUIInfoLabel::GetItemLabelMisses();
+  CDirtyRegionList dirty;
+  currentTime += BENCH_FRAME_TIME;
+  container.DoProcess(currentTime, dirty);
+  EXPECT_EQ(misses, CGUIInfoLabel::GetItemLabelMisses());
+
+  // back at the top, with the layouts of the items far down the list freed again
+  EXPECT_EQ(0, container.GetSelectedItem());
+  EXPECT_EQ(items[0]->GetLabel(), container.GetDescription());
+  EXPECT_TRUE(items[0]->GetFocusedLayout() != NULL);
+  EXPECT_TRUE(items[BENCH_ITEMS - 1]->GetLayout() == NULL);
+}
@@ -0,0 +1,89 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GUIInfoTypes.h"
+#include "FileItem.h"
+#include "utils/Variant.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestGUIInfoTypes, ItemLabel)
+{
+  CGUIInfoLabel info("$INFO[ListItem.Label]$INFO[ListItem.Label2, - ]", "fallback");
+  CFileItem item("label");
+
+  EXPECT_EQ("label", info.GetItemLabel(&item));
+  item.SetLabel2("label2");
+  EXPECT_EQ("label - label2", info.GetItemLabel(&item));
+  item.SetLabel("");
+  item.SetLabel2("");
+  EXPECT_EQ("fallback", info.GetItemLabel(&item));
+}
+
+TEST(TestGUIInfoTypes, ItemLabelCopies)
+{
+  CGUIInfoLabel info("$INFO[ListItem.Label] $INFO[ListItem.Property(plays)]");
+  CGUIInfoLabel copy(info);
+  CFileItem item("label");
+  item.SetProperty("plays", 1);
+
+  EXPECT_EQ("label 1", info.GetItemLabel(&item));
+  EXPECT_EQ("label 1", copy.GetItemLabel(&item));
+  item.IncrementProperty("plays", 1);
+  EXPECT_EQ("label 2", copy.GetItemLabel(&item));
+  EXPECT_EQ("label 2", info.GetItemLabel(&item));
+
+  // a copy of the item does not show labels built for the original
+  CFileItem other(item);
+  other.SetProperty("plays", 5);
+  EXPECT_EQ("label 5", info.GetItemLabel(&other));
+  EXPECT_EQ("label 2", info.GetItemLabel(&item));
+}
+
+TEST(TestGUIInfoTypes, ItemLabelInvalidate)
+{
+  CGUIInfoLabel info("$INFO[ListItem.Label]");
+  CFileItem item("label");
+
+  EXPECT_EQ("label", info.GetItemLabel(&item));
+  unsigned int revision = item.GetRevision();
+  EXPECT_EQ("label", info.GetItemLabel(&item));
+  EXPECT_EQ(revision, item.GetRevision());
+
+  // reading labels leaves the item as it was
+  CGUIListItem::InvalidateCachedLabels();
+  EXPECT_EQ("label", info.GetItemLabel(&item));
+  EXPECT_EQ(revision, item.GetRevision());
+}
+
+TEST(TestGUIInfoTypes, ConstantLabel)
+{
+  CGUIInfoLabel empty;
+  CGUIInfoLabel constant("some text");
+  CGUIInfoLabel info("$INFO[ListItem.Label]");
+
+  EXPECT_TRUE(empty.IsEmpty());
+  EXPECT_TRUE(empty.IsConstant());
+  EXPECT_EQ("", empty.GetLabel(0));
+  EXPECT_FALSE(constant.IsEmpty());
+  EXPECT_TRUE(constant.IsConstant());
+  EXPECT_EQ("some text", constant.GetLabel(0));
+  EXPECT_FALSE(info.IsConstant());
+}
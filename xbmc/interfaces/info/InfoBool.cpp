@@ -30,6 +30,7 @@ InfoSingle::InfoSingle(const CStdString &expression, int context)
 : InfoBool(expression, context)
 {
   m_condition = g_infoManager.TranslateSingleString(expression);
+  m_dependencies = g_infoManager.GetDependencies(m_condition);
 }
 
 void InfoSingle::Update(const CGUIListItem *item)
@@ -41,6 +42,11 @@ InfoExpression::InfoExpression(const CStdString &expression, int context)
 : InfoBool(expression, context)
 {
   Parse(expression);
+
+  // the expression changes only when one of its operands does
+  m_dependencies = DEPENDS_NOTHING;
+  for (vector<unsigned int>::const_iterator it = m_operands.begin(); it != m_operands.end(); ++it)
+    m_dependencies |= g_infoManager.GetBoolDependencies(*it);
 }
 
 void InfoExpression::Update(const CGUIListItem *item)
@@ -28,6 +28,20 @@ class CGUIListItem;
 
 namespace INFO
 {
+/*! \brief Sources of information a condition depends on
+ Sources other than DEPENDS_POLLED tell the info manager when they change, so conditions
+ depending only on them are evaluated again only when one of them has changed.
+ \sa CGUIInfoManager::SetInfoChanged
+ */
+enum InfoDependency
+{
+  DEPENDS_NOTHING = 0,       ///< constant, evaluated once
+  DEPENDS_SKIN    = 1 << 0,  ///< skin settings
+  DEPENDS_LIBRARY = 1 << 1,  ///< library contents
+  DEPENDS_PLAYER  = 1 << 2,  ///< playback state and speed
+  DEPENDS_POLLED  = 1 << 3   ///< anything else, evaluated every frame and for every item
+};
+
 /*!
  \ingroup info
  \brief Base class, wrapping boolean conditions and expressions
@@ -38,6 +52,7 @@ public:
   InfoBool(const CStdString &expression, int context)
     : m_value(false),
       m_context(context),
+      m_dependencies(DEPENDS_POLLED),
       m_expression(expression),
       m_lastUpdate(0)
   {
@@ -47,21 +62,33 @@ public:
 
   /*! \brief Get the value of this info bool
    This is called to update (if necessary) and fetch the value of the info bool
-   \param time current time (used to test if we need to update yet)
+   \param version current version of the sources this bool depends on (used to test if we need to update yet)
    \param item the item used to evaluate the bool
    */
-  inline bool Get(unsigned int time, const CGUIListItem *item = NULL)
+  inline bool Get(unsigned int version, const CGUIListItem *item = NULL)
   {
-    if (item)
+    if (item && (m_dependencies & DEPENDS_POLLED))
       Update(item);
-    else if (time - m_lastUpdate > 0)
+    else if (version != m_lastUpdate)
     {
       Update(NULL);
-      m_lastUpdate = time;
+      m_lastUpdate = version;
     }
     return m_value;
   }
 
+  /*! \brief Check whether Get() will evaluate this info bool
+   \sa Get
+   */
+  inline bool IsDirty(unsigned int version, const CGUIListItem *item = NULL) const
+  {
+    return (item && (m_dependencies & DEPENDS_POLLED)) || version != m_lastUpdate;
+  }
+
+  /*! \brief The InfoDependency flags of the sources this info bool depends on
+   */
+  unsigned int GetDependencies() const { return m_dependencies; };
+
   bool operator==(const InfoBool &right) const
   {
     return (m_context == right.m_context && 
@@ -77,10 +104,11 @@ protected:
 
   bool m_value;                ///< current value
   int m_context;               ///< contextual information to go with the condition
+  unsigned int m_dependencies; ///< InfoDependency flags of the sources the value depends on
 
 private:
   CStdString m_expression;     ///< original expression
-  unsigned int m_lastUpdate;   ///< last update time (to determine dirty status)
+  unsigned int m_lastUpdate;   ///< version of the sources at the last update (to determine dirty status)
 };
 
 /*! \brief Class to wrap active boolean conditions
@@ -242,7 +242,7 @@ void CAddonsOperations::FillDetails(AddonPtr addon, const CVariant& fields, CVar
   }
   
   if (append)
-    result.append(object);
+    result.append_move(object);
   else
-    result = object;
+    result.move(object);
 }
@@ -28,6 +28,7 @@
 #include "FileOperations.h"
 #include "utils/URIUtils.h"
 #include "utils/ISerializable.h"
+#include "utils/JSONVariantWriter.h"
 #include "utils/Variant.h"
 #include "video/VideoInfoTag.h"
 #include "music/tags/MusicInfoTag.h"
@@ -214,22 +215,10 @@ void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const
 
   CThumbLoader *thumbLoader = NULL;
   if (end - start > 0)
-  {
-    if (items.Get(start)->HasVideoInfoTag())
-      thumbLoader = new CVideoThumbLoader();
-    else if (items.Get(start)->HasMusicInfoTag())
-      thumbLoader = new CMusicThumbLoader();
-
-    if (thumbLoader != NULL)
-      thumbLoader->Initialize();
-  }
+    thumbLoader = CreateThumbLoader(items.Get(start));
 
   std::set<std::string> fields;
-  if (parameterObject.isMember("properties") && parameterObject["properties"].isArray())
-  {
-    for (CVariant::const_iterator_array field = parameterObject["properties"].begin_array(); field != parameterObject["properties"].end_array(); field++)
-      fields.insert(field->asString());
-  }
+  GetFields(parameterObject, fields);
 
   for (int i = start; i < end; i++)
   {
@@ -241,15 +230,96 @@ void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const
   delete thumbLoader;
 }
 
-void CFileItemHandler::HandleFileItem(const char *ID, bool allowFile, const char *resultname, CFileItemPtr item, const CVariant &parameterObject, const CVariant &validFields, CVariant &result, bool append /* = true */, CThumbLoader *thumbLoader /* = NULL */)
+namespace JSONRPC
 {
-  std::set<std::string> fields;
-  if (parameterObject.isMember("properties") && parameterObject["properties"].isArray())
+  /*!
+   \brief Writes the items of a list into a streamed response, each item is
+   only serialized right before it is written.
+   */
+  class CFileItemListWriter : public IStreamedResult
   {
-    for (CVariant::const_iterator_array field = parameterObject["properties"].begin_array(); field != parameterObject["properties"].end_array(); field++)
-      fields.insert(field->asString());
+  public:
+    CFileItemListWriter(const char *ID, bool allowFile, const char *resultname, const CVariant &parameterObject)
+      : m_ID(ID != NULL ? ID : ""), m_allowFile(allowFile), m_resultname(resultname), m_parameterObject(parameterObject)
+    {
+      CFileItemHandler::GetFields(m_parameterObject, m_fields);
+    }
+
+    void Add(const CFileItemPtr &item) { m_items.push_back(item); }
+
+    virtual bool Write(CJSONVariantWriter &writer)
+    {
+      CThumbLoader *thumbLoader = NULL;
+      if (!m_items.empty())
+        thumbLoader = CFileItemHandler::CreateThumbLoader(m_items.front());
+
+      bool success = writer.BeginArray();
+      for (VECFILEITEMS::iterator item = m_items.begin(); item != m_items.end() && success; item++)
+      {
+        CVariant result;
+        CFileItemHandler::HandleFileItem(m_ID.empty() ? NULL : m_ID.c_str(), m_allowFile, m_resultname.c_str(), *item, m_parameterObject, m_fields, result, false, thumbLoader);
+        success = writer.WriteValue(result[m_resultname]);
+
+        // the item is not needed anymore once it has been written
+        item->reset();
+      }
+
+      delete thumbLoader;
+      return success && writer.EndArray();
+    }
+
+  private:
+    std::string m_ID;
+    bool m_allowFile;
+    std::string m_resultname;
+    CVariant m_parameterObject;
+    std::set<std::string> m_fields;
+    VECFILEITEMS m_items;
+  };
+}
+
+void CFileItemHandler::StreamFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, bool sortLimit /* = true */)
+{
+  StreamFileItemList(ID, allowFile, resultname, items, parameterObject, result, items.Size(), sortLimit);
+}
+
+void CFileItemHandler::StreamFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, int size, bool sortLimit /* = true */)
+{
+  CStreamedResponse *response = CStreamedResponse::Get();
+  if (response == NULL || resultname == NULL || !response->CanStream(result, resultname))
+  {
+    HandleFileItemList(ID, allowFile, resultname, items, parameterObject, result, size, sortLimit);
+    return;
   }
 
+  int start, end;
+  HandleLimits(parameterObject, result, size, start, end);
+
+  if (sortLimit)
+    Sort(items, parameterObject);
+  else
+  {
+    start = 0;
+    end = items.Size();
+  }
+
+  // without any items the member is left out of the result just like
+  // HandleFileItemList() does
+  if (end - start <= 0)
+    return;
+
+  CFileItemListWriter *writer = new CFileItemListWriter(ID, allowFile, resultname, parameterObject);
+  for (int i = start; i < end; i++)
+    writer->Add(items.Get(i));
+
+  response->Stream(result, resultname, writer);
+}
+
+void CFileItemHandler::HandleFileItem(const char *ID, bool allowFile, const char *resultname, CFileItemPtr item, const CVariant &parameterObject, const CVariant &validFields, CVariant &result, bool append /* = true */, CThumbLoader *thumbLoader /* = NULL */)
+{
+  std::set<std::string> fields;
+  GetFields(parameterObject, fields);
+
   HandleFileItem(ID, allowFile, resultname, item, parameterObject, fields, result, append, thumbLoader);
 }
 
@@ -346,9 +416,32 @@ void CFileItemHandler::HandleFileItem(const char *ID, bool allowFile, const char
   if (resultname)
   {
     if (append)
-      result[resultname].append(object);
+      result[resultname].append_move(object);
     else
-      result[resultname] = object;
+      result[resultname].move(object);
+  }
+}
+
+CThumbLoader *CFileItemHandler::CreateThumbLoader(const CFileItemPtr &item)
+{
+  CThumbLoader *thumbLoader = NULL;
+  if (item->HasVideoInfoTag())
+    thumbLoader = new CVideoThumbLoader();
+  else if (item->HasMusicInfoTag())
+    thumbLoader = new CMusicThumbLoader();
+
+  if (thumbLoader != NULL)
+    thumbLoader->Initialize();
+
+  return thumbLoader;
+}
+
+void CFileItemHandler::GetFields(const CVariant &parameterObject, std::set<std::string> &fields)
+{
+  if (parameterObject.isMember("properties") && parameterObject["properties"].isArray())
+  {
+    for (CVariant::const_iterator_array field = parameterObject["properties"].begin_array(); field != parameterObject["properties"].end_array(); field++)
+      fields.insert(field->asString());
   }
 }
 
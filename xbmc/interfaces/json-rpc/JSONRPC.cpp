@@ -26,6 +26,8 @@
 #include "interfaces/AnnouncementManager.h"
 #include "playlists/SmartPlayList.h"
 #include "settings/AdvancedSettings.h"
+#include "threads/ThreadLocal.h"
+#include "utils/JSONVariantWriter.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
@@ -36,6 +38,87 @@ using namespace std;
 
 bool CJSONRPC::m_initialized = false;
 
+static XbmcThreads::ThreadLocal<CStreamedResponse> streamedResponse;
+
+CStreamedResponse::CStreamedResponse()
+  : m_result(NULL)
+{
+  m_previous = streamedResponse.get();
+  streamedResponse.set(this);
+}
+
+CStreamedResponse::~CStreamedResponse()
+{
+  streamedResponse.set(m_previous);
+
+  for (map<string, IStreamedResult*>::iterator it = m_members.begin(); it != m_members.end(); it++)
+    delete it->second;
+}
+
+CStreamedResponse *CStreamedResponse::Get()
+{
+  return streamedResponse.get();
+}
+
+bool CStreamedResponse::CanStream(const CVariant &result, const string &member) const
+{
+  return &result == m_result && !result.isMember(member);
+}
+
+void CStreamedResponse::Stream(CVariant &result, const string &member, IStreamedResult *value)
+{
+  // keep the member in the result so it is written in the right place
+  result[member] = CVariant();
+
+  map<string, IStreamedResult*>::iterator it = m_members.find(member);
+  if (it != m_members.end())
+  {
+    delete it->second;
+    it->second = value;
+  }
+  else
+    m_members.insert(make_pair(member, value));
+}
+
+bool CStreamedResponse::Write(const CVariant &response, CJSONVariantWriter &writer)
+{
+  if (m_members.empty() || !response["result"].isObject())
+    return writer.WriteValue(response);
+
+  bool success = writer.BeginObject();
+  for (CVariant::const_iterator_map it = response.begin_map(); it != response.end_map() && success; it++)
+  {
+    success = writer.WriteKey(it->first);
+    if (!success)
+      break;
+
+    if (it->first != "result")
+    {
+      success = writer.WriteValue(it->second);
+      continue;
+    }
+
+    success = writer.BeginObject();
+    for (CVariant::const_iterator_map member = it->second.begin_map(); member != it->second.end_map() && success; member++)
+    {
+      success = writer.WriteKey(member->first);
+      if (!success)
+        break;
+
+      map<string, IStreamedResult*>::iterator streamed = m_members.find(member->first);
+      if (streamed != m_members.end())
+        success = streamed->second->Write(writer);
+      else
+        success = writer.WriteValue(member->second);
+    }
+
+    if (success)
+      success = writer.EndObject();
+  }
+
+  return success && writer.EndObject();
+}
+
 void CJSONRPC::Initialize()
 {
   if (m_initialized)
@@ -223,11 +306,21 @@ JSONRPC_STATUS CJSONRPC::NotifyAll(const CStdString &method, ITransportLayer *tr
 
 CStdString CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client)
 {
-  CVariant inputroot, outputroot, result;
+  CStdString str;
+  CJSONStringOutput output(str);
+  if (!MethodCall(inputString, transport, client, &output))
+    str.clear();
+
+  return str;
+}
+
+bool CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client, IJSONOutput *output)
+{
+  CVariant outputroot, result;
   bool hasResponse = false;
 
   CLog::Log(LOGDEBUG, "JSONRPC: Incoming request: %s", inputString.c_str());
-  inputroot = CJSONVariantParser::Parse((unsigned char *)inputString.c_str(), inputString.length());
+  CVariant inputroot = CJSONVariantParser::Parse((unsigned char *)inputString.c_str(), inputString.length());
   if (!inputroot.isNull())
   {
     if (inputroot.isArray())
@@ -235,7 +328,7 @@ CStdString CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *
       if (inputroot.size() <= 0)
       {
         CLog::Log(LOGERROR, "JSONRPC: Empty batch call\n");
-        BuildResponse(inputroot, InvalidRequest, CVariant(), outputroot);
+        BuildResponse(inputroot, InvalidRequest, result, outputroot);
         hasResponse = true;
       }
       else
@@ -245,24 +338,34 @@ CStdString CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *
           CVariant response;
           if (HandleMethodCall(*itr, response, transport, client))
           {
-            outputroot.append(response);
+            outputroot.append_move(response);
             hasResponse = true;
           }
         }
       }
     }
     else
-      hasResponse = HandleMethodCall(inputroot, outputroot, transport, client);
+    {
+      CStreamedResponse response;
+      if (!HandleMethodCall(inputroot, outputroot, transport, client))
+        return false;
+
+      CJSONVariantWriter writer(output, g_advancedSettings.m_jsonOutputCompact);
+      return response.Write(outputroot, writer) && writer.Flush();
+    }
   }
   else
   {
     CLog::Log(LOGERROR, "JSONRPC: Failed to parse '%s'\n", inputString.c_str());
-    BuildResponse(inputroot, ParseError, CVariant(), outputroot);
+    BuildResponse(inputroot, ParseError, result, outputroot);
     hasResponse = true;
   }
 
-  CStdString str = hasResponse ? CJSONVariantWriter::Write(outputroot, g_advancedSettings.m_jsonOutputCompact) : "";
-  return str;
+  if (!hasResponse)
+    return false;
+
+  CJSONVariantWriter writer(output, g_advancedSettings.m_jsonOutputCompact);
+  return writer.WriteValue(outputroot) && writer.Flush();
 }
 
 bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client)
@@ -271,6 +374,10 @@ bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITr
   CVariant result;
   bool isNotification = false;
 
+  CStreamedResponse *streamed = CStreamedResponse::Get();
+  if (streamed != NULL)
+    streamed->SetResult(&result);
+
   if (IsProperJSONRPC(request))
   {
     isNotification = !request.isMember("id");
@@ -285,7 +392,7 @@ bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITr
     if ((errorCode = CJSONServiceDescription::CheckCall(methodName, request["params"], transport, client, isNotification, method, params)) == OK)
       errorCode = method(methodName, transport, client, params, result);
     else
-      result = params;
+      result.move(params);
   }
   else
   {
@@ -293,6 +400,9 @@ bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITr
     errorCode = InvalidRequest;
   }
 
+  if (streamed != NULL)
+    streamed->SetResult(NULL);
+
   BuildResponse(request, errorCode, result, response);
 
   return !isNotification;
@@ -303,7 +413,7 @@ inline bool CJSONRPC::IsProperJSONRPC(const CVariant& inputroot)
   return inputroot.isObject() && inputroot.isMember("jsonrpc") && inputroot["jsonrpc"].isString() && inputroot["jsonrpc"] == CVariant("2.0") && inputroot.isMember("method") && inputroot["method"].isString() && (!inputroot.isMember("params") || inputroot["params"].isArray() || inputroot["params"].isObject());
 }
 
-inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code, const CVariant& result, CVariant& response)
+inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code, CVariant& result, CVariant& response)
 {
   response["jsonrpc"] = "2.0";
   response["id"] = request.isObject() && request.isMember("id") ? request["id"] : CVariant();
@@ -311,7 +421,7 @@ inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code
   switch (code)
   {
     case OK:
-      response["result"] = result;
+      response["result"].move(result);
       break;
     case ACK:
       response["result"] = "OK";
@@ -324,7 +434,7 @@ inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code
       response["error"]["code"] = InvalidParams;
       response["error"]["message"] = "Invalid params.";
       if (!result.isNull())
-        response["error"]["data"] = result;
+        response["error"]["data"].move(result);
       break;
     case MethodNotFound:
       response["error"]["code"] = MethodNotFound;
@@ -29,8 +29,79 @@
 #include "interfaces/IAnnouncer.h"
 #include "utils/StdString.h"
 
+class CJSONVariantWriter;
+class IJSONOutput;
+
 namespace JSONRPC
 {
+  /*!
+   \ingroup jsonrpc
+   \brief Member of a method's result which writes itself into the response.
+   \sa CStreamedResponse
+   */
+  class IStreamedResult
+  {
+  public:
+    virtual ~IStreamedResult() { }
+
+    virtual bool Write(CJSONVariantWriter &writer) = 0;
+  };
+
+  /*!
+   \ingroup jsonrpc
+   \brief Response to the request handled on the current thread which is
+   written straight into the transport.
+
+   While an instance exists, the called method may hand over members of its
+   result (e.g. a long list of items) as IStreamedResult instead of filling
+   them in. They are only written, one piece after another, once the rest
+   of the response is known, so neither the whole result nor the whole
+   response text has to be held in memory.
+   */
+  class CStreamedResponse
+  {
+  public:
+    CStreamedResponse();
+    ~CStreamedResponse();
+
+    /*!
+     \brief Get the streamed response of the current thread
+     \return The response or NULL if the response is not streamed
+     */
+    static CStreamedResponse *Get();
+
+    /*!
+     \brief Set the result of the method being called
+     */
+    void SetResult(const CVariant *result) { m_result = result; }
+
+    /*!
+     \brief Whether the given member of the given result can be streamed.
+
+     Only members of the result of the called method itself which have not
+     been set yet can be streamed.
+     */
+    bool CanStream(const CVariant &result, const std::string &member) const;
+
+    /*!
+     \brief Stream the given member of the result of the called method
+     \param result Result of the called method
+     \param member Name of the member of the result
+     \param value Writes the value of the member, the response takes ownership of it
+     */
+    void Stream(CVariant &result, const std::string &member, IStreamedResult *value);
+
+    /*!
+     \brief Write the given response including the streamed members of its result
+     */
+    bool Write(const CVariant &response, CJSONVariantWriter &writer);
+
+  private:
+    const CVariant *m_result;
+    std::map<std::string, IStreamedResult*> m_members;
+    CStreamedResponse *m_previous;
+  };
+
   /*!
    \ingroup jsonrpc
    \brief JSON RPC handler
@@ -64,6 +135,19 @@ namespace JSONRPC
      */
     static CStdString MethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client);
 
+    /*
+     \brief Handles an incoming JSON-RPC request and writes the response into the given output
+     \param inputString received JSON-RPC request
+     \param transport Transport protocol on which the request arrived
+     \param client Client which sent the request
+     \param output Output receiving the JSON-RPC response while it is written
+     \return True if a response has been written completely
+
+     Same as the other MethodCall() but the response of a single request is
+     streamed (see CStreamedResponse).
+     */
+    static bool MethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client, IJSONOutput *output);
+
     static JSONRPC_STATUS Introspect(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS Version(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS Permission(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
@@ -77,7 +161,7 @@ namespace JSONRPC
     static bool HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client);
     static inline bool IsProperJSONRPC(const CVariant& inputroot);
 
-    inline static void BuildResponse(const CVariant& request, JSONRPC_STATUS code, const CVariant& result, CVariant& response);
+    inline static void BuildResponse(const CVariant& request, JSONRPC_STATUS code, CVariant& result, CVariant& response);
 
     static bool m_initialized;
   };
@@ -0,0 +1,234 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "interfaces/json-rpc/FileItemHandler.h"
+#include "interfaces/json-rpc/JSONRPC.h"
+#include "utils/JSONVariantWriter.h"
+#include "utils/TimeUtils.h"
+#include "utils/Variant.h"
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <iostream>
+#if defined(TARGET_LINUX)
+#include <malloc.h>
+#endif
+
+#define BENCH_ITEMS 50000
+
+using namespace JSONRPC;
+
+class CTestFileItemHandler : public CFileItemHandler
+{
+public:
+  static void List(CFileItemList &items, const CVariant &parameterObject, CVariant &result)
+  {
+    HandleFileItemList("id", true, "files", items, parameterObject, result);
+  }
+
+  static void Stream(CFileItemList &items, const CVariant &parameterObject, CVariant &result)
+  {
+    StreamFileItemList("id", true, "files", items, parameterObject, result);
+  }
+};
+
+/* bytes currently allocated on the heap, used to compare the peak memory
+   needed to write a response */
+static size_t HeapInUse()
+{
+#if defined(TARGET_LINUX)
+  struct mallinfo info = mallinfo();
+  return (size_t)info.uordblks;
+#else
+  return 0;
+#endif
+}
+
+class CMeasuringOutput : public IJSONOutput
+{
+public:
+  CMeasuringOutput(size_t baseline, int64_t start, bool keep)
+    : m_baseline(baseline), m_start(start), m_keep(keep),
+      m_firstByte(0), m_peak(0), m_length(0)
+  { }
+
+  virtual bool Write(const char *data, size_t length)
+  {
+    if (m_firstByte == 0)
+      m_firstByte = CurrentHostCounter();
+    Sample();
+
+    m_length += length;
+    if (m_keep)
+      m_data.append(data, length);
+    return true;
+  }
+
+  void Sample()
+  {
+    size_t inUse = HeapInUse();
+    if (inUse > m_baseline)
+      m_peak = std::max(m_peak, inUse - m_baseline);
+  }
+
+  double FirstByte() const { return (double)(m_firstByte - m_start) * 1000 / CurrentHostFrequency(); }
+  size_t Peak() const { return m_peak; }
+  size_t Length() const { return m_length; }
+  const std::string &Data() const { return m_data; }
+
+private:
+  size_t m_baseline;
+  int64_t m_start;
+  bool m_keep;
+  int64_t m_firstByte;
+  size_t m_peak;
+  size_t m_length;
+  std::string m_data;
+};
+
+static void FillItems(CFileItemList &items, int count)
+{
+  for (int index = 0; index < count; index++)
+  {
+    char path[64];
+    sprintf(path, "smb://server/share/music/%05d - Track.flac", index);
+    CFileItemPtr item(new CFileItem(path, false));
+    item->SetLabel(path + 25);
+    item->m_strTitle = "Track";
+    item->m_dwSize = 25000000 + index;
+    items.Add(item);
+  }
+}
+
+static CVariant Parameters()
+{
+  CVariant parameterObject;
+  parameterObject["properties"].push_back("file");
+  parameterObject["properties"].push_back("title");
+  parameterObject["properties"].push_back("size");
+  return parameterObject;
+}
+
+static void BuildResponse(CVariant &result, CVariant &response)
+{
+  response["jsonrpc"] = "2.0";
+  response["id"] = 1;
+  response["result"].move(result);
+}
+
+static std::string Materialised(CFileItemList &items, const CVariant &parameterObject)
+{
+  CVariant result, response;
+  CTestFileItemHandler::List(items, parameterObject, result);
+  BuildResponse(result, response);
+  return CJSONVariantWriter::Write(response, true);
+}
+
+static bool Streamed(CFileItemList &items, const CVariant &parameterObject, IJSONOutput *output)
+{
+  CStreamedResponse streamed;
+  CVariant result, response;
+  streamed.SetResult(&result);
+  CTestFileItemHandler::Stream(items, parameterObject, result);
+  streamed.SetResult(NULL);
+  BuildResponse(result, response);
+
+  CJSONVariantWriter writer(output, true);
+  return streamed.Write(response, writer) && writer.Flush();
+}
+
+TEST(TestFileItemHandler, StreamFileItemList)
+{
+  CFileItemList items;
+  FillItems(items, 100);
+  CVariant parameterObject = Parameters();
+  parameterObject["limits"]["start"] = 10;
+  parameterObject["limits"]["end"] = 60;
+
+  std::string expected = Materialised(items, parameterObject);
+  CMeasuringOutput output(0, CurrentHostCounter(), true);
+  EXPECT_TRUE(Streamed(items, parameterObject, &output));
+  EXPECT_EQ(expected, output.Data());
+
+  // an empty list leaves the member out of the result
+  CFileItemList empty;
+  expected = Materialised(empty, parameterObject);
+  CMeasuringOutput emptyOutput(0, CurrentHostCounter(), true);
+  EXPECT_TRUE(Streamed(empty, parameterObject, &emptyOutput));
+  EXPECT_EQ(expected, emptyOutput.Data());
+}
+
+TEST(TestFileItemHandler, StreamFileItemListFallback)
+{
+  CFileItemList items;
+  FillItems(items, 3);
+  CVariant parameterObject = Parameters();
+
+  // without a streamed response the items end up in the result
+  CVariant result;
+  CTestFileItemHandler::Stream(items, parameterObject, result);
+  EXPECT_EQ(3, result["files"].size());
+
+  // only members of the result of the called method are streamed
+  CStreamedResponse streamed;
+  CVariant methodResult;
+  streamed.SetResult(&methodResult);
+  CTestFileItemHandler::Stream(items, parameterObject, methodResult["details"]);
+  EXPECT_EQ(3, methodResult["details"]["files"].size());
+  EXPECT_FALSE(streamed.CanStream(methodResult, "details"));
+  EXPECT_TRUE(streamed.CanStream(methodResult, "files"));
+}
+
+TEST(TestFileItemHandler, StreamBenchmark)
+{
+  CFileItemList items;
+  FillItems(items, BENCH_ITEMS);
+  CVariant parameterObject = Parameters();
+
+  size_t baseline = HeapInUse();
+  int64_t start = CurrentHostCounter();
+  CVariant result, response;
+  CTestFileItemHandler::List(items, parameterObject, result);
+  BuildResponse(result, response);
+  std::string materialised = CJSONVariantWriter::Write(response, true);
+  // the whole response is only available at the very end
+  double materialisedTime = (double)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+  size_t materialisedPeak = HeapInUse() - baseline;
+  response.clear();
+
+  baseline = HeapInUse();
+  start = CurrentHostCounter();
+  CMeasuringOutput output(baseline, start, false);
+  EXPECT_TRUE(Streamed(items, parameterObject, &output));
+  double streamedTime = (double)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+
+  std::cout << "writing a response with " << BENCH_ITEMS << " items: "
+            << "materialised " << materialisedPeak / 1024 << " KB peak, "
+            << materialisedTime << " ms to first byte and in total, "
+            << "streamed " << output.Peak() / 1024 << " KB peak, "
+            << output.FirstByte() << " ms to first byte, "
+            << streamedTime << " ms in total" << std::endl;
+  EXPECT_EQ(materialised.size(), output.Length());
+#if defined(TARGET_LINUX)
+  EXPECT_LT(output.Peak(), materialisedPeak);
+#endif
+}
@@ -493,6 +493,7 @@ int CMusicDatabase::AddAlbum(const CStdString& strAlbum1, const CStdString &strA
       strSQL=PrepareSQL("update album set strGenres='%s', iYear=%i where idAlbum=%i", strGenre.c_str(), year, album.idAlbum);
       m_pDS->exec(strSQL.c_str());
       // and clear the link tables - these are updated in AddSong()
+      FlushBatch();
       strSQL=PrepareSQL("delete from album_artist where idAlbum=%i", album.idAlbum);
       m_pDS->exec(strSQL.c_str());
       strSQL=PrepareSQL("delete from album_genre where idAlbum=%i", album.idAlbum);
@@ -608,18 +609,14 @@ int CMusicDatabase::AddArtist(const CStdString& strArtist1)
 
 bool CMusicDatabase::AddSongArtist(int idArtist, int idSong, bool featured, int iOrder)
 {
-  CStdString strSQL;
-  strSQL=PrepareSQL("replace into song_artist (idArtist, idSong, boolFeatured, iOrder) values(%i,%i,%i,%i)",
-                    idArtist, idSong, featured == true ? 1 : 0, iOrder);
-  return ExecuteQuery(strSQL);
+  return QueueBatchRow("replace into song_artist (idArtist, idSong, boolFeatured, iOrder)",
+                       PrepareSQL("%i,%i,%i,%i", idArtist, idSong, featured == true ? 1 : 0, iOrder));
 };
 
 bool CMusicDatabase::AddAlbumArtist(int idArtist, int idAlbum, bool featured, int iOrder)
 {
-  CStdString strSQL;
-  strSQL=PrepareSQL("replace into album_artist (idArtist, idAlbum, boolFeatured, iOrder) values(%i,%i,%i,%i)",
-                    idArtist, idAlbum, featured == true ? 1 : 0, iOrder);
-  return ExecuteQuery(strSQL);
+  return QueueBatchRow("replace into album_artist (idArtist, idAlbum, boolFeatured, iOrder)",
+                       PrepareSQL("%i,%i,%i,%i", idArtist, idAlbum, featured == true ? 1 : 0, iOrder));
 };
 
 bool CMusicDatabase::AddSongGenre(int idGenre, int idSong, int iOrder)
@@ -627,20 +624,17 @@ bool CMusicDatabase::AddSongGenre(int idGenre, int idSong, int iOrder)
   if (idGenre == -1 || idSong == -1)
     return true;
 
-  CStdString strSQL;
-  strSQL=PrepareSQL("replace into song_genre (idGenre, idSong, iOrder) values(%i,%i,%i)",
-                    idGenre, idSong, iOrder);
-  return ExecuteQuery(strSQL);};
+  return QueueBatchRow("replace into song_genre (idGenre, idSong, iOrder)",
+                       PrepareSQL("%i,%i,%i", idGenre, idSong, iOrder));
+};
 
 bool CMusicDatabase::AddAlbumGenre(int idGenre, int idAlbum, int iOrder)
 {
   if (idGenre == -1 || idAlbum == -1)
     return true;
   
-  CStdString strSQL;
-  strSQL=PrepareSQL("replace into album_genre (idGenre, idAlbum, iOrder) values(%i,%i,%i)",
-                    idGenre, idAlbum, iOrder);
-  return ExecuteQuery(strSQL);
+  return QueueBatchRow("replace into album_genre (idGenre, idAlbum, iOrder)",
+                       PrepareSQL("%i,%i,%i", idGenre, idAlbum, iOrder));
 };
 
 bool CMusicDatabase::GetAlbumsByArtist(int idArtist, bool includeFeatured, std::vector<int> &albums)
@@ -3256,6 +3250,42 @@ bool CMusicDatabase::GetSongsByWhere(const CStdString &baseDir, const Filter &fi
     strSQL = PrepareSQL(strSQL, !filter.fields.empty() && filter.fields.compare("*") != 0 ? filter.fields.c_str() : "songview.*") + strSQLExtra;
 
     CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
+
+    // without a sort the rows are wanted in the order they come in, so turn
+    // them into items as they're read rather than holding all of them first
+    if (sortDescription.sortBy == SortByNone)
+    {
+      if (!m_pDS->query_forward(strSQL.c_str()))
+        return false;
+
+      int count = 0;
+      while (!m_pDS->eof())
+      {
+        try
+        {
+          CFileItemPtr item(new CFileItem);
+          GetFileItemFromDataset(m_pDS->get_sql_record(), item.get(), musicUrl.ToString());
+          // HACK for sorting by database returned order
+          item->m_iprogramCount = ++count;
+          items.Add(item);
+        }
+        catch (...)
+        {
+          m_pDS->close();
+          CLog::Log(LOGERROR, "%s: out of memory loading query: %s", __FUNCTION__, filter.where.c_str());
+          return (items.Size() > 0);
+        }
+        m_pDS->next();
+      }
+      m_pDS->close();
+
+      // store the total value of items as a property
+      if (count > 0)
+        items.SetProperty("total", total < count ? count : total);
+      CLog::Log(LOGDEBUG, "%s(%s) - took %d ms", __FUNCTION__, filter.where.c_str(), XbmcThreads::SystemClockMillis() - time);
+      return true;
+    }
+
     // run query
     if (!m_pDS->query(strSQL.c_str()))
       return false;
@@ -3271,7 +3301,7 @@ bool CMusicDatabase::GetSongsByWhere(const CStdString &baseDir, const Filter &fi
     if (total < iRowsFound)
       total = iRowsFound;
     items.SetProperty("total", total);
-    
+
     DatabaseResults results;
     results.reserve(iRowsFound);
     if (!SortUtils::SortFromDataset(sortDescription, MediaTypeSong, m_pDS, results))
@@ -3901,10 +3931,11 @@ int CMusicDatabase::GetArtistByName(const CStdString& strArtist)
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    CStdString strSQL=PrepareSQL("select idArtist from artist where artist.strArtist like '%s'", strArtist.c_str());
+    dbiplus::sql_record params;
+    params.push_back(strArtist.c_str());
 
     // run query
-    if (!m_pDS->query(strSQL.c_str())) return false;
+    if (!m_pDS->query("select idArtist from artist where artist.strArtist like ?", params)) return false;
     int iRowsFound = m_pDS->num_rows();
     if (iRowsFound != 1)
     {
@@ -4318,6 +4349,9 @@ int CMusicDatabase::GetSongIDFromPath(const CStdString &filePath)
 
 bool CMusicDatabase::CommitTransaction()
 {
+  if (InBatch())
+    return CDatabase::CommitTransaction(); // refreshed once the batch ends
+
   if (CDatabase::CommitTransaction())
   { // number of items in the db has likely changed, so reset the infomanager cache
     g_infoManager.SetLibraryBool(LIBRARY_HAS_MUSIC, GetSongsCount() > 0);
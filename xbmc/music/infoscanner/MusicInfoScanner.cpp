@@ -115,6 +115,11 @@ void CMusicInfoScanner::Process()
       m_bCanInterrupt = false;
       m_needsCleanup = false;
 
+      // group the writes of many songs into one transaction. Online scans
+      // batch per folder instead, see RetrieveMusicInfo()
+      if (!(m_flags & SCAN_ONLINE))
+        m_musicDatabase.BeginBatch(500);
+
       bool commit = false;
       bool cancelled = false;
       while (!cancelled && m_pathsToScan.size())
@@ -130,6 +135,7 @@ void CMusicInfoScanner::Process()
           cancelled = true;
         commit = !cancelled;
       }
+      m_musicDatabase.EndBatch();
 
       if (commit)
       {
@@ -421,8 +427,9 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
         OnDirectoryScanned(strDirectory);
     }
 
-    // save information about this folder
-    m_musicDatabase.SetPathHash(strDirectory, hash);
+    // save information about this folder, unless it was only partly scanned
+    if (!m_bStop)
+      m_musicDatabase.SetPathHash(strDirectory, hash);
   }
   else
   { // path is the same - no need to rescan
@@ -551,35 +558,41 @@ int CMusicInfoScanner::RetrieveMusicInfo(CFileItemList& items, const CStdString&
   CategoriseAlbums(songsToAdd, albums);
   FindArtForAlbums(albums, items.GetPath());
 
-  // finally, add these to the database
-  m_musicDatabase.BeginTransaction();
+  // finally, add these to the database. Offline scans are batched as a whole,
+  // online ones per folder so the database isn't held while waiting on the network below
+  m_musicDatabase.BeginBatch();
   int numAdded = 0;
   set<int> albumsToScan;
   set<int> artistsToScan;
+  vector<int> songIDs;
   for (VECALBUMS::iterator i = albums.begin(); i != albums.end(); ++i)
   {
-    vector<int> songIDs;
     int idAlbum = m_musicDatabase.AddAlbum(*i, songIDs);
     numAdded += i->songs.size();
     if (m_bStop)
     {
-      m_musicDatabase.RollbackTransaction();
+      m_musicDatabase.AbortBatch();
       return numAdded;
     }
-
-    // Build the artist & album sets
     albumsToScan.insert(idAlbum);
-    for (vector<int>::iterator j = songIDs.begin(); j != songIDs.end(); ++j)
-    {
-      vector<int> songArtists;
-      m_musicDatabase.GetArtistsBySong(*j, false, songArtists);
-      artistsToScan.insert(songArtists.begin(), songArtists.end());
-    }
+  }
+
+  // Build the artist set - the links are only queued so far
+  m_musicDatabase.FlushBatch();
+  for (vector<int>::iterator j = songIDs.begin(); j != songIDs.end(); ++j)
+  {
+    vector<int> songArtists;
+    m_musicDatabase.GetArtistsBySong(*j, false, songArtists);
+    artistsToScan.insert(songArtists.begin(), songArtists.end());
+  }
+  for (set<int>::iterator j = albumsToScan.begin(); j != albumsToScan.end(); ++j)
+  {
     std::vector<int> albumArtists;
-    m_musicDatabase.GetArtistsByAlbum(idAlbum, false, albumArtists);
+    m_musicDatabase.GetArtistsByAlbum(*j, false, albumArtists);
     artistsToScan.insert(albumArtists.begin(), albumArtists.end());
   }
-  m_musicDatabase.CommitTransaction();
+  m_musicDatabase.BatchItemDone(numAdded);
+  m_musicDatabase.EndBatch();
 
   // Download info & artwork
   bool bCanceled;
@@ -0,0 +1,330 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "music/MusicDatabase.h"
+#include "music/Album.h"
+#include "filesystem/SpecialProtocol.h"
+#include "filesystem/File.h"
+#include "settings/AdvancedSettings.h"
+#include "dbwrappers/dataset.h"
+#include "utils/TimeUtils.h"
+#include "FileItem.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdlib.h>
+
+#define BENCH_SONGS           50000
+#define BENCH_BASELINE_SONGS  2000
+#define BENCH_LOOKUPS         20000
+#define LISTING_SONGS         2000
+#define SONGS_PER_ALBUM       10
+#define ALBUMS_PER_ARTIST     5
+#define GENRES                20
+
+class CTestMusicDatabase : public CMusicDatabase
+{
+public:
+  bool Create(const char *name)
+  {
+    DatabaseSettings settings;
+    settings.type = "sqlite3";
+    settings.host = CSpecialProtocol::TranslatePath("special://temp/");
+    settings.name = name;
+    return Update(settings);
+  }
+
+  // the sqlite file Create() made for name
+  CStdString GetFile(const char *name) const
+  {
+    CStdString file;
+    file.Format("special://temp/%s%d.db", name, GetMinVersion());
+    return file;
+  }
+
+  int Count(const char *table)
+  {
+    return atoi(GetSingleValue(table, "count(*)").c_str());
+  }
+
+  // GetArtistByName() the way it was done before statements were cached
+  int GetArtistByNameText(const CStdString &strArtist)
+  {
+    CStdString strSQL = PrepareSQL("select idArtist from artist where artist.strArtist like '%s'", strArtist.c_str());
+    if (!m_pDS->query(strSQL.c_str()) || m_pDS->num_rows() != 1)
+      return -1;
+    int idArtist = m_pDS->fv("artist.idArtist").get_asInt();
+    m_pDS->close();
+    return idArtist;
+  }
+
+  /* Reads every row of songview either materialised or forward-only and
+   * returns the most rows the dataset held in memory at once.
+   */
+  size_t ReadSongs(bool forward, int &rows)
+  {
+    const char *sql = "select * from songview";
+    size_t held = 0;
+    if (forward)
+      m_pDS->query_forward(sql);
+    else
+      m_pDS->query(sql);
+    for (rows = 0; !m_pDS->eof(); rows++)
+    {
+      held = std::max(held, m_pDS->get_result_set().records.size());
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return held;
+  }
+};
+
+/* Every database a test creates goes through Create() so TearDown() can
+ * remove its file again.
+ */
+class TestMusicDatabase : public testing::Test
+{
+protected:
+  bool Create(CTestMusicDatabase &db, const char *name)
+  {
+    m_files.push_back(db.GetFile(name));
+    return db.Create(name);
+  }
+
+  virtual void TearDown()
+  {
+    for (std::vector<CStdString>::const_iterator i = m_files.begin(); i != m_files.end(); ++i)
+      XFILE::CFile::Delete(*i);
+  }
+
+  std::vector<CStdString> m_files;
+};
+
+static void MakeAlbum(int index, CAlbum &album)
+{
+  CStdString artist, genre;
+  artist.Format("Artist %d", index / ALBUMS_PER_ARTIST);
+  genre.Format("Genre %d", index % GENRES);
+
+  album.Reset();
+  album.strAlbum.Format("Album %d", index);
+  album.artist.push_back(artist);
+  album.genre.push_back(genre);
+  album.iYear = 1950 + index % 60;
+
+  for (int i = 0; i < SONGS_PER_ALBUM; i++)
+  {
+    CSong song;
+    song.strTitle.Format("Song %d", i + 1);
+    song.strFileName.Format("/music/%s/Album %d/%02d.mp3", artist.c_str(), index, i + 1);
+    song.strAlbum = album.strAlbum;
+    song.artist = album.artist;
+    song.albumArtist = album.artist;
+    song.genre = album.genre;
+    if (i % 3 == 0) // a featured artist every now and then
+      song.artist.push_back("Guest Artist");
+    song.iTrack = i + 1;
+    song.iDuration = 180 + i;
+    song.iYear = album.iYear;
+    album.songs.push_back(song);
+  }
+}
+
+/* Imports a synthetic library the way the scanner does: batched, or with a
+ * transaction per album as the scanner used to.
+ */
+static double Import(CTestMusicDatabase &db, int albums, bool batched)
+{
+  int64_t start = CurrentHostCounter();
+  if (batched)
+    db.BeginBatch(500);
+  for (int i = 0; i < albums; i++)
+  {
+    CAlbum album;
+    MakeAlbum(i, album);
+    std::vector<int> songIDs;
+    if (!batched)
+      db.BeginTransaction();
+    db.AddAlbum(album, songIDs);
+    if (batched)
+      db.BatchItemDone(songIDs.size());
+    else
+      db.CommitTransaction();
+  }
+  if (batched)
+    db.EndBatch();
+  double seconds = (double)(CurrentHostCounter() - start) / CurrentHostFrequency();
+  return albums * SONGS_PER_ALBUM / seconds;
+}
+
+TEST_F(TestMusicDatabase, BatchedImport)
+{
+  const char *tables[] = { "song", "album", "artist", "genre", "path",
+                           "song_artist", "song_genre", "album_artist", "album_genre" };
+  CTestMusicDatabase reference, batched;
+
+  ASSERT_TRUE(Create(reference, "TestMusicReference"));
+  ASSERT_TRUE(Create(batched, "TestMusicBatched"));
+  Import(reference, 50, false);
+  Import(batched, 50, true);
+  EXPECT_FALSE(batched.InBatch());
+
+  EXPECT_EQ(50 * SONGS_PER_ALBUM, batched.Count("song"));
+  for (unsigned int i = 0; i < sizeof(tables) / sizeof(tables[0]); i++)
+    EXPECT_EQ(reference.Count(tables[i]), batched.Count(tables[i])) << tables[i];
+
+  reference.Close();
+  batched.Close();
+}
+
+// takes minutes, run with --gtest_also_run_disabled_tests
+TEST_F(TestMusicDatabase, AbortNestedBatch)
+{
+  CTestMusicDatabase db;
+  CAlbum album;
+  std::vector<int> songIDs;
+
+  ASSERT_TRUE(Create(db, "TestMusicAbort"));
+  db.BeginBatch();
+  MakeAlbum(0, album);
+  db.AddAlbum(album, songIDs);
+  db.BatchItemDone(songIDs.size());
+
+  // a failing item only takes its own writes with it
+  db.BeginBatch();
+  MakeAlbum(1, album);
+  db.AddAlbum(album, songIDs);
+  EXPECT_EQ(0U, db.AbortBatch());
+  EXPECT_TRUE(db.InBatch());
+  EXPECT_TRUE(db.EndBatch());
+  EXPECT_FALSE(db.InBatch());
+
+  EXPECT_EQ(1, db.Count("album"));
+  EXPECT_EQ(SONGS_PER_ALBUM, db.Count("song"));
+  EXPECT_EQ(SONGS_PER_ALBUM, db.Count("song_genre"));
+
+  // without a savepoint the items done since the last commit are reported
+  db.BeginBatch();
+  MakeAlbum(2, album);
+  db.AddAlbum(album, songIDs);
+  db.BatchItemDone(SONGS_PER_ALBUM);
+  db.RollbackTransaction();
+  EXPECT_FALSE(db.EndBatch());
+  EXPECT_EQ(1, db.Count("album"));
+
+  db.BeginBatch();
+  db.AddAlbum(album, songIDs);
+  db.BatchItemDone(SONGS_PER_ALBUM);
+  EXPECT_EQ((unsigned int)SONGS_PER_ALBUM, db.AbortBatch());
+  EXPECT_FALSE(db.InBatch());
+  EXPECT_EQ(1, db.Count("album"));
+
+  db.Close();
+}
+
+// takes minutes, run with --gtest_also_run_disabled_tests
+TEST_F(TestMusicDatabase, DISABLED_ImportBenchmark)
+{
+  CTestMusicDatabase reference, batched;
+
+  ASSERT_TRUE(Create(reference, "TestMusicBaseline"));
+  ASSERT_TRUE(Create(batched, "TestMusicBenchmark"));
+  double referenceRate = Import(reference, BENCH_BASELINE_SONGS / SONGS_PER_ALBUM, false);
+  double batchedRate = Import(batched, BENCH_SONGS / SONGS_PER_ALBUM, true);
+  std::cout << "transaction per album: " << referenceRate << " songs/s" << std::endl
+            << "batched: "               << batchedRate   << " songs/s" << std::endl;
+
+  EXPECT_EQ(BENCH_SONGS, batched.Count("song"));
+  EXPECT_EQ(BENCH_SONGS / SONGS_PER_ALBUM / ALBUMS_PER_ARTIST + 1, batched.Count("artist"));
+  // every third song of an album has a featured artist
+  EXPECT_EQ(BENCH_SONGS + BENCH_SONGS / SONGS_PER_ALBUM * ((SONGS_PER_ALBUM + 2) / 3), batched.Count("song_artist"));
+
+  reference.Close();
+  batched.Close();
+}
+
+TEST_F(TestMusicDatabase, LookupBenchmark)
+{
+  CTestMusicDatabase db;
+  const int artists = 100;
+
+  ASSERT_TRUE(Create(db, "TestMusicLookup"));
+  Import(db, artists * ALBUMS_PER_ARTIST, true);
+
+  CStdString artist;
+  artist.Format("Artist %d", artists / 2);
+  int idArtist = db.GetArtistByName(artist);
+  EXPECT_GT(idArtist, 0);
+  EXPECT_EQ(idArtist, db.GetArtistByNameText(artist));
+  EXPECT_EQ(-1, db.GetArtistByName("it's not there"));
+
+  int64_t start = CurrentHostCounter();
+  for (int i = 0; i < BENCH_LOOKUPS; i++)
+  {
+    artist.Format("Artist %d", i % artists);
+    db.GetArtistByNameText(artist);
+  }
+  double textRate = BENCH_LOOKUPS / ((double)(CurrentHostCounter() - start) / CurrentHostFrequency());
+
+  start = CurrentHostCounter();
+  for (int i = 0; i < BENCH_LOOKUPS; i++)
+  {
+    artist.Format("Artist %d", i % artists);
+    db.GetArtistByName(artist);
+  }
+  double cachedRate = BENCH_LOOKUPS / ((double)(CurrentHostCounter() - start) / CurrentHostFrequency());
+  std::cout << "formatted sql: "     << textRate   << " queries/s" << std::endl
+            << "cached statement: "  << cachedRate << " queries/s" << std::endl;
+
+  db.Close();
+}
+
+TEST_F(TestMusicDatabase, ListingMemory)
+{
+  CTestMusicDatabase db;
+
+  ASSERT_TRUE(Create(db, "TestMusicListing"));
+  Import(db, LISTING_SONGS / SONGS_PER_ALBUM, true);
+
+  // an unsorted listing streams, a sorted one goes through the result set
+  CFileItemList streamed, sorted;
+  SortDescription sorting;
+  sorting.sortBy = SortByTrackNumber;
+  EXPECT_TRUE(db.GetSongsByWhere("musicdb://4/", CDatabase::Filter(), streamed));
+  EXPECT_TRUE(db.GetSongsByWhere("musicdb://4/", CDatabase::Filter(), sorted, sorting));
+  EXPECT_EQ(LISTING_SONGS, streamed.Size());
+  EXPECT_EQ(sorted.Size(), streamed.Size());
+  EXPECT_EQ(LISTING_SONGS, streamed.GetProperty("total").asInteger());
+  EXPECT_EQ(1, streamed[0]->m_iprogramCount);
+  EXPECT_EQ(LISTING_SONGS, streamed[streamed.Size() - 1]->m_iprogramCount);
+  streamed.Clear();
+  sorted.Clear();
+
+  // forward-only holds the current row only, materialised every row
+  int forwardRows, materialisedRows;
+  EXPECT_EQ(1U, db.ReadSongs(true, forwardRows));
+  EXPECT_EQ((size_t)LISTING_SONGS, db.ReadSongs(false, materialisedRows));
+  EXPECT_EQ(LISTING_SONGS, forwardRows);
+  EXPECT_EQ(LISTING_SONGS, materialisedRows);
+
+  db.Close();
+}
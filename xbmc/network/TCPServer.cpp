@@ -498,6 +498,7 @@ CTCPServer::CTCPClient::CTCPClient()
   m_endBrackets = 0;
   m_beginChar = 0;
   m_endChar = 0;
+  m_streaming = false;
 
   m_addrlen = sizeof(m_cliaddr);
 }
@@ -530,13 +531,37 @@ bool CTCPServer::CTCPClient::SetAnnouncementFlags(int flags)
 }
 
 void CTCPServer::CTCPClient::Send(const char *data, unsigned int size)
+{
+  CSingleLock lock (m_critSection);
+  // don't mix anything into a response which is being streamed
+  if (m_streaming)
+  {
+    m_pending.append(data, size);
+    return;
+  }
+
+  SendData(data, size);
+}
+
+bool CTCPServer::CTCPClient::Write(const char *data, size_t length)
+{
+  return SendData(data, (unsigned int)length);
+}
+
+bool CTCPServer::CTCPClient::SendData(const char *data, unsigned int size)
 {
   unsigned int sent = 0;
   do
   {
     CSingleLock lock (m_critSection);
-    sent += send(m_socket, data, size - sent, 0);
+    int result = send(m_socket, data + sent, size - sent, 0);
+    if (result <= 0)
+      return false;
+
+    sent += result;
   } while (sent < size);
+
+  return true;
 }
 
 void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -567,8 +592,29 @@ void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, in
         m_endBrackets++;
       if (m_beginBrackets > 0 && m_endBrackets > 0 && m_beginBrackets == m_endBrackets)
       {
-        std::string line = CJSONRPC::MethodCall(m_buffer, host, this);
-        Send(line.c_str(), line.size());
+        if (CanStreamResponses())
+        {
+          {
+            CSingleLock lock (m_critSection);
+            m_streaming = true;
+          }
+
+          CJSONRPC::MethodCall(m_buffer, host, this, this);
+
+          // send whatever had to wait for the response
+          CSingleLock lock (m_critSection);
+          m_streaming = false;
+          if (!m_pending.empty())
+          {
+            SendData(m_pending.c_str(), m_pending.size());
+            m_pending.clear();
+          }
+        }
+        else
+        {
+          std::string line = CJSONRPC::MethodCall(m_buffer, host, this);
+          Send(line.c_str(), line.size());
+        }
         m_beginChar = m_beginBrackets = m_endBrackets = 0;
         m_buffer.clear();
       }
@@ -599,6 +645,8 @@ void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
   m_beginChar         = client.m_beginChar;
   m_endChar           = client.m_endChar;
   m_buffer            = client.m_buffer;
+  m_streaming         = client.m_streaming;
+  m_pending           = client.m_pending;
 }
 
 CTCPServer::CWebSocketClient::CWebSocketClient(CWebSocket *websocket)
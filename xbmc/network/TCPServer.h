@@ -27,6 +27,7 @@
 #include "interfaces/json-rpc/ITransportLayer.h"
 #include "threads/CriticalSection.h"
 #include "threads/Thread.h"
+#include "utils/JSONVariantWriter.h"
 #include "websocket/WebSocket.h"
 
 namespace JSONRPC
@@ -51,7 +52,7 @@ namespace JSONRPC
     bool InitializeTCP();
     void Deinitialize();
 
-    class CTCPClient : public IClient
+    class CTCPClient : public IClient, public IJSONOutput
     {
     public:
       CTCPClient();
@@ -72,6 +73,14 @@ namespace JSONRPC
       virtual bool IsNew() const { return m_new; }
       virtual bool Closing() const { return false; }
 
+      /*!
+       \brief Whether responses can be sent in pieces while they are written
+       */
+      virtual bool CanStreamResponses() const { return true; }
+
+      // implementation of IJSONOutput
+      virtual bool Write(const char *data, size_t length);
+
       SOCKET           m_socket;
       sockaddr_storage m_cliaddr;
       socklen_t        m_addrlen;
@@ -80,11 +89,15 @@ namespace JSONRPC
     protected:
       void Copy(const CTCPClient& client);
     private:
+      bool SendData(const char *data, unsigned int size);
+
       bool m_new;
       int m_announcementflags;
       int m_beginBrackets, m_endBrackets;
       char m_beginChar, m_endChar;
       std::string m_buffer;
+      bool m_streaming;
+      std::string m_pending;
     };
 
     class CWebSocketClient : public CTCPClient
@@ -103,6 +116,9 @@ namespace JSONRPC
       virtual bool IsNew() const { return m_websocket == NULL; }
       virtual bool Closing() const { return m_websocket != NULL && m_websocket->GetState() == WebSocketStateClosed; }
 
+      // every response has to be sent as one message
+      virtual bool CanStreamResponses() const { return false; }
+
     private:
       CWebSocket *m_websocket;
     };
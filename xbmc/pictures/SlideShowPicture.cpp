@@ -21,6 +21,9 @@
 #include "SlideShowPicture.h"
 #include "system.h"
 #include "guilib/Texture.h"
+#if defined(HAS_GL)
+#include "guilib/GUIQuadBatchGL.h"
+#endif
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "settings/GUISettings.h"
@@ -776,6 +779,7 @@ void CSlideShowPic::Render(float *x, float *y, CBaseTexture* pTexture, color_t c
 
 #elif defined(HAS_GL)
   g_graphicsContext.BeginPaint();
+  CGUIQuadBatchGL::Get().Flush();
   if (pTexture)
   {
     pTexture->LoadToGPU();
@@ -154,6 +154,10 @@ class CAdvancedSettings
     float m_videoAutoScaleMaxFps;
     bool  m_videoAllowMpeg4VDPAU;
     bool  m_videoAllowMpeg4VAAPI;
+    CStdString m_videoDecoderThreadType; // "auto", "frame" or "slice"
+    int   m_videoDecoderThreads;         // 0 = derived from the cpu count
+    bool  m_videoZeroCopy;               // let the renderer upload straight from decoder buffers
+    CStdString m_videoMappedProtocols;   // comma separated protocols dvdplayer reads through mmap, eg "file,special"
     std::vector<RefreshOverride> m_videoAdjustRefreshOverrides;
     std::vector<RefreshVideoLatency> m_videoRefreshLatency;
     float m_videoDefaultLatency;
@@ -253,6 +257,7 @@ class CAdvancedSettings
     bool m_bVideoLibraryImportResumePoint;
 
     bool m_bVideoScannerIgnoreErrors;
+    int m_videoScannerThreads; // folders listed ahead of the video scanner at once, 0 scans everything in order on one thread
     int m_iVideoLibraryDateAdded;
 
     std::vector<CStdString> m_vecTokens; // cleaning strings tied to language
@@ -350,9 +355,12 @@ class CAdvancedSettings
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     int  m_guiDirtyRegionNoFlipTimeout;
+    int  m_guiTextureAtlasThreshold;
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemBufferSize;
+    unsigned int m_cachePersistentSize; // MB of network file data kept on disk across opens, 0 disables
+    float m_demuxReadAhead; // seconds of packets the ffmpeg demuxer reads ahead on its own thread, 0 disables
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
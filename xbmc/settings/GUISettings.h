@@ -37,6 +37,7 @@ class TiXmlElement;
 #define RENDER_METHOD_SOFTWARE  3
 #define RENDER_METHOD_D3D_PS    4
 #define RENDER_METHOD_DXVA      5
+#define RENDER_METHOD_SOFTWARE_MT 6
 #define RENDER_OVERLAYS         99   // to retain compatibility
 
 // Scaling options.
@@ -1025,6 +1025,8 @@ void CGUIWindowSettingsCategory::UpdateSettings()
 
   g_guiSettings.SetChanged();
   g_guiSettings.NotifyObservers(ObservableMessageGuiSettings);
+  // item labels may be formatted according to the setting
+  CGUIListItem::InvalidateCachedLabels();
 }
 
 void CGUIWindowSettingsCategory::OnClick(BaseSettingControlPtr pSettingControl)
@@ -32,6 +32,7 @@
 #include "utils/RegExp.h"
 #include "GUIPassword.h"
 #include "GUIInfoManager.h"
+#include "interfaces/info/InfoBool.h"
 #include "filesystem/MultiPathDirectory.h"
 #include "filesystem/SpecialProtocol.h"
 #include "guilib/GUIWindowManager.h"
@@ -1440,6 +1441,7 @@ void CSettings::LoadSkinSettings(const TiXmlElement* pRootElement)
       }
       pChild = pChild->NextSiblingElement("setting");
     }
+    g_infoManager.SetInfoChanged(INFO::DEPENDS_SKIN);
   }
 }
 
@@ -1539,6 +1541,7 @@ void CSettings::SetSkinString(int setting, const CStdString &label)
   if (it != m_skinStrings.end())
   {
     (*it).second.value = label;
+    g_infoManager.SetInfoChanged(INFO::DEPENDS_SKIN);
     return;
   }
   assert(false);
@@ -1555,6 +1558,7 @@ void CSettings::ResetSkinSetting(const CStdString &setting)
     if (settingName.Equals((*it).second.name))
     {
       (*it).second.value = "";
+      g_infoManager.SetInfoChanged(INFO::DEPENDS_SKIN);
       return;
     }
   }
@@ -1564,6 +1568,7 @@ void CSettings::ResetSkinSetting(const CStdString &setting)
     if (settingName.Equals((*it).second.name))
     {
       (*it).second.value = false;
+      g_infoManager.SetInfoChanged(INFO::DEPENDS_SKIN);
       return;
     }
   }
@@ -1604,6 +1609,7 @@ void CSettings::SetSkinBool(int setting, bool set)
   if (it != m_skinBools.end())
   {
     (*it).second.value = set;
+    g_infoManager.SetInfoChanged(INFO::DEPENDS_SKIN);
     return;
   }
   assert(false);
@@ -1632,6 +1638,7 @@ void CSettings::ResetSkinSettings()
 
     it2++;
   }
+  g_infoManager.SetInfoChanged(INFO::DEPENDS_SKIN);
   g_infoManager.ResetCache();
 }
 
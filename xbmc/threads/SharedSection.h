@@ -63,6 +63,7 @@ class CExclusiveLock : public XbmcThreads::UniqueLock<CSharedSection>
 public:
   inline CExclusiveLock(CSharedSection& cs) : XbmcThreads::UniqueLock<CSharedSection>(cs) {}
   inline CExclusiveLock(const CSharedSection& cs) : XbmcThreads::UniqueLock<CSharedSection> ((CSharedSection&)cs) {}
+  inline CExclusiveLock(CSharedSection& cs, bool try_to_lock_discrim) : XbmcThreads::UniqueLock<CSharedSection>(cs, try_to_lock_discrim) {}
 
   inline bool IsOwner() const { return owns_lock(); }
   inline void Leave() { unlock(); }
@@ -24,6 +24,7 @@
 #include "dbwrappers/dataset.h"
 #include "music/MusicDatabase.h"
 #include "utils/log.h"
+#include "utils/SortUtils.h"
 #include "utils/Variant.h"
 #include "video/VideoDatabase.h"
 
@@ -545,7 +546,7 @@ bool DatabaseUtils::GetFieldValue(const dbiplus::field_value &fieldValue, CVaria
   return false;
 }
 
-bool DatabaseUtils::GetDatabaseResults(MediaType mediaType, const FieldList &fields, const std::auto_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results)
+bool DatabaseUtils::GetDatabaseResults(MediaType mediaType, const FieldList &fields, const std::auto_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results, bool selected /* = false */)
 {
   if (dataset->num_rows() == 0)
     return true;
@@ -571,13 +572,21 @@ bool DatabaseUtils::GetDatabaseResults(MediaType mediaType, const FieldList &fie
   std::vector<int> fieldIndexLookup;
   fieldIndexLookup.reserve(fields.size());
   for (FieldList::const_iterator it = fields.begin(); it != fields.end(); it++)
-    fieldIndexLookup.push_back(GetFieldIndex(*it, mediaType));
+  {
+    // selected fields follow the id in the order they were asked for
+    if (selected)
+      fieldIndexLookup.push_back(fieldIndexLookup.size() + 1);
+    else
+      fieldIndexLookup.push_back(GetFieldIndex(*it, mediaType));
+  }
 
   results.reserve(resultSet.records.size() + offset);
   for (unsigned int index = 0; index < resultSet.records.size(); index++)
   {
     DatabaseResult result;
     result[FieldRow] = index + offset;
+    if (selected)
+      result[FieldId] = resultSet.records[index]->at(0).get_asInt();
 
     unsigned int lookupIndex = 0;
     for (FieldList::const_iterator it = fields.begin(); it != fields.end(); it++)
@@ -648,12 +657,53 @@ bool DatabaseUtils::GetDatabaseResults(MediaType mediaType, const FieldList &fie
       break;
     }
 
-    results.push_back(result);
+    // hand the fields over instead of copying every value
+    results.push_back(DatabaseResult());
+    results.back().swap(result);
   }
 
   return true;
 }
 
+std::string DatabaseUtils::BuildSelectFields(const FieldList &fields, MediaType mediaType)
+{
+  std::string select = GetField(FieldId, mediaType, DatabaseQueryPartSelect);
+  for (FieldList::const_iterator it = fields.begin(); it != fields.end(); it++)
+    select += ", " + GetField(*it, mediaType, DatabaseQueryPartSelect);
+
+  return select;
+}
+
+bool DatabaseUtils::BuildOrderClause(const SortDescription &sortDescription, MediaType mediaType, bool sqlite, std::string &orderBy)
+{
+  // SortUtils compares the labels of its preparators alphanumerically and
+  // without case, which only matches SQL for keys with a fixed format
+  std::string direction = sortDescription.sortOrder == SortOrderDescending ? " DESC" : " ASC";
+  switch (sortDescription.sortBy)
+  {
+  case SortByRandom:
+    orderBy = sqlite ? "RANDOM()" : "RAND()";
+    return true;
+
+  case SortByDateAdded:
+  {
+    // "YYYY-MM-DD HH:MM:SS" (or the id where there is no date) and the id
+    std::string dateAdded = GetField(FieldDateAdded, mediaType, DatabaseQueryPartOrderBy);
+    std::string id = GetField(FieldId, mediaType, DatabaseQueryPartOrderBy);
+    if (dateAdded.empty() || id.empty())
+      return false;
+
+    orderBy = dateAdded + direction + ", " + id + direction;
+    return true;
+  }
+
+  default:
+    break;
+  }
+
+  return false;
+}
+
 std::string DatabaseUtils::BuildLimitClause(int end, int start /* = 0 */)
 {
   std::ostringstream sql;
@@ -26,6 +26,7 @@
 #include <vector>
 
 class CVariant;
+struct SortDescription;
 
 namespace dbiplus
 {
@@ -158,7 +159,18 @@ public:
   static bool GetSelectFields(const Fields &fields, MediaType mediaType, FieldList &selectFields);
   
   static bool GetFieldValue(const dbiplus::field_value &fieldValue, CVariant &variantValue);
-  static bool GetDatabaseResults(MediaType mediaType, const FieldList &fields, const std::auto_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results);
+  /*! \brief Reads the given fields of every row of the dataset into results.
+   \param selected whether the dataset holds rows selected with BuildSelectFields() rather than full rows of the view
+   */
+  static bool GetDatabaseResults(MediaType mediaType, const FieldList &fields, const std::auto_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results, bool selected = false);
 
+  /*! \brief Builds the select list for the id of the item followed by the given fields.
+   */
+  static std::string BuildSelectFields(const FieldList &fields, MediaType mediaType);
+  /*! \brief Builds an ORDER BY clause (without the keywords) that sorts rows exactly like SortUtils would.
+   \param sqlite whether the clause is for sqlite or mysql
+   \return false if SortUtils' ordering can't be reproduced in SQL, the items have to be sorted in memory then
+   */
+  static bool BuildOrderClause(const SortDescription &sortDescription, MediaType mediaType, bool sqlite, std::string &orderBy);
   static std::string BuildLimitClause(int end, int start = 0);
 };
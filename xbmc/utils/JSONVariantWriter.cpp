@@ -18,48 +18,129 @@
  *
  */
 
+#include <algorithm>
 #include <locale>
+#include <string.h>
 
 #include "JSONVariantWriter.h"
 
 using namespace std;
 
-string CJSONVariantWriter::Write(const CVariant &value, bool compact)
+CJSONVariantWriter::CJSONVariantWriter(IJSONOutput *output, bool compact)
+  : m_output(output), m_failed(false), m_used(0)
 {
-  string output;
-
 #if YAJL_MAJOR == 2
-  yajl_gen g = yajl_gen_alloc(NULL);
-  yajl_gen_config(g, yajl_gen_beautify, compact ? 0 : 1);
-  yajl_gen_config(g, yajl_gen_indent_string, "\t");
+  m_generator = yajl_gen_alloc(NULL);
+  yajl_gen_config(m_generator, yajl_gen_beautify, compact ? 0 : 1);
+  yajl_gen_config(m_generator, yajl_gen_indent_string, "\t");
+  yajl_gen_config(m_generator, yajl_gen_print_callback, &CJSONVariantWriter::Print, this);
 #else
   yajl_gen_config conf = { compact ? 0 : 1, "\t" };
-  yajl_gen g = yajl_gen_alloc(&conf, NULL);
+  m_generator = yajl_gen_alloc2(&CJSONVariantWriter::Print, &conf, NULL, this);
 #endif
+}
+
+CJSONVariantWriter::~CJSONVariantWriter()
+{
+  Flush();
+  yajl_gen_free(m_generator);
+}
+
+bool CJSONVariantWriter::BeginObject()
+{
+  return Check(yajl_gen_status_ok == yajl_gen_map_open(m_generator));
+}
+
+bool CJSONVariantWriter::WriteKey(const std::string &key)
+{
+#if YAJL_MAJOR == 2
+  return Check(yajl_gen_status_ok == yajl_gen_string(m_generator, (const unsigned char*)key.c_str(), (size_t)key.length()));
+#else
+  return Check(yajl_gen_status_ok == yajl_gen_string(m_generator, (const unsigned char*)key.c_str(), key.length()));
+#endif
+}
+
+bool CJSONVariantWriter::EndObject()
+{
+  return Check(yajl_gen_status_ok == yajl_gen_map_close(m_generator));
+}
+
+bool CJSONVariantWriter::BeginArray()
+{
+  return Check(yajl_gen_status_ok == yajl_gen_array_open(m_generator));
+}
+
+bool CJSONVariantWriter::EndArray()
+{
+  return Check(yajl_gen_status_ok == yajl_gen_array_close(m_generator));
+}
+
+bool CJSONVariantWriter::WriteValue(const CVariant &value)
+{
+  if (m_failed)
+    return false;
 
   // Set locale to classic ("C") to ensure valid JSON numbers
-  std::string currentLocale = setlocale(LC_NUMERIC, NULL);
+  const char *locale = setlocale(LC_NUMERIC, NULL);
+  if (locale == NULL || strcmp(locale, "C") == 0)
+    return Check(InternalWrite(m_generator, value));
+
+  std::string currentLocale = locale;
   setlocale(LC_NUMERIC, "C");
 
-  if (InternalWrite(g, value))
-  {
-    const unsigned char * buffer;
+  bool success = InternalWrite(m_generator, value);
+
+  // Re-set locale to what it was before using yajl
+  setlocale(LC_NUMERIC, currentLocale.c_str());
+
+  return Check(success);
+}
+
+bool CJSONVariantWriter::Flush()
+{
+  if (m_used > 0 && !m_failed)
+    m_failed = !m_output->Write(m_buffer, m_used);
+  m_used = 0;
+
+  return !m_failed;
+}
+
+bool CJSONVariantWriter::Check(bool success)
+{
+  if (!success)
+    m_failed = true;
+
+  return !m_failed;
+}
 
 #if YAJL_MAJOR == 2
-    size_t length;
-    yajl_gen_get_buf(g, &buffer, &length);
+void CJSONVariantWriter::Print(void *ctx, const char *str, size_t length)
 #else
-    unsigned int length;
-    yajl_gen_get_buf(g, &buffer, &length);
+void CJSONVariantWriter::Print(void *ctx, const char *str, unsigned int length)
 #endif
-    output = string((const char *)buffer, length);
+{
+  CJSONVariantWriter *writer = (CJSONVariantWriter *)ctx;
+  while (length > 0 && !writer->m_failed)
+  {
+    if (writer->m_used == sizeof(writer->m_buffer))
+      writer->Flush();
+
+    size_t count = std::min((size_t)length, sizeof(writer->m_buffer) - writer->m_used);
+    memcpy(writer->m_buffer + writer->m_used, str, count);
+    writer->m_used += count;
+    str += count;
+    length -= count;
   }
+}
 
-  // Re-set locale to what it was before using yajl
-  setlocale(LC_NUMERIC, currentLocale.c_str());
+string CJSONVariantWriter::Write(const CVariant &value, bool compact)
+{
+  string output;
+  CJSONStringOutput stringOutput(output);
+  CJSONVariantWriter writer(&stringOutput, compact);
 
-  yajl_gen_clear(g);
-  yajl_gen_free(g);
+  if (!writer.WriteValue(value) || !writer.Flush())
+    output.clear();
 
   return output;
 }
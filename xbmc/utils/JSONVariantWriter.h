@@ -26,10 +26,79 @@
 #include <yajl/yajl_version.h>
 #endif
 
+/*!
+ \brief Receives the JSON text written by a CJSONVariantWriter in pieces.
+ */
+class IJSONOutput
+{
+public:
+  virtual ~IJSONOutput() { }
+
+  /*!
+   \brief Takes the next piece of JSON text
+   \return false if no more text can be taken (e.g. the client disconnected)
+   */
+  virtual bool Write(const char *data, size_t length) = 0;
+};
+
+/*!
+ \brief Collects the written JSON text in a string.
+ */
+class CJSONStringOutput : public IJSONOutput
+{
+public:
+  CJSONStringOutput(std::string &output) : m_output(output) { }
+
+  virtual bool Write(const char *data, size_t length)
+  {
+    m_output.append(data, length);
+    return true;
+  }
+
+private:
+  std::string &m_output;
+};
+
 class CJSONVariantWriter
 {
 public:
+  /*!
+   \brief Writes JSON into the given output while it is being generated.
+
+   The text is collected in a fixed buffer which is passed on to the output
+   whenever it fills up, so the memory needed does not grow with the size
+   of the written document. Values can be written as a whole or pieced
+   together with the Begin/End methods, e.g. to write the items of a large
+   list one at a time.
+   */
+  CJSONVariantWriter(IJSONOutput *output, bool compact);
+  ~CJSONVariantWriter();
+
+  bool BeginObject();
+  bool WriteKey(const std::string &key);
+  bool EndObject();
+  bool BeginArray();
+  bool EndArray();
+  bool WriteValue(const CVariant &value);
+
+  /*!
+   \brief Passes all buffered text on to the output
+   */
+  bool Flush();
+
   static std::string Write(const CVariant &value, bool compact);
 private:
   static bool InternalWrite(yajl_gen g, const CVariant &value);
+#if YAJL_MAJOR == 2
+  static void Print(void *ctx, const char *str, size_t length);
+#else
+  static void Print(void *ctx, const char *str, unsigned int length);
+#endif
+  bool Check(bool success);
+
+  yajl_gen m_generator;
+  IJSONOutput *m_output;
+  bool m_failed;
+  size_t m_used;
+  char m_buffer[8192];
 };
@@ -35,6 +35,9 @@
 
 #include "filesystem/File.h"
 #include "guilib/GraphicContext.h"
+#if defined(HAS_GL)
+#include "guilib/GUIQuadBatchGL.h"
+#endif
 
 #include "utils/JobManager.h"
 #include "utils/URIUtils.h"
@@ -112,6 +115,7 @@ bool CScreenshotSurface::capture()
   }
   g_application.RenderNoPresent();
 #ifndef HAS_GLES
+  CGUIQuadBatchGL::Get().Flush();
   glReadBuffer(GL_BACK);
 #endif
   //get current viewport
@@ -28,6 +28,9 @@
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
 
+#include <algorithm>
+#include <locale>
+
 using namespace std;
 
 string ArrayToString(SortAttribute attributes, const CVariant &variant, const string &seperator = " / ")
@@ -411,111 +414,177 @@ string ByChannel(SortAttribute attributes, const SortItem &values)
   return values.at(FieldChannelName).asString();
 }
 
-bool preliminarySort(const SortItem &left, const SortItem &right, bool handleFolder, bool &result, std::wstring &labelLeft, std::wstring &labelRight)
+/* A piece of a sort label as StringUtils::AlphaNumericCompare() looks at it:
+   a single (lower case) character or a run of up to 15 digits */
+struct SortToken
+{
+  int64_t number;
+  unsigned int rank; // collation rank of the character (first digit of a number)
+  bool isNumber;
+};
+
+/* The sort keys of all items in contiguous arrays, so sorting only moves
+   indices around instead of comparing maps of variants. Labels are broken
+   into tokens once and their characters replaced by collation ranks, which
+   makes comparing them a loop over integers that orders exactly like
+   AlphaNumericCompare() */
+class SortColumns
 {
-  // make sure both items have the necessary data to do the sorting
-  SortItem::const_iterator itLeftSort, itRightSort;
-  if ((itLeftSort = left.find(FieldSort)) == left.end())
+public:
+  SortColumns(size_t size)
   {
-    result = false;
-    return true;
+    labels.reserve(size);
+    offsets.reserve(size + 1);
+    special.reserve(size);
+    folder.reserve(size);
+    offsets.push_back(0);
   }
-  if ((itRightSort = right.find(FieldSort)) == right.end())
+
+  void Add(const std::wstring &label, const SortItem &item, bool handleFolder)
   {
-    result = true;
-    return true;
+    labels.push_back(label);
+
+    for (size_t i = 0; i < label.size(); )
+    {
+      SortToken token;
+      wchar_t c = label[i];
+      token.rank = c;
+      token.number = 0;
+      token.isNumber = c >= L'0' && c <= L'9';
+      if (token.isNumber)
+      { // compare only up to 15 digits
+        size_t end = std::min(label.size(), i + 15);
+        for (; i < end && label[i] >= L'0' && label[i] <= L'9'; i++)
+          token.number = token.number * 10 + label[i] - L'0';
+      }
+      else
+      {
+        if (c >= L'A' && c <= L'Z')
+          token.rank += L'a' - L'A';
+        i++;
+      }
+      tokens.push_back(token);
+    }
+    offsets.push_back(tokens.size());
+
+    SortItem::const_iterator it = item.find(FieldSortSpecial);
+    if (it != item.end() && it->second.asInteger() <= (int64_t)SortSpecialOnBottom)
+      special.push_back((unsigned char)it->second.asInteger());
+    else
+      special.push_back(SortSpecialNone);
+
+    it = handleFolder ? item.find(FieldFolder) : item.end();
+    folder.push_back(it != item.end() ? (it->second.asBoolean() ? 1 : 0) : -1);
   }
 
-  // look at special sorting behaviour
-  SortItem::const_iterator itLeft, itRight;
-  SortSpecial leftSortSpecial = SortSpecialNone;
-  SortSpecial rightSortSpecial = SortSpecialNone;
-  if ((itLeft = left.find(FieldSortSpecial)) != left.end() && itLeft->second.asInteger() <= (int64_t)SortSpecialOnBottom)
-    leftSortSpecial = (SortSpecial)itLeft->second.asInteger();
-  if ((itRight = right.find(FieldSortSpecial)) != right.end() && itRight->second.asInteger() <= (int64_t)SortSpecialOnBottom)
-    rightSortSpecial = (SortSpecial)itRight->second.asInteger();
-  
-  // one has a special sort
-  if (leftSortSpecial != rightSortSpecial)
+  /*! \brief Replaces the character codes of all tokens by their rank in the collation order of the current locale */
+  void Collate()
   {
-    // left should be sorted on top
-    // or right should be sorted on bottom
-    // => left is sorted above right
-    if (leftSortSpecial == SortSpecialOnTop ||
-        rightSortSpecial == SortSpecialOnBottom)
+    // the characters used, most of them will be in the BMP
+    std::vector<bool> used(0x10000);
+    std::vector<wchar_t> chars;
+    for (std::vector<SortToken>::const_iterator it = tokens.begin(); it != tokens.end(); ++it)
     {
-      result = true;
-      return true;
+      if (it->rank >= used.size())
+        chars.push_back((wchar_t)it->rank);
+      else if (!used[it->rank])
+      {
+        used[it->rank] = true;
+        chars.push_back((wchar_t)it->rank);
+      }
+    }
+    std::sort(chars.begin(), chars.end());
+    chars.erase(std::unique(chars.begin(), chars.end()), chars.end());
+
+    // characters in collation order, ranked the same where the locale can't tell them apart
+    std::vector<wchar_t> collated(chars);
+    const collate<wchar_t> &coll = use_facet< collate<wchar_t> >(locale());
+    std::stable_sort(collated.begin(), collated.end(), CharLess(coll));
+    std::vector<unsigned int> ranks(chars.size());
+    unsigned int rank = 0;
+    for (size_t i = 0; i < collated.size(); i++)
+    {
+      if (i > 0 && coll.compare(&collated[i - 1], &collated[i - 1] + 1, &collated[i], &collated[i] + 1) != 0)
+        rank++;
+      ranks[std::lower_bound(chars.begin(), chars.end(), collated[i]) - chars.begin()] = rank;
     }
-    
-    // otherwise right is sorted above left
-    result = false;
-    return true;
+
+    for (std::vector<SortToken>::iterator it = tokens.begin(); it != tokens.end(); ++it)
+      it->rank = ranks[std::lower_bound(chars.begin(), chars.end(), (wchar_t)it->rank) - chars.begin()];
   }
-  // both have either sort on top or sort on bottom -> leave as-is
-  else if (leftSortSpecial != SortSpecialNone && leftSortSpecial == rightSortSpecial)
+
+  /*! \brief Orders two items like the preliminary sort and AlphaNumericCompare() of their labels used to */
+  bool Less(unsigned int left, unsigned int right, bool descending) const
   {
-    result = false;
-    return true;
+    // one has a special sort
+    if (special[left] != special[right])
+      return special[left] == SortSpecialOnTop || special[right] == SortSpecialOnBottom;
+    // both have either sort on top or sort on bottom -> leave as-is
+    if (special[left] != SortSpecialNone)
+      return false;
+
+    if (folder[left] >= 0 && folder[right] >= 0 && folder[left] != folder[right])
+      return folder[left] == 1;
+
+    int result = Compare(left, right);
+    return descending ? result > 0 : result < 0;
   }
 
-  if (handleFolder)
+  std::vector<std::wstring> labels;
+
+private:
+  int Compare(unsigned int left, unsigned int right) const
   {
-    itLeft = left.find(FieldFolder);
-    itRight = right.find(FieldFolder);
-    if (itLeft != left.end() && itRight != right.end() &&
-        itLeft->second.asBoolean() != itRight->second.asBoolean())
+    // all labels may be empty, leaving no tokens to index
+    const SortToken *base = tokens.empty() ? NULL : &tokens[0];
+    const SortToken *l = base + offsets[left], *lEnd = base + offsets[left + 1];
+    const SortToken *r = base + offsets[right], *rEnd = base + offsets[right + 1];
+    for (; l < lEnd && r < rEnd; l++, r++)
     {
-      result = itLeft->second.asBoolean();
-      return true;
+      if (l->isNumber && r->isNumber)
+      {
+        if (l->number != r->number)
+          return l->number < r->number ? -1 : 1;
+      }
+      else if (l->rank != r->rank)
+        return l->rank < r->rank ? -1 : 1;
+      else if (l->isNumber != r->isNumber)
+        return l->isNumber ? 1 : -1;
     }
+    if (r < rEnd) // r is longer
+      return -1;
+    if (l < lEnd) // l is longer
+      return 1;
+    return 0;
   }
 
-  labelLeft = itLeftSort->second.asWideString();
-  labelRight = itRightSort->second.asWideString();
-
-  return false;
-}
-
-bool SorterAscending(const SortItem &left, const SortItem &right)
-{
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, true, result, labelLeft, labelRight))
-    return result;
-
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
-}
-
-bool SorterDescending(const SortItem &left, const SortItem &right)
-{
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, true, result, labelLeft, labelRight))
-    return result;
-
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) > 0;
-}
-
-bool SorterIgnoreFoldersAscending(const SortItem &left, const SortItem &right)
-{
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, false, result, labelLeft, labelRight))
-    return result;
-
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
-}
+  class CharLess
+  {
+  public:
+    CharLess(const collate<wchar_t> &coll) : m_coll(coll) { }
+    bool operator()(const wchar_t &left, const wchar_t &right) const
+    {
+      return m_coll.compare(&left, &left + 1, &right, &right + 1) < 0;
+    }
+  private:
+    const collate<wchar_t> &m_coll;
+  };
+
+  std::vector<SortToken> tokens;
+  std::vector<size_t> offsets;       // first token of every label, and one past the last
+  std::vector<unsigned char> special;
+  std::vector<signed char> folder;   // -1 if unknown or ignored
+};
 
-bool SorterIgnoreFoldersDescending(const SortItem &left, const SortItem &right)
+class SortColumnsSorter
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, false, result, labelLeft, labelRight))
-    return result;
-
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) > 0;
-}
+public:
+  SortColumnsSorter(const SortColumns &columns, bool descending) : m_columns(columns), m_descending(descending) { }
+  bool operator()(unsigned int left, unsigned int right) const { return m_columns.Less(left, right, m_descending); }
+private:
+  const SortColumns &m_columns;
+  bool m_descending;
+};
 
 map<SortBy, SortUtils::SortPreparator> fillPreparators()
 {
@@ -644,41 +713,58 @@ map<SortBy, Fields> SortUtils::m_sortingFields = fillSortingFields();
 
 void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, SortItems& items, int limitEnd /* = -1 */, int limitStart /* = 0 */)
 {
-  if (sortBy != SortByNone)
+  // the part of the (sorted) items to keep
+  size_t first = 0, count = items.size();
+  if (limitStart > 0 && (size_t)limitStart < count)
   {
-    // get the matching SortPreparator
-    SortPreparator preparator = getPreparator(sortBy);
-    if (preparator != NULL)
-    {
-      Fields sortingFields = GetFieldsForSorting(sortBy);
+    first = limitStart;
+    count -= limitStart;
+    limitEnd -= limitStart;
+  }
+  if (limitEnd > 0 && (size_t)limitEnd < count)
+    count = limitEnd;
 
-      // Prepare the string used for sorting and store it under FieldSort
-      for (SortItems::iterator item = items.begin(); item != items.end(); item++)
-      {
-        // add all fields to the item that are required for sorting if they are currently missing
-        for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); field++)
-        {
-          if (item->find(*field) == item->end())
-            item->insert(pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
-        }
-
-        CStdStringW sortLabel;
-        g_charsetConverter.utf8ToW(preparator(attributes, *item), sortLabel, false);
-        item->insert(pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
-      }
+  SortPreparator preparator = sortBy != SortByNone ? getPreparator(sortBy) : NULL;
+  if (preparator == NULL)
+  {
+    items.erase(items.begin() + first + count, items.end());
+    items.erase(items.begin(), items.begin() + first);
+    return;
+  }
 
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorter(sortOrder, attributes));
+  // Prepare the string used for sorting of every item
+  Fields sortingFields = GetFieldsForSorting(sortBy);
+  SortColumns columns(items.size());
+  for (SortItems::iterator item = items.begin(); item != items.end(); item++)
+  {
+    // add all fields to the item that are required for sorting if they are currently missing
+    for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); field++)
+    {
+      if (item->find(*field) == item->end())
+        item->insert(pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
     }
+
+    CStdStringW sortLabel;
+    g_charsetConverter.utf8ToW(preparator(attributes, *item), sortLabel, false);
+    columns.Add(sortLabel, *item, !(attributes & SortAttributeIgnoreFolders));
   }
+  columns.Collate();
+
+  // Do the sorting
+  vector<unsigned int> order(items.size());
+  for (unsigned int i = 0; i < order.size(); i++)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), SortColumnsSorter(columns, sortOrder == SortOrderDescending));
 
-  if (limitStart > 0 && (size_t)limitStart < items.size())
+  // move the items we keep into their place and store the string used for sorting with them
+  SortItems sorted(count);
+  for (size_t i = 0; i < count; i++)
   {
-    items.erase(items.begin(), items.begin() + limitStart);
-    limitEnd -= limitStart;
+    unsigned int index = order[first + i];
+    sorted[i].swap(items[index]);
+    sorted[i][FieldSort] = CVariant(columns.labels[index]);
   }
-  if (limitEnd > 0 && (size_t)limitEnd < items.size())
-    items.erase(items.begin() + limitEnd, items.end());
+  items.swap(sorted);
 }
 
 void SortUtils::Sort(const SortDescription &sortDescription, SortItems& items)
@@ -716,14 +802,6 @@ const SortUtils::SortPreparator& SortUtils::getPreparator(SortBy sortBy)
   return m_preparators[SortByNone];
 }
 
-SortUtils::Sorter SortUtils::getSorter(SortOrder sortOrder, SortAttribute attributes)
-{
-  if (attributes & SortAttributeIgnoreFolders)
-    return sortOrder == SortOrderDescending ? SorterIgnoreFoldersDescending : SorterIgnoreFoldersAscending;
-
-  return sortOrder == SortOrderDescending ? SorterDescending : SorterAscending;
-}
-
 const Fields& SortUtils::GetFieldsForSorting(SortBy sortBy)
 {
   map<SortBy, Fields>::const_iterator it = m_sortingFields.find(sortBy);
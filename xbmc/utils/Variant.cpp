@@ -20,6 +20,8 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <new>
 #include <sstream>
 
 #include "Variant.h"
@@ -51,7 +53,8 @@ wstring trimRight(const wstring &str)
 int64_t str2int64(const string &str, int64_t fallback /* = 0 */)
 {
   char *end = NULL;
-  int64_t result = strtol(trimRight(str).c_str(), &end, 0);
+  string trimmed = trimRight(str);
+  int64_t result = strtol(trimmed.c_str(), &end, 0);
   if (end == NULL || *end == '\0')
     return result;
 
@@ -61,7 +64,8 @@ int64_t str2int64(const string &str, int64_t fallback /* = 0 */)
 int64_t str2int64(const wstring &str, int64_t fallback /* = 0 */)
 {
   wchar_t *end = NULL;
-  int64_t result = wcstol(trimRight(str).c_str(), &end, 0);
+  wstring trimmed = trimRight(str);
+  int64_t result = wcstol(trimmed.c_str(), &end, 0);
   if (end == NULL || *end == '\0')
     return result;
 
@@ -71,7 +75,8 @@ int64_t str2int64(const wstring &str, int64_t fallback /* = 0 */)
 uint64_t str2uint64(const string &str, uint64_t fallback /* = 0 */)
 {
   char *end = NULL;
-  uint64_t result = strtoul(trimRight(str).c_str(), &end, 0);
+  string trimmed = trimRight(str);
+  uint64_t result = strtoul(trimmed.c_str(), &end, 0);
   if (end == NULL || *end == '\0')
     return result;
 
@@ -81,7 +86,8 @@ uint64_t str2uint64(const string &str, uint64_t fallback /* = 0 */)
 uint64_t str2uint64(const wstring &str, uint64_t fallback /* = 0 */)
 {
   wchar_t *end = NULL;
-  uint64_t result = wcstoul(trimRight(str).c_str(), &end, 0);
+  wstring trimmed = trimRight(str);
+  uint64_t result = wcstoul(trimmed.c_str(), &end, 0);
   if (end == NULL || *end == '\0')
     return result;
 
@@ -91,7 +97,8 @@ uint64_t str2uint64(const wstring &str, uint64_t fallback /* = 0 */)
 double str2double(const string &str, double fallback /* = 0.0 */)
 {
   char *end = NULL;
-  double result = strtod(trimRight(str).c_str(), &end);
+  string trimmed = trimRight(str);
+  double result = strtod(trimmed.c_str(), &end);
   if (end == NULL || *end == '\0')
     return result;
 
@@ -101,18 +108,221 @@ double str2double(const string &str, double fallback /* = 0.0 */)
 double str2double(const wstring &str, double fallback /* = 0.0 */)
 {
   wchar_t *end = NULL;
-  double result = wcstod(trimRight(str).c_str(), &end);
+  wstring trimmed = trimRight(str);
+  double result = wcstod(trimmed.c_str(), &end);
   if (end == NULL || *end == '\0')
     return result;
 
   return fallback;
 }
 
+/*!
+ \brief Members of an object.
+
+ The members live in blocks of slots which are never moved, so references
+ to a member stay valid while other members are added or removed (just
+ like with std::map). Lookups and iteration go through a vector of
+ pointers to the slots sorted by key, which needs a handful of allocations
+ per object instead of one std::map node per member.
+ */
+class CVariant::VariantMap
+{
+public:
+  VariantMap();
+  VariantMap(const VariantMap &other);
+  ~VariantMap();
+
+  CVariant &operator[](const std::string &key);
+  const VariantMapEntry *find(const std::string &key) const;
+  void erase(const std::string &key);
+  void clear();
+  bool operator==(const VariantMap &rhs) const;
+
+  size_t size() const { return m_index.size(); }
+  bool empty() const { return m_index.empty(); }
+  VariantMapIndex &index() { return m_index; }
+  const VariantMapIndex &index() const { return m_index; }
+
+private:
+  struct Block
+  {
+    Block *next;
+    unsigned int capacity;
+    unsigned int used;
+  };
+
+  // assignment is not needed by CVariant
+  VariantMap &operator=(const VariantMap &rhs);
+
+  static bool LessKey(const VariantMapEntry *entry, const std::string &key) { return entry->first < key; }
+  VariantMapIndex::iterator lowerBound(const std::string &key);
+  void *allocateSlot(unsigned int blockCapacity);
+  void addBlock(unsigned int capacity);
+  void releaseBlocks();
+
+  VariantMapIndex m_index;
+  Block *m_blocks;
+  void *m_freeSlots;
+  size_t m_capacity;
+
+  enum
+  {
+    FirstBlockCapacity = 4,
+    MaxBlockCapacity = 64,
+    // keeps the slots following the header aligned
+    BlockHeaderSize = (sizeof(Block) + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t)
+  };
+};
+
+CVariant::VariantMap::VariantMap()
+  : m_blocks(NULL), m_freeSlots(NULL), m_capacity(0)
+{ }
+
+CVariant::VariantMap::VariantMap(const VariantMap &other)
+  : m_blocks(NULL), m_freeSlots(NULL), m_capacity(0)
+{
+  if (other.empty())
+    return;
+
+  addBlock(other.size());
+  for (VariantMapIndex::const_iterator it = other.m_index.begin(); it != other.m_index.end(); ++it)
+    m_index.push_back(new (allocateSlot(0)) VariantMapEntry(**it));
+}
+
+CVariant::VariantMap::~VariantMap()
+{
+  clear();
+}
+
+CVariant &CVariant::VariantMap::operator[](const std::string &key)
+{
+  VariantMapIndex::iterator it = lowerBound(key);
+  if (it != m_index.end() && (*it)->first == key)
+    return (*it)->second;
+
+  // allocating a slot may reserve more room in the index
+  size_t position = it - m_index.begin();
+  void *slot = allocateSlot(std::min((unsigned int)m_capacity + FirstBlockCapacity, (unsigned int)MaxBlockCapacity));
+  VariantMapEntry *entry;
+  try
+  {
+    entry = new (slot) VariantMapEntry(key, CVariant());
+  }
+  catch (...)
+  {
+    *(void **)slot = m_freeSlots;
+    m_freeSlots = slot;
+    throw;
+  }
+
+  m_index.insert(m_index.begin() + position, entry);
+  return entry->second;
+}
+
+const CVariant::VariantMapEntry *CVariant::VariantMap::find(const std::string &key) const
+{
+  VariantMapIndex::const_iterator it = std::lower_bound(m_index.begin(), m_index.end(), key, LessKey);
+  if (it != m_index.end() && (*it)->first == key)
+    return *it;
+
+  return NULL;
+}
+
+void CVariant::VariantMap::erase(const std::string &key)
+{
+  VariantMapIndex::iterator it = lowerBound(key);
+  if (it == m_index.end() || (*it)->first != key)
+    return;
+
+  VariantMapEntry *entry = *it;
+  m_index.erase(it);
+  entry->~VariantMapEntry();
+
+  // erased slots are reused by the next insertion
+  *(void **)entry = m_freeSlots;
+  m_freeSlots = entry;
+}
+
+void CVariant::VariantMap::clear()
+{
+  for (VariantMapIndex::iterator it = m_index.begin(); it != m_index.end(); ++it)
+    (*it)->~VariantMapEntry();
+  m_index.clear();
+  releaseBlocks();
+}
+
+bool CVariant::VariantMap::operator==(const VariantMap &rhs) const
+{
+  if (size() != rhs.size())
+    return false;
+
+  for (size_t i = 0; i < m_index.size(); i++)
+  {
+    if (m_index[i]->first != rhs.m_index[i]->first ||
+        !(m_index[i]->second == rhs.m_index[i]->second))
+      return false;
+  }
+
+  return true;
+}
+
+CVariant::VariantMapIndex::iterator CVariant::VariantMap::lowerBound(const std::string &key)
+{
+  // members are mostly added in key order so check the end first
+  if (m_index.empty() || m_index.back()->first < key)
+    return m_index.end();
+
+  return std::lower_bound(m_index.begin(), m_index.end(), key, LessKey);
+}
+
+void *CVariant::VariantMap::allocateSlot(unsigned int blockCapacity)
+{
+  if (m_freeSlots != NULL)
+  {
+    void *slot = m_freeSlots;
+    m_freeSlots = *(void **)slot;
+    return slot;
+  }
+
+  if (m_blocks == NULL || m_blocks->used == m_blocks->capacity)
+    addBlock(std::max(blockCapacity, (unsigned int)FirstBlockCapacity));
+
+  char *slots = (char *)m_blocks + BlockHeaderSize;
+  return slots + sizeof(VariantMapEntry) * m_blocks->used++;
+}
+
+void CVariant::VariantMap::addBlock(unsigned int capacity)
+{
+  Block *block = (Block *)new char[BlockHeaderSize + capacity * sizeof(VariantMapEntry)];
+  block->next = m_blocks;
+  block->capacity = capacity;
+  block->used = 0;
+  m_blocks = block;
+
+  // reserve the index along with the slots so inserting never reallocates it on its own
+  m_capacity += capacity;
+  m_index.reserve(m_capacity);
+}
+
+void CVariant::VariantMap::releaseBlocks()
+{
+  while (m_blocks != NULL)
+  {
+    Block *next = m_blocks->next;
+    delete[] (char *)m_blocks;
+    m_blocks = next;
+  }
+
+  m_freeSlots = NULL;
+  m_capacity = 0;
+}
+
 CVariant CVariant::ConstNullVariant = CVariant::VariantTypeConstNull;
 
 CVariant::CVariant(VariantType type)
 {
   m_type = type;
+  m_shortString = false;
 
   switch (type)
   {
@@ -129,7 +339,7 @@ CVariant::CVariant(VariantType type)
       m_data.dvalue = 0.0;
       break;
     case VariantTypeString:
-      m_data.string = new string();
+      setString("", 0);
       break;
     case VariantTypeWideString:
       m_data.wstring = new wstring();
@@ -149,84 +359,99 @@ CVariant::CVariant(VariantType type)
 CVariant::CVariant(int integer)
 {
   m_type = VariantTypeInteger;
+  m_shortString = false;
   m_data.integer = integer;
 }
 
 CVariant::CVariant(int64_t integer)
 {
   m_type = VariantTypeInteger;
+  m_shortString = false;
   m_data.integer = integer;
 }
 
 CVariant::CVariant(unsigned int unsignedinteger)
 {
   m_type = VariantTypeUnsignedInteger;
+  m_shortString = false;
   m_data.unsignedinteger = unsignedinteger;
 }
 
 CVariant::CVariant(uint64_t unsignedinteger)
 {
   m_type = VariantTypeUnsignedInteger;
+  m_shortString = false;
   m_data.unsignedinteger = unsignedinteger;
 }
 
 CVariant::CVariant(double value)
 {
   m_type = VariantTypeDouble;
+  m_shortString = false;
   m_data.dvalue = value;
 }
 
 CVariant::CVariant(float value)
 {
   m_type = VariantTypeDouble;
+  m_shortString = false;
   m_data.dvalue = (double)value;
 }
 
 CVariant::CVariant(bool boolean)
 {
   m_type = VariantTypeBoolean;
+  m_shortString = false;
   m_data.boolean = boolean;
 }
 
 CVariant::CVariant(const char *str)
 {
-  m_type = VariantTypeString;
-  m_data.string = new string(str);
+  setString(str, strlen(str));
 }
 
 CVariant::CVariant(const char *str, unsigned int length)
 {
-  m_type = VariantTypeString;
-  m_data.string = new string(str, length);
+  setString(str, length);
 }
 
 CVariant::CVariant(const string &str)
 {
-  m_type = VariantTypeString;
-  m_data.string = new string(str);
+  if (str.size() > ShortStringLength)
+  {
+    m_type = VariantTypeString;
+    m_shortString = false;
+    m_data.string = new string(str);
+  }
+  else
+    setString(str.c_str(), str.size());
 }
 
 CVariant::CVariant(const wchar_t *str)
 {
   m_type = VariantTypeWideString;
+  m_shortString = false;
   m_data.wstring = new wstring(str);
 }
 
 CVariant::CVariant(const wchar_t *str, unsigned int length)
 {
   m_type = VariantTypeWideString;
+  m_shortString = false;
   m_data.wstring = new wstring(str, length);
 }
 
 CVariant::CVariant(const wstring &str)
 {
   m_type = VariantTypeWideString;
+  m_shortString = false;
   m_data.wstring = new wstring(str);
 }
 
 CVariant::CVariant(const std::vector<std::string> &strArray)
 {
   m_type = VariantTypeArray;
+  m_shortString = false;
   m_data.array = new VariantArray;
   m_data.array->reserve(strArray.size());
   for (unsigned int index = 0; index < strArray.size(); index++)
@@ -236,23 +461,40 @@ CVariant::CVariant(const std::vector<std::string> &strArray)
 CVariant::CVariant(const std::map<std::string, std::string> &strMap)
 {
   m_type = VariantTypeObject;
+  m_shortString = false;
   m_data.map = new VariantMap;
   for (std::map<std::string, std::string>::const_iterator it = strMap.begin(); it != strMap.end(); it++)
-    m_data.map->insert(make_pair(it->first, CVariant(it->second)));
+    (*m_data.map)[it->first] = it->second;
 }
 
 CVariant::CVariant(const std::map<std::string, CVariant> &variantMap)
 {
   m_type = VariantTypeObject;
-  m_data.map = new VariantMap(variantMap.begin(), variantMap.end());
+  m_shortString = false;
+  m_data.map = new VariantMap;
+  for (std::map<std::string, CVariant>::const_iterator it = variantMap.begin(); it != variantMap.end(); it++)
+    (*m_data.map)[it->first] = it->second;
 }
 
 CVariant::CVariant(const CVariant &variant)
 {
   m_type = VariantTypeNull;
+  m_shortString = false;
   *this = variant;
 }
 
+#ifdef VARIANT_HAS_RVALUE_REFERENCES
+CVariant::CVariant(CVariant &&variant) noexcept
+{
+  m_type = VariantTypeNull;
+  m_shortString = false;
+  if (variant.m_type == VariantTypeConstNull)
+    m_type = VariantTypeConstNull;
+  else
+    swap(variant);
+}
+#endif
+
 CVariant::~CVariant()
 {
   cleanup();
@@ -260,7 +502,7 @@ CVariant::~CVariant()
 
 void CVariant::cleanup()
 {
-  if (m_type == VariantTypeString)
+  if (m_type == VariantTypeString && !m_shortString)
     delete m_data.string;
   else if (m_type == VariantTypeWideString)
     delete m_data.wstring;
@@ -269,6 +511,34 @@ void CVariant::cleanup()
   else if (m_type == VariantTypeObject)
     delete m_data.map;
   m_type = VariantTypeNull;
+  m_shortString = false;
+}
+
+void CVariant::setString(const char *str, size_t length)
+{
+  m_type = VariantTypeString;
+  if (length <= ShortStringLength)
+  {
+    m_shortString = true;
+    memcpy(m_data.shortstring.chars, str, length);
+    m_data.shortstring.chars[length] = '\0';
+    m_data.shortstring.length = (unsigned char)length;
+  }
+  else
+  {
+    m_shortString = false;
+    m_data.string = new string(str, length);
+  }
+}
+
+const char *CVariant::stringData() const
+{
+  return m_shortString ? m_data.shortstring.chars : m_data.string->c_str();
+}
+
+size_t CVariant::stringLength() const
+{
+  return m_shortString ? m_data.shortstring.length : m_data.string->size();
 }
 
 bool CVariant::isInteger() const
@@ -332,7 +602,7 @@ int64_t CVariant::asInteger(int64_t fallback) const
     case VariantTypeDouble:
       return (int64_t)m_data.dvalue;
     case VariantTypeString:
-      return str2int64(*m_data.string, fallback);
+      return str2int64(asString(), fallback);
     case VariantTypeWideString:
       return str2int64(*m_data.wstring, fallback);
     default:
@@ -353,7 +623,7 @@ uint64_t CVariant::asUnsignedInteger(uint64_t fallback) const
     case VariantTypeDouble:
       return (uint64_t)m_data.dvalue;
     case VariantTypeString:
-      return str2uint64(*m_data.string, fallback);
+      return str2uint64(asString(), fallback);
     case VariantTypeWideString:
       return str2uint64(*m_data.wstring, fallback);
     default:
@@ -374,7 +644,7 @@ double CVariant::asDouble(double fallback) const
     case VariantTypeUnsignedInteger:
       return (double)m_data.unsignedinteger;
     case VariantTypeString:
-      return str2double(*m_data.string, fallback);
+      return str2double(asString(), fallback);
     case VariantTypeWideString:
       return str2double(*m_data.wstring, fallback);
     default:
@@ -395,7 +665,7 @@ float CVariant::asFloat(float fallback) const
     case VariantTypeUnsignedInteger:
       return (float)m_data.unsignedinteger;
     case VariantTypeString:
-      return (float)str2double(*m_data.string, fallback);
+      return (float)str2double(asString(), fallback);
     case VariantTypeWideString:
       return (float)str2double(*m_data.wstring, fallback);
     default:
@@ -418,9 +688,13 @@ bool CVariant::asBoolean(bool fallback) const
     case VariantTypeDouble:
       return (m_data.dvalue != 0);
     case VariantTypeString:
-      if (m_data.string->empty() || m_data.string->compare("0") == 0 || m_data.string->compare("false") == 0)
+    {
+      size_t length = stringLength();
+      const char *str = stringData();
+      if (length == 0 || (length == 1 && str[0] == '0') || (length == 5 && memcmp(str, "false", 5) == 0))
         return false;
       return true;
+    }
     case VariantTypeWideString:
       if (m_data.wstring->empty() || m_data.wstring->compare(L"0") == 0 || m_data.wstring->compare(L"false") == 0)
         return false;
@@ -437,6 +711,8 @@ std::string CVariant::asString(const std::string &fallback /* = "" */) const
   switch (m_type)
   {
     case VariantTypeString:
+      if (m_shortString)
+        return std::string(m_data.shortstring.chars, m_data.shortstring.length);
       return *m_data.string;
     case VariantTypeBoolean:
       return m_data.boolean ? "true" : "false";
@@ -505,9 +781,9 @@ CVariant &CVariant::operator[](const std::string &key)
 
 const CVariant &CVariant::operator[](const std::string &key) const
 {
-  VariantMap::const_iterator it;
-  if (m_type == VariantTypeObject && (it = m_data.map->find(key)) != m_data.map->end())
-    return it->second;
+  const VariantMapEntry *entry;
+  if (m_type == VariantTypeObject && (entry = m_data.map->find(key)) != NULL)
+    return entry->second;
   else
     return ConstNullVariant;
 }
@@ -530,43 +806,73 @@ const CVariant &CVariant::operator[](unsigned int position) const
 
 CVariant &CVariant::operator=(const CVariant &rhs)
 {
-  if (m_type == VariantTypeConstNull)
+  if (m_type == VariantTypeConstNull || this == &rhs)
     return *this;
 
-  cleanup();
-
-  m_type = rhs.m_type;
+  // build the copy first as rhs may be part of this variant
+  CVariant copy;
+  copy.m_type = rhs.m_type;
 
-  switch (m_type)
+  switch (copy.m_type)
   {
   case VariantTypeInteger:
-    m_data.integer = rhs.m_data.integer;
+    copy.m_data.integer = rhs.m_data.integer;
     break;
   case VariantTypeUnsignedInteger:
-    m_data.integer = rhs.m_data.unsignedinteger;
+    copy.m_data.integer = rhs.m_data.unsignedinteger;
     break;
   case VariantTypeBoolean:
-    m_data.boolean = rhs.m_data.boolean;
+    copy.m_data.boolean = rhs.m_data.boolean;
     break;
   case VariantTypeDouble:
-    m_data.dvalue = rhs.m_data.dvalue;
+    copy.m_data.dvalue = rhs.m_data.dvalue;
     break;
   case VariantTypeString:
-    m_data.string = new string(*rhs.m_data.string);
+    if (rhs.m_shortString)
+    {
+      copy.m_shortString = true;
+      copy.m_data.shortstring = rhs.m_data.shortstring;
+    }
+    else
+      copy.m_data.string = new string(*rhs.m_data.string);
     break;
   case VariantTypeWideString:
-    m_data.wstring = new wstring(*rhs.m_data.wstring);
+    copy.m_data.wstring = new wstring(*rhs.m_data.wstring);
     break;
   case VariantTypeArray:
-    m_data.array = new VariantArray(rhs.m_data.array->begin(), rhs.m_data.array->end());
+    copy.m_data.array = new VariantArray(rhs.m_data.array->begin(), rhs.m_data.array->end());
     break;
   case VariantTypeObject:
-    m_data.map = new VariantMap(rhs.m_data.map->begin(), rhs.m_data.map->end());
+    copy.m_data.map = new VariantMap(*rhs.m_data.map);
     break;
   default:
     break;
   }
 
+  swap(copy);
+  return *this;
+}
+
+#ifdef VARIANT_HAS_RVALUE_REFERENCES
+CVariant &CVariant::operator=(CVariant &&rhs) noexcept
+{
+  return move(rhs);
+}
+#endif
+
+CVariant &CVariant::move(CVariant &rhs)
+{
+  if (m_type == VariantTypeConstNull || this == &rhs)
+    return *this;
+
+  // the shared null variant must never change so copy it instead
+  if (rhs.m_type == VariantTypeConstNull)
+    return *this = rhs;
+
+  // take rhs out first as it may be part of this variant
+  CVariant value;
+  value.swap(rhs);
+  swap(value);
   return *this;
 }
 
@@ -585,7 +891,8 @@ bool CVariant::operator==(const CVariant &rhs) const
     case VariantTypeDouble:
       return m_data.dvalue == rhs.m_data.dvalue;
     case VariantTypeString:
-      return *m_data.string == *rhs.m_data.string;
+      return stringLength() == rhs.stringLength() &&
+             memcmp(stringData(), rhs.stringData(), stringLength()) == 0;
     case VariantTypeWideString:
       return *m_data.wstring == *rhs.m_data.wstring;
     case VariantTypeArray:
@@ -601,6 +908,17 @@ bool CVariant::operator==(const CVariant &rhs) const
 }
 
 void CVariant::push_back(const CVariant &variant)
+{
+  CVariant copy(variant);
+  push_back_move(copy);
+}
+
+void CVariant::append(const CVariant &variant)
+{
+  push_back(variant);
+}
+
+void CVariant::push_back_move(CVariant &variant)
 {
   if (m_type == VariantTypeNull)
   {
@@ -608,19 +926,40 @@ void CVariant::push_back(const CVariant &variant)
     m_data.array = new VariantArray;
   }
 
-  if (m_type == VariantTypeArray)
-    m_data.array->push_back(variant);
+  if (m_type != VariantTypeArray)
+    return;
+
+  // take the variant out first as it may be an item of this array
+  CVariant value;
+  value.move(variant);
+
+  if (m_data.array->size() == m_data.array->capacity())
+    growArray();
+  m_data.array->push_back(CVariant());
+  m_data.array->back().swap(value);
 }
 
-void CVariant::append(const CVariant &variant)
+void CVariant::append_move(CVariant &variant)
 {
-  push_back(variant);
+  push_back_move(variant);
+}
+
+void CVariant::growArray()
+{
+  // std::vector would copy every item into the new storage, swapping
+  // them over leaves all their strings, arrays and objects in place
+  VariantArray grown;
+  grown.reserve(std::max((size_t)4, m_data.array->capacity() * 2));
+  grown.resize(m_data.array->size());
+  for (size_t index = 0; index < grown.size(); index++)
+    grown[index].swap((*m_data.array)[index]);
+  m_data.array->swap(grown);
 }
 
 const char *CVariant::c_str() const
 {
   if (m_type == VariantTypeString)
-    return m_data.string->c_str();
+    return stringData();
   else
     return NULL;
 }
@@ -628,12 +967,15 @@ const char *CVariant::c_str() const
 void CVariant::swap(CVariant &rhs)
 {
   VariantType  temp_type = m_type;
+  bool         temp_shortString = m_shortString;
   VariantUnion temp_data = m_data;
 
   m_type = rhs.m_type;
+  m_shortString = rhs.m_shortString;
   m_data = rhs.m_data;
 
   rhs.m_type = temp_type;
+  rhs.m_shortString = temp_shortString;
   rhs.m_data = temp_data;
 }
 
@@ -672,7 +1014,7 @@ CVariant::const_iterator_array CVariant::end_array() const
 CVariant::iterator_map CVariant::begin_map()
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->begin();
+    return iterator_map(m_data.map->index().begin());
   else
     return iterator_map();
 }
@@ -680,7 +1022,7 @@ CVariant::iterator_map CVariant::begin_map()
 CVariant::const_iterator_map CVariant::begin_map() const
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->begin();
+    return const_iterator_map(m_data.map->index().begin());
   else
     return const_iterator_map();
 }
@@ -688,7 +1030,7 @@ CVariant::const_iterator_map CVariant::begin_map() const
 CVariant::iterator_map CVariant::end_map()
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->end();
+    return iterator_map(m_data.map->index().end());
   else
     return iterator_map();
 }
@@ -696,7 +1038,7 @@ CVariant::iterator_map CVariant::end_map()
 CVariant::const_iterator_map CVariant::end_map() const
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->end();
+    return const_iterator_map(m_data.map->index().end());
   else
     return const_iterator_map();
 }
@@ -708,7 +1050,7 @@ unsigned int CVariant::size() const
   else if (m_type == VariantTypeArray)
     return m_data.array->size();
   else if (m_type == VariantTypeString)
-    return m_data.string->size();
+    return stringLength();
   else if (m_type == VariantTypeWideString)
     return m_data.wstring->size();
   else
@@ -722,7 +1064,7 @@ bool CVariant::empty() const
   else if (m_type == VariantTypeArray)
     return m_data.array->empty();
   else if (m_type == VariantTypeString)
-    return m_data.string->empty();
+    return stringLength() == 0;
   else if (m_type == VariantTypeWideString)
     return m_data.wstring->empty();
   else if (m_type == VariantTypeNull)
@@ -738,7 +1080,10 @@ void CVariant::clear()
   else if (m_type == VariantTypeArray)
     m_data.array->clear();
   else if (m_type == VariantTypeString)
-    m_data.string->clear();
+  {
+    cleanup();
+    setString("", 0);
+  }
   else if (m_type == VariantTypeWideString)
     m_data.wstring->clear();
 }
@@ -763,13 +1108,19 @@ void CVariant::erase(unsigned int position)
   }
 
   if (m_type == VariantTypeArray && position < size())
-    m_data.array->erase(m_data.array->begin() + position);
+  {
+    // swap the erased item to the end instead of copying every following item
+    VariantArray &array = *m_data.array;
+    for (size_t index = position; index + 1 < array.size(); index++)
+      array[index].swap(array[index + 1]);
+    array.pop_back();
+  }
 }
 
 bool CVariant::isMember(const std::string &key) const
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->find(key) != m_data.map->end();
+    return m_data.map->find(key) != NULL;
 
   return false;
 }
@@ -18,12 +18,17 @@
  *  <http://www.gnu.org/licenses/>.
  *
  */
+#include <iterator>
 #include <map>
 #include <vector>
 #include <string>
 #include <stdint.h>
 #include <wchar.h>
 
+#if __cplusplus >= 201103L
+#define VARIANT_HAS_RVALUE_REFERENCES
+#endif
+
 int64_t str2int64(const std::string &str, int64_t fallback = 0);
 int64_t str2int64(const std::wstring &str, int64_t fallback = 0);
 uint64_t str2uint64(const std::string &str, uint64_t fallback = 0);
@@ -66,6 +71,9 @@ public:
   CVariant(const std::map<std::string, std::string> &strMap);
   CVariant(const std::map<std::string, CVariant> &variantMap);
   CVariant(const CVariant &variant);
+#ifdef VARIANT_HAS_RVALUE_REFERENCES
+  CVariant(CVariant &&variant) noexcept;
+#endif
   ~CVariant();
 
   bool isInteger() const;
@@ -94,10 +102,29 @@ public:
   const CVariant &operator[](unsigned int position) const;
 
   CVariant &operator=(const CVariant &rhs);
+#ifdef VARIANT_HAS_RVALUE_REFERENCES
+  CVariant &operator=(CVariant &&rhs) noexcept;
+#endif
   bool operator==(const CVariant &rhs) const;
 
+  /*!
+   \brief Take over the value of the given variant without copying it.
+
+   The given variant is left null. Use this instead of operator= when the
+   source is a temporary that has been filled in completely (e.g. an item
+   object of a JSON-RPC response) to avoid a deep copy of its strings,
+   arrays and objects.
+   */
+  CVariant &move(CVariant &rhs);
+
   void push_back(const CVariant &variant);
   void append(const CVariant &variant);
+  /*!
+   \brief Append the given variant to this array without copying it.
+   \sa move
+   */
+  void push_back_move(CVariant &variant);
+  void append_move(CVariant &variant);
 
   const char *c_str() const;
 
@@ -105,14 +132,54 @@ public:
 
 private:
   typedef std::vector<CVariant> VariantArray;
-  typedef std::map<std::string, CVariant> VariantMap;
+  typedef std::pair<const std::string, CVariant> VariantMapEntry;
+  typedef std::vector<VariantMapEntry *> VariantMapIndex;
+  class VariantMap;
+
+  /*!
+   \brief Iterator over the members of an object in key order.
+
+   Behaves like a std::map iterator: it->first is the key and it->second
+   the value of the member.
+   */
+  template <class Value, class IndexIterator>
+  class map_iterator
+  {
+  public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Value value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Value *pointer;
+    typedef Value &reference;
+
+    map_iterator() : m_position() { }
+    explicit map_iterator(IndexIterator position) : m_position(position) { }
+    template <class OtherValue, class OtherIndexIterator>
+    map_iterator(const map_iterator<OtherValue, OtherIndexIterator> &other) : m_position(other.position()) { }
+
+    reference operator*() const { return **m_position; }
+    pointer operator->() const { return *m_position; }
+    map_iterator &operator++() { ++m_position; return *this; }
+    map_iterator operator++(int) { map_iterator tmp(*this); ++m_position; return tmp; }
+    map_iterator &operator--() { --m_position; return *this; }
+    map_iterator operator--(int) { map_iterator tmp(*this); --m_position; return tmp; }
+    template <class OtherValue, class OtherIndexIterator>
+    bool operator==(const map_iterator<OtherValue, OtherIndexIterator> &other) const { return m_position == other.position(); }
+    template <class OtherValue, class OtherIndexIterator>
+    bool operator!=(const map_iterator<OtherValue, OtherIndexIterator> &other) const { return m_position != other.position(); }
+
+    const IndexIterator &position() const { return m_position; }
+
+  private:
+    IndexIterator m_position;
+  };
 
 public:
   typedef VariantArray::iterator        iterator_array;
   typedef VariantArray::const_iterator  const_iterator_array;
 
-  typedef VariantMap::iterator          iterator_map;
-  typedef VariantMap::const_iterator    const_iterator_map;
+  typedef map_iterator<VariantMapEntry, VariantMapIndex::iterator>              iterator_map;
+  typedef map_iterator<const VariantMapEntry, VariantMapIndex::const_iterator>  const_iterator_map;
 
   iterator_array begin_array();
   const_iterator_array begin_array() const;
@@ -136,6 +203,22 @@ public:
 
 private:
   void cleanup();
+  void setString(const char *str, size_t length);
+  const char *stringData() const;
+  size_t stringLength() const;
+  void growArray();
+
+  /*!
+   \brief Strings of up to ShortStringLength characters are stored inside
+   the variant itself instead of on the heap.
+   */
+  enum { ShortStringLength = 14 };
+  struct ShortString
+  {
+    char chars[ShortStringLength + 1];
+    unsigned char length;
+  };
+
   union VariantUnion
   {
     int64_t integer;
@@ -146,8 +229,10 @@ private:
     std::wstring *wstring;
     VariantArray *array;
     VariantMap *map;
+    ShortString shortstring;
   };
 
   VariantType m_type;
+  bool m_shortString;
   VariantUnion m_data;
 };
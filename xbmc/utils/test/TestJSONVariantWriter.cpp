@@ -30,3 +30,48 @@ TEST(TestJSONVariantWriter, Write)
   str = CJSONVariantWriter::Write(variant, false);
   EXPECT_STREQ("null\n", str.c_str());
 }
+
+class CTestJSONOutput : public IJSONOutput
+{
+public:
+  CTestJSONOutput() : writes(0) { }
+
+  virtual bool Write(const char *data, size_t length)
+  {
+    writes++;
+    text.append(data, length);
+    return true;
+  }
+
+  int writes;
+  std::string text;
+};
+
+TEST(TestJSONVariantWriter, WriteStreamed)
+{
+  CVariant item;
+  item["label"] = std::string(100, 'x');
+
+  CVariant expected;
+  expected["limits"]["total"] = 1000;
+  for (int index = 0; index < 1000; index++)
+    expected["items"].push_back(item);
+
+  CTestJSONOutput output;
+  {
+    CJSONVariantWriter writer(&output, true);
+    EXPECT_TRUE(writer.BeginObject());
+    EXPECT_TRUE(writer.WriteKey("items"));
+    EXPECT_TRUE(writer.BeginArray());
+    for (int index = 0; index < 1000; index++)
+      EXPECT_TRUE(writer.WriteValue(item));
+    EXPECT_TRUE(writer.EndArray());
+    EXPECT_TRUE(writer.WriteKey("limits"));
+    EXPECT_TRUE(writer.WriteValue(expected["limits"]));
+    EXPECT_TRUE(writer.EndObject());
+    EXPECT_TRUE(writer.Flush());
+  }
+
+  EXPECT_EQ(CJSONVariantWriter::Write(expected, true), output.text);
+  EXPECT_LT(1, output.writes);
+}
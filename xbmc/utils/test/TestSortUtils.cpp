@@ -19,10 +19,18 @@
  */
 
 #include "utils/SortUtils.h"
+#include "utils/CharsetConverter.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
 #include "utils/Variant.h"
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <iostream>
+
+#define BENCH_ITEMS 50000
+
 TEST(TestSortUtils, Sort_SortBy)
 {
   SortItems items;
@@ -131,3 +139,95 @@ TEST(TestSortUtils, GetFieldsForSorting)
   EXPECT_EQ(FieldTrackNumber, *it);
   EXPECT_EQ((unsigned int)4, fields.size());
 }
+
+/* The way SortUtils used to sort: the label stored in every item and
+ * compared through map lookups.
+ */
+static bool ReferenceLess(const SortItem &left, const SortItem &right)
+{
+  bool leftFolder = left.at(FieldFolder).asBoolean(), rightFolder = right.at(FieldFolder).asBoolean();
+  if (leftFolder != rightFolder)
+    return leftFolder;
+
+  std::wstring labelLeft = left.at(FieldSort).asWideString();
+  std::wstring labelRight = right.at(FieldSort).asWideString();
+  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
+}
+
+static void ReferenceSort(SortItems &items)
+{
+  for (SortItems::iterator item = items.begin(); item != items.end(); item++)
+  {
+    CStdStringW sortLabel;
+    g_charsetConverter.utf8ToW(SortUtils::RemoveArticles(item->at(FieldTitle).asString()), sortLabel, false);
+    item->insert(std::pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
+  }
+  std::stable_sort(items.begin(), items.end(), ReferenceLess);
+}
+
+static void MakeItems(SortItems &items, int count)
+{
+  items.clear();
+  items.resize(count);
+  for (int i = 0; i < count; i++)
+  {
+    CStdString title;
+    title.Format("%sTitle %d - Part %d", i % 5 ? "" : "The ", (i * 7919) % (count / 3), i % 3);
+    items[i][FieldTitle] = title;
+    items[i][FieldLabel] = title;
+    items[i][FieldFolder] = i % 50 == 0;
+    items[i][FieldId] = i;
+  }
+}
+
+TEST(TestSortUtils, Sort_MatchesReference)
+{
+  SortItems items, reference;
+  MakeItems(items, 2000);
+  reference = items;
+
+  SortUtils::Sort(SortByTitle, SortOrderAscending, SortAttributeIgnoreArticle, items);
+  ReferenceSort(reference);
+
+  ASSERT_EQ(reference.size(), items.size());
+  for (size_t i = 0; i < items.size(); i++)
+  {
+    EXPECT_EQ(reference[i][FieldId].asInteger(), items[i][FieldId].asInteger()) << "item " << i;
+    EXPECT_TRUE(reference[i][FieldSort].asWideString() == items[i][FieldSort].asWideString()) << "item " << i;
+  }
+}
+
+TEST(TestSortUtils, Sort_Limits)
+{
+  SortItems items, all;
+  MakeItems(items, 500);
+  all = items;
+
+  SortUtils::Sort(SortByTitle, SortOrderDescending, SortAttributeIgnoreArticle, all);
+  SortUtils::Sort(SortByTitle, SortOrderDescending, SortAttributeIgnoreArticle, items, 150, 100);
+
+  ASSERT_EQ((size_t)50, items.size());
+  for (size_t i = 0; i < items.size(); i++)
+    EXPECT_EQ(all[100 + i][FieldId].asInteger(), items[i][FieldId].asInteger());
+}
+
+TEST(TestSortUtils, SortBenchmark)
+{
+  SortItems items, reference;
+  MakeItems(items, BENCH_ITEMS);
+  reference = items;
+
+  int64_t start = CurrentHostCounter();
+  ReferenceSort(reference);
+  double referenceTime = (double)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+
+  start = CurrentHostCounter();
+  SortUtils::Sort(SortByTitle, SortOrderAscending, SortAttributeIgnoreArticle, items);
+  double sortTime = (double)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+
+  std::cout << "sorting " << BENCH_ITEMS << " items by title: "
+            << "labels in the items " << referenceTime << " ms, "
+            << "sort columns " << sortTime << " ms" << std::endl;
+  EXPECT_EQ(reference.front()[FieldId].asInteger(), items.front()[FieldId].asInteger());
+  EXPECT_EQ(reference.back()[FieldId].asInteger(), items.back()[FieldId].asInteger());
+}
@@ -19,9 +19,16 @@
  */
 
 #include "utils/Variant.h"
+#include "utils/SortUtils.h"
+#include "utils/TimeUtils.h"
 
 #include "gtest/gtest.h"
 
+#include <stdio.h>
+#include <iostream>
+
+#define BENCH_ITEMS 10000
+
 TEST(TestVariant, VariantTypeInteger)
 {
   CVariant a((int)0), b((int64_t)1);
@@ -75,6 +82,35 @@ TEST(TestVariant, VariantTypeString)
   EXPECT_STREQ("VariantTypeString3", c.asString().c_str());
 }
 
+TEST(TestVariant, VariantTypeShortString)
+{
+  CVariant a("fourteen chars"), b("fifteen chars!!"), c(std::string("a\0b", 3)), d("");
+
+  EXPECT_EQ(14u, a.size());
+  EXPECT_EQ(15u, b.size());
+  EXPECT_STREQ("fourteen chars", a.c_str());
+  EXPECT_STREQ("fifteen chars!!", b.c_str());
+  EXPECT_EQ(std::string("a\0b", 3), c.asString());
+  EXPECT_TRUE(d.empty());
+  EXPECT_TRUE(a == CVariant(std::string("fourteen chars")));
+  EXPECT_FALSE(c == CVariant("a"));
+
+  EXPECT_FALSE(CVariant("false").asBoolean(true));
+  EXPECT_FALSE(CVariant("0").asBoolean(true));
+  EXPECT_TRUE(CVariant("falsehood").asBoolean());
+  EXPECT_EQ(1234, CVariant("1234").asInteger());
+
+  a.clear();
+  EXPECT_TRUE(a.isString());
+  EXPECT_STREQ("", a.c_str());
+
+  // short strings are kept inside the variant
+  CVariant e("short"), f(e);
+  f = e;
+  const char *data = f.c_str();
+  EXPECT_TRUE(data >= (const char *)&f && data < (const char *)(&f + 1));
+}
+
 TEST(TestVariant, VariantTypeWideString)
 {
   CVariant a(L"VariantTypeWideString");
@@ -236,6 +272,97 @@ TEST(TestVariant, swap)
   EXPECT_TRUE(a.isString());
 }
 
+TEST(TestVariant, move)
+{
+  CVariant a, b;
+  b["key"] = "a string long enough for the heap";
+  b["array"].push_back(1);
+
+  // the strings and containers are handed over, not copied
+  const char *key = b["key"].c_str();
+  const CVariant *element = &b["array"][0];
+  a.move(b);
+  EXPECT_EQ(key, a["key"].c_str());
+  EXPECT_EQ(element, &a["array"][0]);
+  EXPECT_TRUE(b.isNull());
+  EXPECT_STREQ("a string long enough for the heap", a["key"].c_str());
+
+  // moving a member into its parent
+  a.move(a["array"]);
+  EXPECT_TRUE(a.isArray());
+  EXPECT_EQ(1, a[0].asInteger());
+
+  // the shared null variant stays null
+  b.move(a[5]);
+  EXPECT_TRUE(b.isNull());
+  EXPECT_TRUE(CVariant::ConstNullVariant.isNull());
+  EXPECT_EQ(CVariant::VariantTypeConstNull, CVariant::ConstNullVariant.type());
+}
+
+TEST(TestVariant, push_back_move)
+{
+  CVariant a, object;
+  object["label"] = "a label long enough for the heap";
+  const char *label = object["label"].c_str();
+
+  a.push_back_move(object);
+  EXPECT_TRUE(object.isNull());
+  EXPECT_EQ(label, a[0]["label"].c_str());
+  EXPECT_STREQ("a label long enough for the heap", a[0]["label"].c_str());
+
+  // appending an item of the array itself
+  for (int i = 0; i < 20; i++)
+    a.push_back(a[0]);
+  a.append_move(a[0]);
+  EXPECT_EQ(22u, a.size());
+  EXPECT_TRUE(a[0].isNull());
+  EXPECT_STREQ("a label long enough for the heap", a[21]["label"].c_str());
+}
+
+TEST(TestVariant, assignFromMember)
+{
+  CVariant a;
+  a["icon"] = "an icon long enough for the heap";
+  a["thumbnail"] = a["icon"];
+  EXPECT_STREQ("an icon long enough for the heap", a["thumbnail"].c_str());
+
+  a = a["icon"];
+  EXPECT_STREQ("an icon long enough for the heap", a.c_str());
+}
+
+TEST(TestVariant, objectMembers)
+{
+  CVariant a;
+  CVariant &first = a["m"];
+  first = "first";
+
+  // references to members stay valid while others are added and removed
+  for (int i = 0; i < 200; i++)
+  {
+    char key[16];
+    sprintf(key, "k%03d", (i * 37) % 200);
+    a[key] = i;
+    if (i % 3 == 0)
+      a.erase(key);
+  }
+  EXPECT_STREQ("first", first.c_str());
+  EXPECT_EQ(&first, &a["m"]);
+  EXPECT_EQ(134u, a.size());
+
+  std::string last;
+  for (CVariant::const_iterator_map it = a.begin_map(); it != a.end_map(); ++it)
+  {
+    EXPECT_LT(last, it->first);
+    last = it->first;
+  }
+
+  CVariant b(a);
+  EXPECT_TRUE(a == b);
+  b["m"] = "changed";
+  EXPECT_FALSE(a == b);
+  EXPECT_STREQ("first", first.c_str());
+}
+
 TEST(TestVariant, interator_array)
 {
   std::vector<std::string> strarray;
@@ -348,3 +475,94 @@ TEST(TestVariant, isMember)
   EXPECT_TRUE(a.isMember("key1"));
   EXPECT_FALSE(a.isMember("key2"));
 }
+
+static void FillItem(CVariant &object, int index)
+{
+  char label[64];
+  sprintf(label, "Movie %d", index);
+  char title[64];
+  sprintf(title, "The Return of Movie Number %d", index);
+  char file[128];
+  sprintf(file, "smb://server/share/movies/The Return of Movie Number %d (%d).mkv", index, 1980 + index % 30);
+
+  object["movieid"] = index;
+  object["label"] = label;
+  object["title"] = title;
+  object["file"] = file;
+  object["thumbnail"] = "image://smb%3a%2f%2fserver%2fshare%2fmovies%2fposter.jpg/";
+  object["year"] = 1980 + index % 30;
+  object["rating"] = 5.0 + (index % 50) / 10.0;
+  object["runtime"] = "5400";
+  object["mpaa"] = "Rated PG-13";
+  object["playcount"] = index % 3;
+  object["genre"].push_back("Action");
+  object["genre"].push_back("Drama");
+}
+
+static void BuildResponse(CVariant &response, bool move)
+{
+  CVariant result;
+  for (int index = 0; index < BENCH_ITEMS; index++)
+  {
+    CVariant object;
+    FillItem(object, index);
+    if (move)
+      result["movies"].append_move(object);
+    else
+      result["movies"].append(object);
+  }
+  result["limits"]["start"] = 0;
+  result["limits"]["end"] = BENCH_ITEMS;
+  result["limits"]["total"] = BENCH_ITEMS;
+
+  response["jsonrpc"] = "2.0";
+  response["id"] = 1;
+  if (move)
+    response["result"].move(result);
+  else
+    response["result"] = result;
+}
+
+TEST(TestVariant, ResponseBenchmark)
+{
+  CVariant copied, moved;
+
+  int64_t start = CurrentHostCounter();
+  BuildResponse(copied, false);
+  double copyTime = (double)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+
+  start = CurrentHostCounter();
+  BuildResponse(moved, true);
+  double moveTime = (double)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+
+  std::cout << "building a response with " << BENCH_ITEMS << " movies: "
+            << "copying " << copyTime << " ms, moving " << moveTime << " ms" << std::endl;
+  EXPECT_TRUE(copied == moved);
+}
+
+TEST(TestVariant, SortItemsBenchmark)
+{
+  int64_t start = CurrentHostCounter();
+  SortItems items;
+  items.resize(BENCH_ITEMS);
+  for (int index = 0; index < BENCH_ITEMS; index++)
+  {
+    char title[64];
+    sprintf(title, "Title %d", (index * 7919) % BENCH_ITEMS);
+    items[index][FieldId] = index;
+    items[index][FieldTitle] = title;
+    items[index][FieldLabel] = title;
+    items[index][FieldYear] = 1980 + index % 30;
+    items[index][FieldGenre] = index % 2 ? "Action" : "Drama";
+    items[index][FieldPath] = "smb://server/share/movies/";
+  }
+  double buildTime = (double)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+
+  start = CurrentHostCounter();
+  SortUtils::Sort(SortByTitle, SortOrderAscending, SortAttributeNone, items);
+  double sortTime = (double)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+
+  std::cout << "sort items for " << BENCH_ITEMS << " movies: "
+            << "building " << buildTime << " ms, sorting " << sortTime << " ms" << std::endl;
+  EXPECT_STREQ("Title 0", items.front()[FieldTitle].c_str());
+}
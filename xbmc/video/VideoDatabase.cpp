@@ -477,8 +477,10 @@ int CVideoDatabase::GetPathId(const CStdString& strPath)
 
     URIUtils::AddSlashAtEnd(strPath1);
 
-    strSQL=PrepareSQL("select idPath from path where strPath='%s'",strPath1.c_str());
-    m_pDS->query(strSQL.c_str());
+    strSQL = "select idPath from path where strPath=?";
+    sql_record params;
+    params.push_back(strPath1.c_str());
+    m_pDS->query(strSQL, params);
     if (!m_pDS->eof())
       idPath = m_pDS->fv("path.idPath").get_asInt();
 
@@ -919,9 +921,10 @@ int CVideoDatabase::GetFileId(const CStdString& strFilenameAndPath)
     int idPath = GetPathId(strPath);
     if (idPath >= 0)
     {
-      CStdString strSQL;
-      strSQL=PrepareSQL("select idFile from files where strFileName='%s' and idPath=%i", strFileName.c_str(),idPath);
-      m_pDS->query(strSQL.c_str());
+      sql_record params;
+      params.push_back(strFileName.c_str());
+      params.push_back(idPath);
+      m_pDS->query("select idFile from files where strFileName=? and idPath=?", params);
       if (m_pDS->num_rows() > 0)
       {
         int idFile = m_pDS->fv("files.idFile").get_asInt();
@@ -1376,6 +1379,14 @@ void CVideoDatabase::AddLinkToActor(const char *table, int actorID, const char *
     if (NULL == m_pDB.get()) return ;
     if (NULL == m_pDS.get()) return ;
 
+    if (InBatch())
+    { // the link table is unique on both ids, so no need to look first. Ignore
+      // rather than replace, the first role of an actor is the one kept
+      QueueBatchRow(PrepareSQL("%s into %s (idActor, %s, strRole, iOrder)", m_sqlite ? "insert or ignore" : "insert ignore", table, secondField),
+                    PrepareSQL("%i,%i,'%s',%i", actorID, secondID, role.c_str(), order));
+      return;
+    }
+
     CStdString strSQL=PrepareSQL("select * from %s where idActor=%i and %s=%i", table, actorID, secondField, secondID);
     m_pDS->query(strSQL.c_str());
     if (m_pDS->num_rows() == 0)
@@ -1399,6 +1410,18 @@ void CVideoDatabase::AddToLinkTable(const char *table, const char *firstField, i
     if (NULL == m_pDB.get()) return ;
     if (NULL == m_pDS.get()) return ;
 
+    if (InBatch())
+    { // the link tables are unique on their ids, so no need to look first
+      const char *insert = m_sqlite ? "insert or ignore" : "insert ignore";
+      if (typeField == NULL || type == NULL)
+        QueueBatchRow(PrepareSQL("%s into %s (%s,%s)", insert, table, firstField, secondField),
+                      PrepareSQL("%i,%i", firstID, secondID));
+      else
+        QueueBatchRow(PrepareSQL("%s into %s (%s,%s,%s)", insert, table, firstField, secondField, typeField),
+                      PrepareSQL("%i,%i,'%s'", firstID, secondID, type));
+      return;
+    }
+
     CStdString strSQL = PrepareSQL("select * from %s where %s=%i and %s=%i", table, firstField, firstID, secondField, secondID);
     if (typeField != NULL && type != NULL)
       strSQL += PrepareSQL(" and %s='%s'", typeField, type);
@@ -1963,7 +1986,7 @@ int CVideoDatabase::SetDetailsForMovie(const CStdString& strFilenameAndPath, con
 {
   try
   {
-    BeginTransaction();
+    BeginBatch();
 
     if (idMovie < 0)
       idMovie = GetMovieId(strFilenameAndPath);
@@ -1978,7 +2001,7 @@ int CVideoDatabase::SetDetailsForMovie(const CStdString& strFilenameAndPath, con
       idMovie = AddMovie(strFilenameAndPath);
       if (idMovie < 0)
       {
-        CommitTransaction();
+        EndBatch();
         return idMovie;
       }
     }
@@ -2045,13 +2068,14 @@ int CVideoDatabase::SetDetailsForMovie(const CStdString& strFilenameAndPath, con
       sql += ", idSet = NULL";
     sql += PrepareSQL(" where idMovie=%i", idMovie);
     m_pDS->exec(sql.c_str());
-    CommitTransaction();
+    EndBatch();
 
     return idMovie;
   }
   catch (...)
   {
     CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, strFilenameAndPath.c_str());
+    AbortBatch();
   }
   return -1;
 }
@@ -2066,7 +2090,7 @@ int CVideoDatabase::SetDetailsForTvShow(const CStdString& strPath, const CVideoI
       return -1;
     }
 
-    BeginTransaction();
+    BeginBatch();
 
     if (idTvShow < 0)
       idTvShow = GetTvShowId(strPath);
@@ -2078,7 +2102,7 @@ int CVideoDatabase::SetDetailsForTvShow(const CStdString& strPath, const CVideoI
       idTvShow = AddTvShow(strPath);
       if (idTvShow < 0)
       {
-        CommitTransaction();
+        EndBatch();
         return idTvShow;
       }
     }
@@ -2129,13 +2153,14 @@ int CVideoDatabase::SetDetailsForTvShow(const CStdString& strPath, const CVideoI
     sql += PrepareSQL(" where idShow=%i", idTvShow);
     m_pDS->exec(sql.c_str());
 
-    CommitTransaction();
+    EndBatch();
 
     return idTvShow;
   }
   catch (...)
   {
     CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, strPath.c_str());
+    AbortBatch();
   }
 
   return -1;
@@ -2145,7 +2170,7 @@ int CVideoDatabase::SetDetailsForEpisode(const CStdString& strFilenameAndPath, c
 {
   try
   {
-    BeginTransaction();
+    BeginBatch();
     if (idEpisode < 0)
       idEpisode = GetEpisodeId(strFilenameAndPath);
 
@@ -2159,7 +2184,7 @@ int CVideoDatabase::SetDetailsForEpisode(const CStdString& strFilenameAndPath, c
       idEpisode = AddEpisode(idShow,strFilenameAndPath);
       if (idEpisode < 0)
       {
-        CommitTransaction();
+        EndBatch();
         return -1;
       }
     }
@@ -2203,13 +2228,14 @@ int CVideoDatabase::SetDetailsForEpisode(const CStdString& strFilenameAndPath, c
     CStdString sql = "update episode set " + GetValueString(details, VIDEODB_ID_EPISODE_MIN, VIDEODB_ID_EPISODE_MAX, DbEpisodeOffsets);
     sql += PrepareSQL(" where idEpisode=%i", idEpisode);
     m_pDS->exec(sql.c_str());
-    CommitTransaction();
+    EndBatch();
 
     return idEpisode;
   }
   catch (...)
   {
     CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, strFilenameAndPath.c_str());
+    AbortBatch();
   }
   return -1;
 }
@@ -2238,7 +2264,7 @@ int CVideoDatabase::SetDetailsForMusicVideo(const CStdString& strFilenameAndPath
 {
   try
   {
-    BeginTransaction();
+    BeginBatch();
 
     if (idMVideo < 0)
       idMVideo = GetMusicVideoId(strFilenameAndPath);
@@ -2253,7 +2279,7 @@ int CVideoDatabase::SetDetailsForMusicVideo(const CStdString& strFilenameAndPath
       idMVideo = AddMusicVideo(strFilenameAndPath);
       if (idMVideo < 0)
       {
-        CommitTransaction();
+        EndBatch();
         return -1;
       }
     }
@@ -2308,13 +2334,14 @@ int CVideoDatabase::SetDetailsForMusicVideo(const CStdString& strFilenameAndPath
     CStdString sql = "update musicvideo set " + GetValueString(details, VIDEODB_ID_MUSICVIDEO_MIN, VIDEODB_ID_MUSICVIDEO_MAX, DbMusicVideoOffsets);
     sql += PrepareSQL(" where idMVideo=%i", idMVideo);
     m_pDS->exec(sql.c_str());
-    CommitTransaction();
+    EndBatch();
 
     return idMVideo;
   }
   catch (...)
   {
     CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, strFilenameAndPath.c_str());
+    AbortBatch();
   }
   return -1;
 }
@@ -5829,6 +5856,9 @@ bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter
     if (!CDatabase::BuildSQL(strSQLExtra, extFilter, strSQLExtra))
       return false;
 
+    // whether the rows come in the order they're wanted in
+    bool sortedInSQL = sortDescription.sortBy == SortByNone;
+
     // Apply the limiting directly here if there's no special sorting but limiting
     if (extFilter.limit.empty() &&
         sorting.sortBy == SortByNone &&
@@ -5837,9 +5867,63 @@ bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter
       total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
       strSQLExtra += DatabaseUtils::BuildLimitClause(sorting.limitEnd, sorting.limitStart);
     }
+    // for a page of a sorted listing let the database sort if it can do so
+    // exactly like SortUtils, otherwise sort on just the fields needed and
+    // only fetch the full rows of the page
+    else if (extFilter.limit.empty() && extFilter.order.empty() &&
+            (extFilter.fields.empty() || extFilter.fields == "*") &&
+             sortDescription.sortBy != SortByNone && sortDescription.limitEnd > 0)
+    {
+      std::string order;
+      if (DatabaseUtils::BuildOrderClause(sortDescription, MediaTypeMovie, m_sqlite, order))
+      {
+        total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
+        strSQLExtra += " ORDER BY " + order + DatabaseUtils::BuildLimitClause(sortDescription.limitEnd, sortDescription.limitStart);
+        sortedInSQL = true;
+      }
+      else
+        sortedInSQL = BuildSortedPageSQL("movieview", MediaTypeMovie, sortDescription, strSQLExtra, total);
+    }
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
+    // without a sort in memory the rows are wanted in the order they come in,
+    // so turn them into items as they're read rather than holding all of them
+    if (sortedInSQL)
+    {
+      unsigned int time = XbmcThreads::SystemClockMillis();
+      if (!m_pDS->query_forward(strSQL.c_str()))
+        return false;
+
+      while (!m_pDS->eof())
+      {
+        CVideoInfoTag movie = GetDetailsForMovie(m_pDS->get_sql_record());
+        if (g_settings.GetMasterProfile().getLockMode() == LOCK_MODE_EVERYONE ||
+            g_passwordManager.bMasterUser                                   ||
+            g_passwordManager.IsDatabasePathUnlocked(movie.m_strPath, g_settings.m_videoSources))
+        {
+          CFileItemPtr pItem(new CFileItem(movie));
+
+          CVideoDbUrl itemUrl = videoUrl;
+          CStdString path; path.Format("%ld", movie.m_iDbId);
+          itemUrl.AppendPath(path);
+          pItem->SetPath(itemUrl.ToString());
+
+          pItem->SetOverlayImage(CGUIListItem::ICON_OVERLAY_UNWATCHED,movie.m_playCount > 0);
+          items.Add(pItem);
+        }
+        m_pDS->next();
+      }
+
+      // store the total value of items as a property
+      int iRowsFound = m_pDS->num_rows();
+      if (iRowsFound > 0)
+        items.SetProperty("total", total < iRowsFound ? iRowsFound : total);
+      m_pDS->close();
+      CLog::Log(LOGDEBUG, "%s took %d ms for %d items query: %s", __FUNCTION__, XbmcThreads::SystemClockMillis() - time, iRowsFound, strSQL.c_str());
+      return true;
+    }
+
     int iRowsFound = RunQuery(strSQL);
     if (iRowsFound <= 0)
       return iRowsFound == 0;
@@ -5848,7 +5932,7 @@ bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter
     if (total < iRowsFound)
       total = iRowsFound;
     items.SetProperty("total", total);
-    
+
     DatabaseResults results;
     results.reserve(iRowsFound);
 
@@ -8915,6 +8999,9 @@ void CVideoDatabase::InvalidatePathHash(const CStdString& strPath)
 
 bool CVideoDatabase::CommitTransaction()
 {
+  if (InBatch())
+    return CDatabase::CommitTransaction(); // recalculated once the batch ends
+
   if (CDatabase::CommitTransaction())
   { // number of items in the db has likely changed, so recalculate
     g_infoManager.SetLibraryBool(LIBRARY_HAS_MOVIES, HasContent(VIDEODB_CONTENT_MOVIES));
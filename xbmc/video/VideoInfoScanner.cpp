@@ -68,6 +68,9 @@ namespace VIDEO
     m_itemCount = 0;
     m_bClean = false;
     m_scanAll = false;
+    m_prefetcher = NULL;
+    m_scannedFolders = 0;
+    m_unchangedFolders = 0;
   }
 
   CVideoInfoScanner::~CVideoInfoScanner()
@@ -97,6 +100,13 @@ namespace VIDEO
       // Reset progress vars
       m_currentItem = 0;
       m_itemCount = -1;
+      m_scannedFolders = 0;
+      m_unchangedFolders = 0;
+
+      // with no threads everything is done in order on this thread
+      unsigned int threads = g_advancedSettings.m_videoScannerThreads;
+      if (threads > 0)
+        m_prefetcher = new CVideoScanPrefetcher(threads, threads * 8);
 
       SetPriority(GetMinPriority());
 
@@ -128,6 +138,14 @@ namespace VIDEO
         else if (!DoScan(directory))
           bCancelled = true;
       }
+      FlushWrites();
+
+      if (m_prefetcher)
+      {
+        m_prefetcher->Stop();
+        CLog::Log(LOGDEBUG, "VideoInfoScanner: %u folders listed ahead of the scan, %u of them used, %u waited for",
+                  m_prefetcher->GetQueued(), m_prefetcher->GetTaken(), m_prefetcher->GetWaited());
+      }
 
       if (!bCancelled)
       {
@@ -145,12 +163,17 @@ namespace VIDEO
 
       tick = XbmcThreads::SystemClockMillis() - tick;
       CLog::Log(LOGNOTICE, "VideoInfoScanner: Finished scan. Scanning for video info took %s", StringUtils::SecondsToTimeString(tick / 1000).c_str());
+      CLog::Log(LOGNOTICE, "VideoInfoScanner: Scanned %u folders, %u of them unchanged", m_scannedFolders, m_unchangedFolders);
+      g_directoryCache.PrintStats();
     }
     catch (...)
     {
       CLog::Log(LOGERROR, "VideoInfoScanner: Exception while scanning.");
     }
-    
+
+    delete m_prefetcher;
+    m_prefetcher = NULL;
+
     m_bRunning = false;
     ANNOUNCEMENT::CAnnouncementManager::Announce(ANNOUNCEMENT::VideoLibrary, "xbmc", "OnScanFinished");
 
@@ -234,6 +257,8 @@ namespace VIDEO
     if (it != m_pathsToScan.end())
       m_pathsToScan.erase(it);
 
+    BatchWrites();
+
     // load subfolder
     CFileItemList items;
     bool foundDirectly = false;
@@ -247,6 +272,11 @@ namespace VIDEO
     CStdStringArray regexps = content == CONTENT_TVSHOWS ? g_advancedSettings.m_tvshowExcludeFromScanRegExps
                                                          : g_advancedSettings.m_moviesExcludeFromScanRegExps;
 
+    // anything listed ahead of us, only used for movies and music videos
+    ScanFolderPtr prefetched;
+    if (m_prefetcher)
+      prefetched = m_prefetcher->Take(SScanFolder::FOLDER, strDirectory, content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS);
+
     if (CUtil::ExcludeFileOrFolder(strDirectory, regexps))
       return true;
 
@@ -254,6 +284,8 @@ namespace VIDEO
     if (content == CONTENT_NONE || ignoreFolder)
       return true;
 
+    m_scannedFolders++;
+
     CStdString hash, dbHash;
     if (content == CONTENT_MOVIES ||content == CONTENT_MUSICVIDEOS)
     {
@@ -263,19 +295,27 @@ namespace VIDEO
         m_handle->SetTitle(StringUtils::Format(g_localizeStrings.Get(str), info->Name().c_str()));
       }
 
-      CStdString fastHash = GetFastHash(strDirectory);
+      CStdString fastHash = prefetched ? prefetched->fastHash : GetFastHash(strDirectory);
       if (m_database.GetPathHash(strDirectory, dbHash) && !fastHash.IsEmpty() && fastHash == dbHash)
       { // fast hashes match - no need to process anything
         CLog::Log(LOGDEBUG, "VideoInfoScanner: Skipping dir '%s' due to no change (fasthash)", strDirectory.c_str());
         hash = fastHash;
         bSkip = true;
       }
-      if (!bSkip)
+      if (!bSkip && prefetched && prefetched->listed)
+      {
+        items.Assign(prefetched->items);
+        hash = prefetched->hash;
+      }
+      else if (!bSkip)
       { // need to fetch the folder
         CDirectory::GetDirectory(strDirectory, items, g_settings.m_videoExtensions);
         items.Stack();
         // compute hash
         GetPathHash(items, hash);
+      }
+      if (!bSkip)
+      {
         if (hash != dbHash && !hash.IsEmpty())
         {
           if (dbHash.IsEmpty())
@@ -330,8 +370,16 @@ namespace VIDEO
       }
     }
 
+    if (bSkip)
+      m_unchangedFolders++;
+
+    // subfolders are visited next, have them listed while we look this one up
+    if (m_prefetcher && settings.recurse > 0 && content != CONTENT_TVSHOWS)
+      PrefetchFolders(items, SScanFolder::FOLDER, settings.parent_name_root);
+
     if (!bSkip)
     {
+      FlushWrites();
       if (RetrieveVideoInfo(items, settings.parent_name_root, content))
       {
         if (!m_bStop && (content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS))
@@ -392,6 +440,10 @@ namespace VIDEO
 
     m_database.Open();
 
+    // episodes are enumerated per show, list the show folders ahead
+    if (m_prefetcher && content == CONTENT_TVSHOWS && fetchEpisodes)
+      PrefetchFolders(items, SScanFolder::SHOW, bDirNames);
+
     bool FoundSomeInfo = false;
     vector<int> seenPaths;
     for (int i = 0; i < (int)items.Size(); ++i)
@@ -461,6 +513,10 @@ namespace VIDEO
     if(pDlgProgress)
       pDlgProgress->ShowProgressBar(false);
 
+    // drop the episode listings of shows we skipped, subfolders queued by DoScan() are still to come
+    if (m_prefetcher && content == CONTENT_TVSHOWS && fetchEpisodes)
+      m_prefetcher->Drop(items, SScanFolder::SHOW);
+
     g_infoManager.ResetLibraryBools();
     m_database.Close();
     return FoundSomeInfo;
@@ -665,9 +721,22 @@ namespace VIDEO
 
     if (item->m_bIsFolder)
     {
-      CUtil::GetRecursiveListing(item->GetPath(), items, g_settings.m_videoExtensions, true);
       CStdString hash, dbHash;
-      int numFilesInFolder = GetPathHash(items, hash);
+      int numFilesInFolder;
+      ScanFolderPtr prefetched;
+      if (m_prefetcher)
+        prefetched = m_prefetcher->Take(SScanFolder::SHOW, item->GetPath());
+      if (prefetched && prefetched->listed)
+      {
+        items.Assign(prefetched->items);
+        hash = prefetched->hash;
+        numFilesInFolder = prefetched->fileCount;
+      }
+      else
+      {
+        CUtil::GetRecursiveListing(item->GetPath(), items, g_settings.m_videoExtensions, true);
+        numFilesInFolder = GetPathHash(items, hash);
+      }
 
       if (m_database.GetPathHash(item->GetPath(), dbHash) && dbHash == hash)
       {
@@ -1480,7 +1549,7 @@ namespace VIDEO
     return INFO_ADDED;
   }
 
-  CStdString CVideoInfoScanner::GetnfoFile(CFileItem *item, bool bGrabAny) const
+  CStdString CVideoInfoScanner::GetnfoFile(CFileItem *item, bool bGrabAny)
   {
     CStdString nfoFile;
     // Find a matching .nfo file
@@ -1663,7 +1732,7 @@ namespace VIDEO
     return items.GetFolderCount() == 0;
   }
 
-  CStdString CVideoInfoScanner::GetFastHash(const CStdString &directory) const
+  CStdString CVideoInfoScanner::GetFastHash(const CStdString &directory)
   {
     struct __stat64 buffer;
     if (XFILE::CFile::Stat(directory, &buffer) == 0)
@@ -1681,6 +1750,40 @@ namespace VIDEO
     return "";
   }
 
+  void CVideoInfoScanner::PrefetchFolders(const CFileItemList &items, SScanFolder::KIND kind, bool dirNames)
+  {
+    vector<CFileItemPtr> folders;
+    unsigned int slots = m_prefetcher->GetFreeSlots();
+    for (int i = 0; i < items.Size() && folders.size() < slots; ++i)
+    {
+      const CFileItemPtr &item = items[i];
+      if (item->m_bIsFolder && !item->IsParentFolder() && !item->IsPlayList())
+        folders.push_back(item);
+    }
+
+    // the prefetcher works last in first out, so the first folder is queued last
+    for (vector<CFileItemPtr>::reverse_iterator i = folders.rbegin(); i != folders.rend(); ++i)
+    {
+      CStdString dbHash;
+      if (kind == SScanFolder::FOLDER)
+        m_database.GetPathHash((*i)->GetPath(), dbHash);
+      m_prefetcher->Queue(kind, (*i)->GetPath(), dbHash, dirNames);
+    }
+  }
+
+  void CVideoInfoScanner::BatchWrites()
+  {
+    if (m_database.InBatch())
+      m_database.BatchItemDone();
+    else
+      m_database.BeginBatch(100);
+  }
+
+  void CVideoInfoScanner::FlushWrites()
+  {
+    m_database.EndBatch();
+  }
+
   void CVideoInfoScanner::GetSeasonThumbs(const CVideoInfoTag &show, map<int, map<string, string> > &seasonArt, const vector<string> &artTypes, bool useLocal)
   {
     bool lookForThumb = find(artTypes.begin(), artTypes.end(), "thumb") == artTypes.end();
@@ -1794,7 +1897,10 @@ namespace VIDEO
   CNfoFile::NFOResult CVideoInfoScanner::CheckForNFOFile(CFileItem* pItem, bool bGrabAny, ScraperPtr& info, CScraperUrl& scrUrl)
   {
     CStdString strNfoFile;
-    if (info->Content() == CONTENT_MOVIES || info->Content() == CONTENT_MUSICVIDEOS
+    if ((info->Content() == CONTENT_MOVIES || info->Content() == CONTENT_MUSICVIDEOS)
+        && pItem->HasProperty("nfofile") && pItem->GetProperty("nfograbany").asBoolean() == bGrabAny)
+      strNfoFile = pItem->GetProperty("nfofile").asString(); // looked up by the prefetcher
+    else if (info->Content() == CONTENT_MOVIES || info->Content() == CONTENT_MUSICVIDEOS
         || (info->Content() == CONTENT_TVSHOWS && !pItem->m_bIsFolder))
       strNfoFile = GetnfoFile(pItem, bGrabAny);
     if (info->Content() == CONTENT_TVSHOWS && pItem->m_bIsFolder)
@@ -22,6 +22,7 @@
 #include "VideoDatabase.h"
 #include "addons/Scraper.h"
 #include "NfoFile.h"
+#include "VideoScanPrefetcher.h"
 
 class CRegExp;
 class CFileItem;
@@ -50,6 +51,7 @@ namespace VIDEO
 
   class CVideoInfoScanner : CThread
   {
+    friend class CVideoScanPrefetchJob;
   public:
     CVideoInfoScanner();
     virtual ~CVideoInfoScanner();
@@ -188,7 +190,7 @@ namespace VIDEO
      \param directory folder to hash
      \return the hash of the folder of the form "fast<datetime>"
      */
-    CStdString GetFastHash(const CStdString &directory) const;
+    static CStdString GetFastHash(const CStdString &directory);
 
     /*! \brief Decide whether a folder listing could use the "fast" hash
      Fast hashing can be done whenever the folder contains no scannable subfolders, as the
@@ -216,7 +218,7 @@ namespace VIDEO
     bool EnumerateEpisodeItem(const CFileItem *item, EPISODELIST& episodeList);
     bool ProcessItemByVideoInfoTag(const CFileItem *item, EPISODELIST &episodeList);
 
-    CStdString GetnfoFile(CFileItem *item, bool bGrabAny=false) const;
+    static CStdString GetnfoFile(CFileItem *item, bool bGrabAny=false);
 
     /*! \brief Retrieve the parent folder of an item, accounting for stacks and files in rars.
      \param item a media item.
@@ -224,6 +226,20 @@ namespace VIDEO
      */
     CStdString GetParentDir(const CFileItem &item) const;
 
+    /*! \brief Queue folders from a listing with the prefetcher, in the order the scan visits them
+     \param items the listing, only folders are queued
+     \param kind how the folders are going to be scanned
+     \param dirNames whether folder names are used for lookups
+     */
+    void PrefetchFolders(const CFileItemList &items, SScanFolder::KIND kind, bool dirNames);
+
+    /*! \brief Group the database writes of folders that need no lookups into transactions
+     Called for each folder. FlushWrites() ends the transaction, which is done before online lookups
+     so the database isn't held while waiting on the network.
+     */
+    void BatchWrites();
+    void FlushWrites();
+
     bool m_showDialog;
     CGUIDialogProgressBarHandle* m_handle;
     int m_currentItem;
@@ -238,6 +254,9 @@ namespace VIDEO
     std::set<CStdString> m_pathsToCount;
     std::set<int> m_pathsToClean;
     CNfoFile m_nfoReader;
+    CVideoScanPrefetcher* m_prefetcher;
+    unsigned int m_scannedFolders;
+    unsigned int m_unchangedFolders;
   };
 }
 
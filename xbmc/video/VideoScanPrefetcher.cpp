@@ -0,0 +1,205 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "VideoScanPrefetcher.h"
+#include "VideoInfoScanner.h"
+#include "filesystem/Directory.h"
+#include "settings/Settings.h"
+#include "threads/SingleLock.h"
+#include "utils/URIUtils.h"
+#include "Util.h"
+
+using namespace std;
+using namespace XFILE;
+
+namespace VIDEO
+{
+  class CVideoScanPrefetchJob : public CJob
+  {
+  public:
+    CVideoScanPrefetchJob(const ScanFolderPtr &folder) : m_folder(folder) {}
+
+    virtual const char *GetType() const { return "videoscanprefetch"; }
+    virtual bool DoWork();
+
+    ScanFolderPtr m_folder;
+  };
+
+  bool CVideoScanPrefetchJob::DoWork()
+  {
+    SScanFolder &folder = *m_folder;
+
+    if (folder.kind == SScanFolder::SHOW)
+    {
+      CUtil::GetRecursiveListing(folder.path, folder.items, g_settings.m_videoExtensions, true);
+      folder.fileCount = CVideoInfoScanner::GetPathHash(folder.items, folder.hash);
+      folder.listed = true;
+      return true;
+    }
+
+    // same order as CVideoInfoScanner::DoScan(), a fast hash match means no listing is needed
+    folder.fastHash = CVideoInfoScanner::GetFastHash(folder.path);
+    if (!folder.fastHash.IsEmpty() && folder.fastHash == folder.dbHash)
+      return true;
+
+    CDirectory::GetDirectory(folder.path, folder.items, g_settings.m_videoExtensions);
+    folder.items.Stack();
+    folder.fileCount = CVideoInfoScanner::GetPathHash(folder.items, folder.hash);
+    folder.listed = true;
+    if (folder.hash.IsEmpty() || folder.hash == folder.dbHash)
+      return true;
+
+    // the folder is going to be scanned, find the .nfo files for its videos
+    for (int i = 0; i < folder.items.Size(); i++)
+    {
+      if (ShouldCancel(i, folder.items.Size()))
+        return false;
+
+      CFileItemPtr item = folder.items[i];
+      if (item->m_bIsFolder || !item->IsVideo() || item->IsNFO() ||
+         (item->IsPlayList() && !URIUtils::GetExtension(item->GetPath()).Equals(".strm")))
+        continue;
+
+      item->SetProperty("nfofile", CVideoInfoScanner::GetnfoFile(item.get(), folder.dirNames));
+      item->SetProperty("nfograbany", folder.dirNames);
+    }
+    return true;
+  }
+
+  CVideoScanPrefetcher::CVideoScanPrefetcher(unsigned int threads, unsigned int depth)
+    : CJobQueue(true, threads, CJob::PRIORITY_LOW)
+  {
+    m_depth = depth;
+    m_stopped = false;
+    m_queued = 0;
+    m_taken = 0;
+    m_waited = 0;
+  }
+
+  CVideoScanPrefetcher::~CVideoScanPrefetcher()
+  {
+    Stop();
+  }
+
+  unsigned int CVideoScanPrefetcher::GetFreeSlots()
+  {
+    CSingleLock lock(m_folderSection);
+    if (m_stopped || m_pending.size() + m_done.size() >= m_depth)
+      return 0;
+    return m_depth - m_pending.size() - m_done.size();
+  }
+
+  bool CVideoScanPrefetcher::Queue(SScanFolder::KIND kind, const CStdString &path, const CStdString &dbHash, bool dirNames)
+  {
+    CSingleLock lock(m_folderSection);
+    if (m_stopped || m_pending.size() + m_done.size() >= m_depth)
+      return false;
+    if (m_pending.find(path) != m_pending.end() || m_done.find(path) != m_done.end())
+      return true;
+
+    ScanFolderPtr folder(new SScanFolder(kind, path, dbHash, dirNames));
+    m_pending.insert(make_pair(path, folder));
+    m_queued++;
+    lock.Leave();
+
+    AddJob(new CVideoScanPrefetchJob(folder));
+    return true;
+  }
+
+  ScanFolderPtr CVideoScanPrefetcher::Take(SScanFolder::KIND kind, const CStdString &path, bool wait)
+  {
+    CSingleLock lock(m_folderSection);
+    bool waited = false;
+    while (true)
+    {
+      Folders::iterator i = m_done.find(path);
+      if (i != m_done.end())
+      {
+        if (i->second->kind != kind)
+          return ScanFolderPtr();
+        ScanFolderPtr folder = i->second;
+        m_done.erase(i);
+        m_taken++;
+        if (waited)
+          m_waited++;
+        return folder;
+      }
+
+      i = m_pending.find(path);
+      if (i == m_pending.end() || i->second->kind != kind)
+        return ScanFolderPtr();
+      if (!wait || m_stopped)
+      { // no longer interested, the result is dropped when the job completes
+        m_pending.erase(i);
+        return ScanFolderPtr();
+      }
+
+      waited = true;
+      lock.Leave();
+      m_folderDone.WaitMSec(100);
+      lock.Enter();
+    }
+  }
+
+  void CVideoScanPrefetcher::Drop(const CFileItemList &items, SScanFolder::KIND kind)
+  {
+    CSingleLock lock(m_folderSection);
+    for (int i = 0; i < items.Size(); i++)
+    {
+      const CStdString &path = items[i]->GetPath();
+      Folders::iterator j = m_done.find(path);
+      if (j != m_done.end() && j->second->kind == kind)
+        m_done.erase(j);
+      // still being processed, the result is dropped when the job completes
+      j = m_pending.find(path);
+      if (j != m_pending.end() && j->second->kind == kind)
+        m_pending.erase(j);
+    }
+  }
+
+  void CVideoScanPrefetcher::Stop()
+  {
+    {
+      CSingleLock lock(m_folderSection);
+      m_stopped = true;
+      m_pending.clear();
+      m_done.clear();
+    }
+    CancelJobs();
+    m_folderDone.Set();
+  }
+
+  void CVideoScanPrefetcher::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+  {
+    {
+      CSingleLock lock(m_folderSection);
+      const ScanFolderPtr &folder = ((CVideoScanPrefetchJob *)job)->m_folder;
+      Folders::iterator i = m_pending.find(folder->path);
+      if (i != m_pending.end() && i->second == folder)
+      {
+        m_pending.erase(i);
+        if (success)
+          m_done.insert(make_pair(folder->path, folder));
+      }
+    }
+    m_folderDone.Set();
+    CJobQueue::OnJobComplete(jobID, success, job);
+  }
+}
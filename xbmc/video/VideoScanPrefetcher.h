@@ -0,0 +1,125 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <boost/shared_ptr.hpp>
+
+#include "FileItem.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/JobManager.h"
+#include "utils/StdString.h"
+
+namespace VIDEO
+{
+  /*! \brief What the prefetch stage found out about a folder
+   */
+  struct SScanFolder
+  {
+    enum KIND { FOLDER, /*!< movie or music video folder, listed and hashed the way CVideoInfoScanner::DoScan does */
+                SHOW    /*!< tvshow folder, listed recursively for its episodes */
+              };
+
+    SScanFolder(KIND folderKind, const CStdString &folderPath, const CStdString &folderDbHash, bool bDirNames)
+      : kind(folderKind), path(folderPath), dbHash(folderDbHash), dirNames(bDirNames), listed(false), fileCount(0) {}
+
+    KIND          kind;
+    CStdString    path;
+    CStdString    dbHash;   //!< hash in the database when queued, the listing is skipped if the fast hash matches it
+    bool          dirNames; //!< the folder uses folder names for lookups, affects the .nfo file search
+    CStdString    fastHash;
+    CStdString    hash;
+    bool          listed;   //!< items and hash are valid
+    int           fileCount;
+    CFileItemList items;    //!< video items carry the .nfo file found for them in the "nfofile" property (and "nfograbany")
+  };
+
+  typedef boost::shared_ptr<SScanFolder> ScanFolderPtr;
+
+  /*! \brief Runs the I/O bound part of a library scan ahead of the scanner
+
+   Folder listings, hashing and .nfo lookups are slow on network shares and
+   need no database, so they run on the job manager, a bounded number at a
+   time, while the scanner thread works through its (unchanged) order and
+   remains the only one writing to the database. The scanner queues folders
+   it is about to visit and takes the results as it gets there, doing the work
+   itself for anything that wasn't queued.
+
+   The queue is processed last in first out so queueing the subfolders of a
+   folder in reverse order matches the depth first order of the scan.
+   */
+  class CVideoScanPrefetcher : public CJobQueue
+  {
+  public:
+    /*! \brief Create a prefetcher
+     \param threads number of folders processed at once
+     \param depth maximum number of folders queued or waiting to be taken
+     */
+    CVideoScanPrefetcher(unsigned int threads, unsigned int depth);
+    virtual ~CVideoScanPrefetcher();
+
+    /*! \brief Queue a folder to be prefetched
+     \return false if the prefetcher is full or stopped, the caller then does the work itself
+     */
+    bool Queue(SScanFolder::KIND kind, const CStdString &path, const CStdString &dbHash, bool dirNames);
+
+    /*! \brief Number of folders that can be queued before the prefetcher is full
+     */
+    unsigned int GetFreeSlots();
+
+    /*! \brief Take the result for a folder
+     \param kind the kind of folder expected, a folder queued as a different kind is left queued
+     \param path the folder
+     \param wait whether to wait for the folder if it is still being processed, otherwise it is dropped
+     \return the result, or an empty pointer if the folder wasn't queued as this kind or isn't done
+     */
+    ScanFolderPtr Take(SScanFolder::KIND kind, const CStdString &path, bool wait = true);
+
+    /*! \brief Drop the folders of a listing that were queued but won't be taken
+     Folders queued as a different kind are kept, they are still to be visited.
+     \param items the listing the folders were queued for
+     \param kind the kind of folders to drop
+     */
+    void Drop(const CFileItemList &items, SScanFolder::KIND kind);
+
+    /*! \brief Cancel all outstanding work and wake anyone waiting in Take()
+     */
+    void Stop();
+
+    virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
+    unsigned int GetQueued() const { return m_queued; }
+    unsigned int GetTaken() const { return m_taken; }
+    unsigned int GetWaited() const { return m_waited; }
+
+  private:
+    typedef std::map<CStdString, ScanFolderPtr> Folders;
+    Folders          m_pending;  //!< queued or being processed
+    Folders          m_done;     //!< processed, not yet taken
+    unsigned int     m_depth;
+    bool             m_stopped;
+    unsigned int     m_queued;
+    unsigned int     m_taken;
+    unsigned int     m_waited;   //!< takes that had to wait for the folder
+    CCriticalSection m_folderSection;
+    CEvent           m_folderDone;
+  };
+}
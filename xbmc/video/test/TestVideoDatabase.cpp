@@ -0,0 +1,153 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "video/VideoDatabase.h"
+#include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/SortUtils.h"
+#include "utils/TimeUtils.h"
+#include "FileItem.h"
+
+#include "gtest/gtest.h"
+
+#include <iostream>
+#include <map>
+#include <string>
+
+#define BENCH_MOVIES      20000
+#define BENCH_PAGE        50
+#define BENCH_REQUESTS    20
+
+class CTestVideoDatabase : public CVideoDatabase
+{
+public:
+  bool Create(const char *name)
+  {
+    DatabaseSettings settings;
+    settings.type = "sqlite3";
+    settings.host = CSpecialProtocol::TranslatePath("special://temp/");
+    settings.name = name;
+    return Update(settings);
+  }
+
+  void AddMovies(int count)
+  {
+    std::map<std::string, std::string> artwork;
+    BeginBatch(1000);
+    for (int i = 0; i < count; i++)
+    {
+      CVideoInfoTag details;
+      // every fourth title has an article and numbers need a natural sort
+      details.m_strTitle.Format("%sMovie %d", i % 4 ? "" : "The ", (i * 7919) % count);
+      details.m_strFileNameAndPath.Format("/movies/%d/movie.mkv", i);
+      details.m_iYear = 1950 + i % 60;
+      details.m_fRating = (float)(i % 100) / 10;
+      SetDetailsForMovie(details.m_strFileNameAndPath, details, artwork);
+      BatchItemDone();
+    }
+    EndBatch();
+  }
+};
+
+/* Lists movies the way VideoLibrary.GetMovies does and returns the time it
+ * took in ms.
+ */
+static double GetMovies(CTestVideoDatabase &db, const SortDescription &sorting, CFileItemList &items)
+{
+  items.Clear();
+  int64_t start = CurrentHostCounter();
+  EXPECT_TRUE(db.GetMoviesNav("videodb://1/2/", items, -1, -1, -1, -1, -1, -1, 0, -1, sorting));
+  return (double)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+}
+
+static SortDescription Sorting(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, int limitEnd = -1)
+{
+  SortDescription sorting;
+  sorting.sortBy = sortBy;
+  sorting.sortOrder = sortOrder;
+  sorting.sortAttributes = attributes;
+  sorting.limitStart = limitEnd > 0 ? limitEnd - BENCH_PAGE : 0;
+  sorting.limitEnd = limitEnd;
+  return sorting;
+}
+
+/* A page has to hold the same movies in the same order as the matching part
+ * of the full listing, wherever the sorting happened.
+ */
+static void ExpectPage(CTestVideoDatabase &db, SortBy sortBy, SortOrder sortOrder, SortAttribute attributes)
+{
+  CFileItemList all, page;
+  GetMovies(db, Sorting(sortBy, sortOrder, attributes), all);
+  for (int end = BENCH_PAGE; end <= 3 * BENCH_PAGE; end += BENCH_PAGE)
+  {
+    GetMovies(db, Sorting(sortBy, sortOrder, attributes, end), page);
+    ASSERT_EQ(BENCH_PAGE, page.Size()) << "sort " << sortBy;
+    EXPECT_EQ(all.Size(), page.GetProperty("total").asInteger()) << "sort " << sortBy;
+    for (int i = 0; i < page.Size(); i++)
+      EXPECT_EQ(all[end - BENCH_PAGE + i]->GetPath(), page[i]->GetPath()) << "sort " << sortBy << " item " << end - BENCH_PAGE + i;
+  }
+}
+
+TEST(TestVideoDatabase, PagedSorting)
+{
+  CTestVideoDatabase db;
+  ASSERT_TRUE(db.Create("TestVideoPaging"));
+  db.AddMovies(1000);
+
+  ExpectPage(db, SortByTitle, SortOrderAscending, SortAttributeIgnoreArticle);
+  ExpectPage(db, SortByTitle, SortOrderDescending, SortAttributeNone);
+  ExpectPage(db, SortByYear, SortOrderAscending, SortAttributeNone);
+  ExpectPage(db, SortByRating, SortOrderDescending, SortAttributeNone);
+  ExpectPage(db, SortByDateAdded, SortOrderDescending, SortAttributeIgnoreFolders);
+  ExpectPage(db, SortByDateAdded, SortOrderAscending, SortAttributeIgnoreFolders);
+
+  CFileItemList page;
+  GetMovies(db, Sorting(SortByRandom, SortOrderAscending, SortAttributeNone, BENCH_PAGE), page);
+  EXPECT_EQ(BENCH_PAGE, page.Size());
+
+  db.Close();
+}
+
+TEST(TestVideoDatabase, PagedGetMoviesBenchmark)
+{
+  CTestVideoDatabase db;
+  ASSERT_TRUE(db.Create("TestVideoPagingBenchmark"));
+  db.AddMovies(BENCH_MOVIES);
+
+  const SortBy sorts[] = { SortByTitle, SortByDateAdded, SortByRandom };
+  const char *names[] = { "title", "dateadded", "random" };
+  for (unsigned int i = 0; i < sizeof(sorts) / sizeof(sorts[0]); i++)
+  {
+    // a page used to cost as much as the full listing
+    CFileItemList items;
+    double full = 0, paged = 0;
+    for (int request = 0; request < BENCH_REQUESTS; request++)
+    {
+      full += GetMovies(db, Sorting(sorts[i], SortOrderAscending, SortAttributeIgnoreArticle), items);
+      paged += GetMovies(db, Sorting(sorts[i], SortOrderAscending, SortAttributeIgnoreArticle, BENCH_PAGE * (request + 1)), items);
+    }
+    std::cout << "movies sorted by " << names[i] << ": "
+              << "all " << BENCH_MOVIES << " " << full / BENCH_REQUESTS << " ms, "
+              << "page of " << BENCH_PAGE << " " << paged / BENCH_REQUESTS << " ms" << std::endl;
+    EXPECT_EQ(BENCH_PAGE, items.Size());
+  }
+
+  db.Close();
+}
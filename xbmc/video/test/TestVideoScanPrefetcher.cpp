@@ -0,0 +1,100 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "video/VideoScanPrefetcher.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "utils/URIUtils.h"
+#include "FileItem.h"
+
+#include "gtest/gtest.h"
+
+class TestVideoScanPrefetcher : public testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    m_folder = URIUtils::AddFileToFolder(CSpecialProtocol::TranslatePath("special://temp/"), "TestVideoScanPrefetcher/");
+    m_movie = URIUtils::AddFileToFolder(m_folder, "movie.avi");
+    ASSERT_TRUE(XFILE::CDirectory::Create(m_folder));
+    XFILE::CFile file;
+    ASSERT_TRUE(file.OpenForWrite(m_movie, true));
+    file.Write("movie", 5);
+    file.Close();
+
+    // the listing of the parent folder DoScan() queues the folder for
+    CFileItemPtr item(new CFileItem(m_folder, true));
+    m_items.Add(item);
+  }
+
+  virtual void TearDown()
+  {
+    XFILE::CFile::Delete(m_movie);
+    XFILE::CDirectory::Remove(m_folder);
+  }
+
+  CStdString    m_folder;
+  CStdString    m_movie;
+  CFileItemList m_items;
+};
+
+TEST_F(TestVideoScanPrefetcher, ChangedFolderIsTaken)
+{
+  VIDEO::CVideoScanPrefetcher prefetcher(1, 8);
+  ASSERT_TRUE(prefetcher.Queue(VIDEO::SScanFolder::FOLDER, m_folder, "", false));
+
+  // RetrieveVideoInfo() drops the show listings it skipped, the folder is kept
+  prefetcher.Drop(m_items, VIDEO::SScanFolder::SHOW);
+
+  VIDEO::ScanFolderPtr folder = prefetcher.Take(VIDEO::SScanFolder::FOLDER, m_folder);
+  ASSERT_TRUE(folder.get() != NULL);
+  EXPECT_TRUE(folder->listed);
+  EXPECT_FALSE(folder->hash.IsEmpty());
+  ASSERT_EQ(1, folder->items.Size());
+  EXPECT_EQ(m_movie, folder->items[0]->GetPath());
+  EXPECT_EQ(1U, prefetcher.GetTaken());
+}
+
+TEST_F(TestVideoScanPrefetcher, SkippedShowIsDropped)
+{
+  VIDEO::CVideoScanPrefetcher prefetcher(1, 8);
+  ASSERT_TRUE(prefetcher.Queue(VIDEO::SScanFolder::SHOW, m_folder, "", false));
+
+  prefetcher.Drop(m_items, VIDEO::SScanFolder::SHOW);
+
+  EXPECT_TRUE(prefetcher.Take(VIDEO::SScanFolder::SHOW, m_folder).get() == NULL);
+  EXPECT_EQ(0U, prefetcher.GetTaken());
+  EXPECT_EQ(8U, prefetcher.GetFreeSlots());
+}
+
+TEST_F(TestVideoScanPrefetcher, OtherKindIsNotTaken)
+{
+  VIDEO::CVideoScanPrefetcher prefetcher(1, 8);
+  ASSERT_TRUE(prefetcher.Queue(VIDEO::SScanFolder::SHOW, m_folder, "", false));
+
+  // DoScan() visits the show folder before RetrieveVideoInfo() lists it
+  EXPECT_TRUE(prefetcher.Take(VIDEO::SScanFolder::FOLDER, m_folder).get() == NULL);
+
+  VIDEO::ScanFolderPtr folder = prefetcher.Take(VIDEO::SScanFolder::SHOW, m_folder);
+  ASSERT_TRUE(folder.get() != NULL);
+  EXPECT_EQ(VIDEO::SScanFolder::SHOW, folder->kind);
+  EXPECT_EQ(1U, prefetcher.GetTaken());
+}